@@ -0,0 +1,66 @@
+#include <benchmark/benchmark.h>
+#include <Arduino.h>
+#include <vector>
+#include <Aquarea.h>
+
+// Response packet: magic, data size, 200 data bytes, checksum
+static std::vector<uint8_t> createResponsePacket()
+{
+    std::vector<uint8_t> packet(203, 0x55); // Enumerated values decode to 0
+    packet[0] = 0x71;
+    packet[1] = 200;
+    packet[2] = 0x01;
+    packet[3] = 0x10;
+    packet[143] = 128 + 45; // Temperatures are offset by 128
+    packet[144] = 128 + 38;
+
+    uint8_t sum = 0;
+    for (size_t i = 0; i < packet.size() - 1; i++)
+        sum += packet[i];
+    packet.back() = -sum;
+    return packet;
+}
+
+
+static void BM_Aquarea_ReadPacket(benchmark::State& state)
+{
+    Aquarea aquarea;
+    std::vector<uint8_t> packet = createResponsePacket();
+    for (auto _ : state)
+    {
+        Serial.injectRx(packet.data(), packet.size());
+        if (!aquarea.readPacket())
+        {
+            state.SkipWithError(aquarea.getLastError().c_str());
+            break;
+        }
+    }
+    state.SetBytesProcessed(state.iterations() * packet.size());
+}
+BENCHMARK(BM_Aquarea_ReadPacket);
+
+
+static void BM_Aquarea_DecodeAllTopics(benchmark::State& state)
+{
+    Aquarea aquarea;
+    std::vector<uint8_t> packet = createResponsePacket();
+    Serial.injectRx(packet.data(), packet.size());
+    if (!aquarea.readPacket())
+    {
+        state.SkipWithError(aquarea.getLastError().c_str());
+        return;
+    }
+
+    std::vector<TopicId> topicIds = Aquarea::getAllTopicIds();
+    for (auto _ : state)
+    {
+        for (TopicId topicId : topicIds)
+        {
+            Topic topic = aquarea.getTopic(topicId);
+            benchmark::DoNotOptimize(topic.getValue());
+            benchmark::DoNotOptimize(topic.getDescription());
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * topicIds.size());
+}
+BENCHMARK(BM_Aquarea_DecodeAllTopics);
@@ -0,0 +1,94 @@
+#include <benchmark/benchmark.h>
+#include <HomeWizardP1Measurement.h>
+
+// Response of a HomeWizard P1 meter to GET /api/v1/data (3 phases and gas)
+static const char _v1Response[] =
+    "{\"wifi_ssid\":\"Wireless\",\"wifi_strength\":72,\"smr_version\":50,"
+    "\"meter_model\":\"ISKRA 2M550T-1012\",\"unique_id\":\"4530303434303037313331363530363137\","
+    "\"active_tariff\":2,\"total_power_import_kwh\":21804.209,\"total_power_import_t1_kwh\":11526.318,"
+    "\"total_power_import_t2_kwh\":10277.891,\"total_power_export_kwh\":8639.283,"
+    "\"total_power_export_t1_kwh\":2543.166,\"total_power_export_t2_kwh\":6096.117,"
+    "\"active_power_w\":1193,\"active_power_l1_w\":521,\"active_power_l2_w\":201,\"active_power_l3_w\":471,"
+    "\"active_voltage_l1_v\":230.1,\"active_voltage_l2_v\":231.4,\"active_voltage_l3_v\":229.8,"
+    "\"active_current_a\":5,\"active_current_l1_a\":2,\"active_current_l2_a\":1,\"active_current_l3_a\":2,"
+    "\"voltage_sag_l1_count\":4,\"voltage_sag_l2_count\":3,\"voltage_sag_l3_count\":3,"
+    "\"voltage_swell_l1_count\":0,\"voltage_swell_l2_count\":0,\"voltage_swell_l3_count\":0,"
+    "\"any_power_fail_count\":10,\"long_power_fail_count\":3,"
+    "\"total_gas_m3\":7352.181,\"gas_timestamp\":230112143000,"
+    "\"gas_unique_id\":\"4730303339303031393339373435393139\","
+    "\"external\":[{\"unique_id\":\"4730303339303031393339373435393139\",\"type\":\"gas_meter\","
+    "\"timestamp\":230112143000,\"value\":7352.181,\"unit\":\"m3\"}]}";
+
+// Response to GET /api/measurement (API version 2)
+static const char _v2Response[] =
+    "{\"protocol_version\":50,\"meter_model\":\"ISKRA 2M550T-1012\","
+    "\"unique_id\":\"4530303434303037313331363530363137\",\"timestamp\":\"2023-01-12T14:30:15\","
+    "\"tariff\":2,\"energy_import_kwh\":21804.209,\"energy_import_t1_kwh\":11526.318,"
+    "\"energy_import_t2_kwh\":10277.891,\"energy_export_kwh\":8639.283,"
+    "\"energy_export_t1_kwh\":2543.166,\"energy_export_t2_kwh\":6096.117,"
+    "\"power_w\":1193,\"power_l1_w\":521,\"power_l2_w\":201,\"power_l3_w\":471,"
+    "\"voltage_l1_v\":230.1,\"voltage_l2_v\":231.4,\"voltage_l3_v\":229.8,"
+    "\"current_a\":5.2,\"current_l1_a\":2.3,\"current_l2_a\":0.9,\"current_l3_a\":2.0,"
+    "\"voltage_sag_l1_count\":4,\"voltage_sag_l2_count\":3,\"voltage_sag_l3_count\":3,"
+    "\"voltage_swell_l1_count\":0,\"voltage_swell_l2_count\":0,\"voltage_swell_l3_count\":0,"
+    "\"any_power_fail_count\":10,\"long_power_fail_count\":3,\"average_power_15m_w\":1021.0,"
+    "\"monthly_power_peak_w\":4710.0,\"monthly_power_peak_timestamp\":\"2023-01-04T18:15:00\","
+    "\"external\":[{\"unique_id\":\"4730303339303031393339373435393139\",\"type\":\"gas_meter\","
+    "\"timestamp\":\"2023-01-12T14:30:00\",\"value\":7352.181,\"unit\":\"m3\"}]}";
+
+
+static void parseResponse(
+    const char* response,
+    P1ApiVersion version,
+    const JsonDocument& filterDoc,
+    JsonDocument& responseDoc,
+    P1Measurement& measurement)
+{
+    deserializeJson(responseDoc, response, DeserializationOption::Filter(filterDoc));
+    parseP1Measurement(responseDoc.as<JsonObjectConst>(), version, measurement);
+}
+
+
+static void BM_HomeWizardP1_ParseV1Response(benchmark::State& state)
+{
+    JsonDocument filterDoc;
+    addP1MeasurementFilter(filterDoc.to<JsonObject>(), P1ApiVersion::V1);
+    JsonDocument responseDoc;
+    P1Measurement measurement;
+
+    for (auto _ : state)
+    {
+        parseResponse(_v1Response, P1ApiVersion::V1, filterDoc, responseDoc, measurement);
+        benchmark::DoNotOptimize(measurement);
+    }
+
+    if ((measurement.phaseCount != 3) || (measurement.gasTimestamp != 230112143000))
+        state.SkipWithError("Unexpected measurement");
+    state.SetBytesProcessed(state.iterations() * (sizeof(_v1Response) - 1));
+}
+BENCHMARK(BM_HomeWizardP1_ParseV1Response);
+
+
+static void BM_HomeWizardP1_ParseV2Response(benchmark::State& state)
+{
+    JsonDocument filterDoc;
+    addP1MeasurementFilter(filterDoc.to<JsonObject>(), P1ApiVersion::V2);
+    JsonDocument responseDoc;
+    P1Measurement measurement;
+
+    // Start from a V1 measurement; the V2 response has no gas properties, so those must be reset.
+    JsonDocument v1FilterDoc;
+    addP1MeasurementFilter(v1FilterDoc.to<JsonObject>(), P1ApiVersion::V1);
+    parseResponse(_v1Response, P1ApiVersion::V1, v1FilterDoc, responseDoc, measurement);
+
+    for (auto _ : state)
+    {
+        parseResponse(_v2Response, P1ApiVersion::V2, filterDoc, responseDoc, measurement);
+        benchmark::DoNotOptimize(measurement);
+    }
+
+    if ((measurement.phaseCount != 3) || (measurement.gasM3 != 0) || (measurement.gasTimestamp != 0))
+        state.SkipWithError("Measurement not reset");
+    state.SetBytesProcessed(state.iterations() * (sizeof(_v2Response) - 1));
+}
+BENCHMARK(BM_HomeWizardP1_ParseV2Response);
@@ -0,0 +1,75 @@
+#include <benchmark/benchmark.h>
+#include <Arduino.h>
+#include <InfluxExporter.h>
+#include <InfluxStandIn.h>
+#include <Log.h>
+
+constexpr time_t START_TIME = 1700000000;
+
+struct HeatLogEntry
+{
+    time_t time;
+    float tInput;
+    float tOutput;
+    float tBuffer;
+    int valveSeconds;
+    bool isOn;
+};
+
+
+// Exports a log of a day's minute readings (like HeatMon's) to a local receiver over HTTP,
+// including line protocol formatting, gzip compression and the receiver's decompression.
+static void BM_InfluxExporter_Export(benchmark::State& state)
+{
+    constexpr uint16_t logSize = 1440;
+    StaticLog<HeatLogEntry> log(logSize, MemoryType::Internal);
+    InfluxStandIn server;
+    InfluxExporter exporter(2000, 0);
+    exporter.begin(server.getWriteUrl().c_str(), "", "heatmon");
+
+    SyncCursor cursor(logSize);
+    exporter.addSource(
+        cursor,
+        [&log](InfluxLineWriter& output, uint16_t unsentEntries, uint16_t maxEntries)
+        {
+            uint16_t entries = 0;
+            for (auto i = log.at(-unsentEntries); (i != log.end()) && (entries < maxEntries); ++i, ++entries)
+            {
+                output.beginLine("heat");
+                output.addField("tInput", i->tInput, 2);
+                output.addField("tOutput", i->tOutput, 2);
+                output.addField("tBuffer", i->tBuffer, 2);
+                output.addField("valveSeconds", i->valveSeconds);
+                output.addField("isOn", i->isOn);
+                output.endLine(i->time);
+            }
+            return entries;
+        });
+
+    for (int i = 0; i < logSize; i++)
+    {
+        HeatLogEntry entry = { START_TIME + i * 60, 45.0F + (i % 50) * 0.1F, 38.0F + (i % 30) * 0.1F, 50.5F, i % 60, (i % 7) != 0 };
+        log.add(&entry);
+    }
+
+    for (auto _ : state)
+    {
+        for (int i = 0; i < logSize; i++) cursor.add();
+        while (cursor.getUnsent() > 0)
+        {
+            if (!exporter.run(START_TIME) && (exporter.getStats().failures != 0))
+            {
+                state.SkipWithError(exporter.getLastError().c_str());
+                return;
+            }
+        }
+    }
+
+    const InfluxExporterStats& stats = exporter.getStats();
+    state.counters["batch_size"] = exporter.getBatchSize();
+    state.counters["compression"] = stats.getCompressionRatio();
+    state.counters["requests"] = benchmark::Counter(server.getRequestCount(), benchmark::Counter::kAvgIterations);
+    state.SetItemsProcessed(stats.lines);
+    state.SetBytesProcessed(stats.bytes);
+}
+BENCHMARK(BM_InfluxExporter_Export)->Unit(benchmark::kMillisecond)->UseRealTime(); // Mostly waiting for the receiver
@@ -0,0 +1,92 @@
+#include <benchmark/benchmark.h>
+#include <Log.h>
+
+struct SampleEntry
+{
+    time_t time;
+    float value1;
+    float value2;
+    uint32_t count;
+};
+
+
+static void BM_StaticLog_Add(benchmark::State& state)
+{
+    StaticLog<SampleEntry> log(state.range(0), MemoryType::Internal);
+    SampleEntry entry = { 0, 1.5F, 2.5F, 0 };
+    for (auto _ : state)
+    {
+        entry.time++;
+        benchmark::DoNotOptimize(log.add(&entry));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_StaticLog_Add)->Arg(64)->Arg(1024);
+
+
+static void BM_StaticLog_Iterate(benchmark::State& state)
+{
+    StaticLog<SampleEntry> log(state.range(0), MemoryType::Internal);
+    SampleEntry entry = { 0, 1.5F, 2.5F, 1 };
+    for (int i = 0; i < state.range(0) * 3 / 2; i++)
+    {
+        entry.time = i;
+        log.add(&entry);
+    }
+
+    for (auto _ : state)
+    {
+        uint32_t total = 0;
+        for (SampleEntry& logEntry : log)
+            total += logEntry.count;
+        benchmark::DoNotOptimize(total);
+    }
+    state.SetItemsProcessed(state.iterations() * log.count());
+}
+BENCHMARK(BM_StaticLog_Iterate)->Arg(64)->Arg(1024);
+
+
+static void BM_StaticLog_AtFromEnd(benchmark::State& state)
+{
+    StaticLog<SampleEntry> log(1024, MemoryType::Internal);
+    SampleEntry entry = { 0, 1.5F, 2.5F, 1 };
+    for (int i = 0; i < 1500; i++)
+        log.add(&entry);
+
+    uint16_t n = 0;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(&*log.at(-1 - n));
+        n = (n + 37) % log.count();
+    }
+}
+BENCHMARK(BM_StaticLog_AtFromEnd);
+
+
+static void BM_StringLog_Add(benchmark::State& state)
+{
+    StringLog log(state.range(0), 80, MemoryType::Internal);
+    const char* message = "12:34:56 WiFi connected. IP address: 192.168.1.100";
+    for (auto _ : state)
+        benchmark::DoNotOptimize(log.add(message));
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_StringLog_Add)->Arg(32)->Arg(256);
+
+
+static void BM_StringLog_Iterate(benchmark::State& state)
+{
+    StringLog log(state.range(0), 80, MemoryType::Internal);
+    for (int i = 0; i < state.range(0) * 3 / 2; i++)
+        log.add("12:34:56 WiFi connected. IP address: 192.168.1.100");
+
+    for (auto _ : state)
+    {
+        size_t totalLength = 0;
+        for (const char* message : log)
+            totalLength += strlen(message);
+        benchmark::DoNotOptimize(totalLength);
+    }
+    state.SetItemsProcessed(state.iterations() * log.count());
+}
+BENCHMARK(BM_StringLog_Iterate)->Arg(32)->Arg(256);
@@ -0,0 +1,79 @@
+#include <benchmark/benchmark.h>
+#include <vector>
+#include <MIDI.h>
+
+static void appendDWord(std::vector<uint8_t>& data, uint32_t value)
+{
+    for (int shift = 24; shift >= 0; shift -= 8)
+        data.push_back(value >> shift);
+}
+
+
+static void appendVariableLength(std::vector<uint8_t>& data, uint32_t value)
+{
+    uint8_t bytes[4];
+    int count = 0;
+    do
+    {
+        bytes[count++] = value & 0x7F;
+        value >>= 7;
+    }
+    while (value != 0);
+    while (count-- > 0)
+        data.push_back(bytes[count] | ((count > 0) ? 0x80 : 0));
+}
+
+
+static void appendTrack(std::vector<uint8_t>& data, const std::vector<uint8_t>& events)
+{
+    data.insert(data.end(), { 'M', 'T', 'r', 'k' });
+    appendDWord(data, events.size());
+    data.insert(data.end(), events.begin(), events.end());
+}
+
+
+// Format 1 file with a tempo track and a note track using running status.
+static std::vector<uint8_t> createMIDIFile(int notes)
+{
+    std::vector<uint8_t> data = { 'M', 'T', 'h', 'd', 0, 0, 0, 6, 0, 1, 0, 2, 0x01, 0xE0 };
+
+    std::vector<uint8_t> tempoTrack = {
+        0x00, 0xFF, 0x03, 5, 'T', 'e', 'm', 'p', 'o',
+        0x00, 0xFF, 0x51, 0x03, 0x07, 0xA1, 0x20, // 120 BPM
+        0x00, 0xFF, 0x58, 0x04, 0x04, 0x02, 0x18, 0x08, // 4/4
+        0x00, 0xFF, 0x2F, 0x00 };
+    appendTrack(data, tempoTrack);
+
+    std::vector<uint8_t> noteTrack = { 0x00, 0xFF, 0x03, 6, 'M', 'e', 'l', 'o', 'd', 'y' };
+    for (int i = 0; i < notes; i++)
+    {
+        uint8_t note = 60 + (i % 12);
+        appendVariableLength(noteTrack, (i == 0) ? 0 : 240);
+        noteTrack.insert(noteTrack.end(), { 0x90, note, 100 });
+        appendVariableLength(noteTrack, 240);
+        noteTrack.insert(noteTrack.end(), { note, 0 }); // Note off using running status
+    }
+    noteTrack.insert(noteTrack.end(), { 0x00, 0xFF, 0x2F, 0x00 });
+    appendTrack(data, noteTrack);
+
+    return data;
+}
+
+
+static void BM_MIDI_Parse(benchmark::State& state)
+{
+    std::vector<uint8_t> data = createMIDIFile(state.range(0));
+    MIDI::File midiFile;
+    for (auto _ : state)
+    {
+        if (!midiFile.parse(data.data(), data.size()))
+        {
+            state.SkipWithError(midiFile.getError().c_str());
+            break;
+        }
+        benchmark::DoNotOptimize(midiFile.getTracks().data());
+    }
+    state.SetBytesProcessed(state.iterations() * data.size());
+    state.SetItemsProcessed(state.iterations() * state.range(0) * 2);
+}
+BENCHMARK(BM_MIDI_Parse)->Arg(100)->Arg(2000);
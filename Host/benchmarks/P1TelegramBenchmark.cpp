@@ -0,0 +1,76 @@
+#include <benchmark/benchmark.h>
+#include <MemoryStream.h>
+#include <P1Telegram.h>
+
+// DSMR 5.0 telegram (3 phases and gas)
+static const char _telegram[] =
+    "/ISK5\\2M550T-1012\r\n"
+    "\r\n"
+    "1-3:0.2.8(50)\r\n"
+    "0-0:1.0.0(230112143015W)\r\n"
+    "0-0:96.1.1(4530303434303037313331363530363137)\r\n"
+    "1-0:1.8.1(011526.318*kWh)\r\n"
+    "1-0:1.8.2(010277.891*kWh)\r\n"
+    "1-0:2.8.1(002543.166*kWh)\r\n"
+    "1-0:2.8.2(006096.117*kWh)\r\n"
+    "0-0:96.14.0(0002)\r\n"
+    "1-0:1.7.0(01.193*kW)\r\n"
+    "1-0:2.7.0(00.000*kW)\r\n"
+    "0-0:96.7.21(00010)\r\n"
+    "0-0:96.7.9(00003)\r\n"
+    "1-0:32.32.0(00004)\r\n"
+    "1-0:52.32.0(00003)\r\n"
+    "1-0:72.32.0(00003)\r\n"
+    "1-0:32.36.0(00000)\r\n"
+    "1-0:52.36.0(00000)\r\n"
+    "1-0:72.36.0(00000)\r\n"
+    "0-0:96.13.0()\r\n"
+    "1-0:32.7.0(230.1*V)\r\n"
+    "1-0:52.7.0(231.4*V)\r\n"
+    "1-0:72.7.0(229.8*V)\r\n"
+    "1-0:31.7.0(002*A)\r\n"
+    "1-0:51.7.0(001*A)\r\n"
+    "1-0:71.7.0(002*A)\r\n"
+    "1-0:21.7.0(00.521*kW)\r\n"
+    "1-0:41.7.0(00.201*kW)\r\n"
+    "1-0:61.7.0(00.471*kW)\r\n"
+    "1-0:22.7.0(00.000*kW)\r\n"
+    "1-0:42.7.0(00.000*kW)\r\n"
+    "1-0:62.7.0(00.000*kW)\r\n"
+    "0-1:24.1.0(003)\r\n"
+    "0-1:96.1.0(4730303339303031393339373435393139)\r\n"
+    "0-1:24.2.1(230112143000W)(07352.181*m3)\r\n"
+    "!5F3E\r\n";
+
+
+static void BM_P1Telegram_ReadFrom(benchmark::State& state)
+{
+    P1Telegram telegram;
+    MemoryStream stream(_telegram);
+    for (auto _ : state)
+    {
+        stream.rewind();
+        benchmark::DoNotOptimize(telegram.readFrom(stream));
+    }
+    state.SetBytesProcessed(state.iterations() * (sizeof(_telegram) - 1));
+}
+BENCHMARK(BM_P1Telegram_ReadFrom);
+
+
+static void BM_P1Telegram_GetValues(benchmark::State& state)
+{
+    P1Telegram telegram;
+    MemoryStream stream(_telegram);
+    telegram.readFrom(stream);
+
+    for (auto _ : state)
+    {
+        float total = 0;
+        for (int id = 0; id < static_cast<int>(P1Telegram::PropertyId::Gas); id++)
+            total += telegram.getFloatValue(static_cast<P1Telegram::PropertyId>(id));
+        String timestamp;
+        total += telegram.getFloatValue(P1Telegram::PropertyId::Gas, &timestamp);
+        benchmark::DoNotOptimize(total);
+    }
+}
+BENCHMARK(BM_P1Telegram_GetValues);
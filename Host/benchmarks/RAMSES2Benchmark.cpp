@@ -0,0 +1,94 @@
+#include <benchmark/benchmark.h>
+#include <RAMSES2.h>
+
+class NullLogger : public ILogger
+{
+    public:
+        void logEvent(const char* msg) override {}
+        void logEvent(String format, ...) override {}
+        void logEvent(const __FlashStringHelper* format, ...) override {}
+};
+
+
+static uint32_t _packetsReceived = 0;
+
+
+class RAMSES2Fixture : public benchmark::Fixture
+{
+    public:
+        CC1101 cc1101 { 1, 14, 12, 13, 15, 4, 5 };
+        SimpleLED led { 2 };
+        NullLogger logger;
+        RAMSES2 ramses2 { cc1101, Serial1, led, logger };
+        RAMSES2Packet packet;
+        uint8_t frame[RAMSES_MAX_FRAME_SIZE];
+        size_t frameSize = 0;
+
+        void SetUp(const benchmark::State& state) override
+        {
+            // Reading the RSSI from the CC1101 involves delays which shouldn't be measured
+            Host::useVirtualTime(true);
+
+            packet.type = RAMSES2PackageType::Info;
+            packet.opcode = RAMSES2Opcode::ZoneTemperature;
+            packet.addr[0].deviceType = RAMSES2DeviceType::CTL;
+            packet.addr[0].deviceId = 0x0ABCD;
+            packet.addr[2].deviceType = RAMSES2DeviceType::CTL;
+            packet.addr[2].deviceId = 0x0ABCD;
+            packet.payloadPtr = new TemperaturePayload();
+            // Temperatures for 4 zones
+            const uint8_t temperatures[] = { 0, 0x07, 0xD0, 1, 0x08, 0x34, 2, 0x07, 0x6C, 3, 0x08, 0x98 };
+            packet.payloadPtr->size = sizeof(temperatures);
+            memcpy(packet.payloadPtr->bytes, temperatures, sizeof(temperatures));
+
+            frameSize = ramses2.createFrame(packet, frame);
+            ramses2.onPacketReceived([](const RAMSES2Packet* packetPtr) { _packetsReceived++; delete packetPtr; });
+            _packetsReceived = 0;
+            ramses2.resetFrame(true);
+        }
+
+        void TearDown(const benchmark::State& state) override
+        {
+            delete packet.payloadPtr;
+            packet.payloadPtr = nullptr;
+            Host::useVirtualTime(false);
+        }
+};
+
+
+BENCHMARK_F(RAMSES2Fixture, BM_RAMSES2_CreateFrame)(benchmark::State& state)
+{
+    for (auto _ : state)
+        benchmark::DoNotOptimize(ramses2.createFrame(packet, frame));
+    state.SetBytesProcessed(state.iterations() * frameSize);
+}
+
+
+BENCHMARK_F(RAMSES2Fixture, BM_RAMSES2_DecodeFrame)(benchmark::State& state)
+{
+    for (auto _ : state)
+        ramses2.dataReceived(frame, frameSize);
+
+    if ((ramses2.errors.getTotal() != 0) || (_packetsReceived != state.iterations()))
+        state.SkipWithError("Frame decoding failed");
+    state.SetBytesProcessed(state.iterations() * frameSize);
+}
+
+
+BENCHMARK_F(RAMSES2Fixture, BM_RAMSES2_DecodeFrameWithBitErrors)(benchmark::State& state)
+{
+    // Corrupt one bit of an encoded "11" bit pair, so it decodes differently and is repaired using the checksum.
+    size_t i = 10; // Skip preamble and header
+    while ((i < frameSize - 2) && ((frame[i] & 0x0F) != 0x05)) i++;
+    frame[i] ^= 0x01;
+    ramses2.maxManchesterBitErrors = 1;
+    uint32_t repairedBefore = ramses2.errors.repairedManchesterCode; // The fixture is reused across runs
+    for (auto _ : state)
+        ramses2.dataReceived(frame, frameSize);
+
+    if (_packetsReceived != state.iterations())
+        state.SkipWithError("Frame decoding failed");
+    if (ramses2.errors.repairedManchesterCode - repairedBefore != state.iterations())
+        state.SkipWithError("Frame was not repaired");
+    state.SetBytesProcessed(state.iterations() * frameSize);
+}
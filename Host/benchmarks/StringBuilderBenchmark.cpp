@@ -0,0 +1,107 @@
+#include <benchmark/benchmark.h>
+#include <StringBuilder.h>
+#include <HtmlWriter.h>
+
+static const char _icon[] PROGMEM = "Logo.png";
+static const char _css[] PROGMEM = "Styles.css";
+
+
+static void BM_StringBuilder_Print(benchmark::State& state)
+{
+    StringBuilder output(16 * 1024, MemoryType::Internal);
+    for (auto _ : state)
+    {
+        output.clear();
+        for (int i = 0; i < 100; i++)
+        {
+            output.print(F("<tr><td>"));
+            output.print(i);
+            output.println(F("</td></tr>"));
+        }
+        benchmark::DoNotOptimize(output.c_str());
+    }
+    state.SetBytesProcessed(state.iterations() * output.length());
+}
+BENCHMARK(BM_StringBuilder_Print);
+
+
+static void BM_StringBuilder_Printf(benchmark::State& state)
+{
+    StringBuilder output(16 * 1024, MemoryType::Internal);
+    for (auto _ : state)
+    {
+        output.clear();
+        for (int i = 0; i < 100; i++)
+            output.printf(F("<tr><td>%d</td><td>%0.1f</td><td>%s</td></tr>\r\n"), i, i * 0.1F, "text");
+        benchmark::DoNotOptimize(output.c_str());
+    }
+    state.SetBytesProcessed(state.iterations() * output.length());
+}
+BENCHMARK(BM_StringBuilder_Printf);
+
+
+static void BM_StringBuilder_LowSpaceChunks(benchmark::State& state)
+{
+    // Small buffer flushed using the low space callback, like a chunked HTTP response
+    StringBuilder output(1024, MemoryType::Internal);
+    size_t bytesFlushed = 0;
+    output.onLowSpace([&output, &bytesFlushed](size_t) { bytesFlushed += output.length(); output.clear(); });
+    for (auto _ : state)
+    {
+        for (int i = 0; i < 100; i++)
+            output.printf(F("<tr><td>%d</td><td>%0.1f</td><td>%s</td></tr>\r\n"), i, i * 0.1F, "text");
+    }
+    state.SetBytesProcessed(bytesFlushed + output.length());
+}
+BENCHMARK(BM_StringBuilder_LowSpaceChunks);
+
+
+static void BM_HtmlWriter_Page(benchmark::State& state)
+{
+    StringBuilder output(32 * 1024, MemoryType::Internal);
+    HtmlWriter html(output, _icon, _css, 40);
+    for (auto _ : state)
+    {
+        html.writeHeader(F("Benchmark"), true, true);
+        html.writeSectionStart(F("Section"));
+        html.writeTableStart();
+        for (int i = 0; i < 50; i++)
+        {
+            html.writeRowStart();
+            html.writeCell(i);
+            html.writeCell(i * 1.5F, F("%0.1f"));
+            html.writeGraphCell(i * 2.0F, 0, 100, F("bar"), true);
+            html.writeRowEnd();
+        }
+        html.writeTableEnd();
+        html.writeSectionEnd();
+        html.writeFooter();
+        benchmark::DoNotOptimize(output.c_str());
+    }
+    state.SetBytesProcessed(state.iterations() * output.length());
+}
+BENCHMARK(BM_HtmlWriter_Page);
+
+
+static void BM_HtmlWriter_Form(benchmark::State& state)
+{
+    StringBuilder output(32 * 1024, MemoryType::Internal);
+    HtmlWriter html(output, _icon, _css, 40);
+    for (auto _ : state)
+    {
+        html.writeHeader(F("Configuration"), true, true);
+        html.writeFormStart(F("/config"));
+        for (int i = 0; i < 10; i++)
+        {
+            html.writeTextBox(F("name"), F("Name"), F("value"), 32);
+            html.writeNumberBox(F("number"), F("Number"), i, 0, 100, 1);
+            html.writeCheckbox(F("check"), F("Check"), (i % 2) == 0);
+        }
+        html.writeSubmitButton();
+        html.writeFormEnd();
+        html.writeFooter();
+        benchmark::DoNotOptimize(output.c_str());
+    }
+    state.SetBytesProcessed(state.iterations() * output.length());
+}
+BENCHMARK(BM_HtmlWriter_Form);
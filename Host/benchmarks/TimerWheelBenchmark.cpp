@@ -0,0 +1,62 @@
+#include <benchmark/benchmark.h>
+#include <Arduino.h>
+#include <TimerWheel.h>
+
+constexpr uint32_t HOUR_MS = 3600 * 1000;
+constexpr uint32_t SAMPLE_INTERVAL_MS = 1000;
+constexpr uint32_t SYNC_INTERVAL_MS = 5 * 60 * 1000;
+constexpr uint32_t INFLUX_INTERVAL_MS = 10 * 1000;
+
+
+// Simulates an hour of HeatMon's jobs in virtual time: a 1 s sample job which integrates time (like the valve seconds)
+// and a sync job which blocks for the given number of milliseconds every 5 minutes, making samples late.
+// Counting one second per sample loses the skipped periods; integrating the elapsed time doesn't.
+static void BM_TimerWheel_SampleHour(benchmark::State& state)
+{
+    Host::useVirtualTime(true);
+    uint32_t blockMs = state.range(0);
+    uint32_t countedSeconds = 0;
+    uint32_t integratedMs = 0;
+    uint32_t overruns = 0;
+    uint32_t runs = 0;
+
+    for (auto _ : state)
+    {
+        TimerWheel timers;
+        int sampleJob = -1;
+        countedSeconds = 0;
+        integratedMs = 0;
+        sampleJob = timers.addPeriodic(
+            "Sample",
+            SAMPLE_INTERVAL_MS,
+            [&]()
+            {
+                countedSeconds++;
+                integratedMs += timers.getElapsedMs(sampleJob);
+            },
+            SAMPLE_INTERVAL_MS);
+        timers.addPeriodic("Sync", SYNC_INTERVAL_MS, [blockMs]() { Host::advanceMillis(blockMs); }, SYNC_INTERVAL_MS / 2);
+        timers.addPeriodic("Influx", INFLUX_INTERVAL_MS, []() {}, INFLUX_INTERVAL_MS);
+
+        uint32_t startMillis = millis();
+        while (true)
+        {
+            timers.run();
+            if (millis() - startMillis >= HOUR_MS) break;
+            // Jobs may have taken time, so the time to the next deadline is determined afterwards.
+            Host::advanceMillis(timers.getTimeToNext());
+        }
+
+        overruns = timers.getJobStats(sampleJob).overruns;
+        runs = timers.getStats().runs;
+    }
+    Host::useVirtualTime(false);
+
+    if (integratedMs != HOUR_MS)
+        state.SkipWithError("Sample time not fully integrated");
+    state.counters["counted_s"] = countedSeconds;
+    state.counters["integrated_s"] = integratedMs / 1000;
+    state.counters["overruns"] = overruns;
+    state.SetItemsProcessed(state.iterations() * runs);
+}
+BENCHMARK(BM_TimerWheel_SampleHour)->Arg(0)->Arg(2500)->Arg(10000);
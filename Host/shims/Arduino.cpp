@@ -0,0 +1,413 @@
+#include <Arduino.h>
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <thread>
+#include "esp_app_desc.h"
+#include "esp_random.h"
+
+EspClass ESP;
+HardwareSerial Serial(0);
+HardwareSerial Serial1(1);
+HardwareSerial Serial2(2);
+
+namespace
+{
+    const auto _startTime = std::chrono::steady_clock::now();
+    std::atomic<bool> _useVirtualTime(false);
+    std::atomic<uint64_t> _virtualMicros(0);
+
+    constexpr int HOST_PINS = 64;
+    int _pinValues[HOST_PINS];
+    uint8_t _pinModes[HOST_PINS];
+    void (*_isrs[HOST_PINS])(void*);
+    void* _isrArgs[HOST_PINS];
+
+    esp_reset_reason_t _resetReason = ESP_RST_POWERON;
+    std::atomic<size_t> _allocationLimit(SIZE_MAX);
+    esp_app_desc_t _appDescription = { 0xABCD5432, 0, "host", "host", __TIME__, __DATE__, "host", { 0x48, 0x4F, 0x53, 0x54 } };
+
+    std::minstd_rand _random;
+    uint32_t _rtcUserMemory[128];
+
+    uint64_t currentMicros()
+    {
+        if (_useVirtualTime) return _virtualMicros;
+        return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - _startTime).count();
+    }
+
+    void callPlainIsr(void* arg)
+    {
+        reinterpret_cast<void (*)(void)>(arg)();
+    }
+}
+
+
+void Host::useVirtualTime(bool enable)
+{
+    if (enable && !_useVirtualTime)
+        _virtualMicros = currentMicros();
+    _useVirtualTime = enable;
+}
+
+
+bool Host::isVirtualTime()
+{
+    return _useVirtualTime;
+}
+
+
+void Host::advanceMicros(uint64_t us)
+{
+    _virtualMicros += us;
+}
+
+
+void Host::setPinValue(uint8_t pin, int value)
+{
+    if (pin < HOST_PINS) _pinValues[pin] = value;
+}
+
+
+int Host::getPinValue(uint8_t pin)
+{
+    return (pin < HOST_PINS) ? _pinValues[pin] : 0;
+}
+
+
+uint8_t Host::getPinMode(uint8_t pin)
+{
+    return (pin < HOST_PINS) ? _pinModes[pin] : 0;
+}
+
+
+void Host::triggerInterrupt(uint8_t pin)
+{
+    if ((pin < HOST_PINS) && (_isrs[pin] != nullptr))
+    {
+        setIsrContext(true);
+        _isrs[pin](_isrArgs[pin]);
+        setIsrContext(false);
+    }
+}
+
+
+void Host::setAllocationLimit(size_t maxSize)
+{
+    _allocationLimit = maxSize;
+}
+
+
+void* Host::allocate(size_t size)
+{
+    return (size > _allocationLimit) ? nullptr : malloc(size);
+}
+
+
+unsigned long millis()
+{
+    return static_cast<uint32_t>(currentMicros() / 1000);
+}
+
+
+unsigned long micros()
+{
+    return static_cast<uint32_t>(currentMicros());
+}
+
+
+int64_t esp_timer_get_time()
+{
+    return currentMicros();
+}
+
+
+void delay(uint32_t ms)
+{
+    delayMicroseconds(ms * 1000);
+}
+
+
+void delayMicroseconds(uint32_t us)
+{
+    if (_useVirtualTime)
+        _virtualMicros += us;
+    else
+        std::this_thread::sleep_for(std::chrono::microseconds(us));
+}
+
+
+void yield()
+{
+    if (!_useVirtualTime)
+        std::this_thread::yield();
+}
+
+
+void pinMode(uint8_t pin, uint8_t mode)
+{
+    if (pin >= HOST_PINS) return;
+    _pinModes[pin] = mode;
+    if (mode & PULLUP) _pinValues[pin] = HIGH;
+}
+
+
+void digitalWrite(uint8_t pin, uint8_t value)
+{
+    Host::setPinValue(pin, value);
+}
+
+
+int digitalRead(uint8_t pin)
+{
+    return Host::getPinValue(pin);
+}
+
+
+uint16_t analogRead(uint8_t pin)
+{
+    return Host::getPinValue(pin);
+}
+
+
+uint32_t analogReadMilliVolts(uint8_t pin)
+{
+    return uint32_t(Host::getPinValue(pin)) * 3300 / 4095;
+}
+
+
+void attachInterrupt(uint8_t pin, void (*isr)(void), int mode)
+{
+    attachInterruptArg(pin, callPlainIsr, reinterpret_cast<void*>(isr), mode);
+}
+
+
+void attachInterruptArg(uint8_t pin, void (*isr)(void*), void* arg, int mode)
+{
+    if (pin >= HOST_PINS) return;
+    _isrs[pin] = isr;
+    _isrArgs[pin] = arg;
+}
+
+
+void detachInterrupt(uint8_t pin)
+{
+    if (pin < HOST_PINS) _isrs[pin] = nullptr;
+}
+
+
+long random(long max)
+{
+    return (max <= 0) ? 0 : long(_random() % max);
+}
+
+
+long random(long min, long max)
+{
+    return (max <= min) ? min : min + random(max - min);
+}
+
+
+void randomSeed(unsigned long seed)
+{
+    _random.seed(seed);
+}
+
+
+uint32_t esp_random()
+{
+    static std::random_device randomDevice;
+    return randomDevice();
+}
+
+
+void esp_fill_random(void* buffer, size_t length)
+{
+    uint8_t* bytePtr = static_cast<uint8_t*>(buffer);
+    while (length > 0)
+    {
+        uint32_t random = esp_random();
+        size_t count = (length < sizeof(random)) ? length : sizeof(random);
+        memcpy(bytePtr, &random, count);
+        bytePtr += count;
+        length -= count;
+    }
+}
+
+
+bool psramFound()
+{
+    return false;
+}
+
+
+void* ps_malloc(size_t size)
+{
+    return malloc(size);
+}
+
+
+void enableLoopWDT()
+{
+}
+
+
+void disableLoopWDT()
+{
+}
+
+
+esp_reset_reason_t esp_reset_reason()
+{
+    return _resetReason;
+}
+
+
+void Host::setResetReason(esp_reset_reason_t reason)
+{
+    _resetReason = reason;
+}
+
+
+const esp_app_desc_t* esp_app_get_description()
+{
+    return &_appDescription;
+}
+
+
+void* heap_caps_malloc(size_t size, uint32_t caps)
+{
+    return malloc(size);
+}
+
+
+void* heap_caps_realloc(void* ptr, size_t size, uint32_t caps)
+{
+    return realloc(ptr, size);
+}
+
+
+void heap_caps_free(void* ptr)
+{
+    free(ptr);
+}
+
+
+size_t heap_caps_get_free_size(uint32_t caps)
+{
+    return (caps & MALLOC_CAP_SPIRAM) ? 0 : ESP.getFreeHeap();
+}
+
+
+size_t heap_caps_get_largest_free_block(uint32_t caps)
+{
+    return (caps & MALLOC_CAP_SPIRAM) ? 0 : ESP.getMaxAllocHeap();
+}
+
+
+uint32_t EspClass::getCycleCount()
+{
+    return static_cast<uint32_t>(currentMicros() * getCpuFreqMHz());
+}
+
+
+bool EspClass::rtcUserMemoryRead(uint32_t offset, uint32_t* data, size_t size)
+{
+    if ((offset * 4 + size) > sizeof(_rtcUserMemory)) return false;
+    memcpy(data, reinterpret_cast<uint8_t*>(_rtcUserMemory) + offset * 4, size);
+    return true;
+}
+
+
+bool EspClass::rtcUserMemoryWrite(uint32_t offset, uint32_t* data, size_t size)
+{
+    if ((offset * 4 + size) > sizeof(_rtcUserMemory)) return false;
+    memcpy(reinterpret_cast<uint8_t*>(_rtcUserMemory) + offset * 4, data, size);
+    return true;
+}
+
+
+void EspClass::restart()
+{
+    fprintf(stderr, "ESP.restart() called\n");
+    abort();
+}
+
+
+void HardwareSerial::begin(unsigned long baud, uint32_t config, int8_t rxPin, int8_t txPin, bool invert)
+{
+    _baud = baud;
+}
+
+
+int HardwareSerial::available()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _rx.size();
+}
+
+
+int HardwareSerial::peek()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _rx.empty() ? -1 : _rx.front();
+}
+
+
+int HardwareSerial::read()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_rx.empty()) return -1;
+    int result = _rx.front();
+    _rx.pop_front();
+    return result;
+}
+
+
+size_t HardwareSerial::read(uint8_t* buffer, size_t size)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    size_t count = std::min(size, _rx.size());
+    std::copy(_rx.begin(), _rx.begin() + count, buffer);
+    _rx.erase(_rx.begin(), _rx.begin() + count);
+    return count;
+}
+
+
+size_t HardwareSerial::readBytes(char* buffer, size_t length)
+{
+    // All RX data is injected up front, so waiting for the timeout wouldn't bring in more.
+    return read(reinterpret_cast<uint8_t*>(buffer), length);
+}
+
+
+size_t HardwareSerial::write(const uint8_t* buffer, size_t size)
+{
+    if (_captureTx)
+        _tx.append(reinterpret_cast<const char*>(buffer), size);
+    else
+        fwrite(buffer, 1, size, stdout);
+    return size;
+}
+
+
+void HardwareSerial::injectRx(const uint8_t* data, size_t size)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _rx.insert(_rx.end(), data, data + size);
+}
+
+
+void HardwareSerial::clearRx()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _rx.clear();
+}
+
+
+std::string HardwareSerial::takeTx()
+{
+    std::string result;
+    result.swap(_tx);
+    return result;
+}
@@ -0,0 +1,113 @@
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+// Host shim for the Arduino core. Covers the part of the ESP32 (and some ESP8266) API
+// used by the libraries, so they can be compiled, tested and benchmarked on a PC.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <time.h>
+#include <math.h>
+#include <algorithm>
+#include <functional>
+#include "pgmspace.h"
+#include "WString.h"
+#include "Print.h"
+#include "Stream.h"
+#include "Esp.h"
+#include "HardwareSerial.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+
+#define IRAM_ATTR
+#define DRAM_ATTR
+#define RTC_NOINIT_ATTR
+#define RTC_DATA_ATTR
+#define ICACHE_RAM_ATTR
+
+#define HIGH 0x1
+#define LOW 0x0
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define PULLUP 0x04
+#define INPUT_PULLUP 0x05
+#define PULLDOWN 0x08
+#define INPUT_PULLDOWN 0x09
+#define OPEN_DRAIN 0x10
+#define OUTPUT_OPEN_DRAIN 0x13
+#define RISING 0x01
+#define FALLING 0x02
+#define CHANGE 0x03
+#define LED_BUILTIN 2
+#define digitalPinToInterrupt(pin) (pin)
+
+// ESP8266 pin functions
+#define FUNCTION_0 0x08
+#define FUNCTION_1 0x18
+#define FUNCTION_2 0x28
+#define FUNCTION_3 0x38
+#define FUNCTION_4 0x48
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+// Newlib (used by the ESP toolchains) has this; glibc doesn't.
+inline float pow10f(float x) { return powf(10, x); }
+
+inline uint16_t word(uint8_t high, uint8_t low) { return (high << 8) | low; }
+
+unsigned long millis();
+unsigned long micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+void yield();
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+uint16_t analogRead(uint8_t pin);
+uint32_t analogReadMilliVolts(uint8_t pin);
+void attachInterrupt(uint8_t pin, void (*isr)(void), int mode);
+void attachInterruptArg(uint8_t pin, void (*isr)(void*), void* arg, int mode);
+void detachInterrupt(uint8_t pin);
+
+long random(long max);
+long random(long min, long max);
+void randomSeed(unsigned long seed);
+
+bool psramFound();
+void* ps_malloc(size_t size);
+void enableLoopWDT();
+void disableLoopWDT();
+
+namespace Host
+{
+    // Switches millis()/micros() to a simulated clock which only moves when advanced
+    // explicitly or by delay(). Lets time-dependent code run deterministically and fast.
+    void useVirtualTime(bool enable);
+    bool isVirtualTime();
+    void advanceMicros(uint64_t us);
+    inline void advanceMillis(uint32_t ms) { advanceMicros(uint64_t(ms) * 1000); }
+
+    // Simulated GPIO; pins driven by the code under test can be inspected and inputs can be set.
+    void setPinValue(uint8_t pin, int value);
+    int getPinValue(uint8_t pin);
+    uint8_t getPinMode(uint8_t pin);
+    void triggerInterrupt(uint8_t pin);
+
+    // Simulated reset; RTC_NOINIT_ATTR data survives unless the reason is ESP_RST_POWERON.
+    void setResetReason(esp_reset_reason_t reason);
+
+    // Simulated out of memory; Memory::allocate() fails for allocations above the limit.
+    void setAllocationLimit(size_t maxSize);
+    void* allocate(size_t size);
+}
+
+#define ESP_MALLOC(size) Host::allocate((size))
+
+#endif
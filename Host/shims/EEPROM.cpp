@@ -0,0 +1,20 @@
+#include "EEPROM.h"
+
+EEPROMClass EEPROM;
+
+
+bool EEPROMClass::begin(size_t size)
+{
+    if (_flash.size() < size) _flash.resize(size, 0xFF);
+    _data.assign(_flash.begin(), _flash.begin() + size);
+    return true;
+}
+
+
+bool EEPROMClass::commit()
+{
+    if (_data.empty()) return false;
+    std::copy(_data.begin(), _data.end(), _flash.begin());
+    _commitCount++;
+    return true;
+}
@@ -0,0 +1,31 @@
+#ifndef HOST_EEPROM_H
+#define HOST_EEPROM_H
+
+#include <vector>
+#include <Arduino.h>
+
+// Host shim for the (emulated) EEPROM. Contents survive end()/begin(), like flash survives a reboot.
+class EEPROMClass
+{
+    public:
+        bool begin(size_t size);
+        void end() { _data.clear(); }
+        uint8_t read(int address) { return (address < int(_data.size())) ? _data[address] : 0; }
+        void write(int address, uint8_t value) { if (address < int(_data.size())) _data[address] = value; }
+        bool commit();
+        uint8_t* getDataPtr() { return _data.data(); }
+        size_t length() { return _data.size(); }
+
+        // Host-only
+        uint32_t getCommitCount() { return _commitCount; }
+        void reset() { _flash.clear(); _data.clear(); _commitCount = 0; }
+
+    private:
+        std::vector<uint8_t> _flash;
+        std::vector<uint8_t> _data;
+        uint32_t _commitCount = 0;
+};
+
+extern EEPROMClass EEPROM;
+
+#endif
@@ -0,0 +1,3 @@
+#pragma once
+
+// Host shim: mDNS is not used on the host.
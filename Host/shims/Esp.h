@@ -0,0 +1,75 @@
+#ifndef HOST_ESP_H
+#define HOST_ESP_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "WString.h"
+
+typedef int esp_err_t;
+#define ESP_OK 0
+#define ESP_FAIL -1
+#define ESP_ERR_NO_MEM 0x101
+#define ESP_ERR_INVALID_ARG 0x102
+#define ESP_ERR_INVALID_STATE 0x103
+#define ESP_ERR_NOT_FOUND 0x105
+#define ESP_ERR_TIMEOUT 0x107
+
+#define MALLOC_CAP_8BIT (1 << 2)
+#define MALLOC_CAP_SPIRAM (1 << 10)
+#define MALLOC_CAP_INTERNAL (1 << 11)
+#define MALLOC_CAP_DEFAULT (1 << 12)
+
+typedef enum
+{
+    ESP_RST_UNKNOWN,
+    ESP_RST_POWERON,
+    ESP_RST_EXT,
+    ESP_RST_SW,
+    ESP_RST_PANIC,
+    ESP_RST_INT_WDT,
+    ESP_RST_TASK_WDT,
+    ESP_RST_WDT,
+    ESP_RST_DEEPSLEEP,
+    ESP_RST_BROWNOUT,
+    ESP_RST_SDIO
+} esp_reset_reason_t;
+
+esp_reset_reason_t esp_reset_reason();
+int64_t esp_timer_get_time();
+void* heap_caps_malloc(size_t size, uint32_t caps);
+void* heap_caps_realloc(void* ptr, size_t size, uint32_t caps);
+void heap_caps_free(void* ptr);
+size_t heap_caps_get_free_size(uint32_t caps);
+size_t heap_caps_get_largest_free_block(uint32_t caps);
+
+class EspClass
+{
+    public:
+        // Simulated heap figures; the host has no meaningful equivalent.
+        uint32_t getHeapSize() { return 320 * 1024; }
+        uint32_t getFreeHeap() { return 200 * 1024; }
+        uint32_t getMinFreeHeap() { return 180 * 1024; }
+        uint32_t getMaxAllocHeap() { return 100 * 1024; }
+        uint32_t getPsramSize() { return 0; }
+        uint32_t getFreePsram() { return 0; }
+        uint32_t getMinFreePsram() { return 0; }
+        uint32_t getMaxAllocPsram() { return 0; }
+        uint32_t getMaxFreeBlockSize() { return 100 * 1024; }
+        uint8_t getHeapFragmentation() { return 0; }
+        uint32_t getCpuFreqMHz() { return 240; }
+        uint32_t getCycleCount();
+        uint32_t getChipId() { return 0x00C0FFEE; }
+        uint64_t getEfuseMac() { return 0x0000C0FFEE000000ULL; }
+        const char* getChipModel() { return "Host"; }
+        String getResetReason() { return F("Host"); }
+
+        // ESP8266 RTC user memory (512 bytes); survives a (simulated) reset, like on the device.
+        bool rtcUserMemoryRead(uint32_t offset, uint32_t* data, size_t size);
+        bool rtcUserMemoryWrite(uint32_t offset, uint32_t* data, size_t size);
+
+        [[noreturn]] void restart();
+};
+
+extern EspClass ESP;
+
+#endif
@@ -0,0 +1,63 @@
+#include <sys/stat.h>
+#include <unistd.h>
+#include "FS.h"
+#include "SPIFFS.h"
+
+fs::FS SPIFFS("spiffs");
+
+
+size_t fs::File::size() const
+{
+    if (!_filePtr) return 0;
+    struct stat fileStat;
+    if (fstat(fileno(_filePtr.get()), &fileStat) != 0) return 0;
+    return fileStat.st_size;
+}
+
+
+int fs::File::read()
+{
+    if (!_filePtr) return -1;
+    int c = fgetc(_filePtr.get());
+    return (c == EOF) ? -1 : c;
+}
+
+
+int fs::File::peek()
+{
+    if (!_filePtr) return -1;
+    int c = fgetc(_filePtr.get());
+    if (c == EOF) return -1;
+    ungetc(c, _filePtr.get());
+    return c;
+}
+
+
+bool fs::FS::begin(bool formatOnFail, const char* basePath, uint8_t maxOpenFiles, const char* partitionLabel)
+{
+    mkdir(_rootDir.c_str(), 0755);
+    struct stat dirStat;
+    return (stat(_rootDir.c_str(), &dirStat) == 0) && S_ISDIR(dirStat.st_mode);
+}
+
+
+fs::File fs::FS::open(const char* path, const char* mode)
+{
+    std::string hostPath = getHostPath(path);
+    std::string hostMode = mode;
+    if (hostMode.find('b') == std::string::npos) hostMode += 'b';
+    FILE* filePtr = fopen(hostPath.c_str(), hostMode.c_str());
+    return (filePtr == nullptr) ? File() : File(filePtr, path);
+}
+
+
+bool fs::FS::exists(const char* path)
+{
+    return access(getHostPath(path).c_str(), F_OK) == 0;
+}
+
+
+bool fs::FS::remove(const char* path)
+{
+    return ::remove(getHostPath(path).c_str()) == 0;
+}
@@ -0,0 +1,68 @@
+#ifndef HOST_FS_H
+#define HOST_FS_H
+
+#include <stdio.h>
+#include <memory>
+#include <string>
+#include <Arduino.h>
+
+namespace fs
+{
+    // Host shim for a file on the flash file system.
+    class File : public Stream
+    {
+        public:
+            File() {}
+            File(FILE* filePtr, const char* name) : _filePtr(filePtr, fclose), _name(name) {}
+
+            operator bool() const { return _filePtr != nullptr; }
+            size_t size() const;
+            size_t position() const { return _filePtr ? ftell(_filePtr.get()) : 0; }
+            bool seek(uint32_t position) { return _filePtr && (fseek(_filePtr.get(), position, SEEK_SET) == 0); }
+            const char* name() const { return _name.c_str(); }
+            void close() { _filePtr.reset(); }
+
+            int available() override { return _filePtr ? int(size() - position()) : 0; }
+            int read() override;
+            size_t read(uint8_t* buffer, size_t size) { return _filePtr ? fread(buffer, 1, size, _filePtr.get()) : 0; }
+            int peek() override;
+            size_t write(uint8_t c) override { return write(&c, 1); }
+            size_t write(const uint8_t* buffer, size_t size) override { return _filePtr ? fwrite(buffer, 1, size, _filePtr.get()) : 0; }
+            void flush() override { if (_filePtr) fflush(_filePtr.get()); }
+            using Print::write;
+
+        private:
+            std::shared_ptr<FILE> _filePtr;
+            std::string _name;
+    };
+
+    // Host shim for a flash file system, backed by a directory on the host.
+    class FS
+    {
+        public:
+            FS(const char* rootDir) : _rootDir(rootDir) {}
+
+            bool begin(bool formatOnFail = false, const char* basePath = "", uint8_t maxOpenFiles = 10, const char* partitionLabel = nullptr);
+            void end() {}
+            File open(const char* path, const char* mode = "r");
+            File open(const String& path, const char* mode = "r") { return open(path.c_str(), mode); }
+            bool exists(const char* path);
+            bool exists(const String& path) { return exists(path.c_str()); }
+            bool remove(const char* path);
+            bool remove(const String& path) { return remove(path.c_str()); }
+            size_t totalBytes() { return 1024 * 1024; }
+            size_t usedBytes() { return 0; }
+
+            // Host-only
+            void setRootDir(const char* rootDir) { _rootDir = rootDir; }
+
+        private:
+            std::string _rootDir;
+
+            std::string getHostPath(const char* path) { return _rootDir + ((path[0] == '/') ? "" : "/") + path; }
+    };
+}
+
+using fs::File;
+
+#endif
@@ -0,0 +1,360 @@
+#include <Arduino.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <list>
+#include <mutex>
+#include <string>
+#include <thread>
+
+struct HostTask
+{
+    std::string name;
+    UBaseType_t priority = 1;
+    BaseType_t coreId = 1;
+    std::mutex mutex;
+    std::condition_variable notified;
+    uint32_t notifyValue = 0;
+    bool isDeleted = false;
+};
+
+struct HostSemaphore
+{
+    std::mutex mutex;
+    std::condition_variable released;
+    UBaseType_t count;
+    UBaseType_t maxCount;
+    std::thread::id owner;
+    UBaseType_t recursion = 0;
+
+    HostSemaphore(UBaseType_t max, UBaseType_t initial) : count(initial), maxCount(max) {}
+};
+
+namespace
+{
+    struct TaskDeleted {};
+
+    std::recursive_mutex _criticalMutex;
+    std::mutex _tasksMutex;
+    std::list<HostTask*> _tasks;
+    thread_local HostTask* _currentTaskPtr = nullptr;
+    thread_local bool _isInIsr = false;
+
+    HostTask* registerTask(const char* name, UBaseType_t priority, BaseType_t coreId)
+    {
+        HostTask* taskPtr = new HostTask();
+        taskPtr->name = name;
+        taskPtr->priority = priority;
+        taskPtr->coreId = coreId;
+        std::lock_guard<std::mutex> lock(_tasksMutex);
+        _tasks.push_back(taskPtr);
+        return taskPtr;
+    }
+
+    HostTask* currentTask()
+    {
+        // The main thread plays the role of the Arduino loop task
+        if (_currentTaskPtr == nullptr)
+            _currentTaskPtr = registerTask("loopTask", 1, 1);
+        return _currentTaskPtr;
+    }
+
+    // Returns false on timeout
+    template<typename Predicate>
+    bool waitFor(std::unique_lock<std::mutex>& lock, std::condition_variable& cv, TickType_t ticks, Predicate predicate)
+    {
+        if (ticks == portMAX_DELAY)
+        {
+            cv.wait(lock, predicate);
+            return true;
+        }
+        return cv.wait_for(lock, std::chrono::milliseconds(ticks * portTICK_PERIOD_MS), predicate);
+    }
+}
+
+
+void Host::setIsrContext(bool inIsr)
+{
+    _isInIsr = inIsr;
+}
+
+
+void vPortEnterCritical(portMUX_TYPE* mux)
+{
+    _criticalMutex.lock();
+}
+
+
+void vPortExitCritical(portMUX_TYPE* mux)
+{
+    _criticalMutex.unlock();
+}
+
+
+BaseType_t xPortInIsrContext()
+{
+    return _isInIsr ? pdTRUE : pdFALSE;
+}
+
+
+BaseType_t xPortGetCoreID()
+{
+    return currentTask()->coreId;
+}
+
+
+BaseType_t xTaskCreatePinnedToCore(
+    TaskFunction_t taskFunction,
+    const char* name,
+    uint32_t stackDepth,
+    void* parameters,
+    UBaseType_t priority,
+    TaskHandle_t* createdTask,
+    BaseType_t coreId)
+{
+    HostTask* taskPtr = registerTask(name, priority, (coreId == tskNO_AFFINITY) ? 0 : coreId);
+    if (createdTask != nullptr) *createdTask = taskPtr;
+
+    std::thread thread([=]()
+    {
+        _currentTaskPtr = taskPtr;
+        try
+        {
+            taskFunction(parameters);
+        }
+        catch (const TaskDeleted&)
+        {
+        }
+    });
+    thread.detach();
+    return pdPASS;
+}
+
+
+BaseType_t xTaskCreate(
+    TaskFunction_t taskFunction,
+    const char* name,
+    uint32_t stackDepth,
+    void* parameters,
+    UBaseType_t priority,
+    TaskHandle_t* createdTask)
+{
+    return xTaskCreatePinnedToCore(taskFunction, name, stackDepth, parameters, priority, createdTask, tskNO_AFFINITY);
+}
+
+
+void vTaskDelete(TaskHandle_t task)
+{
+    HostTask* taskPtr = (task == nullptr) ? currentTask() : task;
+    {
+        std::lock_guard<std::mutex> lock(_tasksMutex);
+        _tasks.remove(taskPtr);
+    }
+    {
+        std::lock_guard<std::mutex> lock(taskPtr->mutex);
+        taskPtr->isDeleted = true;
+    }
+    taskPtr->notified.notify_all();
+
+    // A thread can't be killed from another thread; a task deleting itself unwinds its thread.
+    // The HostTask is leaked deliberately: handles may still be in use by other tasks.
+    if (taskPtr == _currentTaskPtr)
+        throw TaskDeleted();
+}
+
+
+void vTaskDelay(TickType_t ticks)
+{
+    delay(ticks * portTICK_PERIOD_MS);
+}
+
+
+TickType_t xTaskGetTickCount()
+{
+    return millis() / portTICK_PERIOD_MS;
+}
+
+
+TaskHandle_t xTaskGetCurrentTaskHandle()
+{
+    return currentTask();
+}
+
+
+char* pcTaskGetName(TaskHandle_t task)
+{
+    HostTask* taskPtr = (task == nullptr) ? currentTask() : task;
+    return &taskPtr->name[0];
+}
+
+
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task)
+{
+    return 4096;
+}
+
+
+UBaseType_t uxTaskGetNumberOfTasks()
+{
+    currentTask();
+    std::lock_guard<std::mutex> lock(_tasksMutex);
+    return _tasks.size();
+}
+
+
+UBaseType_t uxTaskGetSystemState(TaskStatus_t* taskStatusArray, UBaseType_t arraySize, uint32_t* totalRunTime)
+{
+    currentTask();
+    std::lock_guard<std::mutex> lock(_tasksMutex);
+    UBaseType_t count = 0;
+    for (HostTask* taskPtr : _tasks)
+    {
+        if (count == arraySize) break;
+        TaskStatus_t& status = taskStatusArray[count];
+        memset(&status, 0, sizeof(status));
+        status.xHandle = taskPtr;
+        status.pcTaskName = taskPtr->name.c_str();
+        status.xTaskNumber = ++count;
+        status.eCurrentState = (taskPtr == _currentTaskPtr) ? eRunning : eBlocked;
+        status.uxCurrentPriority = taskPtr->priority;
+        status.uxBasePriority = taskPtr->priority;
+        status.usStackHighWaterMark = 4096;
+        status.xCoreID = taskPtr->coreId;
+    }
+    if (totalRunTime != nullptr) *totalRunTime = 0;
+    return count;
+}
+
+
+uint32_t ulTaskNotifyTake(BaseType_t clearCountOnExit, TickType_t ticksToWait)
+{
+    HostTask* taskPtr = currentTask();
+    std::unique_lock<std::mutex> lock(taskPtr->mutex);
+    waitFor(lock, taskPtr->notified, ticksToWait, [taskPtr] { return taskPtr->notifyValue != 0; });
+    uint32_t result = taskPtr->notifyValue;
+    if (result != 0)
+        taskPtr->notifyValue = clearCountOnExit ? 0 : result - 1;
+    return result;
+}
+
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task)
+{
+    {
+        std::lock_guard<std::mutex> lock(task->mutex);
+        task->notifyValue++;
+    }
+    task->notified.notify_all();
+    return pdPASS;
+}
+
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t* higherPriorityTaskWoken)
+{
+    xTaskNotifyGive(task);
+    if (higherPriorityTaskWoken != nullptr) *higherPriorityTaskWoken = pdTRUE;
+}
+
+
+SemaphoreHandle_t xSemaphoreCreateMutex()
+{
+    return new HostSemaphore(1, 1);
+}
+
+
+SemaphoreHandle_t xSemaphoreCreateRecursiveMutex()
+{
+    return new HostSemaphore(1, 1);
+}
+
+
+SemaphoreHandle_t xSemaphoreCreateBinary()
+{
+    return new HostSemaphore(1, 0);
+}
+
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t maxCount, UBaseType_t initialCount)
+{
+    return new HostSemaphore(maxCount, initialCount);
+}
+
+
+void vSemaphoreDelete(SemaphoreHandle_t semaphore)
+{
+    delete semaphore;
+}
+
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticksToWait)
+{
+    std::unique_lock<std::mutex> lock(semaphore->mutex);
+    if (!waitFor(lock, semaphore->released, ticksToWait, [semaphore] { return semaphore->count > 0; }))
+        return pdFALSE;
+    semaphore->count--;
+    semaphore->owner = std::this_thread::get_id();
+    return pdTRUE;
+}
+
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore)
+{
+    {
+        std::lock_guard<std::mutex> lock(semaphore->mutex);
+        if (semaphore->count == semaphore->maxCount) return pdFALSE;
+        semaphore->count++;
+        semaphore->owner = std::thread::id();
+    }
+    semaphore->released.notify_one();
+    return pdTRUE;
+}
+
+
+BaseType_t xSemaphoreTakeRecursive(SemaphoreHandle_t semaphore, TickType_t ticksToWait)
+{
+    {
+        std::lock_guard<std::mutex> lock(semaphore->mutex);
+        if ((semaphore->recursion > 0) && (semaphore->owner == std::this_thread::get_id()))
+        {
+            semaphore->recursion++;
+            return pdTRUE;
+        }
+    }
+    if (!xSemaphoreTake(semaphore, ticksToWait)) return pdFALSE;
+    std::lock_guard<std::mutex> lock(semaphore->mutex);
+    semaphore->recursion = 1;
+    return pdTRUE;
+}
+
+
+BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t semaphore)
+{
+    {
+        std::lock_guard<std::mutex> lock(semaphore->mutex);
+        if ((semaphore->recursion == 0) || (semaphore->owner != std::this_thread::get_id()))
+            return pdFALSE;
+        if (--semaphore->recursion > 0)
+            return pdTRUE;
+    }
+    return xSemaphoreGive(semaphore);
+}
+
+
+BaseType_t xSemaphoreTakeFromISR(SemaphoreHandle_t semaphore, BaseType_t* higherPriorityTaskWoken)
+{
+    return xSemaphoreTake(semaphore, 0);
+}
+
+
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t semaphore, BaseType_t* higherPriorityTaskWoken)
+{
+    if (higherPriorityTaskWoken != nullptr) *higherPriorityTaskWoken = pdTRUE;
+    return xSemaphoreGive(semaphore);
+}
+
+
+UBaseType_t uxSemaphoreGetCount(SemaphoreHandle_t semaphore)
+{
+    std::lock_guard<std::mutex> lock(semaphore->mutex);
+    return semaphore->count;
+}
@@ -0,0 +1,278 @@
+#include <Arduino.h>
+#include "HTTPClient.h"
+
+bool HTTPClient::begin(NetworkClient& client, const String& url)
+{
+    _clientPtr = &client;
+    _requestHeaders.clear();
+
+    int hostStart = url.indexOf("://");
+    if (hostStart < 0) return false;
+    bool isSecure = url.startsWith("https:");
+    hostStart += 3;
+    int hostEnd = url.indexOf('/', hostStart);
+    if (hostEnd < 0) hostEnd = url.length();
+    String hostPort = url.substring(hostStart, hostEnd);
+    _uri = (hostEnd < int(url.length())) ? url.substring(hostEnd) : String("/");
+
+    int colonIndex = hostPort.indexOf(':');
+    _host = (colonIndex < 0) ? hostPort : hostPort.substring(0, colonIndex);
+    _port = (colonIndex < 0) ? (isSecure ? 443 : 80) : hostPort.substring(colonIndex + 1).toInt();
+    return true;
+}
+
+
+void HTTPClient::end()
+{
+    if (_clientPtr == nullptr) return;
+    if (_reuse && _canReuse && _clientPtr->connected())
+    {
+        // Discard the remainder of the response (if any), so the connection can be reused
+        uint8_t buffer[256];
+        while (_clientPtr->available() > 0)
+            _clientPtr->read(buffer, sizeof(buffer));
+    }
+    else
+        _clientPtr->stop();
+    _requestHeaders.clear();
+}
+
+
+void HTTPClient::addHeader(const String& name, const String& value)
+{
+    _requestHeaders += name + ": " + value + "\r\n";
+}
+
+
+void HTTPClient::collectHeaders(const char* headerKeys[], const size_t headerKeysCount)
+{
+    _responseHeaders.clear();
+    for (size_t i = 0; i < headerKeysCount; i++)
+        _responseHeaders.push_back({ headerKeys[i], String() });
+}
+
+
+String HTTPClient::header(const char* name)
+{
+    for (const Header& header : _responseHeaders)
+    {
+        if (header.name.equalsIgnoreCase(name)) return header.value;
+    }
+    return String();
+}
+
+
+bool HTTPClient::hasHeader(const char* name)
+{
+    return header(name).length() != 0;
+}
+
+
+int HTTPClient::sendRequest(const char* type, const String& payload)
+{
+    return sendRequest(type, reinterpret_cast<uint8_t*>(const_cast<char*>(payload.c_str())), payload.length());
+}
+
+
+int HTTPClient::sendRequest(const char* type, uint8_t* payload, size_t size)
+{
+    if (_clientPtr == nullptr) return HTTPC_ERROR_NOT_CONNECTED;
+    if (!_clientPtr->connected())
+    {
+        _clientPtr->setConnectionTimeout(_connectTimeoutMs);
+        if (!_clientPtr->connect(_host.c_str(), _port)) return HTTPC_ERROR_CONNECTION_REFUSED;
+    }
+    _clientPtr->setTimeout(_timeoutMs);
+
+    String request = String(type) + " " + _uri + " HTTP/1.1\r\n";
+    request += "Host: " + _host + ":" + String(_port) + "\r\n";
+    request += "User-Agent: ESP32HTTPClient\r\n";
+    request += _reuse ? "Connection: keep-alive\r\n" : "Connection: close\r\n";
+    if (_authorization.length() != 0)
+        request += "Authorization: " + _authorizationType + " " + _authorization + "\r\n";
+    if (size != 0 || strcmp(type, "GET") != 0)
+        request += "Content-Length: " + String(size) + "\r\n";
+    request += _requestHeaders;
+    request += "\r\n";
+
+    if (_clientPtr->write(reinterpret_cast<const uint8_t*>(request.c_str()), request.length()) != request.length())
+        return HTTPC_ERROR_SEND_HEADER_FAILED;
+    if ((size != 0) && (_clientPtr->write(payload, size) != size))
+        return HTTPC_ERROR_SEND_PAYLOAD_FAILED;
+
+    return readResponseHeaders();
+}
+
+
+bool HTTPClient::readLine(String& line)
+{
+    line.clear();
+    uint32_t startMillis = millis();
+    while (true)
+    {
+        int c = _clientPtr->read();
+        if (c < 0)
+        {
+            if (!_clientPtr->connected() || (millis() - startMillis >= _timeoutMs)) return false;
+            delay(1);
+            continue;
+        }
+        if (c == '\n') break;
+        if (c != '\r') line += char(c);
+    }
+    return true;
+}
+
+
+bool HTTPClient::readBytes(uint8_t* buffer, size_t size)
+{
+    uint32_t startMillis = millis();
+    while (size > 0)
+    {
+        int received = _clientPtr->read(buffer, size);
+        if (received > 0)
+        {
+            buffer += received;
+            size -= received;
+            startMillis = millis();
+        }
+        else if (!_clientPtr->connected() || (millis() - startMillis >= _timeoutMs))
+            return false;
+        else
+            delay(1);
+    }
+    return true;
+}
+
+
+int HTTPClient::readResponseHeaders()
+{
+    _size = -1;
+    _isChunked = false;
+    _canReuse = _reuse;
+    for (Header& header : _responseHeaders)
+        header.value.clear();
+
+    String line;
+    if (!readLine(line)) return _clientPtr->connected() ? HTTPC_ERROR_READ_TIMEOUT : HTTPC_ERROR_CONNECTION_LOST;
+    if (!line.startsWith("HTTP/1.")) return HTTPC_ERROR_NO_HTTP_SERVER;
+    int result = line.substring(9, 12).toInt();
+
+    while (readLine(line) && (line.length() != 0))
+    {
+        int colonIndex = line.indexOf(':');
+        if (colonIndex < 0) continue;
+        String name = line.substring(0, colonIndex);
+        String value = line.substring(colonIndex + 1);
+        value.trim();
+
+        if (name.equalsIgnoreCase("Content-Length"))
+            _size = value.toInt();
+        else if (name.equalsIgnoreCase("Transfer-Encoding"))
+            _isChunked = value.equalsIgnoreCase("chunked");
+        else if (name.equalsIgnoreCase("Connection"))
+            _canReuse = _canReuse && !value.equalsIgnoreCase("close");
+
+        for (Header& header : _responseHeaders)
+        {
+            if (header.name.equalsIgnoreCase(name)) header.value = value;
+        }
+    }
+    return result;
+}
+
+
+int HTTPClient::writeToStream(Stream* streamPtr)
+{
+    if (streamPtr == nullptr) return HTTPC_ERROR_NO_STREAM;
+    if (!connected()) return HTTPC_ERROR_NOT_CONNECTED;
+
+    uint8_t buffer[512];
+    int total = 0;
+    if (_isChunked)
+    {
+        String line;
+        while (readLine(line))
+        {
+            int chunkSize = strtol(line.c_str(), nullptr, 16);
+            if (chunkSize == 0)
+            {
+                // Skip the trailer (if any) up to the empty line
+                while (readLine(line) && (line.length() != 0)) {}
+                return total;
+            }
+            while (chunkSize > 0)
+            {
+                size_t size = std::min<size_t>(chunkSize, sizeof(buffer));
+                if (!readBytes(buffer, size)) return HTTPC_ERROR_READ_TIMEOUT;
+                if (streamPtr->write(buffer, size) != size) return HTTPC_ERROR_STREAM_WRITE;
+                chunkSize -= size;
+                total += size;
+            }
+            readLine(line); // CRLF after the chunk data
+        }
+        return HTTPC_ERROR_READ_TIMEOUT;
+    }
+
+    // Without Content-Length the body ends when the server closes the connection
+    int remaining = _size;
+    while ((remaining != 0) && (connected() || (_clientPtr->available() > 0)))
+    {
+        size_t size = (remaining < 0) ? sizeof(buffer) : std::min<size_t>(remaining, sizeof(buffer));
+        int received = _clientPtr->read(buffer, size);
+        if (received <= 0)
+        {
+            delay(1);
+            continue;
+        }
+        if (streamPtr->write(buffer, received) != size_t(received)) return HTTPC_ERROR_STREAM_WRITE;
+        total += received;
+        if (remaining > 0) remaining -= received;
+    }
+    return (remaining > 0) ? HTTPC_ERROR_CONNECTION_LOST : total;
+}
+
+
+class StringStream : public Stream
+{
+    public:
+        String str;
+
+        int available() override { return 0; }
+        int read() override { return -1; }
+        int peek() override { return -1; }
+        size_t write(uint8_t c) override { str += char(c); return 1; }
+        size_t write(const uint8_t* buffer, size_t size) override
+        {
+            str.concat(reinterpret_cast<const char*>(buffer), size);
+            return size;
+        }
+};
+
+
+String HTTPClient::getString()
+{
+    StringStream stream;
+    writeToStream(&stream);
+    return stream.str;
+}
+
+
+String HTTPClient::errorToString(int error)
+{
+    switch (error)
+    {
+        case HTTPC_ERROR_CONNECTION_REFUSED: return "connection refused";
+        case HTTPC_ERROR_SEND_HEADER_FAILED: return "send header failed";
+        case HTTPC_ERROR_SEND_PAYLOAD_FAILED: return "send payload failed";
+        case HTTPC_ERROR_NOT_CONNECTED: return "not connected";
+        case HTTPC_ERROR_CONNECTION_LOST: return "connection lost";
+        case HTTPC_ERROR_NO_STREAM: return "no stream";
+        case HTTPC_ERROR_NO_HTTP_SERVER: return "no HTTP server";
+        case HTTPC_ERROR_TOO_LESS_RAM: return "too less ram";
+        case HTTPC_ERROR_ENCODING: return "Transfer-Encoding not supported";
+        case HTTPC_ERROR_STREAM_WRITE: return "Stream write error";
+        case HTTPC_ERROR_READ_TIMEOUT: return "read Timeout";
+        default: return String();
+    }
+}
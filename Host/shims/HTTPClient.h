@@ -0,0 +1,84 @@
+#ifndef HOST_HTTPCLIENT_H
+#define HOST_HTTPCLIENT_H
+
+#include <Arduino.h>
+#include <NetworkClient.h>
+#include <vector>
+
+#define HTTPC_ERROR_CONNECTION_REFUSED (-1)
+#define HTTPC_ERROR_SEND_HEADER_FAILED (-2)
+#define HTTPC_ERROR_SEND_PAYLOAD_FAILED (-3)
+#define HTTPC_ERROR_NOT_CONNECTED (-4)
+#define HTTPC_ERROR_CONNECTION_LOST (-5)
+#define HTTPC_ERROR_NO_STREAM (-6)
+#define HTTPC_ERROR_NO_HTTP_SERVER (-7)
+#define HTTPC_ERROR_TOO_LESS_RAM (-8)
+#define HTTPC_ERROR_ENCODING (-9)
+#define HTTPC_ERROR_STREAM_WRITE (-10)
+#define HTTPC_ERROR_READ_TIMEOUT (-11)
+
+constexpr int HTTP_CODE_OK = 200;
+constexpr int HTTP_CODE_TOO_MANY_REQUESTS = 429;
+
+// Host shim for the ESP32 HTTP client; the subset used by the libraries, on a given (TLS) client.
+// Like the ESP32 version it keeps the connection open after end() if reuse is set and the server allows it.
+class HTTPClient
+{
+    public:
+        bool begin(NetworkClient& client, const String& url);
+        void end();
+        bool connected() { return (_clientPtr != nullptr) && _clientPtr->connected(); }
+
+        void setReuse(bool reuse) { _reuse = reuse; }
+        void setTimeout(uint32_t timeoutMs) { _timeoutMs = timeoutMs; }
+        void setConnectTimeout(int32_t timeoutMs) { _connectTimeoutMs = timeoutMs; }
+        void setAuthorizationType(const char* authType) { _authorizationType = authType; }
+        void setAuthorization(const char* authorization) { _authorization = authorization; }
+        void addHeader(const String& name, const String& value);
+        void collectHeaders(const char* headerKeys[], const size_t headerKeysCount);
+        String header(const char* name);
+        bool hasHeader(const char* name);
+
+        int GET() { return sendRequest("GET"); }
+        int POST(const String& payload) { return sendRequest("POST", payload); }
+        int POST(uint8_t* payload, size_t size) { return sendRequest("POST", payload, size); }
+        int PUT(const String& payload) { return sendRequest("PUT", payload); }
+        int sendRequest(const char* type, const String& payload);
+        int sendRequest(const char* type, uint8_t* payload = nullptr, size_t size = 0);
+
+        int getSize() { return _size; }
+        NetworkClient& getStream() { return *_clientPtr; }
+        NetworkClient* getStreamPtr() { return _clientPtr; }
+        int writeToStream(Stream* streamPtr);
+        String getString();
+
+        static String errorToString(int error);
+
+    private:
+        struct Header
+        {
+            String name;
+            String value;
+        };
+
+        NetworkClient* _clientPtr = nullptr;
+        String _host;
+        uint16_t _port = 0;
+        String _uri;
+        bool _reuse = true;
+        bool _canReuse = false;
+        uint32_t _timeoutMs = 5000;
+        int32_t _connectTimeoutMs = 5000;
+        String _authorizationType = "Basic";
+        String _authorization;
+        String _requestHeaders;
+        std::vector<Header> _responseHeaders; // Names to collect, with the values of the last response
+        int _size = -1;
+        bool _isChunked = false;
+
+        bool readLine(String& line);
+        bool readBytes(uint8_t* buffer, size_t size);
+        int readResponseHeaders();
+};
+
+#endif
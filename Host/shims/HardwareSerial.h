@@ -0,0 +1,62 @@
+#ifndef HOST_HARDWARESERIAL_H
+#define HOST_HARDWARESERIAL_H
+
+#include <deque>
+#include <mutex>
+#include <string>
+#include "Stream.h"
+
+#define SERIAL_8N1 0x800001c
+#define SERIAL_8E1 0x800001e
+#define SERIAL_8O1 0x800001f
+
+// Host shim for a UART. Received data is injected by the test or benchmark; transmitted data
+// goes to stdout, or to a buffer when capturing.
+class HardwareSerial : public Stream
+{
+    public:
+        HardwareSerial(int uartNum = 0) : _uartNum(uartNum) {}
+
+        void begin(unsigned long baud, uint32_t config = SERIAL_8N1, int8_t rxPin = -1, int8_t txPin = -1, bool invert = false);
+        void end() {}
+        void setDebugOutput(bool) {}
+        size_t setRxBufferSize(size_t size) { return size; }
+        size_t setTxBufferSize(size_t size) { return size; }
+        void updateBaudRate(unsigned long baud) { _baud = baud; }
+        unsigned long baudRate() { return _baud; }
+        void swap() {}
+        operator bool() const { return true; }
+
+        int available() override;
+        int availableForWrite() override { return 128; }
+        int peek() override;
+        int read() override;
+        size_t read(uint8_t* buffer, size_t size);
+        size_t readBytes(char* buffer, size_t length) override;
+        using Stream::readBytes;
+        size_t write(uint8_t c) override { return write(&c, 1); }
+        size_t write(const uint8_t* buffer, size_t size) override;
+        using Print::write;
+        void flush() override {}
+
+        // Host-only
+        void injectRx(const uint8_t* data, size_t size);
+        void injectRx(const char* str) { injectRx(reinterpret_cast<const uint8_t*>(str), strlen(str)); }
+        void clearRx();
+        void captureTx(bool capture) { _captureTx = capture; _tx.clear(); }
+        std::string takeTx();
+
+    private:
+        int _uartNum;
+        unsigned long _baud = 0;
+        std::mutex _mutex;
+        std::deque<uint8_t> _rx;
+        bool _captureTx = false;
+        std::string _tx;
+};
+
+extern HardwareSerial Serial;
+extern HardwareSerial Serial1;
+extern HardwareSerial Serial2;
+
+#endif
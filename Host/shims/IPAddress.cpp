@@ -0,0 +1,30 @@
+#include <stdio.h>
+#include "IPAddress.h"
+
+bool IPAddress::fromString(const char* address)
+{
+    unsigned int b[4];
+    char trailing;
+    if (sscanf(address, "%u.%u.%u.%u%c", &b[0], &b[1], &b[2], &b[3], &trailing) != 4)
+        return false;
+    for (int i = 0; i < 4; i++)
+    {
+        if (b[i] > 255) return false;
+        _bytes[i] = b[i];
+    }
+    return true;
+}
+
+
+String IPAddress::toString() const
+{
+    char buffer[16];
+    snprintf(buffer, sizeof(buffer), "%u.%u.%u.%u", _bytes[0], _bytes[1], _bytes[2], _bytes[3]);
+    return buffer;
+}
+
+
+size_t IPAddress::printTo(Print& p) const
+{
+    return p.print(toString());
+}
@@ -0,0 +1,32 @@
+#ifndef HOST_IPADDRESS_H
+#define HOST_IPADDRESS_H
+
+#include <stdint.h>
+#include <string.h>
+#include "Printable.h"
+#include "WString.h"
+
+// Host shim for IPv4 addresses; stored in network byte order like on the ESP.
+class IPAddress : public Printable
+{
+    public:
+        IPAddress() {}
+        IPAddress(uint8_t b1, uint8_t b2, uint8_t b3, uint8_t b4) : _bytes{b1, b2, b3, b4} {}
+        IPAddress(uint32_t address) { memcpy(_bytes, &address, sizeof(_bytes)); }
+
+        operator uint32_t() const { uint32_t address; memcpy(&address, _bytes, sizeof(address)); return address; }
+        bool operator==(const IPAddress& other) const { return uint32_t(*this) == uint32_t(other); }
+        bool operator!=(const IPAddress& other) const { return !(*this == other); }
+        uint8_t operator[](int index) const { return _bytes[index]; }
+        uint8_t& operator[](int index) { return _bytes[index]; }
+
+        bool fromString(const char* address);
+        bool fromString(const String& address) { return fromString(address.c_str()); }
+        String toString() const;
+        size_t printTo(Print& p) const override;
+
+    private:
+        uint8_t _bytes[4] = {0, 0, 0, 0};
+};
+
+#endif
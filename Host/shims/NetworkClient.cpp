@@ -0,0 +1,203 @@
+#include <Arduino.h>
+#include "NetworkClient.h"
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+int NetworkClient::connect(IPAddress ip, uint16_t port, int32_t timeoutMs)
+{
+    stop();
+
+    _socket = socket(AF_INET, SOCK_STREAM, 0);
+    if (_socket < 0) return 0;
+
+    sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = uint32_t(ip);
+
+    // Non-blocking connect, so the connection timeout can be applied
+    fcntl(_socket, F_SETFL, fcntl(_socket, F_GETFL) | O_NONBLOCK);
+    int result = ::connect(_socket, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+    if ((result < 0) && (errno == EINPROGRESS))
+    {
+        pollfd pfd = { _socket, POLLOUT, 0 };
+        int error = 0;
+        socklen_t errorSize = sizeof(error);
+        if ((poll(&pfd, 1, timeoutMs) == 1)
+            && (getsockopt(_socket, SOL_SOCKET, SO_ERROR, &error, &errorSize) == 0)
+            && (error == 0))
+            result = 0;
+    }
+    if (result < 0)
+    {
+        stop();
+        return 0;
+    }
+
+    return 1;
+}
+
+
+int NetworkClient::connect(const char* host, uint16_t port, int32_t timeoutMs)
+{
+    IPAddress ip;
+    if (!ip.fromString(host))
+    {
+        addrinfo hints;
+        memset(&hints, 0, sizeof(hints));
+        hints.ai_family = AF_INET;
+        hints.ai_socktype = SOCK_STREAM;
+        addrinfo* resultPtr = nullptr;
+        if ((getaddrinfo(host, nullptr, &hints, &resultPtr) != 0) || (resultPtr == nullptr))
+            return 0;
+        ip = IPAddress(uint32_t(reinterpret_cast<sockaddr_in*>(resultPtr->ai_addr)->sin_addr.s_addr));
+        freeaddrinfo(resultPtr);
+    }
+    return connect(ip, port, timeoutMs);
+}
+
+
+int NetworkClient::setNoDelay(bool noDelay)
+{
+    if (_socket < 0) return -1;
+    int flag = noDelay;
+    return setsockopt(_socket, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
+}
+
+
+size_t NetworkClient::write(const uint8_t* buffer, size_t size)
+{
+    if (_socket < 0) return 0;
+
+    size_t totalSent = 0;
+    uint32_t startMillis = millis();
+    while (totalSent < size)
+    {
+        ssize_t sent = send(_socket, buffer + totalSent, size - totalSent, MSG_NOSIGNAL);
+        if (sent > 0)
+            totalSent += sent;
+        else if ((sent < 0) && ((errno == EAGAIN) || (errno == EWOULDBLOCK)) && (millis() - startMillis < _timeout))
+        {
+            pollfd pfd = { _socket, POLLOUT, 0 };
+            poll(&pfd, 1, 10);
+        }
+        else
+        {
+            stop();
+            break;
+        }
+    }
+    return totalSent;
+}
+
+
+int NetworkClient::available()
+{
+    if (_socket < 0) return 0;
+    int count = 0;
+    if (ioctl(_socket, FIONREAD, &count) < 0) return 0;
+    return count;
+}
+
+
+int NetworkClient::read()
+{
+    uint8_t c;
+    return (read(&c, 1) == 1) ? c : -1;
+}
+
+
+int NetworkClient::read(uint8_t* buffer, size_t size)
+{
+    if (_socket < 0) return -1;
+    ssize_t received = recv(_socket, buffer, size, MSG_DONTWAIT);
+    if (received > 0) return received;
+    if ((received == 0) || ((errno != EAGAIN) && (errno != EWOULDBLOCK)))
+        stop();
+    return -1;
+}
+
+
+int NetworkClient::peek()
+{
+    if (_socket < 0) return -1;
+    uint8_t c;
+    return (recv(_socket, &c, 1, MSG_PEEK | MSG_DONTWAIT) == 1) ? c : -1;
+}
+
+
+void NetworkClient::clear()
+{
+    uint8_t buffer[256];
+    while (available() > 0)
+        read(buffer, sizeof(buffer));
+}
+
+
+void NetworkClient::stop()
+{
+    if (_socket < 0) return;
+    close(_socket);
+    _socket = -1;
+}
+
+
+uint8_t NetworkClient::connected()
+{
+    if (_socket < 0) return 0;
+    uint8_t c;
+    ssize_t result = recv(_socket, &c, 1, MSG_PEEK | MSG_DONTWAIT);
+    if (result > 0) return 1;
+    if ((result < 0) && ((errno == EAGAIN) || (errno == EWOULDBLOCK))) return 1;
+    // Peer closed the connection. Like on the ESP, data received before can still be read.
+    return 0;
+}
+
+
+IPAddress NetworkClient::remoteIP() const
+{
+    sockaddr_in address;
+    socklen_t size = sizeof(address);
+    if ((_socket < 0) || (getpeername(_socket, reinterpret_cast<sockaddr*>(&address), &size) != 0))
+        return IPAddress();
+    return IPAddress(uint32_t(address.sin_addr.s_addr));
+}
+
+
+uint16_t NetworkClient::remotePort() const
+{
+    sockaddr_in address;
+    socklen_t size = sizeof(address);
+    if ((_socket < 0) || (getpeername(_socket, reinterpret_cast<sockaddr*>(&address), &size) != 0))
+        return 0;
+    return ntohs(address.sin_port);
+}
+
+
+IPAddress NetworkClient::localIP() const
+{
+    sockaddr_in address;
+    socklen_t size = sizeof(address);
+    if ((_socket < 0) || (getsockname(_socket, reinterpret_cast<sockaddr*>(&address), &size) != 0))
+        return IPAddress();
+    return IPAddress(uint32_t(address.sin_addr.s_addr));
+}
+
+
+uint16_t NetworkClient::localPort() const
+{
+    sockaddr_in address;
+    socklen_t size = sizeof(address);
+    if ((_socket < 0) || (getsockname(_socket, reinterpret_cast<sockaddr*>(&address), &size) != 0))
+        return 0;
+    return ntohs(address.sin_port);
+}
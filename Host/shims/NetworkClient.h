@@ -0,0 +1,48 @@
+#ifndef HOST_NETWORKCLIENT_H
+#define HOST_NETWORKCLIENT_H
+
+#include <Arduino.h>
+#include "Client.h"
+
+// Host shim for the ESP32 TCP client, using POSIX sockets. Like on the ESP, reads don't block.
+class NetworkClient : public Client
+{
+    public:
+        NetworkClient() {}
+        NetworkClient(const NetworkClient&) = delete;
+        NetworkClient& operator=(const NetworkClient&) = delete;
+        ~NetworkClient() override { stop(); }
+
+        int connect(IPAddress ip, uint16_t port) override { return connect(ip, port, _connectionTimeout); }
+        int connect(IPAddress ip, uint16_t port, int32_t timeoutMs);
+        int connect(const char* host, uint16_t port) override { return connect(host, port, _connectionTimeout); }
+        int connect(const char* host, uint16_t port, int32_t timeoutMs);
+        void setConnectionTimeout(uint32_t timeoutMs) { _connectionTimeout = timeoutMs; }
+        int setNoDelay(bool noDelay);
+
+        size_t write(uint8_t c) override { return write(&c, 1); }
+        size_t write(const uint8_t* buffer, size_t size) override;
+        int availableForWrite() override { return connected() ? 4096 : 0; }
+        int available() override;
+        int read() override;
+        int read(uint8_t* buffer, size_t size) override;
+        int peek() override;
+        void flush() override {}
+        void clear();
+        void stop() override;
+        uint8_t connected() override;
+        operator bool() override { return connected(); }
+        using Print::write;
+
+        int fd() const { return _socket; }
+        IPAddress remoteIP() const;
+        uint16_t remotePort() const;
+        IPAddress localIP() const;
+        uint16_t localPort() const;
+
+    private:
+        int _socket = -1;
+        int32_t _connectionTimeout = 3000;
+};
+
+#endif
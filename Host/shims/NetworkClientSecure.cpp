@@ -0,0 +1,174 @@
+#include <Arduino.h>
+#include "NetworkClientSecure.h"
+#include <openssl/err.h>
+#include <openssl/pem.h>
+#include <openssl/ssl.h>
+#include <openssl/x509v3.h>
+#include <poll.h>
+
+int NetworkClientSecure::connect(IPAddress ip, uint16_t port)
+{
+    stop();
+    return NetworkClient::connect(ip, port) && startTLS(ip.toString().c_str());
+}
+
+
+int NetworkClientSecure::connect(const char* host, uint16_t port)
+{
+    stop();
+    return NetworkClient::connect(host, port) && startTLS(host);
+}
+
+
+bool NetworkClientSecure::startTLS(const char* host)
+{
+    _contextPtr = SSL_CTX_new(TLS_client_method());
+    if (_contextPtr == nullptr)
+    {
+        stop();
+        return false;
+    }
+
+    IPAddress ip;
+    bool isIP = ip.fromString(host);
+    if (!_isInsecure)
+    {
+        // Like on the ESP, validation fails without a root certificate
+        BIO* bioPtr = BIO_new_mem_buf(_rootCA ? _rootCA : "", -1);
+        X509* certificatePtr = PEM_read_bio_X509(bioPtr, nullptr, nullptr, nullptr);
+        BIO_free(bioPtr);
+        if (certificatePtr != nullptr)
+        {
+            X509_STORE_add_cert(SSL_CTX_get_cert_store(_contextPtr), certificatePtr);
+            X509_free(certificatePtr);
+        }
+        SSL_CTX_set_verify(_contextPtr, SSL_VERIFY_PEER, nullptr);
+        X509_VERIFY_PARAM* paramPtr = SSL_CTX_get0_param(_contextPtr);
+        if (isIP)
+            X509_VERIFY_PARAM_set1_ip_asc(paramPtr, host);
+        else
+            X509_VERIFY_PARAM_set1_host(paramPtr, host, 0);
+    }
+
+    _sslPtr = SSL_new(_contextPtr);
+    SSL_set_fd(_sslPtr, fd());
+    if (!isIP) SSL_set_tlsext_host_name(_sslPtr, host);
+
+    // The socket doesn't block, so the handshake timeout can be applied
+    uint32_t startMillis = millis();
+    int result;
+    while ((result = SSL_connect(_sslPtr)) != 1)
+    {
+        if (!awaitSocket(result, startMillis, _handshakeTimeout * 1000))
+        {
+            stop();
+            return false;
+        }
+    }
+    return true;
+}
+
+
+bool NetworkClientSecure::awaitSocket(int sslResult, uint32_t startMillis, uint32_t timeoutMs)
+{
+    int error = SSL_get_error(_sslPtr, sslResult);
+    if ((error != SSL_ERROR_WANT_READ) && (error != SSL_ERROR_WANT_WRITE))
+    {
+        ERR_clear_error();
+        return false;
+    }
+
+    uint32_t elapsedMs = millis() - startMillis;
+    if (elapsedMs >= timeoutMs) return false;
+    pollfd pfd = { fd(), short((error == SSL_ERROR_WANT_READ) ? POLLIN : POLLOUT), 0 };
+    poll(&pfd, 1, std::min<uint32_t>(timeoutMs - elapsedMs, 10));
+    return true;
+}
+
+
+size_t NetworkClientSecure::write(const uint8_t* buffer, size_t size)
+{
+    if (_sslPtr == nullptr) return 0;
+    if (size == 0) return 0;
+
+    uint32_t startMillis = millis();
+    int result;
+    while ((result = SSL_write(_sslPtr, buffer, size)) <= 0)
+    {
+        if (!awaitSocket(result, startMillis, _timeout))
+        {
+            stop();
+            return 0;
+        }
+    }
+    return result;
+}
+
+
+int NetworkClientSecure::available()
+{
+    if (_sslPtr == nullptr) return 0;
+
+    // Processes the received records, so only application data is counted
+    uint8_t c;
+    int result = SSL_peek(_sslPtr, &c, 1);
+    if (result > 0) return SSL_pending(_sslPtr);
+
+    int error = SSL_get_error(_sslPtr, result);
+    if ((error != SSL_ERROR_WANT_READ) && (error != SSL_ERROR_WANT_WRITE))
+    {
+        // Closed by the peer (or failed)
+        ERR_clear_error();
+        stop();
+    }
+    return 0;
+}
+
+
+int NetworkClientSecure::read()
+{
+    uint8_t c;
+    return (read(&c, 1) == 1) ? c : -1;
+}
+
+
+int NetworkClientSecure::read(uint8_t* buffer, size_t size)
+{
+    if (available() == 0) return -1;
+    int result = SSL_read(_sslPtr, buffer, size);
+    return (result > 0) ? result : -1;
+}
+
+
+int NetworkClientSecure::peek()
+{
+    if (available() == 0) return -1;
+    uint8_t c;
+    return (SSL_peek(_sslPtr, &c, 1) == 1) ? c : -1;
+}
+
+
+void NetworkClientSecure::stop()
+{
+    if (_sslPtr != nullptr)
+    {
+        SSL_shutdown(_sslPtr); // Sends close_notify; doesn't wait for the peer's
+        SSL_free(_sslPtr);
+        _sslPtr = nullptr;
+        ERR_clear_error();
+    }
+    if (_contextPtr != nullptr)
+    {
+        SSL_CTX_free(_contextPtr);
+        _contextPtr = nullptr;
+    }
+    NetworkClient::stop();
+}
+
+
+uint8_t NetworkClientSecure::connected()
+{
+    if (_sslPtr == nullptr) return 0;
+    // Data received before the peer closed the connection can still be read
+    return (available() > 0) || NetworkClient::connected();
+}
@@ -0,0 +1,45 @@
+#ifndef HOST_NETWORKCLIENTSECURE_H
+#define HOST_NETWORKCLIENTSECURE_H
+
+#include "NetworkClient.h"
+
+typedef struct ssl_st SSL;
+typedef struct ssl_ctx_st SSL_CTX;
+
+// Host shim for the ESP32 TLS client, using OpenSSL on top of the TCP client. Like on the ESP, reads don't block.
+class NetworkClientSecure : public NetworkClient
+{
+    public:
+        NetworkClientSecure() {}
+        ~NetworkClientSecure() override { stop(); }
+
+        void setInsecure() { _isInsecure = true; }
+        void setCACert(const char* rootCA) { _rootCA = rootCA; _isInsecure = false; }
+        void setHandshakeTimeout(unsigned long handshakeTimeout) { _handshakeTimeout = handshakeTimeout; }
+
+        int connect(IPAddress ip, uint16_t port) override;
+        int connect(const char* host, uint16_t port) override;
+
+        size_t write(uint8_t c) override { return write(&c, 1); }
+        size_t write(const uint8_t* buffer, size_t size) override;
+        int available() override;
+        int read() override;
+        int read(uint8_t* buffer, size_t size) override;
+        int peek() override;
+        void stop() override;
+        uint8_t connected() override;
+        operator bool() override { return connected(); }
+        using Print::write;
+
+    private:
+        const char* _rootCA = nullptr;
+        bool _isInsecure = false;
+        unsigned long _handshakeTimeout = 120; // seconds
+        SSL_CTX* _contextPtr = nullptr;
+        SSL* _sslPtr = nullptr;
+
+        bool startTLS(const char* host);
+        bool awaitSocket(int sslResult, uint32_t startMillis, uint32_t timeoutMs);
+};
+
+#endif
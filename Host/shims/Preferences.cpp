@@ -0,0 +1,97 @@
+#include "Preferences.h"
+
+std::map<std::string, std::vector<uint8_t>> Preferences::_store;
+uint32_t Preferences::_writeCount = 0;
+uint32_t Preferences::_readCount = 0;
+
+
+void Preferences::reset()
+{
+    _store.clear();
+    _writeCount = 0;
+    _readCount = 0;
+}
+
+
+bool Preferences::begin(const char* name, bool readOnly, const char* partitionLabel)
+{
+    // NVS namespace names are max. 15 characters
+    if ((name == nullptr) || (strlen(name) > 15)) return false;
+    _namespace = name;
+    _namespace += '/';
+    _readOnly = readOnly;
+    return true;
+}
+
+
+bool Preferences::clear()
+{
+    if (_namespace.empty() || _readOnly) return false;
+    for (auto it = _store.begin(); it != _store.end();)
+    {
+        if (it->first.compare(0, _namespace.length(), _namespace) == 0)
+            it = _store.erase(it);
+        else
+            ++it;
+    }
+    _writeCount++;
+    return true;
+}
+
+
+bool Preferences::remove(const char* key)
+{
+    if (_namespace.empty() || _readOnly) return false;
+    _writeCount++;
+    return _store.erase(_namespace + key) > 0;
+}
+
+
+bool Preferences::isKey(const char* key)
+{
+    return find(key) != nullptr;
+}
+
+
+const std::vector<uint8_t>* Preferences::find(const char* key)
+{
+    if (_namespace.empty() || (key == nullptr)) return nullptr;
+    _readCount++;
+    auto it = _store.find(_namespace + key);
+    return (it == _store.end()) ? nullptr : &it->second;
+}
+
+
+size_t Preferences::putBytes(const char* key, const void* value, size_t length)
+{
+    // NVS keys are max. 15 characters
+    if (_namespace.empty() || _readOnly || (key == nullptr) || (strlen(key) > 15)) return 0;
+    const uint8_t* bytePtr = static_cast<const uint8_t*>(value);
+    _store[_namespace + key].assign(bytePtr, bytePtr + length);
+    _writeCount++;
+    return length;
+}
+
+
+String Preferences::getString(const char* key, const String& defaultValue)
+{
+    const std::vector<uint8_t>* valuePtr = find(key);
+    if ((valuePtr == nullptr) || valuePtr->empty()) return defaultValue;
+    return String(reinterpret_cast<const char*>(valuePtr->data()));
+}
+
+
+size_t Preferences::getBytesLength(const char* key)
+{
+    const std::vector<uint8_t>* valuePtr = find(key);
+    return (valuePtr == nullptr) ? 0 : valuePtr->size();
+}
+
+
+size_t Preferences::getBytes(const char* key, void* buffer, size_t maxLength)
+{
+    const std::vector<uint8_t>* valuePtr = find(key);
+    if ((valuePtr == nullptr) || (valuePtr->size() > maxLength)) return 0;
+    memcpy(buffer, valuePtr->data(), valuePtr->size());
+    return valuePtr->size();
+}
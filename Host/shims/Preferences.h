@@ -0,0 +1,70 @@
+#ifndef HOST_PREFERENCES_H
+#define HOST_PREFERENCES_H
+
+#include <map>
+#include <string>
+#include <vector>
+#include <Arduino.h>
+
+// Host shim for the ESP32 Preferences (NVS) library. The store is in memory and shared by all
+// instances, so it survives re-opening like NVS survives a reboot. Writes are counted to
+// check flash wear.
+class Preferences
+{
+    public:
+        bool begin(const char* name, bool readOnly = false, const char* partitionLabel = nullptr);
+        void end() { _namespace.clear(); }
+        bool clear();
+        bool remove(const char* key);
+        bool isKey(const char* key);
+
+        size_t putBool(const char* key, bool value) { return putValue(key, value); }
+        size_t putUChar(const char* key, uint8_t value) { return putValue(key, value); }
+        size_t putUShort(const char* key, uint16_t value) { return putValue(key, value); }
+        size_t putInt(const char* key, int32_t value) { return putValue(key, value); }
+        size_t putUInt(const char* key, uint32_t value) { return putValue(key, value); }
+        size_t putULong64(const char* key, uint64_t value) { return putValue(key, value); }
+        size_t putFloat(const char* key, float value) { return putValue(key, value); }
+        size_t putString(const char* key, const String& value) { return putBytes(key, value.c_str(), value.length() + 1); }
+        size_t putBytes(const char* key, const void* value, size_t length);
+
+        bool getBool(const char* key, bool defaultValue = false) { return getValue(key, defaultValue); }
+        uint8_t getUChar(const char* key, uint8_t defaultValue = 0) { return getValue(key, defaultValue); }
+        uint16_t getUShort(const char* key, uint16_t defaultValue = 0) { return getValue(key, defaultValue); }
+        int32_t getInt(const char* key, int32_t defaultValue = 0) { return getValue(key, defaultValue); }
+        uint32_t getUInt(const char* key, uint32_t defaultValue = 0) { return getValue(key, defaultValue); }
+        uint64_t getULong64(const char* key, uint64_t defaultValue = 0) { return getValue(key, defaultValue); }
+        float getFloat(const char* key, float defaultValue = 0) { return getValue(key, defaultValue); }
+        String getString(const char* key, const String& defaultValue = String());
+        size_t getBytesLength(const char* key);
+        size_t getBytes(const char* key, void* buffer, size_t maxLength);
+
+        // Host-only
+        static void reset(); // Erases the NVS partition
+        static uint32_t getWriteCount() { return _writeCount; }
+        static uint32_t getReadCount() { return _readCount; }
+
+    private:
+        static std::map<std::string, std::vector<uint8_t>> _store;
+        static uint32_t _writeCount;
+        static uint32_t _readCount;
+        std::string _namespace;
+        bool _readOnly = false;
+
+        const std::vector<uint8_t>* find(const char* key);
+
+        template<typename T>
+        size_t putValue(const char* key, T value) { return putBytes(key, &value, sizeof(value)); }
+
+        template<typename T>
+        T getValue(const char* key, T defaultValue)
+        {
+            const std::vector<uint8_t>* valuePtr = find(key);
+            if ((valuePtr == nullptr) || (valuePtr->size() != sizeof(T))) return defaultValue;
+            T value;
+            memcpy(&value, valuePtr->data(), sizeof(T));
+            return value;
+        }
+};
+
+#endif
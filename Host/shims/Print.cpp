@@ -0,0 +1,75 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "Print.h"
+
+size_t Print::write(const uint8_t* buffer, size_t size)
+{
+    size_t n = 0;
+    while (size--)
+    {
+        if (write(*buffer++) == 0) break;
+        n++;
+    }
+    return n;
+}
+
+
+size_t Print::vprintf(const char* format, va_list args)
+{
+    char buffer[64];
+    va_list argsCopy;
+    va_copy(argsCopy, args);
+    int length = vsnprintf(buffer, sizeof(buffer), format, argsCopy);
+    va_end(argsCopy);
+    if (length < 0) return 0;
+
+    if (size_t(length) < sizeof(buffer))
+        return write(buffer, length);
+
+    char* heapBuffer = static_cast<char*>(malloc(length + 1));
+    if (heapBuffer == nullptr) return 0;
+    vsnprintf(heapBuffer, length + 1, format, args);
+    size_t n = write(heapBuffer, length);
+    free(heapBuffer);
+    return n;
+}
+
+
+size_t Print::printf(const char* format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    size_t n = vprintf(format, args);
+    va_end(args);
+    return n;
+}
+
+
+size_t Print::printf_P(PGM_P format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    size_t n = vprintf(format, args);
+    va_end(args);
+    return n;
+}
+
+
+size_t Print::print(long long value, int base)
+{
+    if (base == 0) return write(uint8_t(value));
+    return print(String(value, base));
+}
+
+
+size_t Print::print(unsigned long long value, int base)
+{
+    if (base == 0) return write(uint8_t(value));
+    return print(String(value, base));
+}
+
+
+size_t Print::print(double value, int decimalPlaces)
+{
+    return print(String(value, decimalPlaces));
+}
@@ -0,0 +1,73 @@
+#ifndef HOST_PRINT_H
+#define HOST_PRINT_H
+
+// Host shim for the Arduino Print class (ESP32 core API).
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdarg.h>
+#include <string.h>
+#include "WString.h"
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+class Print;
+
+class Printable
+{
+    public:
+        virtual ~Printable() {}
+        virtual size_t printTo(Print& p) const = 0;
+};
+
+class Print
+{
+    public:
+        virtual ~Print() {}
+
+        int getWriteError() { return _writeError; }
+        void clearWriteError() { _writeError = 0; }
+
+        virtual size_t write(uint8_t) = 0;
+        virtual size_t write(const uint8_t* buffer, size_t size);
+        size_t write(const char* str) { return (str == nullptr) ? 0 : write(str, strlen(str)); }
+        size_t write(const char* buffer, size_t size) { return write(reinterpret_cast<const uint8_t*>(buffer), size); }
+        virtual int availableForWrite() { return 0; }
+        virtual void flush() {}
+
+        size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+        size_t printf_P(PGM_P format, ...) __attribute__((format(printf, 2, 3)));
+
+        size_t print(const __FlashStringHelper* pstr) { return write(reinterpret_cast<const char*>(pstr)); }
+        size_t print(const String& str) { return write(str.c_str(), str.length()); }
+        size_t print(const char str[]) { return write(str); }
+        size_t print(char c) { return write(uint8_t(c)); }
+        size_t print(unsigned char value, int base = DEC) { return print((unsigned long long)value, base); }
+        size_t print(int value, int base = DEC) { return print((long long)value, base); }
+        size_t print(unsigned int value, int base = DEC) { return print((unsigned long long)value, base); }
+        size_t print(long value, int base = DEC) { return print((long long)value, base); }
+        size_t print(unsigned long value, int base = DEC) { return print((unsigned long long)value, base); }
+        size_t print(long long value, int base = DEC);
+        size_t print(unsigned long long value, int base = DEC);
+        size_t print(double value, int decimalPlaces = 2);
+        size_t print(const Printable& printable) { return printable.printTo(*this); }
+
+        size_t println() { return write("\r\n"); }
+        template<typename T>
+        size_t println(const T& value) { size_t n = print(value); return n + println(); }
+        template<typename T>
+        size_t println(const T& value, int format) { size_t n = print(value, format); return n + println(); }
+
+    protected:
+        void setWriteError(int error = 1) { _writeError = error; }
+
+    private:
+        int _writeError = 0;
+
+        size_t vprintf(const char* format, va_list args);
+};
+
+#endif
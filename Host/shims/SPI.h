@@ -0,0 +1,45 @@
+#ifndef HOST_SPI_H
+#define HOST_SPI_H
+
+#include <stdint.h>
+#include <functional>
+#include <Arduino.h>
+
+#define SPI_MSBFIRST 1
+#define SPI_LSBFIRST 0
+#define SPI_MODE0 0
+#define FSPI 0
+#define HSPI 1
+#define VSPI 2
+
+class SPISettings
+{
+    public:
+        SPISettings(uint32_t clock = 1000000, uint8_t bitOrder = SPI_MSBFIRST, uint8_t dataMode = SPI_MODE0) {}
+};
+
+// Host shim for an SPI bus. There is no device attached; a test can install a responder
+// which returns the byte clocked in for each byte clocked out.
+class SPIClass
+{
+    public:
+        SPIClass(uint8_t spiBus = HSPI) {}
+
+        void begin(int8_t sck = -1, int8_t miso = -1, int8_t mosi = -1, int8_t ss = -1) {}
+        void end() {}
+        void setFrequency(uint32_t frequency) {}
+        void setBitOrder(uint8_t bitOrder) {}
+        void setDataMode(uint8_t dataMode) {}
+        void setHwCs(bool use) {}
+        void beginTransaction(SPISettings settings) {}
+        void endTransaction() {}
+        uint8_t transfer(uint8_t data) { return _responder ? _responder(data) : 0; }
+
+        // Host-only
+        void setResponder(std::function<uint8_t(uint8_t)> responder) { _responder = responder; }
+
+    private:
+        std::function<uint8_t(uint8_t)> _responder;
+};
+
+#endif
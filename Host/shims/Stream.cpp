@@ -0,0 +1,153 @@
+#include <Arduino.h>
+#include "Stream.h"
+
+int Stream::timedRead()
+{
+    unsigned long startMillis = millis();
+    do
+    {
+        int c = read();
+        if (c >= 0) return c;
+        yield();
+    }
+    while (millis() - startMillis < _timeout);
+    return -1;
+}
+
+
+int Stream::timedPeek()
+{
+    unsigned long startMillis = millis();
+    do
+    {
+        int c = peek();
+        if (c >= 0) return c;
+        yield();
+    }
+    while (millis() - startMillis < _timeout);
+    return -1;
+}
+
+
+int Stream::peekNextDigit(bool allowDecimal)
+{
+    while (true)
+    {
+        int c = timedPeek();
+        if ((c < 0) || (c == '-') || ((c >= '0') && (c <= '9')) || (allowDecimal && (c == '.')))
+            return c;
+        read();
+    }
+}
+
+
+bool Stream::findUntil(const char* target, const char* terminator)
+{
+    size_t targetLength = strlen(target);
+    size_t terminatorLength = (terminator == nullptr) ? 0 : strlen(terminator);
+    if (targetLength == 0) return true;
+
+    size_t targetIndex = 0;
+    size_t terminatorIndex = 0;
+    int c;
+    while ((c = timedRead()) >= 0)
+    {
+        targetIndex = (c == target[targetIndex]) ? targetIndex + 1 : ((c == target[0]) ? 1 : 0);
+        if (targetIndex == targetLength) return true;
+
+        if (terminatorLength > 0)
+        {
+            terminatorIndex = (c == terminator[terminatorIndex]) ? terminatorIndex + 1 : ((c == terminator[0]) ? 1 : 0);
+            if (terminatorIndex == terminatorLength) return false;
+        }
+    }
+    return false;
+}
+
+
+long Stream::parseInt()
+{
+    int c = peekNextDigit(false);
+    if (c < 0) return 0;
+
+    bool isNegative = false;
+    long value = 0;
+    do
+    {
+        if (c == '-')
+            isNegative = true;
+        else
+            value = value * 10 + c - '0';
+        read();
+        c = timedPeek();
+    }
+    while ((c >= '0') && (c <= '9'));
+
+    return isNegative ? -value : value;
+}
+
+
+float Stream::parseFloat()
+{
+    int c = peekNextDigit(true);
+    if (c < 0) return 0;
+
+    String number;
+    do
+    {
+        number += char(c);
+        read();
+        c = timedPeek();
+    }
+    while (((c >= '0') && (c <= '9')) || (c == '.'));
+
+    return number.toFloat();
+}
+
+
+size_t Stream::readBytes(char* buffer, size_t length)
+{
+    size_t count = 0;
+    while (count < length)
+    {
+        int c = timedRead();
+        if (c < 0) break;
+        *buffer++ = char(c);
+        count++;
+    }
+    return count;
+}
+
+
+size_t Stream::readBytesUntil(char terminator, char* buffer, size_t length)
+{
+    size_t count = 0;
+    while (count < length)
+    {
+        int c = timedRead();
+        if ((c < 0) || (c == terminator)) break;
+        *buffer++ = char(c);
+        count++;
+    }
+    return count;
+}
+
+
+String Stream::readString()
+{
+    String result;
+    int c;
+    while ((c = timedRead()) >= 0)
+        result += char(c);
+    return result;
+}
+
+
+String Stream::readStringUntil(char terminator)
+{
+    String result;
+    int c;
+    while (((c = timedRead()) >= 0) && (c != terminator))
+        result += char(c);
+    return result;
+}
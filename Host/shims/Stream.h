@@ -0,0 +1,44 @@
+#ifndef HOST_STREAM_H
+#define HOST_STREAM_H
+
+// Host shim for the Arduino Stream class (ESP32 core API).
+
+#include "Print.h"
+
+class Stream : public Print
+{
+    public:
+        virtual int available() = 0;
+        virtual int read() = 0;
+        virtual int peek() = 0;
+
+        void setTimeout(unsigned long timeout) { _timeout = timeout; }
+        unsigned long getTimeout() const { return _timeout; }
+
+        bool find(const char* target) { return findUntil(target, nullptr); }
+        bool find(char target) { char str[2] = { target, 0 }; return find(str); }
+        bool findUntil(const char* target, const char* terminator);
+
+        long parseInt();
+        float parseFloat();
+
+        virtual size_t readBytes(char* buffer, size_t length);
+        size_t readBytes(uint8_t* buffer, size_t length) { return readBytes(reinterpret_cast<char*>(buffer), length); }
+        size_t readBytesUntil(char terminator, char* buffer, size_t length);
+        size_t readBytesUntil(char terminator, uint8_t* buffer, size_t length)
+        {
+            return readBytesUntil(terminator, reinterpret_cast<char*>(buffer), length);
+        }
+
+        String readString();
+        String readStringUntil(char terminator);
+
+    protected:
+        unsigned long _timeout = 1000;
+
+        int timedRead();
+        int timedPeek();
+        int peekNextDigit(bool allowDecimal);
+};
+
+#endif
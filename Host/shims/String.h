@@ -0,0 +1,5 @@
+#pragma once
+
+// P1Telegram.h includes <String.h>; on a case-sensitive host file system this would otherwise be <string.h>.
+#include <string.h>
+#include "WString.h"
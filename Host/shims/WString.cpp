@@ -0,0 +1,138 @@
+#include <algorithm>
+#include <ctype.h>
+#include <stdio.h>
+#include "WString.h"
+
+std::string String::format(long long value, unsigned char base)
+{
+    if ((value < 0) && (base == 10))
+        return "-" + format((unsigned long long)(-value), base);
+    return format((unsigned long long)value, base);
+}
+
+
+std::string String::format(unsigned long long value, unsigned char base)
+{
+    if ((base < 2) || (base > 36)) base = 10;
+
+    char digits[65];
+    char* digitPtr = digits + sizeof(digits) - 1;
+    *digitPtr = 0;
+    do
+    {
+        int digit = value % base;
+        *--digitPtr = (digit < 10) ? ('0' + digit) : ('a' + digit - 10);
+        value /= base;
+    }
+    while (value != 0);
+    return digitPtr;
+}
+
+
+std::string String::format(double value, unsigned int decimalPlaces)
+{
+    char buffer[64];
+    snprintf(buffer, sizeof(buffer), "%.*f", decimalPlaces, value);
+    return buffer;
+}
+
+
+bool String::equalsIgnoreCase(const String& str) const
+{
+    return (_str.length() == str._str.length()) && (strcasecmp(_str.c_str(), str._str.c_str()) == 0);
+}
+
+
+bool String::startsWith(const String& prefix, unsigned int offset) const
+{
+    if (offset > _str.length()) return false;
+    return _str.compare(offset, prefix._str.length(), prefix._str) == 0;
+}
+
+
+bool String::endsWith(const String& suffix) const
+{
+    if (suffix._str.length() > _str.length()) return false;
+    return _str.compare(_str.length() - suffix._str.length(), suffix._str.length(), suffix._str) == 0;
+}
+
+
+char& String::operator[](unsigned int index)
+{
+    static char dummy;
+    if (index >= _str.length())
+    {
+        dummy = 0;
+        return dummy;
+    }
+    return _str[index];
+}
+
+
+void String::getBytes(unsigned char* buf, unsigned int bufsize, unsigned int index) const
+{
+    if ((buf == nullptr) || (bufsize == 0)) return;
+    if (index >= _str.length())
+    {
+        buf[0] = 0;
+        return;
+    }
+    size_t count = std::min<size_t>(bufsize - 1, _str.length() - index);
+    memcpy(buf, _str.c_str() + index, count);
+    buf[count] = 0;
+}
+
+
+String String::substring(unsigned int beginIndex, unsigned int endIndex) const
+{
+    if (beginIndex > endIndex) std::swap(beginIndex, endIndex);
+    if (beginIndex >= _str.length()) return String();
+    if (endIndex > _str.length()) endIndex = _str.length();
+    String result;
+    result._str = _str.substr(beginIndex, endIndex - beginIndex);
+    return result;
+}
+
+
+void String::replace(char find, char replace)
+{
+    for (char& c : _str)
+        if (c == find) c = replace;
+}
+
+
+void String::replace(const String& find, const String& replace)
+{
+    if (find._str.empty()) return;
+    size_t pos = 0;
+    while ((pos = _str.find(find._str, pos)) != std::string::npos)
+    {
+        _str.replace(pos, find._str.length(), replace._str);
+        pos += replace._str.length();
+    }
+}
+
+
+void String::toLowerCase()
+{
+    for (char& c : _str) c = tolower(c);
+}
+
+
+void String::toUpperCase()
+{
+    for (char& c : _str) c = toupper(c);
+}
+
+
+void String::trim()
+{
+    size_t begin = _str.find_first_not_of(" \t\r\n\f\v");
+    if (begin == std::string::npos)
+    {
+        _str.clear();
+        return;
+    }
+    size_t end = _str.find_last_not_of(" \t\r\n\f\v");
+    _str = _str.substr(begin, end - begin + 1);
+}
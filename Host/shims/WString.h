@@ -0,0 +1,136 @@
+#ifndef HOST_WSTRING_H
+#define HOST_WSTRING_H
+
+// Host shim for the Arduino String class, backed by std::string.
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string>
+#include "pgmspace.h"
+
+class __FlashStringHelper;
+#define F(string_literal) (reinterpret_cast<const __FlashStringHelper*>(PSTR(string_literal)))
+#define FPSTR(pstr_pointer) (reinterpret_cast<const __FlashStringHelper*>(pstr_pointer))
+
+class String
+{
+    public:
+        String(const char* cstr = "") { if (cstr != nullptr) _str = cstr; }
+        String(const char* cstr, unsigned int length) { if (cstr != nullptr) _str.assign(cstr, length); }
+        String(const uint8_t* cstr, unsigned int length) : String(reinterpret_cast<const char*>(cstr), length) {}
+        String(const __FlashStringHelper* pstr) : String(reinterpret_cast<const char*>(pstr)) {}
+        String(const String& other) = default;
+        String(String&& other) = default;
+        explicit String(char c) : _str(1, c) {}
+        explicit String(unsigned char value, unsigned char base = 10) : _str(format(value, base)) {}
+        explicit String(int value, unsigned char base = 10) : _str(format(value, base)) {}
+        explicit String(unsigned int value, unsigned char base = 10) : _str(format(value, base)) {}
+        explicit String(long value, unsigned char base = 10) : _str(format(value, base)) {}
+        explicit String(unsigned long value, unsigned char base = 10) : _str(format(value, base)) {}
+        explicit String(long long value, unsigned char base = 10) : _str(format(value, base)) {}
+        explicit String(unsigned long long value, unsigned char base = 10) : _str(format(value, base)) {}
+        explicit String(float value, unsigned int decimalPlaces = 2) : _str(format(double(value), decimalPlaces)) {}
+        explicit String(double value, unsigned int decimalPlaces = 2) : _str(format(value, decimalPlaces)) {}
+
+        String& operator=(const String& rhs) = default;
+        String& operator=(String&& rhs) = default;
+        String& operator=(const char* cstr) { _str = (cstr != nullptr) ? cstr : ""; return *this; }
+        String& operator=(const __FlashStringHelper* pstr) { return operator=(reinterpret_cast<const char*>(pstr)); }
+
+        bool reserve(unsigned int size) { _str.reserve(size); return true; }
+        unsigned int length() const { return _str.length(); }
+        bool isEmpty() const { return _str.empty(); }
+        void clear() { _str.clear(); }
+
+        bool concat(const String& str) { _str += str._str; return true; }
+        bool concat(const char* cstr) { if (cstr == nullptr) return false; _str += cstr; return true; }
+        bool concat(const char* cstr, unsigned int length) { if (cstr == nullptr) return false; _str.append(cstr, length); return true; }
+        bool concat(const __FlashStringHelper* pstr) { return concat(reinterpret_cast<const char*>(pstr)); }
+        bool concat(char c) { _str += c; return true; }
+        bool concat(unsigned char value) { _str += format(value, 10); return true; }
+        bool concat(int value) { _str += format(value, 10); return true; }
+        bool concat(unsigned int value) { _str += format(value, 10); return true; }
+        bool concat(long value) { _str += format(value, 10); return true; }
+        bool concat(unsigned long value) { _str += format(value, 10); return true; }
+        bool concat(long long value) { _str += format(value, 10); return true; }
+        bool concat(unsigned long long value) { _str += format(value, 10); return true; }
+        bool concat(float value) { _str += format(double(value), 2); return true; }
+        bool concat(double value) { _str += format(value, 2); return true; }
+
+        template<typename T>
+        String& operator+=(const T& rhs) { concat(rhs); return *this; }
+
+        template<typename T>
+        friend String operator+(const String& lhs, const T& rhs) { String result(lhs); result.concat(rhs); return result; }
+        friend String operator+(const char* lhs, const String& rhs) { String result(lhs); result.concat(rhs); return result; }
+        friend String operator+(const __FlashStringHelper* lhs, const String& rhs) { String result(lhs); result.concat(rhs); return result; }
+
+        int compareTo(const String& str) const { return _str.compare(str._str); }
+        bool equals(const String& str) const { return _str == str._str; }
+        bool equals(const char* cstr) const { return _str == ((cstr != nullptr) ? cstr : ""); }
+        bool equalsIgnoreCase(const String& str) const;
+        bool operator==(const String& rhs) const { return equals(rhs); }
+        bool operator==(const char* cstr) const { return equals(cstr); }
+        bool operator!=(const String& rhs) const { return !equals(rhs); }
+        bool operator!=(const char* cstr) const { return !equals(cstr); }
+        bool operator<(const String& rhs) const { return compareTo(rhs) < 0; }
+        bool operator>(const String& rhs) const { return compareTo(rhs) > 0; }
+        bool operator<=(const String& rhs) const { return compareTo(rhs) <= 0; }
+        bool operator>=(const String& rhs) const { return compareTo(rhs) >= 0; }
+
+        bool startsWith(const String& prefix) const { return _str.compare(0, prefix._str.length(), prefix._str) == 0; }
+        bool startsWith(const String& prefix, unsigned int offset) const;
+        bool endsWith(const String& suffix) const;
+
+        char charAt(unsigned int index) const { return (index < _str.length()) ? _str[index] : 0; }
+        void setCharAt(unsigned int index, char c) { if (index < _str.length()) _str[index] = c; }
+        char operator[](unsigned int index) const { return charAt(index); }
+        char& operator[](unsigned int index);
+        void getBytes(unsigned char* buf, unsigned int bufsize, unsigned int index = 0) const;
+        void toCharArray(char* buf, unsigned int bufsize, unsigned int index = 0) const
+        {
+            getBytes(reinterpret_cast<unsigned char*>(buf), bufsize, index);
+        }
+        const char* c_str() const { return _str.c_str(); }
+        char* begin() { return &_str[0]; }
+        char* end() { return begin() + _str.length(); }
+        const char* begin() const { return c_str(); }
+        const char* end() const { return c_str() + _str.length(); }
+
+        int indexOf(char ch, unsigned int fromIndex = 0) const { return toIndex(_str.find(ch, fromIndex)); }
+        int indexOf(const String& str, unsigned int fromIndex = 0) const { return toIndex(_str.find(str._str, fromIndex)); }
+        int lastIndexOf(char ch) const { return toIndex(_str.rfind(ch)); }
+        int lastIndexOf(char ch, unsigned int fromIndex) const { return toIndex(_str.rfind(ch, fromIndex)); }
+        int lastIndexOf(const String& str) const { return toIndex(_str.rfind(str._str)); }
+        int lastIndexOf(const String& str, unsigned int fromIndex) const { return toIndex(_str.rfind(str._str, fromIndex)); }
+        String substring(unsigned int beginIndex) const { return substring(beginIndex, _str.length()); }
+        String substring(unsigned int beginIndex, unsigned int endIndex) const;
+
+        void replace(char find, char replace);
+        void replace(const String& find, const String& replace);
+        void remove(unsigned int index) { remove(index, _str.length()); }
+        void remove(unsigned int index, unsigned int count) { if (index < _str.length()) _str.erase(index, count); }
+        void toLowerCase();
+        void toUpperCase();
+        void trim();
+
+        long toInt() const { return atol(_str.c_str()); }
+        float toFloat() const { return float(atof(_str.c_str())); }
+        double toDouble() const { return atof(_str.c_str()); }
+
+    private:
+        std::string _str;
+
+        static int toIndex(size_t pos) { return (pos == std::string::npos) ? -1 : int(pos); }
+        static std::string format(long long value, unsigned char base);
+        static std::string format(unsigned long long value, unsigned char base);
+        static std::string format(int value, unsigned char base) { return format((long long)value, base); }
+        static std::string format(long value, unsigned char base) { return format((long long)value, base); }
+        static std::string format(unsigned char value, unsigned char base) { return format((unsigned long long)value, base); }
+        static std::string format(unsigned int value, unsigned char base) { return format((unsigned long long)value, base); }
+        static std::string format(unsigned long value, unsigned char base) { return format((unsigned long long)value, base); }
+        static std::string format(double value, unsigned int decimalPlaces);
+};
+
+#endif
@@ -0,0 +1,70 @@
+#include "WebServer.h"
+
+void WebServer::on(const String& uri, HTTPMethod method, THandlerFunction handler)
+{
+    _handlers.push_back({ uri, method, handler });
+}
+
+
+String WebServer::arg(const String& name)
+{
+    auto it = _args.find(name.c_str());
+    return (it == _args.end()) ? String() : it->second;
+}
+
+
+String WebServer::header(const String& name)
+{
+    auto it = _headers.find(name.c_str());
+    return (it == _headers.end()) ? String() : it->second;
+}
+
+
+void WebServer::sendHeader(const String& name, const String& value, bool first)
+{
+    _responseHeaders[name.c_str()] = value;
+}
+
+
+void WebServer::send(int code, const char* contentType, const String& content)
+{
+    _responseCode = code;
+    _responseContentType = (contentType == nullptr) ? "" : contentType;
+    _responseBody.append(content.c_str(), content.length());
+}
+
+
+void WebServer::sendContent(const char* content, size_t size)
+{
+    _responseBody.append(content, size);
+}
+
+
+bool WebServer::handleRequest(
+    HTTPMethod method,
+    const String& uri,
+    const std::map<std::string, String>& args,
+    const std::map<std::string, String>& headers)
+{
+    _method = method;
+    _uri = uri;
+    _args = args;
+    _headers = headers;
+    _contentLength = CONTENT_LENGTH_NOT_SET;
+    _responseCode = 0;
+    _responseContentType.clear();
+    _responseBody.clear();
+    _responseHeaders.clear();
+
+    for (Handler& handler : _handlers)
+    {
+        if ((handler.uri == uri) && ((handler.method == HTTP_ANY) || (handler.method == method)))
+        {
+            handler.function();
+            return true;
+        }
+    }
+
+    if (_notFoundHandler) _notFoundHandler();
+    return false;
+}
@@ -0,0 +1,92 @@
+#ifndef HOST_WEBSERVER_H
+#define HOST_WEBSERVER_H
+
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+#include <Arduino.h>
+#include "FS.h"
+#include "WiFiClient.h"
+
+#define CONTENT_LENGTH_UNKNOWN ((size_t)-1)
+#define CONTENT_LENGTH_NOT_SET ((size_t)-2)
+
+typedef enum
+{
+    HTTP_ANY,
+    HTTP_GET,
+    HTTP_HEAD,
+    HTTP_POST,
+    HTTP_PUT,
+    HTTP_PATCH,
+    HTTP_DELETE,
+    HTTP_OPTIONS
+} HTTPMethod;
+
+// Host shim for the ESP32 web server. It doesn't listen; a test invokes a request using
+// handleRequest() and inspects the response.
+class WebServer
+{
+    public:
+        typedef std::function<void(void)> THandlerFunction;
+
+        WebServer(int port = 80) {}
+
+        void begin() {}
+        void handleClient() {}
+        void on(const String& uri, THandlerFunction handler) { on(uri, HTTP_ANY, handler); }
+        void on(const String& uri, HTTPMethod method, THandlerFunction handler);
+        void onNotFound(THandlerFunction handler) { _notFoundHandler = handler; }
+        void serveStatic(const char* uri, fs::FS& fs, const char* path, const char* cacheHeader = nullptr) {}
+
+        String uri() { return _uri; }
+        HTTPMethod method() { return _method; }
+        bool hasArg(const String& name) { return _args.count(name.c_str()) != 0; }
+        String arg(const String& name);
+        int args() { return _args.size(); }
+        bool hasHeader(const String& name) { return _headers.count(name.c_str()) != 0; }
+        String header(const String& name);
+        void collectHeaders(const char* headerKeys[], size_t headerKeysCount) {}
+
+        void setContentLength(size_t contentLength) { _contentLength = contentLength; }
+        void sendHeader(const String& name, const String& value, bool first = false);
+        void send(int code, const char* contentType = nullptr, const String& content = String());
+        void send(int code, const String& contentType, const String& content) { send(code, contentType.c_str(), content); }
+        void send(int code, const char* contentType, const char* content) { send(code, contentType, String(content)); }
+        void send_P(int code, PGM_P contentType, PGM_P content) { send(code, contentType, String(content)); }
+        void sendContent(const String& content) { sendContent(content.c_str(), content.length()); }
+        void sendContent(const char* content, size_t size);
+
+        // Host-only
+        bool handleRequest(
+            HTTPMethod method,
+            const String& uri,
+            const std::map<std::string, String>& args = {},
+            const std::map<std::string, String>& headers = {});
+        int getResponseCode() { return _responseCode; }
+        const std::string& getResponseBody() { return _responseBody; }
+        const std::string& getResponseContentType() { return _responseContentType; }
+
+    private:
+        struct Handler
+        {
+            String uri;
+            HTTPMethod method;
+            THandlerFunction function;
+        };
+
+        std::vector<Handler> _handlers;
+        THandlerFunction _notFoundHandler;
+        String _uri;
+        HTTPMethod _method = HTTP_GET;
+        std::map<std::string, String> _args;
+        std::map<std::string, String> _headers;
+        size_t _contentLength = CONTENT_LENGTH_NOT_SET;
+        int _responseCode = 0;
+        std::string _responseContentType;
+        std::string _responseBody;
+        std::map<std::string, String> _responseHeaders;
+};
+
+#endif
@@ -0,0 +1,22 @@
+#include "WiFi.h"
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+WiFiClass WiFi;
+
+
+int WiFiClass::hostByName(const char* host, IPAddress& result)
+{
+    if (result.fromString(host)) return 1;
+
+    addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    addrinfo* resultPtr = nullptr;
+    if ((getaddrinfo(host, nullptr, &hints, &resultPtr) != 0) || (resultPtr == nullptr))
+        return 0;
+    result = IPAddress(uint32_t(reinterpret_cast<sockaddr_in*>(resultPtr->ai_addr)->sin_addr.s_addr));
+    freeaddrinfo(resultPtr);
+    return 1;
+}
@@ -0,0 +1,56 @@
+#ifndef HOST_WIFI_H
+#define HOST_WIFI_H
+
+#include <Arduino.h>
+#include "IPAddress.h"
+#include "WiFiClient.h"
+
+typedef enum
+{
+    WL_IDLE_STATUS = 0,
+    WL_NO_SSID_AVAIL = 1,
+    WL_SCAN_COMPLETED = 2,
+    WL_CONNECTED = 3,
+    WL_CONNECT_FAILED = 4,
+    WL_CONNECTION_LOST = 5,
+    WL_DISCONNECTED = 6
+} wl_status_t;
+
+typedef enum
+{
+    WIFI_PS_NONE = 0,
+    WIFI_PS_MIN_MODEM,
+    WIFI_PS_MAX_MODEM
+} wifi_ps_type_t;
+
+// Host shim: the host's own network connection acts as an always connected station.
+class WiFiClass
+{
+    public:
+        bool isConnected() { return _isConnected; }
+        wl_status_t status() { return _isConnected ? WL_CONNECTED : WL_DISCONNECTED; }
+        IPAddress localIP() { return IPAddress(127, 0, 0, 1); }
+        IPAddress gatewayIP() { return IPAddress(127, 0, 0, 1); }
+        IPAddress subnetMask() { return IPAddress(255, 0, 0, 0); }
+        IPAddress dnsIP(uint8_t = 0) { return IPAddress(127, 0, 0, 53); }
+        String macAddress() { return F("02:00:00:C0:FF:EE"); }
+        const char* getHostname() { return "host"; }
+        int8_t RSSI() { return -50; }
+        uint8_t* BSSID() { return _bssid; }
+        int32_t channel() { return 1; }
+        int hostByName(const char* host, IPAddress& result);
+        bool setSleep(wifi_ps_type_t sleepType) { _sleepType = sleepType; return true; }
+        wifi_ps_type_t getSleep() { return _sleepType; }
+
+        // Host-only
+        void setConnected(bool connected) { _isConnected = connected; }
+
+    private:
+        bool _isConnected = true;
+        uint8_t _bssid[6] = { 0x02, 0x00, 0x00, 0x0A, 0xCC, 0xE5 };
+        wifi_ps_type_t _sleepType = WIFI_PS_MIN_MODEM;
+};
+
+extern WiFiClass WiFi;
+
+#endif
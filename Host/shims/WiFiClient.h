@@ -0,0 +1,8 @@
+#ifndef HOST_WIFICLIENT_H
+#define HOST_WIFICLIENT_H
+
+#include "NetworkClient.h"
+
+typedef NetworkClient WiFiClient;
+
+#endif
@@ -0,0 +1,11 @@
+#ifndef HOST_DRIVER_UART_H
+#define HOST_DRIVER_UART_H
+
+#include "Esp.h"
+
+typedef int uart_port_t;
+
+// Host shim: UART wake-up has no effect; light-sleep always ends by its timer.
+inline esp_err_t uart_set_wakeup_threshold(uart_port_t uartNum, int threshold) { return ESP_OK; }
+
+#endif
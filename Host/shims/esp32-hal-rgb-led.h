@@ -0,0 +1,9 @@
+#ifndef HOST_ESP32_HAL_RGB_LED_H
+#define HOST_ESP32_HAL_RGB_LED_H
+
+#include <stdint.h>
+
+inline void rgbLedWrite(uint8_t pin, uint8_t red, uint8_t green, uint8_t blue) {}
+inline void neopixelWrite(uint8_t pin, uint8_t red, uint8_t green, uint8_t blue) {}
+
+#endif
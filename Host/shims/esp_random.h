@@ -0,0 +1,10 @@
+#ifndef HOST_ESP_RANDOM_H
+#define HOST_ESP_RANDOM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+uint32_t esp_random();
+void esp_fill_random(void* buffer, size_t length);
+
+#endif
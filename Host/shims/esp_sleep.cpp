@@ -0,0 +1,48 @@
+#include <Arduino.h>
+#include "esp_sleep.h"
+
+namespace
+{
+    uint64_t _timerWakeupUs = 0;
+}
+
+
+esp_err_t esp_sleep_enable_timer_wakeup(uint64_t timeUs)
+{
+    _timerWakeupUs = timeUs;
+    return ESP_OK;
+}
+
+
+esp_err_t esp_sleep_enable_uart_wakeup(int uartNum)
+{
+    return ESP_OK;
+}
+
+
+esp_err_t esp_sleep_enable_gpio_wakeup()
+{
+    return ESP_OK;
+}
+
+
+esp_err_t esp_sleep_disable_wakeup_source(esp_sleep_source_t source)
+{
+    if ((source == ESP_SLEEP_WAKEUP_ALL) || (source == ESP_SLEEP_WAKEUP_TIMER))
+        _timerWakeupUs = 0;
+    return ESP_OK;
+}
+
+
+esp_err_t esp_light_sleep_start()
+{
+    if (_timerWakeupUs == 0) return ESP_ERR_INVALID_STATE;
+    delayMicroseconds(static_cast<uint32_t>(_timerWakeupUs));
+    return ESP_OK;
+}
+
+
+esp_sleep_source_t esp_sleep_get_wakeup_cause()
+{
+    return ESP_SLEEP_WAKEUP_TIMER;
+}
@@ -0,0 +1,42 @@
+// Host shim for the mbedTLS functions used by the libraries, implemented using OpenSSL.
+
+#include <mbedtls/base64.h>
+#include <mbedtls/sha1.h>
+#include <openssl/evp.h>
+
+int mbedtls_base64_encode(unsigned char* dst, size_t dlen, size_t* olen, const unsigned char* src, size_t slen)
+{
+    size_t required = 4 * ((slen + 2) / 3) + 1;
+    if ((dst == nullptr) || (dlen < required))
+    {
+        *olen = required;
+        return MBEDTLS_ERR_BASE64_BUFFER_TOO_SMALL;
+    }
+    *olen = EVP_EncodeBlock(dst, src, slen);
+    return 0;
+}
+
+
+int mbedtls_base64_decode(unsigned char* dst, size_t dlen, size_t* olen, const unsigned char* src, size_t slen)
+{
+    size_t required = 3 * (slen / 4);
+    if ((dst == nullptr) || (dlen < required))
+    {
+        *olen = required;
+        return MBEDTLS_ERR_BASE64_BUFFER_TOO_SMALL;
+    }
+    int length = EVP_DecodeBlock(dst, src, slen);
+    if (length < 0) return MBEDTLS_ERR_BASE64_INVALID_CHARACTER;
+    // EVP_DecodeBlock doesn't account for padding
+    while ((slen > 0) && (src[--slen] == '='))
+        length--;
+    *olen = length;
+    return 0;
+}
+
+
+int mbedtls_sha1(const unsigned char* input, size_t ilen, unsigned char output[20])
+{
+    return EVP_Digest(input, ilen, output, nullptr, EVP_sha1(), nullptr) ? 0 : -1;
+}
+
@@ -0,0 +1,189 @@
+#ifndef HOST_FTP_STAND_IN_H
+#define HOST_FTP_STAND_IN_H
+
+// FTP server with a single user, standing in for the sync server in tests.
+// It logs the received commands and data, keeps the uploaded files and can fail transfers to test recovery.
+// Like most servers, STOR after REST overwrites the file from the given offset and keeps any bytes beyond.
+
+#include <Arduino.h>
+#include <StandInServer.h>
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+enum struct FTPFault
+{
+    None,
+    Abort, // Receives the data, but responds 451 instead of 226
+    Disconnect, // Receives the data, but closes the control connection without response
+    Partial // Keeps only the first half of the data (like a lost connection) and responds 426
+};
+
+
+class FTPStandIn
+{
+    public:
+        FTPStandIn(int timeoutMs = 2000)
+            : _timeoutMs(timeoutMs),
+              _controlServer([this](StandInConnection& connection) { handleControl(connection); }),
+              _dataServer([this](StandInConnection& connection) { handleData(connection); })
+        {}
+
+        uint16_t getPort() const { return _controlServer.getPort(); }
+        int getConnectionCount() const { return _controlServer.getConnectionCount(); }
+
+        // Fails the next transfers.
+        void injectFault(FTPFault fault, int count = 1)
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _fault = fault;
+            _faultCount = count;
+        }
+
+        std::vector<std::string> getCommands()
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            return _commands;
+        }
+
+        // Data of all transfers, including failed ones.
+        std::string getData()
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            return _data;
+        }
+
+        // Contents of an uploaded file
+        std::string getFile(const std::string& name)
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            return _files[name];
+        }
+
+    private:
+        int _timeoutMs;
+        std::mutex _mutex;
+        std::vector<std::string> _commands;
+        std::string _data;
+        std::map<std::string, std::string> _files;
+        std::atomic<int> _transfers { 0 };
+        FTPFault _fault = FTPFault::None;
+        int _faultCount = 0;
+        FTPFault _transferFault = FTPFault::None;
+        std::string _transferFile; // Target of the upload in progress
+        size_t _transferOffset = 0;
+        bool _isAppend = false;
+        StandInServer _controlServer; // Last, so the state above exists before connections are handled
+        StandInServer _dataServer;
+
+        FTPFault takeFault()
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (_faultCount == 0) return FTPFault::None;
+            _faultCount--;
+            return _fault;
+        }
+
+        void handleControl(StandInConnection& connection)
+        {
+            connection.write("220 Stand-in FTP\r\n");
+            size_t restOffset = 0;
+            std::string line;
+            while (connection.readLine(line, _timeoutMs * 2))
+            {
+                {
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    _commands.push_back(line);
+                }
+                std::string command = line.substr(0, line.find(' '));
+                std::string arg = (line.find(' ') == std::string::npos) ? "" : line.substr(line.find(' ') + 1);
+                if (command == "USER")
+                    connection.write("331 Password required\r\n");
+                else if (command == "PASS")
+                    connection.write("230 Logged in\r\n");
+                else if (command == "PASV")
+                {
+                    uint16_t dataPort = _dataServer.getPort();
+                    connection.write(
+                        "227 Entering Passive Mode (127,0,0,1," + std::to_string(dataPort >> 8)
+                        + "," + std::to_string(dataPort & 0xFF) + ")\r\n");
+                }
+                else if (command == "TYPE")
+                    connection.write("200 Type set\r\n");
+                else if (command == "SIZE")
+                {
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    auto fileIter = _files.find(arg);
+                    connection.write((fileIter == _files.end())
+                        ? std::string("550 No such file\r\n")
+                        : "213 " + std::to_string(fileIter->second.size()) + "\r\n");
+                }
+                else if (command == "REST")
+                {
+                    restOffset = std::stoul(arg);
+                    connection.write("350 Restarting at " + arg + "\r\n");
+                }
+                else if ((command == "APPE") || (command == "STOR"))
+                {
+                    int transfers = _transfers;
+                    FTPFault fault = takeFault();
+                    {
+                        std::lock_guard<std::mutex> lock(_mutex);
+                        _transferFault = fault;
+                        _transferFile = arg;
+                        _isAppend = (command == "APPE");
+                        _transferOffset = restOffset;
+                        if (!_isAppend && (restOffset == 0)) _files[arg].clear();
+                    }
+                    restOffset = 0;
+                    connection.write("150 Ok to send data\r\n");
+                    for (int waitedMs = 0; (_transfers == transfers) && (waitedMs < _timeoutMs); waitedMs += 10)
+                        delay(10);
+                    switch (fault)
+                    {
+                        case FTPFault::None:
+                            connection.write("226 Transfer complete\r\n");
+                            break;
+                        case FTPFault::Abort:
+                            connection.write("451 Transfer aborted\r\n");
+                            break;
+                        case FTPFault::Partial:
+                            connection.write("426 Connection closed; transfer aborted\r\n");
+                            break;
+                        case FTPFault::Disconnect:
+                            return;
+                    }
+                }
+                else if (command == "QUIT")
+                {
+                    connection.write("221 Goodbye\r\n");
+                    return;
+                }
+                else
+                    connection.write("502 Not implemented\r\n");
+            }
+        }
+
+        void handleData(StandInConnection& connection)
+        {
+            std::string data;
+            char c;
+            while (connection.read(&c, 1, _timeoutMs))
+                data += c;
+
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _data += data;
+                if (_transferFault == FTPFault::Partial) data.resize(data.size() / 2);
+                std::string& file = _files[_transferFile];
+                size_t offset = _isAppend ? file.size() : _transferOffset;
+                if (file.size() < offset + data.size()) file.resize(offset + data.size());
+                file.replace(offset, data.size(), data);
+            }
+            _transfers++;
+        }
+};
+
+#endif
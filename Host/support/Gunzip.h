@@ -0,0 +1,33 @@
+#ifndef HOST_GUNZIP_H
+#define HOST_GUNZIP_H
+
+// Reference gzip decoder (zlib) to check the output of GzipPrint; link with ZLIB::ZLIB.
+
+#include <zlib.h>
+#include <string>
+
+// Decompresses all (concatenated) gzip members; returns false if the data is invalid.
+inline bool gunzip(const std::string& compressed, std::string& result)
+{
+    z_stream stream = {};
+    if (inflateInit2(&stream, 16 + MAX_WBITS) != Z_OK) return false;
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(compressed.data()));
+    stream.avail_in = compressed.size();
+
+    result.clear();
+    int status = Z_OK;
+    while (status == Z_OK)
+    {
+        char buffer[1024];
+        stream.next_out = reinterpret_cast<Bytef*>(buffer);
+        stream.avail_out = sizeof(buffer);
+        status = inflate(&stream, Z_NO_FLUSH);
+        result.append(buffer, sizeof(buffer) - stream.avail_out);
+        if ((status == Z_STREAM_END) && (stream.avail_in > 0))
+            status = inflateReset(&stream); // Next member
+    }
+    inflateEnd(&stream);
+    return (status == Z_STREAM_END) && (stream.avail_in == 0);
+}
+
+#endif
@@ -0,0 +1,200 @@
+#ifndef HOST_HTTPS_STAND_IN_H
+#define HOST_HTTPS_STAND_IN_H
+
+// HTTPS (HTTP/1.1 over TLS) server standing in for a cloud API in tests.
+// It uses a self-signed certificate for 127.0.0.1 generated at startup, keeps connections alive
+// and counts the TLS handshakes and requests.
+
+#include <StandInServer.h>
+#include <openssl/err.h>
+#include <openssl/pem.h>
+#include <openssl/ssl.h>
+#include <openssl/x509v3.h>
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class HTTPSStandIn
+{
+    public:
+        HTTPSStandIn(int timeoutMs = 2000)
+            : _timeoutMs(timeoutMs),
+              _contextPtr(createContext(_certificate)),
+              _server([this](StandInConnection& connection) { handleConnection(connection); })
+        {}
+
+        ~HTTPSStandIn()
+        {
+            _isStopping = true;
+            _server.stop();
+            SSL_CTX_free(_contextPtr);
+        }
+
+        uint16_t getPort() const { return _server.getPort(); }
+        int getConnectionCount() const { return _server.getConnectionCount(); }
+        int getHandshakeCount() const { return _handshakeCount; }
+        int getRequestCount() const { return _requestCount; }
+
+        // The self-signed server certificate (PEM), to pass as root certificate.
+        const char* getCertificate() const { return _certificate.c_str(); }
+
+        void setResponse(int statusCode, const std::string& body)
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _statusCode = statusCode;
+            _body = body;
+        }
+
+        // The server closes a kept-alive connection after the given number of requests (0 = never).
+        void setMaxRequestsPerConnection(int maxRequests) { _maxRequestsPerConnection = maxRequests; }
+
+        // Request lines received ("GET /path")
+        std::vector<std::string> getRequests()
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            return _requests;
+        }
+
+    private:
+        int _timeoutMs;
+        std::string _certificate;
+        SSL_CTX* _contextPtr;
+        std::mutex _mutex;
+        int _statusCode = 200;
+        std::string _body = "{}";
+        std::vector<std::string> _requests;
+        std::atomic<int> _maxRequestsPerConnection { 0 };
+        std::atomic<int> _handshakeCount { 0 };
+        std::atomic<int> _requestCount { 0 };
+        std::atomic<bool> _isStopping { false };
+        StandInServer _server; // Last, so the state above exists before connections are handled
+
+        static SSL_CTX* createContext(std::string& certificatePem)
+        {
+            EVP_PKEY* keyPtr = EVP_EC_gen("P-256");
+            X509* certificatePtr = X509_new();
+            X509_set_version(certificatePtr, 2);
+            ASN1_INTEGER_set(X509_get_serialNumber(certificatePtr), 1);
+            X509_gmtime_adj(X509_getm_notBefore(certificatePtr), -3600);
+            X509_gmtime_adj(X509_getm_notAfter(certificatePtr), 24 * 3600);
+            X509_set_pubkey(certificatePtr, keyPtr);
+            X509_NAME* namePtr = X509_get_subject_name(certificatePtr);
+            X509_NAME_add_entry_by_txt(namePtr, "CN", MBSTRING_ASC, reinterpret_cast<const uint8_t*>("127.0.0.1"), -1, -1, 0);
+            X509_set_issuer_name(certificatePtr, namePtr);
+            X509V3_CTX extensionContext;
+            X509V3_set_ctx_nodb(&extensionContext);
+            X509V3_set_ctx(&extensionContext, certificatePtr, certificatePtr, nullptr, nullptr, 0);
+            X509_EXTENSION* extensionPtr = X509V3_EXT_conf_nid(
+                nullptr, &extensionContext, NID_subject_alt_name, "IP:127.0.0.1,DNS:localhost");
+            X509_add_ext(certificatePtr, extensionPtr, -1);
+            X509_EXTENSION_free(extensionPtr);
+            X509_sign(certificatePtr, keyPtr, EVP_sha256());
+
+            BIO* bioPtr = BIO_new(BIO_s_mem());
+            PEM_write_bio_X509(bioPtr, certificatePtr);
+            char* pemPtr;
+            long pemSize = BIO_get_mem_data(bioPtr, &pemPtr);
+            certificatePem.assign(pemPtr, pemSize);
+            BIO_free(bioPtr);
+
+            SSL_CTX* contextPtr = SSL_CTX_new(TLS_server_method());
+            SSL_CTX_use_certificate(contextPtr, certificatePtr);
+            SSL_CTX_use_PrivateKey(contextPtr, keyPtr);
+            X509_free(certificatePtr);
+            EVP_PKEY_free(keyPtr);
+            return contextPtr;
+        }
+
+        // Waits for data, polling so the server can be stopped while a kept-alive connection is idle.
+        bool awaitReadable(SSL* sslPtr, int socket, int timeoutMs)
+        {
+            for (int elapsedMs = 0; elapsedMs < timeoutMs; elapsedMs += 20)
+            {
+                if (_isStopping) return false;
+                if (SSL_pending(sslPtr) > 0) return true;
+                pollfd pfd = { socket, POLLIN, 0 };
+                if (poll(&pfd, 1, 20) == 1) return true;
+            }
+            return false;
+        }
+
+        bool readLine(SSL* sslPtr, int socket, std::string& line, int timeoutMs)
+        {
+            line.clear();
+            char c;
+            while (awaitReadable(sslPtr, socket, timeoutMs))
+            {
+                int result = SSL_read(sslPtr, &c, 1);
+                if (result <= 0)
+                {
+                    if (SSL_get_error(sslPtr, result) == SSL_ERROR_WANT_READ) continue;
+                    return false;
+                }
+                if (c == '\n')
+                {
+                    if (!line.empty() && (line.back() == '\r')) line.pop_back();
+                    return true;
+                }
+                line += c;
+            }
+            return false;
+        }
+
+        void handleConnection(StandInConnection& connection)
+        {
+            SSL* sslPtr = SSL_new(_contextPtr);
+            SSL_set_fd(sslPtr, connection.getSocket());
+            if (SSL_accept(sslPtr) == 1)
+            {
+                _handshakeCount++;
+                handleRequests(sslPtr, connection.getSocket());
+                SSL_shutdown(sslPtr);
+            }
+            SSL_free(sslPtr);
+            ERR_clear_error();
+        }
+
+        void handleRequests(SSL* sslPtr, int socket)
+        {
+            std::string requestLine;
+            int requestCount = 0;
+            while (readLine(sslPtr, socket, requestLine, _timeoutMs * 10))
+            {
+                size_t contentLength = 0;
+                std::string line;
+                while (readLine(sslPtr, socket, line, _timeoutMs) && !line.empty())
+                {
+                    if (strncasecmp(line.c_str(), "Content-Length:", 15) == 0)
+                        contentLength = std::stoul(line.substr(15));
+                }
+                std::string body(contentLength, 0);
+                for (size_t received = 0; received < contentLength; )
+                {
+                    if (!awaitReadable(sslPtr, socket, _timeoutMs)) return;
+                    int result = SSL_read(sslPtr, &body[received], contentLength - received);
+                    if (result <= 0) return;
+                    received += result;
+                }
+
+                requestCount++;
+                _requestCount++;
+                int maxRequests = _maxRequestsPerConnection;
+                bool isClosing = (maxRequests != 0) && (requestCount >= maxRequests);
+                std::string response;
+                {
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    _requests.push_back(requestLine.substr(0, requestLine.rfind(' ')));
+                    response = "HTTP/1.1 " + std::to_string(_statusCode) + " Stand-in\r\n"
+                        "Content-Type: application/json\r\n"
+                        "Content-Length: " + std::to_string(_body.size()) + "\r\n"
+                        + (isClosing ? "Connection: close\r\n" : "Connection: keep-alive\r\n")
+                        + "\r\n" + _body;
+                }
+                if (SSL_write(sslPtr, response.data(), response.size()) != int(response.size())) return;
+                if (isClosing) return;
+            }
+        }
+};
+
+#endif
@@ -0,0 +1,145 @@
+#ifndef HOST_INFLUX_STAND_IN_H
+#define HOST_INFLUX_STAND_IN_H
+
+// HTTP server standing in for the InfluxDB write endpoint in tests and benchmarks.
+// It keeps connections alive, decompresses gzip request bodies (zlib) and keeps the lines it accepted.
+// Like InfluxDB it responds 204 to a successful write and 400 to a body it can't decode.
+
+#include <StandInServer.h>
+#include <Gunzip.h>
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <strings.h>
+#include <vector>
+
+class InfluxStandIn
+{
+    public:
+        InfluxStandIn(int timeoutMs = 2000)
+            : _timeoutMs(timeoutMs),
+              _server([this](StandInConnection& connection) { handleRequests(connection); })
+        {}
+
+        ~InfluxStandIn()
+        {
+            _isStopping = true;
+            _server.stop();
+        }
+
+        uint16_t getPort() const { return _server.getPort(); }
+        int getConnectionCount() const { return _server.getConnectionCount(); }
+        int getRequestCount() const { return _requestCount; }
+        size_t getReceivedBytes() const { return _receivedBytes; } // Request bodies, as sent
+
+        std::string getWriteUrl() const
+        {
+            return "http://127.0.0.1:" + std::to_string(getPort()) + "/api/v2/write?org=home&bucket=test";
+        }
+
+        // Responds with the given status to the next requests (count < 0: all requests).
+        void setResponse(int statusCode, int count = -1)
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _statusCode = statusCode;
+            _statusCount = count;
+        }
+
+        // Request lines received ("POST /api/v2/write?...")
+        std::vector<std::string> getRequests()
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            return _requests;
+        }
+
+        // Decompressed lines of the accepted writes
+        std::string getLines()
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            return _lines;
+        }
+
+        std::string getLastAuthorization()
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            return _authorization;
+        }
+
+    private:
+        int _timeoutMs;
+        std::mutex _mutex;
+        int _statusCode = 204;
+        int _statusCount = -1;
+        std::vector<std::string> _requests;
+        std::string _lines;
+        std::string _authorization;
+        std::atomic<int> _requestCount { 0 };
+        std::atomic<size_t> _receivedBytes { 0 };
+        std::atomic<bool> _isStopping { false };
+        StandInServer _server; // Last, so the state above exists before connections are handled
+
+        // Waits for the next request, polling so the server can be stopped while a kept-alive connection is idle.
+        bool awaitRequest(StandInConnection& connection)
+        {
+            for (int elapsedMs = 0; elapsedMs < _timeoutMs * 10; elapsedMs += 20)
+            {
+                if (_isStopping) return false;
+                pollfd pfd = { connection.getSocket(), POLLIN, 0 };
+                if (poll(&pfd, 1, 20) == 1) return true;
+            }
+            return false;
+        }
+
+        void handleRequests(StandInConnection& connection)
+        {
+            std::string requestLine;
+            while (awaitRequest(connection) && connection.readLine(requestLine, _timeoutMs))
+            {
+                size_t contentLength = 0;
+                bool isGzip = false;
+                bool isClosing = false;
+                std::string authorization;
+                std::string line;
+                while (connection.readLine(line, _timeoutMs) && !line.empty())
+                {
+                    if (strncasecmp(line.c_str(), "Content-Length:", 15) == 0)
+                        contentLength = std::stoul(line.substr(15));
+                    else if (strncasecmp(line.c_str(), "Content-Encoding: gzip", 22) == 0)
+                        isGzip = true;
+                    else if (strncasecmp(line.c_str(), "Connection: close", 17) == 0)
+                        isClosing = true;
+                    else if (strncasecmp(line.c_str(), "Authorization: ", 15) == 0)
+                        authorization = line.substr(15);
+                }
+                std::string body(contentLength, 0);
+                if ((contentLength != 0) && !connection.read(&body[0], contentLength, _timeoutMs)) return;
+                _receivedBytes += contentLength;
+                _requestCount++;
+
+                std::string lines = body;
+                int statusCode;
+                {
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    _requests.push_back(requestLine.substr(0, requestLine.rfind(' ')));
+                    _authorization = authorization;
+                    statusCode = _statusCode;
+                    if ((_statusCount > 0) && (--_statusCount == 0))
+                        _statusCode = 204;
+                    if (isGzip && !gunzip(body, lines))
+                        statusCode = 400;
+                    if ((statusCode >= 200) && (statusCode < 300))
+                        _lines += lines;
+                }
+
+                std::string responseBody = (statusCode == 204) ? "" : "{\"code\":\"stand-in\"}";
+                std::string response = "HTTP/1.1 " + std::to_string(statusCode) + " Stand-in\r\n"
+                    "Content-Type: application/json\r\n"
+                    "Content-Length: " + std::to_string(responseBody.size()) + "\r\n"
+                    + (isClosing ? "Connection: close\r\n" : "Connection: keep-alive\r\n")
+                    + "\r\n" + responseBody;
+                if (!connection.write(response) || isClosing) return;
+            }
+        }
+};
+
+#endif
@@ -0,0 +1,180 @@
+#ifndef HOST_MQTT_STAND_IN_H
+#define HOST_MQTT_STAND_IN_H
+
+// MQTT (3.1.1) broker for a single publishing client, standing in for the real broker in tests.
+// It logs the received PUBLISH packets, keeps the retained values and measures the message rate.
+
+#include <Arduino.h>
+#include <StandInServer.h>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+struct MQTTStandInMessage
+{
+    std::string topic;
+    std::string payload;
+    uint8_t qos;
+    bool retain;
+    bool isDuplicate;
+};
+
+
+class MQTTStandIn
+{
+    public:
+        MQTTStandIn(int timeoutMs = 2000)
+            : _timeoutMs(timeoutMs),
+              _server([this](StandInConnection& connection) { handleConnection(connection); })
+        {}
+
+        uint16_t getPort() const { return _server.getPort(); }
+        int getConnectionCount() const { return _server.getConnectionCount(); }
+
+        // Closes the connection (without PUBACK) when the next QoS 1 message for the topic arrives.
+        void dropConnectionOn(const std::string& topic)
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _dropTopic = topic;
+        }
+
+        std::string getClientId()
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            return _clientId;
+        }
+
+        std::vector<MQTTStandInMessage> getMessages()
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            return _messages;
+        }
+
+        size_t getMessageCount()
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            return _messages.size();
+        }
+
+        // Last retained payload for the topic; empty if none.
+        std::string getRetained(const std::string& topic)
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            auto loc = _retained.find(topic);
+            return (loc == _retained.end()) ? std::string() : loc->second;
+        }
+
+        // Rate between the first and the last received message.
+        float getMessagesPerSecond()
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            uint32_t durationMs = _lastMessageMillis - _firstMessageMillis;
+            return (durationMs == 0) ? 0 : 1000.0F * (_messages.size() - 1) / durationMs;
+        }
+
+    private:
+        int _timeoutMs;
+        std::mutex _mutex;
+        std::string _clientId;
+        std::string _dropTopic;
+        std::vector<MQTTStandInMessage> _messages;
+        std::map<std::string, std::string> _retained;
+        uint32_t _firstMessageMillis = 0;
+        uint32_t _lastMessageMillis = 0;
+        StandInServer _server; // Last, so the state above exists before connections are handled
+
+        static std::string readString(const std::string& data, size_t& pos)
+        {
+            if (pos + 2 > data.size()) return std::string();
+            size_t length = (uint8_t(data[pos]) << 8) | uint8_t(data[pos + 1]);
+            std::string result = data.substr(pos + 2, length);
+            pos += 2 + length;
+            return result;
+        }
+
+        bool readPacket(StandInConnection& connection, uint8_t& header, std::string& data)
+        {
+            if (!connection.read(&header, 1, _timeoutMs * 2)) return false;
+            size_t remainingLength = 0;
+            int shift = 0;
+            uint8_t encodedByte;
+            do
+            {
+                if (!connection.read(&encodedByte, 1, _timeoutMs)) return false;
+                remainingLength |= size_t(encodedByte & 0x7F) << shift;
+                shift += 7;
+            }
+            while ((encodedByte & 0x80) && (shift < 28));
+            data.resize(remainingLength);
+            return (remainingLength == 0) || connection.read(&data[0], remainingLength, _timeoutMs);
+        }
+
+        void handleConnection(StandInConnection& connection)
+        {
+            uint8_t header;
+            std::string data;
+            while (readPacket(connection, header, data))
+            {
+                switch (header & 0xF0)
+                {
+                    case 0x10: // CONNECT
+                    {
+                        size_t pos = 10; // Protocol name, level, flags and keep alive
+                        std::lock_guard<std::mutex> lock(_mutex);
+                        _clientId = readString(data, pos);
+                        connection.write(std::string("\x20\x02\x00\x00", 4));
+                        break;
+                    }
+
+                    case 0x30: // PUBLISH
+                        if (!handlePublish(connection, header, data)) return;
+                        break;
+
+                    case 0xC0: // PINGREQ
+                        connection.write(std::string("\xD0\x00", 2));
+                        break;
+
+                    case 0xE0: // DISCONNECT
+                        return;
+                }
+            }
+        }
+
+        bool handlePublish(StandInConnection& connection, uint8_t header, const std::string& data)
+        {
+            MQTTStandInMessage message;
+            message.qos = (header >> 1) & 0x03;
+            message.retain = (header & 0x01) != 0;
+            message.isDuplicate = (header & 0x08) != 0;
+            size_t pos = 0;
+            message.topic = readString(data, pos);
+            std::string packetId;
+            if (message.qos > 0)
+            {
+                packetId = data.substr(pos, 2);
+                pos += 2;
+            }
+            message.payload = data.substr(pos);
+
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                uint32_t currentMillis = millis();
+                if (_messages.empty()) _firstMessageMillis = currentMillis;
+                _lastMessageMillis = currentMillis;
+                _messages.push_back(message);
+                if ((message.qos > 0) && (message.topic == _dropTopic))
+                {
+                    _dropTopic.clear();
+                    return false;
+                }
+                if (message.retain) _retained[message.topic] = message.payload;
+            }
+
+            if (message.qos > 0)
+                connection.write(std::string("\x40\x02", 2) + packetId);
+            return true;
+        }
+};
+
+#endif
@@ -0,0 +1,36 @@
+#ifndef HOST_MEMORY_STREAM_H
+#define HOST_MEMORY_STREAM_H
+
+#include <string>
+#include <Stream.h>
+
+// A Stream reading from a buffer in memory; written data is collected in a string.
+class MemoryStream : public Stream
+{
+    public:
+        MemoryStream(const char* data = "") : _data(data) { setTimeout(0); }
+        MemoryStream(const uint8_t* data, size_t size) : _data(reinterpret_cast<const char*>(data), size) { setTimeout(0); }
+
+        void setData(const std::string& data) { _data = data; _position = 0; }
+        void rewind() { _position = 0; }
+        const std::string& getOutput() const { return _output; }
+        void clearOutput() { _output.clear(); }
+
+        int available() override { return _data.size() - _position; }
+        int read() override { return (_position < _data.size()) ? uint8_t(_data[_position++]) : -1; }
+        int peek() override { return (_position < _data.size()) ? uint8_t(_data[_position]) : -1; }
+        size_t write(uint8_t c) override { _output += char(c); return 1; }
+        size_t write(const uint8_t* buffer, size_t size) override
+        {
+            _output.append(reinterpret_cast<const char*>(buffer), size);
+            return size;
+        }
+        using Print::write;
+
+    private:
+        std::string _data;
+        size_t _position = 0;
+        std::string _output;
+};
+
+#endif
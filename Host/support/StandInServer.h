@@ -0,0 +1,157 @@
+#ifndef HOST_STAND_IN_SERVER_H
+#define HOST_STAND_IN_SERVER_H
+
+// Minimal TCP server on the loopback interface, standing in for a remote server (or broker) in tests.
+// Connections are accepted on a background thread and handled one at a time by the given handler.
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <atomic>
+#include <functional>
+#include <string>
+#include <thread>
+
+class StandInConnection
+{
+    public:
+        explicit StandInConnection(int socket) : _socket(socket) {}
+        ~StandInConnection() { close(); }
+
+        // Reads exactly the given number of bytes.
+        bool read(void* buffer, size_t size, int timeoutMs = 2000)
+        {
+            uint8_t* bytes = static_cast<uint8_t*>(buffer);
+            while (size > 0)
+            {
+                if (!awaitReadable(timeoutMs)) return false;
+                ssize_t received = recv(_socket, bytes, size, 0);
+                if (received <= 0) return false;
+                bytes += received;
+                size -= received;
+            }
+            return true;
+        }
+
+        // Reads a line, without the line ending.
+        bool readLine(std::string& line, int timeoutMs = 2000)
+        {
+            line.clear();
+            char c;
+            while (read(&c, 1, timeoutMs))
+            {
+                if (c == '\n')
+                {
+                    if (!line.empty() && (line.back() == '\r')) line.pop_back();
+                    return true;
+                }
+                line += c;
+            }
+            return false;
+        }
+
+        bool write(const void* data, size_t size)
+        {
+            return send(_socket, data, size, MSG_NOSIGNAL) == static_cast<ssize_t>(size);
+        }
+
+        bool write(const std::string& str) { return write(str.data(), str.size()); }
+
+        // Waits until the client closes the connection (and drains anything it sends before).
+        bool awaitClosed(int timeoutMs = 2000)
+        {
+            uint8_t buffer[256];
+            while (awaitReadable(timeoutMs))
+            {
+                if (recv(_socket, buffer, sizeof(buffer), 0) <= 0) return true;
+            }
+            return false;
+        }
+
+        int getSocket() const { return _socket; }
+
+        void close()
+        {
+            if (_socket < 0) return;
+            ::close(_socket);
+            _socket = -1;
+        }
+
+    private:
+        int _socket;
+
+        bool awaitReadable(int timeoutMs)
+        {
+            pollfd pfd = { _socket, POLLIN, 0 };
+            return poll(&pfd, 1, timeoutMs) == 1;
+        }
+};
+
+
+class StandInServer
+{
+    public:
+        using Handler = std::function<void(StandInConnection& connection)>;
+
+        explicit StandInServer(Handler handler) : _handler(handler)
+        {
+            _socket = socket(AF_INET, SOCK_STREAM, 0);
+            int reuse = 1;
+            setsockopt(_socket, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+            sockaddr_in address = {};
+            address.sin_family = AF_INET;
+            address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            address.sin_port = 0; // Any free port
+            bind(_socket, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+            listen(_socket, 4);
+
+            socklen_t size = sizeof(address);
+            getsockname(_socket, reinterpret_cast<sockaddr*>(&address), &size);
+            _port = ntohs(address.sin_port);
+
+            _thread = std::thread([this]() { run(); });
+        }
+
+        ~StandInServer() { stop(); }
+
+        uint16_t getPort() const { return _port; }
+        int getConnectionCount() const { return _connectionCount; }
+
+        void stop()
+        {
+            _isStopping = true;
+            if (_thread.joinable()) _thread.join();
+            if (_socket >= 0)
+            {
+                ::close(_socket);
+                _socket = -1;
+            }
+        }
+
+    private:
+        Handler _handler;
+        int _socket = -1;
+        uint16_t _port = 0;
+        std::atomic<bool> _isStopping { false };
+        std::atomic<int> _connectionCount { 0 };
+        std::thread _thread;
+
+        void run()
+        {
+            while (!_isStopping)
+            {
+                pollfd pfd = { _socket, POLLIN, 0 };
+                if (poll(&pfd, 1, 20) != 1) continue;
+                int clientSocket = accept(_socket, nullptr, nullptr);
+                if (clientSocket < 0) continue;
+                _connectionCount++;
+                StandInConnection connection(clientSocket);
+                _handler(connection);
+            }
+        }
+};
+
+#endif
@@ -0,0 +1,4 @@
+#include <Localization.h>
+
+// The projects each define their own translations; the host build has none.
+std::map<const char*, std::vector<const char*>> Localization::translations;
@@ -0,0 +1,91 @@
+#include <gtest/gtest.h>
+#include <AdaptivePoller.h>
+
+
+class AdaptivePollerTest : public testing::Test
+{
+    protected:
+        AdaptivePoller poller { 1000, 8000, 10 };
+        uint32_t currentMillis = 0;
+
+        // Polls when due and records the reading; returns the interval used.
+        uint32_t poll(float value)
+        {
+            currentMillis += poller.getIntervalMs();
+            EXPECT_TRUE(poller.isDue(currentMillis));
+            poller.update(value);
+            return poller.getLastIntervalMs();
+        }
+};
+
+
+TEST_F(AdaptivePollerTest, PollsAtIntervalOnly)
+{
+    EXPECT_TRUE(poller.isDue(0)); // First poll is due immediately
+    EXPECT_FALSE(poller.isDue(999));
+    EXPECT_TRUE(poller.isDue(1000));
+    EXPECT_EQ(1000U, poller.getLastIntervalMs());
+    EXPECT_EQ(2U, poller.getStats().polls);
+}
+
+
+TEST_F(AdaptivePollerTest, SlowsDownWhileStable)
+{
+    poller.isDue(0);
+    poller.update(100);
+    for (int i = 0; i < 20; i++) poll(100 + (i % 2) * 5);
+
+    // +25% per stable reading: 1000, 1250, 1562, 1952, 2440, ... up to the maximum
+    EXPECT_EQ(8000U, poller.getIntervalMs());
+    EXPECT_EQ(0U, poller.getStats().speedUps);
+    EXPECT_GE(poller.getStats().slowDowns, 9U);
+}
+
+
+TEST_F(AdaptivePollerTest, SpeedsUpOnChange)
+{
+    poller.isDue(0);
+    poller.update(100);
+    for (int i = 0; i < 20; i++) poll(100);
+    ASSERT_EQ(8000U, poller.getIntervalMs());
+
+    poll(200);
+    EXPECT_EQ(4000U, poller.getIntervalMs());
+    poll(300);
+    poll(400);
+    poll(500);
+    EXPECT_EQ(1000U, poller.getIntervalMs()); // Not below the minimum
+    EXPECT_EQ(3U, poller.getStats().speedUps);
+}
+
+
+TEST_F(AdaptivePollerTest, UsesMinimumIntervalWhileActive)
+{
+    poller.isDue(0);
+    poller.update(100);
+    for (int i = 0; i < 20; i++) poll(100);
+    ASSERT_EQ(8000U, poller.getIntervalMs());
+
+    poller.setActive(true);
+    EXPECT_EQ(1000U, poller.getIntervalMs());
+    EXPECT_EQ(1000U, poll(100));
+    EXPECT_EQ(1000U, poll(100));
+    EXPECT_EQ(2U, poller.getStats().activePolls);
+
+    // The interval kept adapting while active
+    poller.setActive(false);
+    EXPECT_EQ(8000U, poller.getIntervalMs());
+}
+
+
+TEST_F(AdaptivePollerTest, ClampsIntervalToNewLimits)
+{
+    poller.isDue(0);
+    poller.update(100);
+    for (int i = 0; i < 20; i++) poll(100);
+
+    poller.setLimits(500, 2000);
+    EXPECT_EQ(2000U, poller.getIntervalMs());
+    poller.setLimits(3000, 6000);
+    EXPECT_EQ(3000U, poller.getIntervalMs());
+}
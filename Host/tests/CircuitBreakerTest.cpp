@@ -0,0 +1,132 @@
+#include <gtest/gtest.h>
+#include <Arduino.h>
+#include <CircuitBreaker.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+
+class CircuitBreakerTest : public testing::Test
+{
+    protected:
+        CircuitBreaker breaker { 3, 1000, 8000 };
+
+        void trip(uint32_t currentMillis)
+        {
+            for (int i = 0; i < 3; i++)
+            {
+                ASSERT_TRUE(breaker.allowRequest(currentMillis));
+                breaker.recordFailure(currentMillis);
+            }
+        }
+
+        // The retry delay is the backoff with +/- 25% jitter
+        void expectRetryAfter(uint32_t currentMillis, uint32_t backoffMs)
+        {
+            EXPECT_EQ(backoffMs, breaker.getBackoffMs());
+            EXPECT_GE(breaker.getRetryMillis() - currentMillis, backoffMs * 3 / 4);
+            EXPECT_LE(breaker.getRetryMillis() - currentMillis, backoffMs * 5 / 4);
+        }
+};
+
+
+TEST_F(CircuitBreakerTest, OpensAfterConsecutiveFailures)
+{
+    breaker.recordFailure(0);
+    breaker.recordFailure(0);
+    breaker.recordSuccess(); // Resets the count
+    breaker.recordFailure(0);
+    breaker.recordFailure(0);
+    EXPECT_EQ(CircuitState::Closed, breaker.getState());
+
+    breaker.recordFailure(100);
+    EXPECT_EQ(CircuitState::Open, breaker.getState());
+    expectRetryAfter(100, 1000);
+    EXPECT_FALSE(breaker.allowRequest(200));
+    EXPECT_EQ(1U, breaker.getStats().rejected);
+    EXPECT_EQ(1U, breaker.getStats().trips);
+    EXPECT_EQ(5U, breaker.getStats().failures);
+}
+
+
+TEST_F(CircuitBreakerTest, ProbesOnceWhenHalfOpen)
+{
+    trip(0);
+    uint32_t retryMillis = breaker.getRetryMillis();
+
+    EXPECT_FALSE(breaker.allowRequest(retryMillis - 1));
+    EXPECT_TRUE(breaker.allowRequest(retryMillis));
+    EXPECT_EQ(CircuitState::HalfOpen, breaker.getState());
+    EXPECT_FALSE(breaker.allowRequest(retryMillis)); // Probe in progress
+
+    breaker.recordSuccess();
+    EXPECT_EQ(CircuitState::Closed, breaker.getState());
+    EXPECT_TRUE(breaker.allowRequest(retryMillis));
+    EXPECT_EQ(0U, breaker.getBackoffMs());
+}
+
+
+TEST_F(CircuitBreakerTest, DoublesBackoffIfProbeFails)
+{
+    trip(0);
+    uint32_t expectedBackoffMs = 1000;
+    for (int i = 0; i < 5; i++)
+    {
+        uint32_t retryMillis = breaker.getRetryMillis();
+        ASSERT_TRUE(breaker.allowRequest(retryMillis));
+        breaker.recordFailure(retryMillis);
+        expectedBackoffMs = std::min(expectedBackoffMs * 2, 8000U);
+
+        EXPECT_EQ(CircuitState::Open, breaker.getState());
+        expectRetryAfter(retryMillis, expectedBackoffMs);
+    }
+    EXPECT_EQ(1U, breaker.getStats().trips);
+}
+
+
+TEST_F(CircuitBreakerTest, ProbesAgainIfProbeResultGetsLost)
+{
+    trip(0);
+    uint32_t retryMillis = breaker.getRetryMillis();
+    ASSERT_TRUE(breaker.allowRequest(retryMillis));
+
+    EXPECT_FALSE(breaker.allowRequest(retryMillis + 999));
+    EXPECT_TRUE(breaker.allowRequest(retryMillis + 1000));
+}
+
+
+TEST_F(CircuitBreakerTest, ResetCloses)
+{
+    trip(0);
+    breaker.reset();
+    EXPECT_EQ(CircuitState::Closed, breaker.getState());
+    EXPECT_TRUE(breaker.allowRequest(1));
+}
+
+
+TEST_F(CircuitBreakerTest, AllowsSingleProbeAcrossTasks)
+{
+    // Like RESTClient's background task and the loop sharing a breaker
+    for (int round = 0; round < 100; round++)
+    {
+        breaker.reset();
+        trip(0);
+        uint32_t retryMillis = breaker.getRetryMillis();
+
+        std::atomic<int> probes { 0 };
+        std::vector<std::thread> tasks;
+        for (int i = 0; i < 4; i++)
+        {
+            tasks.emplace_back([&]()
+            {
+                for (int j = 0; j < 100; j++)
+                {
+                    if (breaker.allowRequest(retryMillis)) probes++;
+                }
+            });
+        }
+        for (std::thread& task : tasks) task.join();
+
+        ASSERT_EQ(1, probes.load()) << "Round " << round;
+    }
+}
@@ -0,0 +1,138 @@
+#include <gtest/gtest.h>
+#include <Arduino.h>
+#include <GzipPrint.h>
+#include <Gunzip.h>
+#include <string>
+
+
+class StringPrint : public Print
+{
+    public:
+        std::string data;
+        size_t maxSize = SIZE_MAX; // Writes beyond this fail, like a lost connection
+
+        size_t write(uint8_t c) override { return write(&c, 1); }
+        size_t write(const uint8_t* buffer, size_t size) override
+        {
+            if (data.size() + size > maxSize) return 0;
+            data.append(reinterpret_cast<const char*>(buffer), size);
+            return size;
+        }
+};
+
+
+static std::string compress(const std::string& data, size_t writeSize = SIZE_MAX)
+{
+    StringPrint output;
+    GzipPrint gzip(output);
+    for (size_t i = 0; i < data.size(); i += writeSize)
+    {
+        size_t size = std::min(writeSize, data.size() - i);
+        EXPECT_EQ(size, gzip.write(reinterpret_cast<const uint8_t*>(data.data() + i), size));
+    }
+    EXPECT_TRUE(gzip.finish());
+    EXPECT_EQ(data.size(), gzip.getInputSize());
+    EXPECT_EQ(output.data.size(), gzip.getOutputSize());
+    return output.data;
+}
+
+
+static std::string createCsv(int rows)
+{
+    std::string csv;
+    char line[64];
+    for (int i = 0; i < rows; i++)
+    {
+        snprintf(line, sizeof(line), "2024-01-%02d %02d:%02d;%d;%0.1f;%0.1f\r\n", 1 + i / 1440, (i / 60) % 24, i % 60, i % 7, 20 + (i % 13) * 0.1, 45.5);
+        csv += line;
+    }
+    return csv;
+}
+
+
+TEST(GzipPrintTest, RoundTripsCsv)
+{
+    std::string csv = createCsv(2000); // Much larger than the window, so it slides
+    std::string compressed = compress(csv);
+
+    std::string decompressed;
+    ASSERT_TRUE(gunzip(compressed, decompressed));
+    EXPECT_EQ(csv, decompressed);
+    EXPECT_LT(compressed.size(), csv.size() / 3);
+}
+
+
+TEST(GzipPrintTest, RoundTripsSmallWrites)
+{
+    std::string csv = createCsv(300);
+    std::string decompressed;
+    ASSERT_TRUE(gunzip(compress(csv, 1), decompressed));
+    EXPECT_EQ(csv, decompressed);
+    ASSERT_TRUE(gunzip(compress(csv, 37), decompressed));
+    EXPECT_EQ(csv, decompressed);
+}
+
+
+TEST(GzipPrintTest, RoundTripsIncompressibleAndLongRuns)
+{
+    std::string data;
+    uint32_t seed = 12345;
+    for (int i = 0; i < 5000; i++)
+    {
+        seed = seed * 1103515245 + 12345;
+        data += char(seed >> 24);
+    }
+    data += std::string(10000, 'x'); // Matches of maximum length
+    data += "x";
+
+    std::string decompressed;
+    ASSERT_TRUE(gunzip(compress(data), decompressed));
+    EXPECT_EQ(data, decompressed);
+}
+
+
+TEST(GzipPrintTest, RoundTripsEmptyInput)
+{
+    std::string decompressed = "x";
+    ASSERT_TRUE(gunzip(compress(""), decompressed));
+    EXPECT_EQ("", decompressed);
+}
+
+
+TEST(GzipPrintTest, ConcatenatedMembersDecompressAsOne)
+{
+    // Like appending a sync to an existing .gz file
+    std::string first = createCsv(100);
+    std::string second = createCsv(50);
+
+    std::string decompressed;
+    ASSERT_TRUE(gunzip(compress(first) + compress(second), decompressed));
+    EXPECT_EQ(first + second, decompressed);
+}
+
+
+TEST(GzipPrintTest, FinishFailsIfOutputFails)
+{
+    StringPrint output;
+    output.maxSize = 100;
+    GzipPrint gzip(output);
+    gzip.print(createCsv(500).c_str());
+
+    EXPECT_FALSE(gzip.finish());
+    EXPECT_FALSE(gzip.finish());
+    EXPECT_EQ(0U, gzip.write('x'));
+}
+
+
+TEST(GzipPrintTest, ReportsOutOfMemory)
+{
+    StringPrint output;
+    Host::setAllocationLimit(GZIP_BUFFER_SIZE - 1);
+    GzipPrint gzip(output);
+    Host::setAllocationLimit(SIZE_MAX);
+
+    EXPECT_EQ(0U, gzip.write('x'));
+    EXPECT_FALSE(gzip.finish());
+    EXPECT_TRUE(gzip.isOutOfMemory());
+    EXPECT_EQ("", output.data);
+}
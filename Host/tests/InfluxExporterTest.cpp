@@ -0,0 +1,192 @@
+#include <gtest/gtest.h>
+#include <Arduino.h>
+#include <InfluxExporter.h>
+#include <InfluxStandIn.h>
+#include <Log.h>
+#include <string>
+
+constexpr uint16_t LOG_SIZE = 500;
+constexpr uint16_t FLUSH_INTERVAL = 60;
+constexpr time_t START_TIME = 1700000000;
+
+
+static int hash(uint32_t value)
+{
+    value *= 2654435761U;
+    value ^= value >> 15;
+    value *= 2246822519U;
+    return int(value >> 1);
+}
+
+
+// Exports a log of readings to the stand-in like the projects do.
+class InfluxExporterTest : public testing::Test
+{
+    protected:
+        StaticLog<int> log { LOG_SIZE, MemoryType::Internal };
+        SyncCursor cursor { LOG_SIZE };
+        InfluxExporter exporter { 500, FLUSH_INTERVAL };
+        InfluxStandIn server { 500 };
+        int fieldCount = 1;
+        int nextEntry = 0;
+
+        void SetUp() override
+        {
+            Host::setResetReason(ESP_RST_POWERON);
+            ASSERT_TRUE(exporter.begin(server.getWriteUrl().c_str(), "secret", "test"));
+            exporter.addSource(
+                cursor,
+                [this](InfluxLineWriter& output, uint16_t unsentEntries, uint16_t maxEntries)
+                {
+                    uint16_t entries = 0;
+                    for (auto i = log.at(-unsentEntries); (i != log.end()) && (entries < maxEntries); ++i, ++entries)
+                    {
+                        output.beginLine("p1");
+                        for (int field = 0; field < fieldCount; field++)
+                        {
+                            // Extra fields are hashed, so they compress badly
+                            std::string key = "f" + std::to_string(field);
+                            output.addField(key.c_str(), (field == 0) ? *i : hash(*i * 64 + field));
+                        }
+                        output.endLine(START_TIME + *i);
+                    }
+                    return entries;
+                });
+        }
+
+        void TearDown() override
+        {
+            Host::setAllocationLimit(SIZE_MAX);
+        }
+
+        void addEntries(int count)
+        {
+            for (int i = 0; i < count; i++)
+            {
+                log.add(nextEntry++);
+                cursor.add();
+            }
+        }
+
+        static std::string getLines(int first, int count)
+        {
+            std::string result;
+            for (int i = first; i < first + count; i++)
+                result += "p1,host=test f0=" + std::to_string(i) + "i " + std::to_string(START_TIME + i) + "\n";
+            return result;
+        }
+};
+
+
+TEST_F(InfluxExporterTest, SendsCompressedBatches)
+{
+    addEntries(30);
+
+    // The initial batch size is 20; a full batch sent quickly doubles it.
+    EXPECT_TRUE(exporter.run(START_TIME)) << exporter.getLastError().c_str();
+    EXPECT_EQ(40, exporter.getBatchSize());
+    EXPECT_TRUE(exporter.run(START_TIME));
+    EXPECT_FALSE(exporter.run(START_TIME)); // All sent
+
+    EXPECT_EQ(getLines(0, 30), server.getLines());
+    EXPECT_EQ(0, cursor.getLag());
+    ASSERT_EQ(2U, server.getRequests().size());
+    EXPECT_EQ("POST /api/v2/write?org=home&bucket=test&precision=s", server.getRequests()[0]);
+    EXPECT_EQ("Token secret", server.getLastAuthorization());
+    EXPECT_EQ(1, server.getConnectionCount()); // Kept alive
+
+    const InfluxExporterStats& stats = exporter.getStats();
+    EXPECT_EQ(2U, stats.batches);
+    EXPECT_EQ(30U, stats.lines);
+    EXPECT_EQ(getLines(0, 30).size(), stats.bytes);
+    EXPECT_EQ(server.getReceivedBytes(), stats.compressedBytes);
+    EXPECT_LT(stats.getCompressionRatio(), 0.5F);
+}
+
+
+TEST_F(InfluxExporterTest, WaitsForFullBatchUntilFlushInterval)
+{
+    addEntries(5);
+    EXPECT_TRUE(exporter.run(START_TIME)); // First run flushes
+    EXPECT_FALSE(exporter.run(START_TIME)); // Marks the flush done
+
+    addEntries(5);
+    EXPECT_FALSE(exporter.run(START_TIME + FLUSH_INTERVAL - 1));
+    EXPECT_EQ(1, server.getRequestCount());
+
+    EXPECT_TRUE(exporter.run(START_TIME + FLUSH_INTERVAL));
+    EXPECT_EQ(getLines(0, 10), server.getLines());
+}
+
+
+TEST_F(InfluxExporterTest, ResendsAfterServerError)
+{
+    addEntries(10);
+    server.setResponse(503, 1);
+    EXPECT_FALSE(exporter.run(START_TIME));
+    EXPECT_EQ(10, cursor.getLag());
+    EXPECT_EQ(1U, exporter.getStats().failures);
+    EXPECT_EQ(CircuitState::Closed, exporter.getCircuitBreaker().getState());
+
+    EXPECT_TRUE(exporter.run(START_TIME));
+    EXPECT_EQ(getLines(0, 10), server.getLines()); // No duplicates
+    EXPECT_EQ(0, cursor.getLag());
+}
+
+
+TEST_F(InfluxExporterTest, ShrinksBatchIfPayloadTooLarge)
+{
+    addEntries(10);
+    server.setResponse(413, 1);
+    EXPECT_FALSE(exporter.run(START_TIME));
+    EXPECT_EQ(10, exporter.getBatchSize());
+    EXPECT_EQ(10, cursor.getLag());
+}
+
+
+TEST_F(InfluxExporterTest, DropsRejectedBatch)
+{
+    // Sending data the server refuses again won't help.
+    addEntries(10);
+    server.setResponse(400, 1);
+    EXPECT_FALSE(exporter.run(START_TIME));
+    EXPECT_EQ(0, cursor.getLag());
+    EXPECT_EQ(10U, exporter.getStats().rejectedLines);
+    EXPECT_EQ(0U, exporter.getStats().failures);
+    EXPECT_EQ("", server.getLines());
+}
+
+
+TEST_F(InfluxExporterTest, ShrinksBatchIfBufferOverflows)
+{
+    fieldCount = 30; // ~5 kB compressed per batch of 20 lines, which doesn't fit the buffer
+    addEntries(20);
+
+    EXPECT_FALSE(exporter.run(START_TIME));
+    EXPECT_EQ(10, exporter.getBatchSize());
+    EXPECT_EQ(0, server.getRequestCount());
+    EXPECT_EQ(20, cursor.getLag());
+
+    EXPECT_TRUE(exporter.run(START_TIME)) << exporter.getLastError().c_str();
+    EXPECT_EQ(10U, exporter.getStats().lines);
+    EXPECT_EQ(10, cursor.getLag());
+}
+
+
+TEST_F(InfluxExporterTest, KeepsEntriesIfOutOfMemory)
+{
+    // Unlike an overflow, this says nothing about the batch; it must not be skipped or shrunk.
+    addEntries(10);
+    Host::setAllocationLimit(1000);
+    EXPECT_FALSE(exporter.run(START_TIME));
+    EXPECT_STREQ("Out of memory", exporter.getLastError().c_str());
+    EXPECT_EQ(10, cursor.getLag());
+    EXPECT_EQ(20, exporter.getBatchSize());
+    EXPECT_EQ(0U, exporter.getStats().rejectedLines);
+    EXPECT_EQ(1U, exporter.getStats().failures);
+    EXPECT_EQ(0, server.getRequestCount());
+
+    Host::setAllocationLimit(SIZE_MAX);
+    EXPECT_TRUE(exporter.run(START_TIME));
+    EXPECT_EQ(getLines(0, 10), server.getLines());
+}
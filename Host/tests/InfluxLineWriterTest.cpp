@@ -0,0 +1,97 @@
+#include <gtest/gtest.h>
+#include <Arduino.h>
+#include <InfluxLineWriter.h>
+#include <MemoryStream.h>
+#include <string>
+
+constexpr time_t LINE_TIME = 1700000000;
+
+
+class InfluxLineWriterTest : public testing::Test
+{
+    protected:
+        MemoryStream output;
+        InfluxLineWriter writer { output, "otgw" };
+};
+
+
+TEST_F(InfluxLineWriterTest, WritesTagsAndFields)
+{
+    writer.beginLine("opentherm");
+    writer.addTag("zone", "living");
+    writer.addField("tBoiler", 45.46F);
+    writer.addField("modulation", 30);
+    writer.addField("flame", true);
+    writer.addField("setpoint", 21.0F, 0);
+    writer.endLine(LINE_TIME);
+
+    EXPECT_EQ("opentherm,host=otgw,zone=living tBoiler=45.5,modulation=30i,flame=t,setpoint=21 1700000000\n", output.getOutput());
+    EXPECT_EQ(1, writer.getLines());
+}
+
+
+TEST_F(InfluxLineWriterTest, EscapesSpecialChars)
+{
+    writer.beginLine("zone temp,x");
+    writer.addTag("name", "Living room=1,2");
+    writer.addField("t set", 20.0F);
+    writer.endLine(LINE_TIME);
+
+    EXPECT_EQ("zone\\ temp\\,x,host=otgw,name=Living\\ room\\=1\\,2 t\\ set=20.0 1700000000\n", output.getOutput());
+}
+
+
+TEST_F(InfluxLineWriterTest, OmitsNonFiniteFields)
+{
+    writer.beginLine("heat");
+    writer.addField("tIn", NAN);
+    writer.addField("tOut", 35.0F);
+    writer.addField("power", INFINITY);
+    writer.endLine(LINE_TIME);
+
+    EXPECT_EQ("heat,host=otgw tOut=35.0 1700000000\n", output.getOutput());
+}
+
+
+TEST_F(InfluxLineWriterTest, SkipsLinesWithoutFields)
+{
+    // Line protocol requires a field; a line without would make the server reject the whole batch.
+    writer.beginLine("zone");
+    writer.addTag("zone", "living");
+    writer.addField("temperature", NAN);
+    writer.endLine(LINE_TIME);
+    writer.beginLine("boiler");
+    writer.endLine(LINE_TIME);
+    writer.beginLine("boiler");
+    writer.addField("heatDemand", 12);
+    writer.endLine(LINE_TIME + 1);
+
+    EXPECT_EQ("boiler,host=otgw heatDemand=12i 1700000001\n", output.getOutput());
+    EXPECT_EQ(1, writer.getLines());
+    EXPECT_EQ(2, writer.getSkippedLines());
+}
+
+
+TEST_F(InfluxLineWriterTest, SkipsLinesWithTruncatedTags)
+{
+    std::string longName(INFLUX_LINE_START_SIZE, 'x');
+    writer.beginLine("zone");
+    writer.addTag("zone", longName.c_str());
+    writer.addField("temperature", 20.0F);
+    writer.endLine(LINE_TIME);
+
+    EXPECT_EQ("", output.getOutput());
+    EXPECT_EQ(1, writer.getSkippedLines());
+}
+
+
+TEST(InfluxLineWriterNoHostTest, WritesWithoutHostTag)
+{
+    MemoryStream output;
+    InfluxLineWriter writer(output);
+    writer.beginLine("p1");
+    writer.addField("power", -250);
+    writer.endLine(LINE_TIME);
+
+    EXPECT_EQ("p1 power=-250i 1700000000\n", output.getOutput());
+}
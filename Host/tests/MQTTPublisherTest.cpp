@@ -0,0 +1,152 @@
+#include <gtest/gtest.h>
+#include <Arduino.h>
+#include <MQTTPublisher.h>
+#include <MQTTStandIn.h>
+#include <functional>
+#include <string>
+
+constexpr uint32_t RUN_TIMEOUT_MS = 3000;
+
+
+class MQTTPublisherTest : public testing::Test
+{
+    protected:
+        MQTTStandIn broker;
+        MQTTPublisher publisher { 1000 };
+
+        void begin()
+        {
+            ASSERT_TRUE(publisher.begin("127.0.0.1", broker.getPort(), "", "", "test"));
+        }
+
+        // Runs the publisher like the projects' loop does, until the condition holds.
+        bool runUntil(std::function<bool()> condition)
+        {
+            uint32_t startMillis = millis();
+            while (!condition())
+            {
+                if (millis() - startMillis >= RUN_TIMEOUT_MS) return false;
+                publisher.run();
+                delay(1);
+            }
+            return true;
+        }
+
+        // QoS 0 messages leave the queue once written, so also wait till the broker received them.
+        bool runUntilSent()
+        {
+            return runUntil([this]()
+            {
+                const MQTTPublisherStats& stats = publisher.getStats();
+                return publisher.isConnected() && (publisher.getQueueLength() == 0)
+                    && (broker.getMessageCount() == stats.published + stats.retransmitted);
+            });
+        }
+};
+
+
+TEST_F(MQTTPublisherTest, PublishesDiscoveryAndRetainedValues)
+{
+    int temperatureSensor = publisher.addSensor("T inside", "°C", "temperature", 0.1F, 1);
+    int statusSensor = publisher.addSensor("Status");
+    begin();
+    publisher.setValue(temperatureSensor, 21.46F);
+    publisher.setValue(statusSensor, "Heating \"on\"");
+
+    ASSERT_TRUE(runUntilSent()) << publisher.getLastError().c_str();
+    EXPECT_EQ("test", broker.getClientId());
+    EXPECT_EQ("online", broker.getRetained("test/status"));
+    EXPECT_EQ("21.5", broker.getRetained("test/T_inside"));
+    EXPECT_EQ("Heating \"on\"", broker.getRetained("test/Status"));
+    EXPECT_EQ(
+        "{\"name\":\"T inside\",\"unique_id\":\"test_T_inside\",\"state_topic\":\"test/T_inside\","
+        "\"availability_topic\":\"test/status\",\"unit_of_measurement\":\"°C\","
+        "\"device_class\":\"temperature\",\"state_class\":\"measurement\","
+        "\"device\":{\"identifiers\":[\"test\"],\"name\":\"test\"}}",
+        broker.getRetained("homeassistant/sensor/test/T_inside/config"));
+    EXPECT_EQ(
+        "{\"name\":\"Status\",\"unique_id\":\"test_Status\",\"state_topic\":\"test/Status\","
+        "\"availability_topic\":\"test/status\",\"device\":{\"identifiers\":[\"test\"],\"name\":\"test\"}}",
+        broker.getRetained("homeassistant/sensor/test/Status/config"));
+}
+
+
+TEST_F(MQTTPublisherTest, SuppressesChangesWithinDeadband)
+{
+    int sensor = publisher.addSensor("Pressure", "bar", nullptr, 0.5F, 1);
+    begin();
+    ASSERT_TRUE(runUntilSent());
+
+    for (float value : { 1.0F, 1.3F, 1.6F, 1.2F })
+    {
+        publisher.setValue(sensor, value);
+        ASSERT_TRUE(runUntilSent());
+    }
+
+    std::vector<std::string> payloads;
+    for (const MQTTStandInMessage& message : broker.getMessages())
+    {
+        if (message.topic == "test/Pressure") payloads.push_back(message.payload);
+    }
+    EXPECT_EQ(std::vector<std::string>({ "1.0", "1.6" }), payloads);
+    EXPECT_EQ(2U, publisher.getStats().suppressed);
+}
+
+
+TEST_F(MQTTPublisherTest, ResendsUnacknowledgedAfterReconnect)
+{
+    int sensor = publisher.addSensor("Status");
+    publisher.setQoS(1);
+    begin();
+    ASSERT_TRUE(runUntilSent());
+
+    broker.dropConnectionOn("test/Status");
+    publisher.setValue(sensor, "Charging");
+    ASSERT_TRUE(runUntil([this]() { return broker.getRetained("test/Status") == "Charging"; }))
+        << publisher.getLastError().c_str();
+    ASSERT_TRUE(runUntilSent());
+
+    EXPECT_EQ(2, broker.getConnectionCount());
+    EXPECT_EQ(2U, publisher.getStats().connects);
+    EXPECT_EQ(0U, publisher.getStats().dropped);
+}
+
+
+TEST_F(MQTTPublisherTest, ReportsThroughputAndQueueHighWater)
+{
+    constexpr int SENSORS = 8;
+    constexpr int ROUNDS = 250;
+
+    int sensors[SENSORS];
+    for (int i = 0; i < SENSORS; i++)
+        sensors[i] = publisher.addSensor(("Sensor " + std::to_string(i)).c_str(), nullptr, nullptr, 0, 0);
+    begin();
+    ASSERT_TRUE(runUntilSent());
+    uint32_t publishedBefore = publisher.getStats().published;
+
+    // A burst of changes for all sensors each round; the queue coalesces values which are not sent yet.
+    for (int round = 1; round <= ROUNDS; round++)
+    {
+        for (int i = 0; i < SENSORS; i++)
+            publisher.setValue(sensors[i], float(round));
+        publisher.run();
+    }
+    ASSERT_TRUE(runUntilSent());
+
+    for (int i = 0; i < SENSORS; i++)
+        EXPECT_EQ(std::to_string(ROUNDS), broker.getRetained("test/Sensor_" + std::to_string(i)));
+
+    const MQTTPublisherStats& stats = publisher.getStats();
+    EXPECT_EQ(0U, stats.dropped);
+    EXPECT_LE(stats.queueHighWater, MQTT_QUEUE_SIZE);
+    EXPECT_EQ(broker.getMessageCount(), stats.published);
+    EXPECT_GT(broker.getMessagesPerSecond(), 0);
+
+    // Each value was either sent or replaced by a newer one while queued
+    EXPECT_GT(stats.coalesced, 0U);
+    EXPECT_EQ(uint32_t(SENSORS * ROUNDS), stats.published - publishedBefore + stats.coalesced);
+
+    RecordProperty("MessagesPerSecond", std::to_string(broker.getMessagesPerSecond()));
+    RecordProperty("QueueHighWater", stats.queueHighWater);
+    RecordProperty("Coalesced", stats.coalesced);
+}
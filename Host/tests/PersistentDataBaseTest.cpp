@@ -0,0 +1,265 @@
+#include <gtest/gtest.h>
+#include <EEPROM.h>
+#include <Preferences.h>
+#include <PersistentDataBase.h>
+#include <StringBuilder.h>
+
+struct SettingsV1 : public PersistentDataBase
+{
+    char name[16];
+    int interval;
+    float offset;
+    bool enabled;
+
+    SettingsV1();
+};
+
+PERSISTENT_FIELD_TABLE_BEGIN
+constexpr PersistentDataField SETTINGS_V1_FIELDS[] PROGMEM =
+{
+    PersistentDataField::stringField("Name", PERSISTENT_FIELD(SettingsV1, name), "Default"),
+    PersistentDataField::integerField("Interval", PERSISTENT_FIELD(SettingsV1, interval), 1, 3600, 60),
+    PersistentDataField::floatField("Offset", PERSISTENT_FIELD(SettingsV1, offset), 1, -5, 5, 0.5),
+    PersistentDataField::booleanField("Enabled", PERSISTENT_FIELD(SettingsV1, enabled), true)
+};
+PERSISTENT_FIELD_TABLE_END
+
+SettingsV1::SettingsV1()
+{
+    addFields(SETTINGS_V1_FIELDS);
+}
+
+
+// Adds a field and bumps the schema version.
+struct SettingsV2 : public SettingsV1
+{
+    int threshold;
+    uint16_t migratedFrom = 0;
+
+    SettingsV2();
+
+    void migrate(uint16_t fromSchemaVersion) override
+    {
+        migratedFrom = fromSchemaVersion;
+    }
+};
+
+PERSISTENT_FIELD_TABLE_BEGIN
+constexpr PersistentDataField SETTINGS_V2_FIELDS[] PROGMEM =
+{
+    PersistentDataField::integerField("Threshold", PERSISTENT_FIELD(SettingsV2, threshold), 0, 100, 42)
+};
+PERSISTENT_FIELD_TABLE_END
+
+SettingsV2::SettingsV2()
+{
+    setSchemaVersion(2);
+    addFields(SETTINGS_V2_FIELDS);
+}
+
+// SettingsV2, with the threshold added after the legacy EEPROM format.
+struct LegacySettingsV2 : public SettingsV2
+{
+    LegacySettingsV2();
+};
+
+PERSISTENT_FIELD_TABLE_BEGIN
+constexpr auto LEGACY_SETTINGS_V2_LEGACY_DATA_END = PERSISTENT_FIELD(LegacySettingsV2, threshold);
+PERSISTENT_FIELD_TABLE_END
+
+LegacySettingsV2::LegacySettingsV2()
+{
+    setLegacyDataEnd(LEGACY_SETTINGS_V2_LEGACY_DATA_END);
+}
+
+// The field descriptors are built at compile time
+static_assert(SETTINGS_V1_FIELDS[1].tag == PersistentDataField::getTag("Interval"), "Tag is derived from the label");
+static_assert(SETTINGS_V1_FIELDS[0].size == 16, "String size is derived from the member");
+
+
+class PersistentDataBaseTest : public testing::Test
+{
+    protected:
+        void SetUp() override
+        {
+            Preferences::reset();
+            EEPROM.reset();
+        }
+};
+
+
+TEST_F(PersistentDataBaseTest, UsesDefaultsIfNVSIsEmpty)
+{
+    SettingsV1 settings;
+    settings.begin(PersistentStorage::NVS);
+
+    EXPECT_STREQ("Default", settings.name);
+    EXPECT_EQ(60, settings.interval);
+    EXPECT_FLOAT_EQ(0.5, settings.offset);
+    EXPECT_TRUE(settings.enabled);
+    EXPECT_EQ(0U, Preferences::getWriteCount());
+}
+
+
+TEST_F(PersistentDataBaseTest, ReadsBackWrittenFields)
+{
+    {
+        SettingsV1 settings;
+        settings.begin(PersistentStorage::NVS);
+        strcpy(settings.name, "Living room");
+        settings.interval = 300;
+        settings.offset = -1.5;
+        settings.enabled = false;
+        settings.writeToEEPROM();
+    }
+    EXPECT_EQ(5U, Preferences::getWriteCount()); // Schema version and 4 fields
+
+    SettingsV1 settings;
+    settings.begin(PersistentStorage::NVS);
+    EXPECT_STREQ("Living room", settings.name);
+    EXPECT_EQ(300, settings.interval);
+    EXPECT_FLOAT_EQ(-1.5, settings.offset);
+    EXPECT_FALSE(settings.enabled);
+    EXPECT_EQ(5U, Preferences::getWriteCount()); // Layout is valid; nothing rewritten
+
+    Preferences nvs;
+    ASSERT_TRUE(nvs.begin("settings", true));
+    EXPECT_EQ(1, nvs.getUShort("schema"));
+}
+
+
+TEST_F(PersistentDataBaseTest, WritesOnlyChangedFields)
+{
+    SettingsV1 settings;
+    settings.begin(PersistentStorage::NVS);
+    settings.writeToEEPROM();
+    uint32_t writeCount = Preferences::getWriteCount();
+
+    settings.writeToEEPROM();
+    EXPECT_EQ(writeCount, Preferences::getWriteCount());
+
+    settings.interval = 120;
+    settings.writeToEEPROM();
+    EXPECT_EQ(writeCount + 1, Preferences::getWriteCount());
+}
+
+
+TEST_F(PersistentDataBaseTest, ValidatesFieldsRead)
+{
+    {
+        SettingsV1 settings;
+        settings.begin(PersistentStorage::NVS);
+        settings.writeToEEPROM();
+    }
+
+    // Store an out-of-range value
+    Preferences nvs;
+    ASSERT_TRUE(nvs.begin("settings"));
+    char key[8];
+    snprintf(key, sizeof(key), "f%04X", PersistentDataBase::getFieldTag(PSTR("Interval")));
+    ASSERT_TRUE(nvs.isKey(key));
+    nvs.putInt(key, 100000);
+    nvs.end();
+
+    SettingsV1 settings;
+    settings.begin(PersistentStorage::NVS);
+    EXPECT_EQ(3600, settings.interval);
+}
+
+
+TEST_F(PersistentDataBaseTest, MigratesFromEEPROM)
+{
+    {
+        SettingsV1 settings;
+        settings.begin(PersistentStorage::EEPROM);
+        strcpy(settings.name, "From EEPROM");
+        settings.interval = 900;
+        settings.writeToEEPROM();
+    }
+    EXPECT_EQ(0U, Preferences::getWriteCount());
+
+    {
+        SettingsV1 settings;
+        settings.begin(PersistentStorage::NVS);
+        EXPECT_STREQ("From EEPROM", settings.name);
+        EXPECT_EQ(900, settings.interval);
+    }
+    EXPECT_EQ(5U, Preferences::getWriteCount());
+
+    // Subsequent boots read from NVS
+    EEPROM.reset();
+    SettingsV1 settings;
+    settings.begin(PersistentStorage::NVS);
+    EXPECT_STREQ("From EEPROM", settings.name);
+    EXPECT_EQ(900, settings.interval);
+    EXPECT_EQ(0U, EEPROM.getCommitCount());
+}
+
+
+TEST_F(PersistentDataBaseTest, MigratesSchemaVersion)
+{
+    {
+        SettingsV1 settings;
+        settings.begin(PersistentStorage::NVS);
+        settings.interval = 30;
+        settings.writeToEEPROM();
+    }
+
+    {
+        SettingsV2 settings;
+        settings.begin(PersistentStorage::NVS);
+        EXPECT_EQ(1, settings.migratedFrom);
+        EXPECT_EQ(30, settings.interval);
+        EXPECT_EQ(42, settings.threshold); // New field gets its default
+    }
+
+    // The new layout is written, so the next boot doesn't migrate again
+    uint32_t writeCount = Preferences::getWriteCount();
+    SettingsV2 settings;
+    settings.begin(PersistentStorage::NVS);
+    EXPECT_EQ(0, settings.migratedFrom);
+    EXPECT_EQ(writeCount, Preferences::getWriteCount());
+}
+
+
+
+TEST_F(PersistentDataBaseTest, MigratesLegacyImageWithoutLaterFields)
+{
+    // Legacy image: magic and the raw SettingsV1 data; the EEPROM after it is erased.
+    SettingsV1 legacy;
+    legacy.initialize();
+    strcpy(legacy.name, "Legacy");
+    legacy.interval = 600;
+    const uint8_t* dataPtr = reinterpret_cast<const uint8_t*>(legacy.name);
+    size_t dataSize = reinterpret_cast<const uint8_t*>(&legacy.enabled) + sizeof(legacy.enabled) - dataPtr;
+    ASSERT_TRUE(EEPROM.begin(1024));
+    uint32_t magic = 0xCAFEBABE;
+    memcpy(EEPROM.getDataPtr(), &magic, sizeof(magic));
+    memcpy(EEPROM.getDataPtr() + sizeof(magic), dataPtr, dataSize);
+    ASSERT_TRUE(EEPROM.commit());
+    EEPROM.end();
+
+    LegacySettingsV2 settings;
+    settings.begin(PersistentStorage::EEPROM);
+    EXPECT_STREQ("Legacy", settings.name);
+    EXPECT_EQ(600, settings.interval);
+    EXPECT_TRUE(settings.enabled);
+    EXPECT_EQ(42, settings.threshold); // Not read from the erased EEPROM (0xFFFFFFFF would be validated to 0)
+}
+
+
+TEST_F(PersistentDataBaseTest, WritesHtmlForm)
+{
+    SettingsV2 settings;
+    settings.begin(PersistentStorage::NVS);
+    strcpy(settings.name, "Kitchen");
+
+    StringBuilder output(4096);
+    HtmlWriter html(output, "", "");
+    settings.writeHtmlForm(html);
+    String form = output.c_str();
+
+    EXPECT_GE(form.indexOf("Kitchen"), 0);
+    EXPECT_GE(form.indexOf("Interval"), 0);
+    EXPECT_GE(form.indexOf("Threshold"), 0);
+}
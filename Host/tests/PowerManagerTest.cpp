@@ -0,0 +1,171 @@
+#include <gtest/gtest.h>
+#include <Arduino.h>
+#include <PowerManager.h>
+#include <MemoryStream.h>
+#include <vector>
+
+
+// Light sleep in virtual time: the sleep hook advances the clock instead of sleeping.
+class PowerManagerTest : public testing::Test
+{
+    protected:
+        TimerWheel timers;
+        PowerManager powerManager { timers };
+        std::vector<uint32_t> sleeps;
+        uint32_t wakeLateMs = 0;
+        WakeCause wakeCause = WakeCause::Timer;
+
+        void SetUp() override
+        {
+            Host::useVirtualTime(true);
+            powerManager.setClock([]() { return uint32_t(micros()); });
+            powerManager.setSleepHook([this](uint32_t sleepMs)
+            {
+                sleeps.push_back(sleepMs);
+                Host::advanceMillis((wakeCause == WakeCause::Timer) ? sleepMs + wakeLateMs : sleepMs / 2);
+                return wakeCause;
+            });
+        }
+
+        void TearDown() override
+        {
+            Host::useVirtualTime(false);
+        }
+
+        int addJob(uint32_t delayMs)
+        {
+            int job = timers.addJob("Job", []() {});
+            timers.schedule(job, delayMs);
+            return job;
+        }
+
+        uint32_t getWakes(WakeCause cause) { return powerManager.getStats().wakes[static_cast<int>(cause)]; }
+};
+
+
+TEST_F(PowerManagerTest, SleepsUntilNextDeadline)
+{
+    ASSERT_TRUE(powerManager.begin());
+    addJob(200);
+
+    powerManager.sleep(1000);
+
+    EXPECT_EQ(std::vector<uint32_t>({ 200 }), sleeps);
+    EXPECT_EQ(0U, timers.getTimeToNext());
+    const PowerManagerStats& stats = powerManager.getStats();
+    EXPECT_EQ(1U, stats.sleeps);
+    EXPECT_EQ(200000U, stats.sleepUs);
+    EXPECT_EQ(1U, getWakes(WakeCause::Timer));
+    EXPECT_EQ(WakeCause::Timer, powerManager.getLastWakeCause());
+}
+
+
+TEST_F(PowerManagerTest, CapsSleepDuration)
+{
+    ASSERT_TRUE(powerManager.begin());
+    addJob(5000);
+
+    powerManager.sleep(1000);
+    powerManager.sleep(100);
+    powerManager.setSleepLimits(10, 2000);
+    powerManager.sleep(5000);
+
+    // At most LIGHT_SLEEP_MAX_MS by default, so the station wakes up for beacons
+    EXPECT_EQ(std::vector<uint32_t>({ LIGHT_SLEEP_MAX_MS, 100, 2000 }), sleeps);
+}
+
+
+TEST_F(PowerManagerTest, SkipsShortSleepsAndWhileKeptAwake)
+{
+    ASSERT_TRUE(powerManager.begin());
+    int shortJob = addJob(LIGHT_SLEEP_MIN_MS - 1);
+    powerManager.sleep(1000);
+    timers.cancel(shortJob);
+
+    addJob(200);
+    powerManager.setKeepAwake(true);
+    powerManager.sleep(1);
+
+    EXPECT_TRUE(sleeps.empty());
+    EXPECT_EQ(2U, powerManager.getStats().skipped);
+    EXPECT_EQ(0U, powerManager.getStats().sleeps);
+}
+
+
+TEST_F(PowerManagerTest, SkipsSleepWhileWakeSourceActive)
+{
+    // Data which is already received would end the sleep right away
+    MemoryStream serial("command\n");
+    powerManager.enableUartWakeup(serial);
+    ASSERT_TRUE(powerManager.begin());
+    addJob(200);
+
+    powerManager.sleep(1);
+
+    EXPECT_TRUE(sleeps.empty());
+    EXPECT_EQ(1U, powerManager.getStats().skipped);
+}
+
+
+TEST_F(PowerManagerTest, DoesNotSleepUnlessEnabled)
+{
+    addJob(200);
+    powerManager.sleep(1);
+
+    EXPECT_TRUE(sleeps.empty());
+    EXPECT_EQ(0U, powerManager.getStats().skipped);
+}
+
+
+TEST_F(PowerManagerTest, MeasuresTimerWakeLatency)
+{
+    ASSERT_TRUE(powerManager.begin());
+    addJob(10000);
+
+    wakeLateMs = 2;
+    powerManager.sleep(100);
+    wakeLateMs = 5;
+    powerManager.sleep(100);
+
+    const PowerManagerStats& stats = powerManager.getStats();
+    EXPECT_EQ(5000U, stats.maxWakeLatencyUs);
+    EXPECT_FLOAT_EQ(3500.0F, stats.getAvgWakeLatencyUs());
+}
+
+
+TEST_F(PowerManagerTest, CountsWakeCausesAndCallsGpioHandler)
+{
+    int gpioWakes = 0;
+    powerManager.enableGpioWakeup(4, false, [&]() { gpioWakes++; });
+    ASSERT_TRUE(powerManager.begin());
+    addJob(10000);
+
+    wakeCause = WakeCause::Gpio;
+    powerManager.sleep(200);
+    wakeCause = WakeCause::Uart;
+    powerManager.sleep(200);
+
+    EXPECT_EQ(1, gpioWakes);
+    EXPECT_EQ(1U, getWakes(WakeCause::Gpio));
+    EXPECT_EQ(1U, getWakes(WakeCause::Uart));
+    EXPECT_EQ(0U, getWakes(WakeCause::Timer));
+    EXPECT_EQ(0U, powerManager.getStats().maxWakeLatencyUs); // Only timer wakes have a deadline
+}
+
+
+TEST_F(PowerManagerTest, ReportsTimeAsleep)
+{
+    ASSERT_TRUE(powerManager.begin());
+    addJob(10000);
+
+    for (int i = 0; i < 4; i++)
+    {
+        Host::advanceMillis(100); // Awake
+        powerManager.sleep(300);
+    }
+
+    const PowerManagerStats& stats = powerManager.getStats();
+    EXPECT_EQ(1200000U, stats.sleepUs);
+    EXPECT_EQ(400000U, stats.awakeUs);
+    EXPECT_FLOAT_EQ(75.0F, stats.getSleepPercent());
+}
@@ -0,0 +1,138 @@
+#include <gtest/gtest.h>
+#include <Arduino.h>
+#include <RESTClient.h>
+#include <HTTPSStandIn.h>
+#include <functional>
+
+constexpr uint32_t WAIT_TIMEOUT_MS = 3000;
+
+
+class CounterClient : public RESTClient
+{
+    public:
+        int count = -1;
+
+        CounterClient() : RESTClient(2) {}
+
+        bool begin(const String& baseUrl, const char* certificate = nullptr)
+        {
+            return RESTClient::begin(baseUrl, certificate);
+        }
+
+    protected:
+        bool parseResponse(const JsonDocument& response) override
+        {
+            count = response["count"].as<int>();
+            return !response["count"].isNull();
+        }
+};
+
+
+class RESTClientTest : public testing::Test
+{
+    protected:
+        HTTPSStandIn server;
+        // The background task runs forever (like on the ESP), so the client is never deleted.
+        CounterClient& client = *new CounterClient();
+
+        void begin(const char* certificate = nullptr)
+        {
+            server.setResponse(200, "{\"count\":42}");
+            String baseUrl = "https://127.0.0.1:" + String(server.getPort());
+            ASSERT_TRUE(client.begin(baseUrl, certificate));
+        }
+
+        static bool waitUntil(std::function<bool()> condition)
+        {
+            uint32_t startMillis = millis();
+            while (!condition())
+            {
+                if (millis() - startMillis >= WAIT_TIMEOUT_MS) return false;
+                delay(10);
+            }
+            return true;
+        }
+};
+
+
+TEST_F(RESTClientTest, ReusesConnectionForSubsequentRequests)
+{
+    begin();
+
+    EXPECT_EQ(HTTP_OK, client.awaitData("/count")) << client.getLastError().c_str();
+    EXPECT_EQ(42, client.count);
+    EXPECT_EQ(HTTP_OK, client.awaitData("/count")) << client.getLastError().c_str();
+
+    const RESTClientStats& stats = client.getStats();
+    EXPECT_EQ(2U, stats.requests);
+    EXPECT_EQ(1U, stats.connects);
+    EXPECT_EQ(1U, stats.reusedConnections);
+    EXPECT_EQ(stats.lastConnectMs, stats.totalConnectMs); // Handshake time of the single connection
+    EXPECT_EQ(1, server.getHandshakeCount());
+    EXPECT_EQ(2, server.getRequestCount());
+    EXPECT_EQ(std::vector<std::string>({ "GET /count", "GET /count" }), server.getRequests());
+}
+
+
+TEST_F(RESTClientTest, ReconnectsIfServerClosesConnection)
+{
+    server.setMaxRequestsPerConnection(1);
+    begin();
+
+    EXPECT_EQ(HTTP_OK, client.awaitData("/count")) << client.getLastError().c_str();
+    EXPECT_EQ(HTTP_OK, client.awaitData("/count")) << client.getLastError().c_str();
+
+    EXPECT_EQ(2U, client.getStats().connects);
+    EXPECT_EQ(0U, client.getStats().reusedConnections);
+    EXPECT_EQ(2, server.getHandshakeCount());
+}
+
+
+TEST_F(RESTClientTest, ClosesIdleConnection)
+{
+    client.setIdleTimeout(1);
+    begin();
+
+    EXPECT_EQ(HTTP_OK, client.awaitData("/count")) << client.getLastError().c_str();
+    ASSERT_TRUE(waitUntil([this]() { return client.getStats().idleDisconnects == 1; }));
+    EXPECT_EQ(HTTP_OK, client.awaitData("/count")) << client.getLastError().c_str();
+
+    EXPECT_EQ(2U, client.getStats().connects);
+    EXPECT_EQ(2, server.getHandshakeCount());
+}
+
+
+TEST_F(RESTClientTest, ResetTLSDeletesClientOnBackgroundTask)
+{
+    begin();
+    EXPECT_EQ(HTTP_OK, client.awaitData("/count")) << client.getLastError().c_str();
+
+    // Like EVSE32 when WiFi is lost; the next request does a new handshake.
+    client.resetTLS();
+    EXPECT_EQ(HTTP_OK, client.awaitData("/count")) << client.getLastError().c_str();
+
+    EXPECT_EQ(2U, client.getStats().connects);
+    EXPECT_EQ(0U, client.getStats().reusedConnections);
+    EXPECT_EQ(2, server.getHandshakeCount());
+}
+
+
+TEST_F(RESTClientTest, ValidatesServerCertificate)
+{
+    begin(server.getCertificate());
+    EXPECT_EQ(HTTP_OK, client.awaitData("/count")) << client.getLastError().c_str();
+    EXPECT_EQ(1, server.getHandshakeCount());
+}
+
+
+TEST_F(RESTClientTest, RejectsServerWithOtherCertificate)
+{
+    HTTPSStandIn otherServer;
+    begin(otherServer.getCertificate());
+
+    uint32_t startMillis = millis();
+    EXPECT_EQ(HTTPC_ERROR_CONNECTION_REFUSED, client.awaitData("/count"));
+    EXPECT_LT(millis() - startMillis, 1000U); // Fails on validation, not on the handshake timeout
+    EXPECT_EQ(1U, client.getStats().connectFailures);
+    EXPECT_EQ(0, server.getHandshakeCount());
+}
@@ -0,0 +1,44 @@
+#include <gtest/gtest.h>
+#include <Arduino.h>
+#include <RequestBudget.h>
+#include <TimeUtils.h>
+
+constexpr time_t DAY_START = 1700006400; // Midnight UTC
+
+
+TEST(RequestBudgetTest, SpreadsRequestsOverPeriod)
+{
+    RequestBudget budget(96, SECONDS_PER_DAY, 0);
+
+    EXPECT_TRUE(budget.tryAcquire(DAY_START));
+    EXPECT_EQ(DAY_START + 86400 / 95, budget.getNextRequestTime()); // 95 requests left
+    EXPECT_FALSE(budget.tryAcquire(DAY_START + 60));
+    EXPECT_TRUE(budget.tryAcquire(DAY_START + 60, true));
+}
+
+
+TEST(RequestBudgetTest, UrgentRequestsRespectRetryAfter)
+{
+    RequestBudget budget(1000, SECONDS_PER_DAY, 10);
+
+    EXPECT_TRUE(budget.tryAcquire(DAY_START));
+    budget.rateLimited(DAY_START, 120);
+
+    EXPECT_EQ(DAY_START + 120, budget.getNextRequestTime());
+    EXPECT_FALSE(budget.tryAcquire(DAY_START + 60, true));
+    EXPECT_TRUE(budget.tryAcquire(DAY_START + 120, true));
+    EXPECT_EQ(1U, budget.getStats().rateLimited);
+    EXPECT_EQ(1U, budget.getStats().deferred);
+}
+
+
+TEST(RequestBudgetTest, RetryAfterSurvivesScheduling)
+{
+    RequestBudget budget(1000, SECONDS_PER_DAY, 0);
+
+    budget.rateLimited(DAY_START, 600);
+    budget.update(DAY_START + 1, 1000, 999); // Must not shorten the Retry-After
+
+    EXPECT_FALSE(budget.tryAcquire(DAY_START + 300));
+    EXPECT_TRUE(budget.tryAcquire(DAY_START + 600));
+}
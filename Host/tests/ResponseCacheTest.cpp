@@ -0,0 +1,72 @@
+#include <gtest/gtest.h>
+#include <Arduino.h>
+#include <ResponseCache.h>
+#include <SpiRamAllocator.h>
+
+constexpr uint32_t TTL_SECONDS = 10;
+
+
+class ResponseCacheTest : public testing::Test
+{
+    protected:
+        SpiRamAllocator allocator;
+        ResponseCache cache { 2, TTL_SECONDS, &allocator };
+        JsonDocument doc;
+
+        void put(const char* key, time_t time, int power)
+        {
+            JsonDocument response;
+            response["power"] = power;
+            cache.put(key, time, response);
+        }
+};
+
+
+TEST_F(ResponseCacheTest, ReturnsCachedResponseWithinTTL)
+{
+    put("/devices/1/status", 1000, 42);
+
+    ASSERT_TRUE(cache.get("/devices/1/status", 1000 + TTL_SECONDS, doc));
+    EXPECT_EQ(42, doc["power"].as<int>());
+    EXPECT_FALSE(cache.get("/devices/2/status", 1000, doc));
+
+    EXPECT_EQ(1U, cache.getHits());
+    EXPECT_EQ(1U, cache.getMisses());
+}
+
+
+TEST_F(ResponseCacheTest, ExpiresAfterTTL)
+{
+    put("/devices/1/status", 1000, 42);
+
+    EXPECT_FALSE(cache.get("/devices/1/status", 1001 + TTL_SECONDS, doc));
+    EXPECT_TRUE(cache.get("/devices/1/status", 1001 + TTL_SECONDS, doc, UINT32_MAX)); // Any age accepted
+    EXPECT_FALSE(cache.get("/devices/1/status", 1005, doc, 4)); // Shorter maximum age
+
+    // A new response restarts the TTL
+    put("/devices/1/status", 1020, 43);
+    ASSERT_TRUE(cache.get("/devices/1/status", 1025, doc));
+    EXPECT_EQ(43, doc["power"].as<int>());
+}
+
+
+TEST_F(ResponseCacheTest, ReplacesOldestEntryWhenFull)
+{
+    put("/devices/1/status", 1002, 1);
+    put("/devices/2/status", 1000, 2);
+    put("/devices/3/status", 1004, 3);
+
+    EXPECT_TRUE(cache.get("/devices/1/status", 1005, doc));
+    EXPECT_FALSE(cache.get("/devices/2/status", 1005, doc));
+    ASSERT_TRUE(cache.get("/devices/3/status", 1005, doc));
+    EXPECT_EQ(3, doc["power"].as<int>());
+}
+
+
+TEST_F(ResponseCacheTest, ClearRemovesAllEntries)
+{
+    put("/devices/1/status", 1000, 42);
+    cache.clear();
+
+    EXPECT_FALSE(cache.get("/devices/1/status", 1000, doc));
+}
@@ -0,0 +1,112 @@
+#include <gtest/gtest.h>
+#include <Arduino.h>
+#include <StreamUtils.h>
+#include <string>
+#include <vector>
+
+
+// A socket-like stream: each segment only arrives after the previous one is read (and a read found no data).
+class SegmentedStream : public Stream
+{
+    public:
+        SegmentedStream(std::vector<std::string> segments) : _segments(segments) { setTimeout(100); }
+
+        std::string getRemaining()
+        {
+            std::string result;
+            while (available() > 0 || nextSegment()) result += char(read());
+            return result;
+        }
+
+        int available() override { return isSegmentRead() ? 0 : _segments[_index].size() - _position; }
+        int read() override { return (available() > 0) ? uint8_t(_segments[_index][_position++]) : (nextSegment(), -1); }
+        int peek() override { return (available() > 0) ? uint8_t(_segments[_index][_position]) : -1; }
+        size_t write(uint8_t c) override { return 0; }
+
+    private:
+        std::vector<std::string> _segments;
+        size_t _index = 0;
+        size_t _position = 0;
+
+        bool isSegmentRead() { return (_index == _segments.size()) || (_position == _segments[_index].size()); }
+
+        bool nextSegment()
+        {
+            if ((_index == _segments.size()) || (++_index == _segments.size())) return false;
+            _position = 0;
+            return true;
+        }
+};
+
+
+static std::string readBody(HttpBodyStream& body, size_t bufferSize = 64)
+{
+    std::string result;
+    char buffer[64];
+    size_t length;
+    while ((length = body.readBytes(buffer, std::min(bufferSize, sizeof(buffer)))) > 0)
+        result.append(buffer, length);
+    return result;
+}
+
+
+TEST(HttpBodyStreamTest, DecodesChunks)
+{
+    SegmentedStream stream({ "4\r\nWiki\r\n5\r\npedia\r\nA\r\n in chunks\r\n0\r\n\r\n" });
+    HttpBodyStream body(stream, true);
+
+    EXPECT_EQ("Wikipedia in chunks", readBody(body));
+    EXPECT_EQ(-1, body.read());
+}
+
+
+TEST(HttpBodyStreamTest, IgnoresChunkExtensions)
+{
+    SegmentedStream stream({ "4;name=value\r\nWiki\r\n5;ext\r\npedia\r\n0;last\r\n\r\n" });
+    HttpBodyStream body(stream, true);
+
+    EXPECT_EQ("Wikipedia", readBody(body));
+}
+
+
+TEST(HttpBodyStreamTest, ReadsSplitChunkHeaders)
+{
+    // Chunk headers (and CRLFs) split across TCP segments
+    SegmentedStream stream({ "4\r", "\nWi", "ki\r", "\n1", "0\r\n0123456789", "abcdef\r\n", "0", "\r\n\r\n" });
+    HttpBodyStream body(stream, true);
+
+    EXPECT_EQ("Wiki0123456789abcdef", readBody(body, 3));
+}
+
+
+TEST(HttpBodyStreamTest, SkipsTrailers)
+{
+    // The next response on the kept-alive connection follows the trailers
+    SegmentedStream stream({ "4\r\nWiki\r\n0\r\nExpires: never\r\nX-Checksum: 1234\r\n\r\n", "HTTP/1.1 200 OK" });
+    HttpBodyStream body(stream, true);
+
+    EXPECT_EQ("Wiki", readBody(body));
+    EXPECT_EQ("HTTP/1.1 200 OK", stream.getRemaining());
+}
+
+
+TEST(HttpBodyStreamTest, DrainsRemainingChunks)
+{
+    SegmentedStream stream({ "4\r\nWiki\r\n5\r\npedia\r\n0\r\nX-Trailer: 1\r\n\r\n", "NEXT" });
+    HttpBodyStream body(stream, true);
+
+    char buffer[2];
+    ASSERT_EQ(2U, body.readBytes(buffer, sizeof(buffer)));
+    body.drain();
+    EXPECT_EQ("NEXT", stream.getRemaining());
+}
+
+
+TEST(HttpBodyStreamTest, ReadsContentLength)
+{
+    SegmentedStream stream({ "{\"value\":", "42}", "NEXT" });
+    HttpBodyStream body(stream, false, 12);
+
+    EXPECT_EQ("{\"value\":42}", readBody(body));
+    EXPECT_EQ("NEXT", stream.getRemaining());
+}
@@ -0,0 +1,94 @@
+#include <gtest/gtest.h>
+#include <Arduino.h>
+#include <StructuredEventLog.h>
+
+class StructuredEventLogTest : public testing::Test
+{
+    protected:
+        StructuredEventLog log { 4, MemoryType::Internal };
+
+        void TearDown() override
+        {
+            Host::setIsrContext(false);
+        }
+
+        std::string getEventText(const StructuredEvent& event)
+        {
+            char buffer[128];
+            event.toString(buffer, sizeof(buffer));
+            // Strip the timestamp
+            const char* text = strstr(buffer, " : ");
+            return (text == nullptr) ? buffer : text + 3;
+        }
+};
+
+
+TEST_F(StructuredEventLogTest, FormatsArgumentsWhenRendered)
+{
+    char name[16] = "Zone 1";
+    EXPECT_TRUE(log.add(F("%s: %d.%02d C (%lu)"), name, 21, 5, 123456UL));
+    name[0] = 0; // String arguments are copied
+
+    int count = 0;
+    for (const StructuredEvent& event : log)
+    {
+        EXPECT_EQ("Zone 1: 21.05 C (123456)", getEventText(event));
+        count++;
+    }
+    EXPECT_EQ(1, count);
+}
+
+
+TEST_F(StructuredEventLogTest, GetsEventBySequence)
+{
+    EXPECT_TRUE(log.add(F("Init")));
+    ASSERT_TRUE(log.add(F("Value %d"), 42));
+
+    StructuredEvent event;
+    EXPECT_TRUE(log.getEvent(1, event));
+    EXPECT_EQ("Value 42", getEventText(event));
+}
+
+
+TEST_F(StructuredEventLogTest, TruncatesArguments)
+{
+    std::string longString(STRUCTURED_EVENT_ARGS_SIZE * 2, 'x');
+    EXPECT_TRUE(log.add(F("%s"), longString.c_str()));
+
+    StructuredEvent event;
+    ASSERT_TRUE(log.getEvent(0, event));
+    EXPECT_TRUE(event.flags & STRUCTURED_EVENT_TRUNCATED);
+    std::string text = getEventText(event);
+    EXPECT_EQ(std::string(STRUCTURED_EVENT_ARGS_SIZE - 1, 'x') + "...", text);
+}
+
+
+TEST_F(StructuredEventLogTest, OverwritesOldestEvents)
+{
+    for (int i = 0; i < 6; i++)
+        log.add(F("Event %d"), i);
+
+    EXPECT_EQ(4, log.count());
+    EXPECT_EQ(2U, log.getOverwrittenCount());
+    EXPECT_EQ(2U, log.getFirstSequence());
+
+    StructuredEvent event;
+    EXPECT_FALSE(log.getEvent(1, event));
+    ASSERT_TRUE(log.getEvent(2, event));
+    EXPECT_EQ("Event 2", getEventText(event));
+}
+
+
+TEST_F(StructuredEventLogTest, DoesNotAllocateInISR)
+{
+    Host::setIsrContext(true);
+    EXPECT_FALSE(log.add(F("From ISR")));
+    EXPECT_EQ(0, log.count());
+
+    // Once the buffer is allocated by a task, events can be added from an ISR
+    Host::setIsrContext(false);
+    EXPECT_TRUE(log.add(F("From task")));
+    Host::setIsrContext(true);
+    EXPECT_TRUE(log.add(F("From ISR %u"), 1U));
+    EXPECT_EQ(2, log.count());
+}
@@ -0,0 +1,220 @@
+#include <gtest/gtest.h>
+#include <Arduino.h>
+#include <Log.h>
+#include <SyncCursor.h>
+#include <WiFiFTP.h>
+#include <FTPStandIn.h>
+#include <algorithm>
+#include <string>
+
+constexpr uint16_t LOG_SIZE = 8;
+constexpr int FTP_TIMEOUT_MS = 300;
+constexpr time_t SYNC_TIME = 1700000000;
+
+
+// Syncs a log of sequence numbers like the projects do: entries only count as synced once acknowledged.
+class SyncCursorTest : public testing::Test
+{
+    protected:
+        StaticLog<uint32_t> log { LOG_SIZE, MemoryType::Internal };
+        SyncCursor cursor { LOG_SIZE };
+        WiFiFTPClient ftpClient { FTP_TIMEOUT_MS };
+        FTPStandIn server { FTP_TIMEOUT_MS };
+        uint32_t nextEntry = 0;
+
+        void SetUp() override
+        {
+            Host::setResetReason(ESP_RST_POWERON);
+        }
+
+        void addEntries(int count)
+        {
+            for (int i = 0; i < count; i++)
+            {
+                log.add(nextEntry++);
+                cursor.add();
+            }
+        }
+
+        bool sync()
+        {
+            ftpClient.beginAsync("127.0.0.1", "user", "secret", server.getPort());
+            auto logWriter = [this](Print& output)
+            {
+                uint16_t unsentEntries = cursor.getUnsent();
+                for (auto entryIter = log.at(-unsentEntries); entryIter != log.end(); ++entryIter)
+                    output.printf("%u;", *entryIter);
+                cursor.advance(unsentEntries);
+            };
+            ftpClient.appendLogAsync("log.csv", cursor, logWriter, [this]() { cursor.acknowledge(SYNC_TIME); });
+
+            bool success = ftpClient.run();
+            if (!success) cursor.rollback();
+            return success;
+        }
+
+        // Simulates a reset; the log lives in RAM, so only the cursor survives.
+        void reset(esp_reset_reason_t reason)
+        {
+            Host::setResetReason(reason);
+            log.clear();
+            cursor = SyncCursor(LOG_SIZE);
+        }
+};
+
+
+TEST_F(SyncCursorTest, ResendsAfterAbortedTransfer)
+{
+    addEntries(3);
+    server.injectFault(FTPFault::Abort);
+    EXPECT_FALSE(sync());
+    EXPECT_EQ(3, cursor.getLag());
+
+    addEntries(2);
+    EXPECT_TRUE(sync()) << ftpClient.getLastError();
+    EXPECT_EQ(0, cursor.getLag());
+    EXPECT_EQ("0;1;2;0;1;2;3;4;", server.getData());
+    EXPECT_EQ("0;1;2;3;4;", server.getFile("log.csv")); // The resend overwrote the unacknowledged entries
+    EXPECT_EQ(SYNC_TIME, cursor.getLastAckTime());
+    EXPECT_EQ(SYNC_CURSOR_NO_OFFSET, cursor.getResumeOffset());
+}
+
+
+TEST_F(SyncCursorTest, OverwritesPartialTransfer)
+{
+    addEntries(2);
+    EXPECT_TRUE(sync()) << ftpClient.getLastError();
+    addEntries(3);
+    server.injectFault(FTPFault::Partial);
+    EXPECT_FALSE(sync());
+    EXPECT_EQ("0;1;2;3", server.getFile("log.csv"));
+
+    addEntries(1);
+    EXPECT_TRUE(sync()) << ftpClient.getLastError();
+    EXPECT_EQ("0;1;2;3;4;5;", server.getFile("log.csv"));
+
+    std::vector<std::string> commands = server.getCommands();
+    EXPECT_NE(commands.end(), std::find(commands.begin(), commands.end(), "REST 4"));
+    EXPECT_NE(commands.end(), std::find(commands.begin(), commands.end(), "STOR log.csv"));
+}
+
+
+TEST_F(SyncCursorTest, AppendsIfFileWasReplaced)
+{
+    addEntries(3);
+    server.injectFault(FTPFault::Abort);
+    EXPECT_FALSE(sync());
+    EXPECT_EQ(0U, cursor.getResumeOffset());
+
+    cursor.setResumeOffset(100); // Beyond the end of the file
+    EXPECT_TRUE(sync()) << ftpClient.getLastError();
+    EXPECT_EQ("0;1;2;0;1;2;", server.getFile("log.csv"));
+}
+
+
+TEST_F(SyncCursorTest, ResendsAfterDisconnect)
+{
+    addEntries(3);
+    server.injectFault(FTPFault::Disconnect);
+    EXPECT_FALSE(sync());
+    EXPECT_EQ(3, cursor.getLag());
+
+    EXPECT_TRUE(sync()) << ftpClient.getLastError();
+    EXPECT_EQ(0, cursor.getLag());
+    EXPECT_EQ("0;1;2;0;1;2;", server.getData());
+    EXPECT_EQ("0;1;2;", server.getFile("log.csv"));
+}
+
+
+TEST_F(SyncCursorTest, KeepsCursorIfWriterAborts)
+{
+    addEntries(3);
+    ftpClient.beginAsync("127.0.0.1", "user", "secret", server.getPort());
+    bool isAcknowledged = false;
+    auto failingWriter = [this](Print& output)
+    {
+        output.print("0;1");
+        ftpClient.abortTransfer("gzip failed"); // Like the projects if GzipPrint::finish() fails
+    };
+    ftpClient.appendLogAsync("log.csv", cursor, failingWriter, [&]() { isAcknowledged = true; });
+
+    EXPECT_FALSE(ftpClient.run());
+    EXPECT_FALSE(isAcknowledged);
+    EXPECT_STREQ("Upload aborted: gzip failed", ftpClient.getLastError());
+    EXPECT_EQ(3, cursor.getUnsent());
+    EXPECT_EQ(3, cursor.getLag());
+
+    EXPECT_TRUE(sync()) << ftpClient.getLastError();
+    EXPECT_EQ("0;1;2;", server.getFile("log.csv"));
+}
+
+
+TEST_F(SyncCursorTest, CountsOverwrittenEntriesAsLost)
+{
+    addEntries(3);
+    server.injectFault(FTPFault::Abort, 2);
+    EXPECT_FALSE(sync());
+    EXPECT_FALSE(sync());
+
+    addEntries(LOG_SIZE);
+    EXPECT_EQ(3U, cursor.getLost());
+    EXPECT_TRUE(sync()) << ftpClient.getLastError();
+    // The unacknowledged data of the lost entries is replaced
+    EXPECT_EQ("3;4;5;6;7;8;9;10;", server.getFile("log.csv"));
+}
+
+
+TEST_F(SyncCursorTest, RestoresAfterReset)
+{
+    EXPECT_FALSE(cursor.begin(0));
+    addEntries(5);
+    EXPECT_TRUE(sync());
+    addEntries(2);
+    server.injectFault(FTPFault::Abort);
+    EXPECT_FALSE(sync()); // Entries sent, but not acknowledged
+
+    reset(ESP_RST_PANIC);
+    EXPECT_TRUE(cursor.begin(0));
+    EXPECT_EQ(2U, cursor.getLost());
+    EXPECT_EQ(0, cursor.getLag());
+    EXPECT_EQ(SYNC_TIME, cursor.getLastAckTime());
+
+    // Continues with the next entries only
+    nextEntry = 100;
+    addEntries(2);
+    EXPECT_EQ(2, cursor.getUnsent());
+    EXPECT_TRUE(sync());
+    EXPECT_EQ("0;1;2;3;4;5;6;100;101;", server.getData());
+    EXPECT_EQ("0;1;2;3;4;100;101;", server.getFile("log.csv")); // The resume offset survived too
+}
+
+
+TEST_F(SyncCursorTest, ResumesIfLogSurvivesReset)
+{
+    EXPECT_FALSE(cursor.begin(1));
+    addEntries(4);
+    EXPECT_TRUE(sync());
+    addEntries(3);
+
+    Host::setResetReason(ESP_RST_SW);
+    cursor = SyncCursor(LOG_SIZE);
+    EXPECT_TRUE(cursor.begin(1, log.count()));
+    EXPECT_EQ(0U, cursor.getLost());
+    EXPECT_EQ(3, cursor.getLag());
+    EXPECT_TRUE(sync());
+    EXPECT_EQ("0;1;2;3;4;5;6;", server.getData());
+    EXPECT_EQ("0;1;2;3;4;5;6;", server.getFile("log.csv"));
+}
+
+
+TEST_F(SyncCursorTest, StartsOverAfterPowerCycle)
+{
+    EXPECT_FALSE(cursor.begin(2));
+    addEntries(4);
+
+    reset(ESP_RST_POWERON);
+    EXPECT_FALSE(cursor.begin(2));
+    EXPECT_EQ(0U, cursor.getLost());
+    EXPECT_EQ(0, cursor.getLag());
+    EXPECT_EQ(0, cursor.getLastAckTime());
+}
@@ -0,0 +1,200 @@
+#include <gtest/gtest.h>
+#include <Arduino.h>
+#include <TimerWheel.h>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+
+class TimerWheelTest : public testing::Test
+{
+    protected:
+        TimerWheel timers;
+
+        void SetUp() override
+        {
+            Host::useVirtualTime(true);
+        }
+
+        void TearDown() override
+        {
+            Host::useVirtualTime(false);
+        }
+
+        void runFor(uint32_t durationMs)
+        {
+            uint32_t startMillis = millis();
+            while (true)
+            {
+                timers.run();
+                if (millis() - startMillis >= durationMs) break;
+                // Jobs may have taken time, so the time to the next deadline is determined afterwards.
+                uint32_t remainingMs = durationMs - (millis() - startMillis);
+                Host::advanceMillis(std::min(timers.getTimeToNext(), remainingMs));
+            }
+        }
+};
+
+
+TEST_F(TimerWheelTest, ReportsElapsedTimeOverSkippedPeriods)
+{
+    std::vector<uint32_t> elapsed;
+    int sampleJob = -1;
+    sampleJob = timers.addPeriodic("Sample", 1000, [&]() { elapsed.push_back(timers.getElapsedMs(sampleJob)); }, 1000);
+    timers.addPeriodic("Block", 5000, []() { Host::advanceMillis(2500); }, 4500);
+
+    runFor(10000);
+
+    // The sample at 5 s is skipped (blocked from 4.5 to 7 s); the next one reports the time since the previous run.
+    EXPECT_EQ(std::vector<uint32_t>({ 1000, 1000, 1000, 1000, 3000, 1000, 1000 }), elapsed);
+    EXPECT_EQ(2U, timers.getJobStats(sampleJob).overruns);
+}
+
+
+TEST_F(TimerWheelTest, MeasuresElapsedTimeFromScheduling)
+{
+    uint32_t elapsedMs = 0;
+    int job = -1;
+    job = timers.addJob("OneShot", [&]() { elapsedMs = timers.getElapsedMs(job); });
+
+    timers.run();
+    Host::advanceMillis(5000);
+    timers.schedule(job, 300);
+    runFor(1000);
+
+    EXPECT_EQ(300U, elapsedMs);
+}
+
+
+TEST_F(TimerWheelTest, RunsJobsAtDeadlinesAcrossLevels)
+{
+    // Level 0 spans 64 ticks, level 1 4096 and level 2 262144; the later jobs cascade down.
+    std::vector<uint32_t> delays = { 1, 63, 64, 65, 130, 4095, 4096, 4097, 70000, 262143 };
+    std::vector<uint32_t> runMillis;
+    uint32_t startMillis = millis();
+    for (uint32_t delayMs : delays)
+    {
+        int job = timers.addJob("OneShot", [&]() { runMillis.push_back(millis() - startMillis); });
+        timers.schedule(job, delayMs);
+    }
+
+    runFor(300000);
+
+    EXPECT_EQ(delays, runMillis);
+    EXPECT_GT(timers.getStats().cascades, 0U);
+    for (size_t job = 0; job < delays.size(); job++)
+        EXPECT_EQ(0U, timers.getJobStats(job).maxLatenessMs) << delays[job];
+}
+
+
+TEST_F(TimerWheelTest, RunsJobsParkedBeyondWheel)
+{
+    constexpr uint32_t DELAY_MS = 1000000; // The wheel spans 262144 ticks
+    uint32_t startMillis = millis();
+    uint32_t runMillis = 0;
+    int job = timers.addJob("Far", [&]() { runMillis = millis() - startMillis; });
+    timers.schedule(job, DELAY_MS);
+    timers.addPeriodic("Tick", 60000, []() {}, 60000);
+
+    runFor(DELAY_MS - 1);
+    EXPECT_EQ(0U, runMillis);
+    EXPECT_TRUE(timers.isScheduled(job));
+
+    runFor(1);
+    EXPECT_EQ(DELAY_MS, runMillis);
+    EXPECT_FALSE(timers.isScheduled(job));
+}
+
+
+TEST_F(TimerWheelTest, CountsOverrunsAndLateness)
+{
+    int job = timers.addPeriodic("Periodic", 100, []() {}, 100);
+
+    Host::advanceMillis(105);
+    timers.run(); // 5 ms late
+    Host::advanceMillis(105);
+    timers.run(); // 10 ms late
+    Host::advanceMillis(340);
+    timers.run(); // Due at 300; 250 ms late, skipping the periods due at 400 and 500
+
+    const TimerJobStats& stats = timers.getJobStats(job);
+    EXPECT_EQ(3U, stats.runs);
+    EXPECT_EQ(2U, stats.overruns);
+    EXPECT_EQ(250U, stats.maxLatenessMs);
+    EXPECT_FLOAT_EQ(265.0F / 3, stats.getAvgLatenessMs());
+
+    // The next deadline stays on the original grid
+    EXPECT_EQ(50U, timers.getTimeToNext());
+}
+
+
+TEST_F(TimerWheelTest, ReportsTimeToNextDeadline)
+{
+    EXPECT_EQ(UINT32_MAX, timers.getTimeToNext());
+
+    int job = timers.addJob("OneShot", []() {});
+    timers.schedule(job, 250);
+    EXPECT_EQ(250U, timers.getTimeToNext());
+    Host::advanceMillis(100);
+    EXPECT_EQ(150U, timers.run());
+    Host::advanceMillis(200);
+    EXPECT_EQ(0U, timers.getTimeToNext()); // Overdue
+
+    timers.run();
+    EXPECT_EQ(UINT32_MAX, timers.getTimeToNext());
+}
+
+
+TEST_F(TimerWheelTest, RoundsDeadlinesUpToTicks)
+{
+    TimerWheel coarseTimers(10);
+    int job = coarseTimers.addJob("OneShot", []() {});
+    coarseTimers.schedule(job, 25);
+    EXPECT_EQ(30U, coarseTimers.getTimeToNext());
+
+    Host::advanceMillis(25);
+    coarseTimers.run();
+    EXPECT_EQ(0U, coarseTimers.getJobStats(job).runs); // Not before the tick boundary
+    Host::advanceMillis(5);
+    coarseTimers.run();
+    EXPECT_EQ(1U, coarseTimers.getJobStats(job).runs);
+}
+
+
+TEST_F(TimerWheelTest, WakeEndsSleepEarly)
+{
+    timers.addPeriodic("Slow", 10000, []() {}, 10000);
+
+    // Like an event handled by another task (e.g. the UART event task)
+    std::thread waker([this]()
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        timers.wake();
+    });
+    auto startTime = std::chrono::steady_clock::now();
+    bool isWoken = timers.sleep(2000);
+    auto sleptMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count();
+    waker.join();
+
+    EXPECT_TRUE(isWoken);
+    EXPECT_LT(sleptMs, 1000);
+    EXPECT_EQ(1U, timers.getStats().sleeps);
+    EXPECT_EQ(1U, timers.getStats().wakeups);
+}
+
+
+TEST_F(TimerWheelTest, KeepsWakeFromISRBeforeSleep)
+{
+    constexpr uint8_t EVENT_PIN = 5;
+    timers.addPeriodic("Slow", 10000, []() {}, 10000);
+    attachInterruptArg(EVENT_PIN, [](void* arg) { static_cast<TimerWheel*>(arg)->wakeFromISR(); }, &timers, FALLING);
+
+    EXPECT_FALSE(timers.sleep(1)); // The first sleep registers the loop task
+    Host::triggerInterrupt(EVENT_PIN);
+    EXPECT_TRUE(timers.sleep(2000)); // Ends immediately
+    EXPECT_FALSE(timers.sleep(1));
+    detachInterrupt(EVENT_PIN);
+
+    EXPECT_EQ(1U, timers.getStats().wakeups);
+}
@@ -0,0 +1,215 @@
+#include <gtest/gtest.h>
+#include <Arduino.h>
+#include <NetworkClient.h>
+#include <WebSocketClient.h>
+#include <StandInServer.h>
+#include <mbedtls/base64.h>
+#include <mbedtls/sha1.h>
+#include <string>
+#include <vector>
+
+constexpr uint32_t RECEIVE_TIMEOUT_MS = 500;
+
+struct WebSocketFrame
+{
+    uint8_t opcode = 0xFF;
+    std::string payload;
+};
+
+
+// Server side of the WebSocket protocol, as far as the tests need it.
+class WebSocketStandIn
+{
+    public:
+        static bool acceptUpgrade(StandInConnection& connection)
+        {
+            std::string line;
+            std::string key;
+            const std::string keyHeader = "Sec-WebSocket-Key: ";
+            while (connection.readLine(line) && !line.empty())
+            {
+                if (line.compare(0, keyHeader.size(), keyHeader) == 0)
+                    key = line.substr(keyHeader.size());
+            }
+            if (key.empty()) return false;
+
+            std::string acceptSource = key + "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+            uint8_t hash[20];
+            mbedtls_sha1(reinterpret_cast<const uint8_t*>(acceptSource.data()), acceptSource.size(), hash);
+            char accept[32];
+            size_t acceptLength;
+            mbedtls_base64_encode(reinterpret_cast<uint8_t*>(accept), sizeof(accept), &acceptLength, hash, sizeof(hash));
+
+            return connection.write(
+                "HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+                "Sec-WebSocket-Accept: " + std::string(accept, acceptLength) + "\r\n\r\n");
+        }
+
+        // Server frames are not masked
+        static bool sendFrame(StandInConnection& connection, uint8_t opcode, const std::string& payload, bool isFinal = true)
+        {
+            std::string frame;
+            frame += static_cast<char>((isFinal ? 0x80 : 0) | opcode);
+            if (payload.size() < 126)
+                frame += static_cast<char>(payload.size());
+            else
+            {
+                frame += static_cast<char>(126);
+                frame += static_cast<char>(payload.size() >> 8);
+                frame += static_cast<char>(payload.size() & 0xFF);
+            }
+            return connection.write(frame + payload);
+        }
+
+        static bool receiveFrame(StandInConnection& connection, WebSocketFrame& frame)
+        {
+            uint8_t header[2];
+            if (!connection.read(header, sizeof(header))) return false;
+            frame.opcode = header[0] & 0x0F;
+            size_t length = header[1] & 0x7F;
+            if (length == 126)
+            {
+                uint8_t extendedLength[2];
+                if (!connection.read(extendedLength, sizeof(extendedLength))) return false;
+                length = (extendedLength[0] << 8) | extendedLength[1];
+            }
+            uint8_t mask[4];
+            if (!connection.read(mask, sizeof(mask))) return false;
+            frame.payload.resize(length);
+            if ((length != 0) && !connection.read(&frame.payload[0], length)) return false;
+            for (size_t i = 0; i < length; i++)
+                frame.payload[i] ^= mask[i % 4];
+            return true;
+        }
+};
+
+
+class WebSocketClientTest : public testing::Test
+{
+    protected:
+        NetworkClient tcpClient;
+        WebSocketClient webSocket { tcpClient };
+        char message[64];
+
+        bool connect(StandInServer& server)
+        {
+            return webSocket.connect("127.0.0.1", server.getPort(), "/api/ws", 2000);
+        }
+};
+
+
+TEST_F(WebSocketClientTest, ReceivesTextMessage)
+{
+    StandInServer server([](StandInConnection& connection)
+    {
+        if (!WebSocketStandIn::acceptUpgrade(connection)) return;
+        WebSocketStandIn::sendFrame(connection, 0x1, "{\"type\":\"measurement\"}");
+        connection.awaitClosed();
+    });
+
+    ASSERT_TRUE(connect(server)) << webSocket.getLastError().c_str();
+    EXPECT_EQ(22, webSocket.receive(message, sizeof(message), RECEIVE_TIMEOUT_MS));
+    EXPECT_STREQ("{\"type\":\"measurement\"}", message);
+    EXPECT_EQ(0, webSocket.receive(message, sizeof(message), 50)); // Nothing more
+    webSocket.close();
+}
+
+
+TEST_F(WebSocketClientTest, AnswersPing)
+{
+    WebSocketFrame pong;
+    StandInServer server([&pong](StandInConnection& connection)
+    {
+        if (!WebSocketStandIn::acceptUpgrade(connection)) return;
+        WebSocketStandIn::sendFrame(connection, 0x9, "ping!");
+        WebSocketStandIn::receiveFrame(connection, pong);
+        WebSocketStandIn::sendFrame(connection, 0x1, "after ping");
+        connection.awaitClosed();
+    });
+
+    ASSERT_TRUE(connect(server));
+    EXPECT_EQ(10, webSocket.receive(message, sizeof(message), RECEIVE_TIMEOUT_MS));
+    webSocket.close();
+    server.stop();
+
+    EXPECT_EQ(0xA, pong.opcode);
+    EXPECT_EQ("ping!", pong.payload);
+}
+
+
+TEST_F(WebSocketClientTest, ClosesOnOversizedPing)
+{
+    WebSocketFrame closeFrame;
+    StandInServer server([&closeFrame](StandInConnection& connection)
+    {
+        if (!WebSocketStandIn::acceptUpgrade(connection)) return;
+        WebSocketStandIn::sendFrame(connection, 0x9, std::string(200, 'p'));
+        WebSocketStandIn::receiveFrame(connection, closeFrame);
+        connection.awaitClosed();
+    });
+
+    ASSERT_TRUE(connect(server));
+    EXPECT_EQ(-1, webSocket.receive(message, sizeof(message), RECEIVE_TIMEOUT_MS));
+    EXPECT_FALSE(webSocket.isConnected());
+    server.stop();
+
+    EXPECT_EQ(0x8, closeFrame.opcode);
+    ASSERT_EQ(2U, closeFrame.payload.size());
+    EXPECT_EQ(WEBSOCKET_PROTOCOL_ERROR, (uint8_t(closeFrame.payload[0]) << 8) | uint8_t(closeFrame.payload[1]));
+}
+
+
+TEST_F(WebSocketClientTest, ReassemblesFragments)
+{
+    StandInServer server([](StandInConnection& connection)
+    {
+        if (!WebSocketStandIn::acceptUpgrade(connection)) return;
+        WebSocketStandIn::sendFrame(connection, 0x1, "Hello, ", false);
+        WebSocketStandIn::sendFrame(connection, 0x9, "ping"); // Control frames may be interleaved
+        WebSocketStandIn::sendFrame(connection, 0x0, "fragmented ", false);
+        WebSocketStandIn::sendFrame(connection, 0x0, "world");
+        connection.awaitClosed();
+    });
+
+    ASSERT_TRUE(connect(server));
+    EXPECT_EQ(23, webSocket.receive(message, sizeof(message), RECEIVE_TIMEOUT_MS));
+    EXPECT_STREQ("Hello, fragmented world", message);
+    webSocket.close();
+}
+
+
+TEST_F(WebSocketClientTest, ClosesIfFragmentsStall)
+{
+    StandInServer server([](StandInConnection& connection)
+    {
+        if (!WebSocketStandIn::acceptUpgrade(connection)) return;
+        WebSocketStandIn::sendFrame(connection, 0x1, "Incomplete", false);
+        connection.awaitClosed();
+    });
+
+    ASSERT_TRUE(connect(server));
+    uint32_t startMillis = millis();
+    EXPECT_EQ(-1, webSocket.receive(message, sizeof(message), 200));
+    EXPECT_LT(millis() - startMillis, 1000U);
+    EXPECT_STREQ("Fragment timeout", webSocket.getLastError().c_str());
+    EXPECT_FALSE(webSocket.isConnected());
+}
+
+
+TEST_F(WebSocketClientTest, ClosesOnUnexpectedContinuation)
+{
+    WebSocketFrame closeFrame;
+    StandInServer server([&closeFrame](StandInConnection& connection)
+    {
+        if (!WebSocketStandIn::acceptUpgrade(connection)) return;
+        WebSocketStandIn::sendFrame(connection, 0x0, "orphan");
+        WebSocketStandIn::receiveFrame(connection, closeFrame);
+        connection.awaitClosed();
+    });
+
+    ASSERT_TRUE(connect(server));
+    EXPECT_EQ(-1, webSocket.receive(message, sizeof(message), RECEIVE_TIMEOUT_MS));
+    server.stop();
+
+    EXPECT_EQ(0x8, closeFrame.opcode);
+}
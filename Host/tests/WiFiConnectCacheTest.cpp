@@ -0,0 +1,154 @@
+#include <gtest/gtest.h>
+#include <Arduino.h>
+#include <WiFi.h>
+#include <WiFiConnectCache.h>
+#include <stddef.h>
+
+// The cache lives in RTC memory; on the host that is a plain global.
+extern WiFiConnectCacheData _wifiConnectCacheData;
+
+
+class WiFiConnectCacheTest : public testing::Test
+{
+    protected:
+        WiFiConnectCache cache;
+
+        void SetUp() override
+        {
+            memset(&_wifiConnectCacheData, 0, sizeof(_wifiConnectCacheData));
+        }
+
+        // Stores the current connection and loads it again, like after a reset.
+        bool storeAndReload(bool includeLease, const char* ssid = "home")
+        {
+            cache.begin("home");
+            cache.store(includeLease);
+            cache = WiFiConnectCache();
+            return cache.begin(ssid);
+        }
+
+        // Ages the stored data; the checksum is updated, so only the refresh time is checked.
+        static void setRefreshTime(time_t refreshTime)
+        {
+            _wifiConnectCacheData.refreshTime = refreshTime;
+            _wifiConnectCacheData.checksum = getChecksum();
+        }
+
+        static uint32_t getChecksum()
+        {
+            // FNV-1a over the data before the checksum
+            const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&_wifiConnectCacheData);
+            uint32_t hash = 2166136261;
+            for (size_t i = 0; i < offsetof(WiFiConnectCacheData, checksum); i++)
+            {
+                hash ^= bytes[i];
+                hash *= 16777619;
+            }
+            return hash;
+        }
+
+        bool getLease()
+        {
+            IPAddress ipAddress, gateway, subnetMask, dns;
+            return cache.getLease(ipAddress, gateway, subnetMask, dns);
+        }
+};
+
+
+TEST_F(WiFiConnectCacheTest, RestoresConnectionAfterReset)
+{
+    EXPECT_FALSE(cache.begin("home"));
+    ASSERT_TRUE(storeAndReload(true));
+
+    EXPECT_EQ(0, memcmp(WiFi.BSSID(), cache.getBSSID(), 6));
+    EXPECT_EQ(WiFi.channel(), cache.getChannel());
+    IPAddress ipAddress, gateway, subnetMask, dns;
+    ASSERT_TRUE(cache.getLease(ipAddress, gateway, subnetMask, dns));
+    EXPECT_EQ(WiFi.localIP(), ipAddress);
+    EXPECT_EQ(WiFi.gatewayIP(), gateway);
+    EXPECT_EQ(WiFi.subnetMask(), subnetMask);
+    EXPECT_EQ(WiFi.dnsIP(), dns);
+}
+
+
+TEST_F(WiFiConnectCacheTest, RejectsGarbage)
+{
+    // RTC memory contains garbage after a power cycle
+    memset(&_wifiConnectCacheData, 0x5A, sizeof(_wifiConnectCacheData));
+    EXPECT_FALSE(cache.begin("home"));
+    EXPECT_FALSE(getLease());
+}
+
+
+TEST_F(WiFiConnectCacheTest, RejectsWrongMagic)
+{
+    ASSERT_TRUE(storeAndReload(true));
+
+    _wifiConnectCacheData.magic = WIFI_CONNECT_CACHE_MAGIC + 1;
+    _wifiConnectCacheData.checksum = getChecksum();
+    EXPECT_FALSE(cache.begin("home"));
+    EXPECT_FALSE(getLease());
+}
+
+
+TEST_F(WiFiConnectCacheTest, RejectsWrongChecksum)
+{
+    ASSERT_TRUE(storeAndReload(true));
+
+    _wifiConnectCacheData.ipAddress ^= 1;
+    EXPECT_FALSE(cache.begin("home"));
+    EXPECT_EQ(0, cache.getChannel()); // Cleared
+}
+
+
+TEST_F(WiFiConnectCacheTest, RejectsOtherSSID)
+{
+    EXPECT_FALSE(storeAndReload(true, "guest"));
+    EXPECT_FALSE(getLease());
+    EXPECT_TRUE(cache.begin("home"));
+}
+
+
+TEST_F(WiFiConnectCacheTest, RejectsExpiredLease)
+{
+    ASSERT_TRUE(storeAndReload(true));
+    time_t currentTime = time(nullptr);
+
+    setRefreshTime(currentTime - WIFI_LEASE_REUSE_SECONDS + 10);
+    ASSERT_TRUE(cache.begin("home"));
+    EXPECT_TRUE(getLease());
+
+    setRefreshTime(currentTime - WIFI_LEASE_REUSE_SECONDS - 10);
+    ASSERT_TRUE(cache.begin("home"));
+    EXPECT_FALSE(getLease());
+
+    // Stored in the future; the system time isn't right, so the age is unknown.
+    setRefreshTime(currentTime + 60);
+    ASSERT_TRUE(cache.begin("home"));
+    EXPECT_FALSE(getLease());
+
+    setRefreshTime(0);
+    ASSERT_TRUE(cache.begin("home"));
+    EXPECT_FALSE(getLease());
+}
+
+
+TEST_F(WiFiConnectCacheTest, KeepsAccessPointWithoutLease)
+{
+    // A reused lease isn't renewed, so it's not stored again.
+    ASSERT_TRUE(storeAndReload(false));
+    EXPECT_EQ(WiFi.channel(), cache.getChannel());
+    EXPECT_FALSE(getLease());
+}
+
+
+TEST_F(WiFiConnectCacheTest, Invalidates)
+{
+    ASSERT_TRUE(storeAndReload(true));
+    cache.invalidate();
+    EXPECT_FALSE(cache.isValid());
+    EXPECT_FALSE(getLease());
+
+    cache = WiFiConnectCache();
+    EXPECT_FALSE(cache.begin("home"));
+}
@@ -0,0 +1,91 @@
+#include <gtest/gtest.h>
+#include <Arduino.h>
+#include <WiFiFTP.h>
+#include <FTPStandIn.h>
+#include <string>
+#include <vector>
+
+constexpr int FTP_TIMEOUT_MS = 2000;
+
+
+class WiFiFTPTest : public testing::Test
+{
+    protected:
+        WiFiFTPClient ftpClient { FTP_TIMEOUT_MS };
+
+        void SetUp() override
+        {
+            ftpClient.setIdleTimeout(60);
+        }
+
+        bool sync(FTPStandIn& server, const char* userName, const char* password, const char* data)
+        {
+            ftpClient.beginAsync("127.0.0.1", userName, password, server.getPort());
+            ftpClient.appendAsync("log.txt", [data](Print& output) { output.print(data); });
+            bool success = ftpClient.run();
+            EXPECT_TRUE(success) << ftpClient.getLastError();
+            return success;
+        }
+};
+
+
+TEST_F(WiFiFTPTest, ReusesSessionForSameServer)
+{
+    FTPStandIn server;
+
+    ASSERT_TRUE(sync(server, "user", "secret", "first;"));
+    ASSERT_TRUE(sync(server, "user", "secret", "second;"));
+    ftpClient.end();
+
+    EXPECT_EQ(1, server.getConnectionCount());
+    EXPECT_EQ(1U, ftpClient.getStats().sessions);
+    EXPECT_EQ(1U, ftpClient.getStats().reusedSessions);
+    EXPECT_EQ("first;second;", server.getData());
+}
+
+
+TEST_F(WiFiFTPTest, LogsInAgainIfCredentialsChange)
+{
+    FTPStandIn server;
+
+    ASSERT_TRUE(sync(server, "user", "secret", "first;"));
+    ASSERT_TRUE(sync(server, "other", "secret", "second;"));
+    ASSERT_TRUE(sync(server, "other", "changed", "third;"));
+    ftpClient.end();
+
+    EXPECT_EQ(3, server.getConnectionCount());
+    EXPECT_EQ(3U, ftpClient.getStats().sessions);
+    EXPECT_EQ(0U, ftpClient.getStats().reusedSessions);
+
+    std::vector<std::string> commands = server.getCommands();
+    std::vector<std::string> logins;
+    for (const std::string& command : commands)
+    {
+        if ((command.compare(0, 4, "USER") == 0) || (command.compare(0, 4, "PASS") == 0) || (command == "QUIT"))
+            logins.push_back(command);
+    }
+    std::vector<std::string> expected =
+    {
+        "USER user", "PASS secret", "QUIT",
+        "USER other", "PASS secret", "QUIT",
+        "USER other", "PASS changed", "QUIT"
+    };
+    EXPECT_EQ(expected, logins);
+}
+
+
+TEST_F(WiFiFTPTest, LogsInAgainIfServerChanges)
+{
+    FTPStandIn server;
+    FTPStandIn otherServer;
+
+    ASSERT_TRUE(sync(server, "user", "secret", "first;"));
+    ASSERT_TRUE(sync(otherServer, "user", "secret", "second;"));
+    ftpClient.end();
+
+    EXPECT_EQ(1, otherServer.getConnectionCount());
+    EXPECT_EQ(2U, ftpClient.getStats().sessions);
+    EXPECT_EQ(0U, ftpClient.getStats().reusedSessions);
+    EXPECT_EQ("first;", server.getData());
+    EXPECT_EQ("second;", otherServer.getData());
+}
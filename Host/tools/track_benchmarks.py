@@ -0,0 +1,105 @@
+#!/usr/bin/env python3
+"""Runs the host benchmarks and tracks the results over time.
+
+Each run is stored as Google Benchmark JSON in the results directory, named after the date and
+the git commit. The run is compared against the previous result file and regressions are reported.
+
+Usage:
+    track_benchmarks.py run <benchmark binary> [--results-dir DIR] [--threshold PCT]
+    track_benchmarks.py compare <old.json> <new.json> [--threshold PCT]
+"""
+
+import argparse
+import datetime
+import json
+import os
+import subprocess
+import sys
+
+DEFAULT_THRESHOLD = 10.0 # Percent
+
+
+def get_commit():
+    try:
+        return subprocess.check_output(
+            ["git", "rev-parse", "--short", "HEAD"],
+            stderr=subprocess.DEVNULL,
+            text=True).strip()
+    except (OSError, subprocess.CalledProcessError):
+        return "unknown"
+
+
+def load_times(path):
+    with open(path) as file:
+        data = json.load(file)
+    times = {}
+    for benchmark in data.get("benchmarks", []):
+        if benchmark.get("error_occurred") or benchmark.get("run_type") == "aggregate":
+            continue
+        times[benchmark["name"]] = benchmark["cpu_time"]
+    return times
+
+
+def compare(old_path, new_path, threshold):
+    old_times = load_times(old_path)
+    new_times = load_times(new_path)
+    regressions = 0
+    print(f"Comparing {os.path.basename(new_path)} against {os.path.basename(old_path)}")
+    for name, new_time in sorted(new_times.items()):
+        old_time = old_times.get(name)
+        if not old_time:
+            print(f"  {name:60} (new)")
+            continue
+        change = (new_time - old_time) * 100.0 / old_time
+        marker = ""
+        if change > threshold:
+            marker = "  <-- REGRESSION"
+            regressions += 1
+        print(f"  {name:60} {change:+7.1f}%{marker}")
+    return regressions
+
+
+def run(binary, results_dir, threshold):
+    os.makedirs(results_dir, exist_ok=True)
+    previous = sorted(f for f in os.listdir(results_dir) if f.endswith(".json"))
+
+    timestamp = datetime.datetime.now().strftime("%Y%m%d-%H%M%S")
+    result_path = os.path.join(results_dir, f"{timestamp}-{get_commit()}.json")
+    subprocess.check_call([
+        binary,
+        f"--benchmark_out={result_path}",
+        "--benchmark_out_format=json"])
+    print(f"Results written to {result_path}")
+
+    if not previous:
+        return 0
+    return compare(os.path.join(results_dir, previous[-1]), result_path, threshold)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Track host benchmark results")
+    commands = parser.add_subparsers(dest="command", required=True)
+
+    run_parser = commands.add_parser("run")
+    run_parser.add_argument("binary")
+    run_parser.add_argument("--results-dir", default=os.path.join(os.path.dirname(__file__), "..", "results"))
+    run_parser.add_argument("--threshold", type=float, default=DEFAULT_THRESHOLD)
+
+    compare_parser = commands.add_parser("compare")
+    compare_parser.add_argument("old")
+    compare_parser.add_argument("new")
+    compare_parser.add_argument("--threshold", type=float, default=DEFAULT_THRESHOLD)
+
+    args = parser.parse_args()
+    if args.command == "run":
+        regressions = run(args.binary, args.results_dir, args.threshold)
+    else:
+        regressions = compare(args.old, args.new, args.threshold)
+
+    if regressions:
+        print(f"{regressions} benchmark(s) regressed more than {args.threshold}%")
+    return 1 if regressions else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
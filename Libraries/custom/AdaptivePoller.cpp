@@ -0,0 +1,48 @@
+#include "AdaptivePoller.h"
+#include <math.h>
+#include <algorithm>
+
+
+void AdaptivePoller::setLimits(uint32_t minIntervalMs, uint32_t maxIntervalMs)
+{
+    _minIntervalMs = minIntervalMs;
+    _maxIntervalMs = maxIntervalMs;
+    _intervalMs = std::min(std::max(_intervalMs, minIntervalMs), maxIntervalMs);
+}
+
+
+bool AdaptivePoller::isDue(uint32_t currentMillis)
+{
+    uint32_t elapsedMs = currentMillis - _lastPollMillis;
+    if (_hasPolled && (elapsedMs < getIntervalMs())) return false;
+
+    _lastIntervalMs = _hasPolled ? elapsedMs : 0;
+    _lastPollMillis = currentMillis;
+    _hasPolled = true;
+    _stats.polls++;
+    if (_isActive) _stats.activePolls++;
+    return true;
+}
+
+
+void AdaptivePoller::update(float value)
+{
+    float delta = fabsf(value - _lastValue);
+    bool isFirst = !_hasValue;
+    _lastValue = value;
+    _hasValue = true;
+    if (isFirst) return;
+
+    if (delta > _changeThreshold)
+    {
+        uint32_t newIntervalMs = std::max(_intervalMs / 2, _minIntervalMs);
+        if (newIntervalMs < _intervalMs) _stats.speedUps++;
+        _intervalMs = newIntervalMs;
+    }
+    else
+    {
+        uint32_t newIntervalMs = std::min(_intervalMs + std::max<uint32_t>(_intervalMs / 4, 1), _maxIntervalMs);
+        if (newIntervalMs > _intervalMs) _stats.slowDowns++;
+        _intervalMs = newIntervalMs;
+    }
+}
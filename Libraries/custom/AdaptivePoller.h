@@ -0,0 +1,55 @@
+#ifndef ADAPTIVE_POLLER_H
+#define ADAPTIVE_POLLER_H
+
+#include <stdint.h>
+
+struct AdaptivePollerStats
+{
+    uint32_t polls = 0;
+    uint32_t activePolls = 0; // Polls at minimum interval because a control loop is active
+    uint32_t speedUps = 0; // Interval shortened because the reading changed
+    uint32_t slowDowns = 0; // Interval lengthened because the reading was stable
+};
+
+// Determines when to poll a value, based on how quickly it changes.
+// The interval halves when a reading differs more than the threshold from the previous one,
+// and grows by 25% while readings are stable; it always stays within the given limits.
+class AdaptivePoller
+{
+    public:
+        AdaptivePoller(uint32_t minIntervalMs, uint32_t maxIntervalMs, float changeThreshold)
+            : _minIntervalMs(minIntervalMs), _maxIntervalMs(maxIntervalMs), _intervalMs(minIntervalMs),
+            _changeThreshold(changeThreshold) {}
+
+        void setLimits(uint32_t minIntervalMs, uint32_t maxIntervalMs);
+        void setChangeThreshold(float threshold) { _changeThreshold = threshold; }
+
+        // While active (e.g. a control loop depends on the value) the minimum interval is used.
+        void setActive(bool isActive) { _isActive = isActive; }
+        bool isActive() const { return _isActive; }
+
+        // Returns true if a poll is due; the poll is then considered started.
+        bool isDue(uint32_t currentMillis);
+
+        // Records a new reading and adapts the interval.
+        void update(float value);
+
+        uint32_t getIntervalMs() const { return _isActive ? _minIntervalMs : _intervalMs; }
+        uint32_t getLastIntervalMs() const { return _lastIntervalMs; } // Between the last two polls
+        const AdaptivePollerStats& getStats() const { return _stats; }
+
+    private:
+        uint32_t _minIntervalMs;
+        uint32_t _maxIntervalMs;
+        uint32_t _intervalMs;
+        float _changeThreshold;
+        bool _isActive = false;
+        bool _hasPolled = false;
+        bool _hasValue = false;
+        float _lastValue = 0;
+        uint32_t _lastPollMillis = 0;
+        uint32_t _lastIntervalMs = 0;
+        AdaptivePollerStats _stats;
+};
+
+#endif
@@ -0,0 +1,107 @@
+#include <Arduino.h>
+#include "CircuitBreaker.h"
+#include <Tracer.h>
+
+#ifdef ESP32
+#define CIRCUIT_LOCK() portENTER_CRITICAL(&_mux)
+#define CIRCUIT_UNLOCK() portEXIT_CRITICAL(&_mux)
+#else
+// No tasks on ESP8266
+#define CIRCUIT_LOCK()
+#define CIRCUIT_UNLOCK()
+#endif
+
+static const char* _circuitStateLabels[] = { "Closed", "Open", "Half open" };
+
+
+const char* CircuitBreaker::getStateLabel() const
+{
+    return _circuitStateLabels[static_cast<int>(_state)];
+}
+
+
+bool CircuitBreaker::allowRequest()
+{
+    return allowRequest(millis());
+}
+
+
+bool CircuitBreaker::allowRequest(uint32_t currentMillis)
+{
+    CIRCUIT_LOCK();
+    // While a probe is in progress, another one is only allowed if its result got lost (e.g. it expired).
+    bool isAllowed = (_state == CircuitState::Closed) || ((int32_t)(currentMillis - _retryMillis) >= 0);
+    bool isProbe = isAllowed && (_state != CircuitState::Closed);
+    if (isProbe)
+    {
+        _state = CircuitState::HalfOpen;
+        _retryMillis = currentMillis + _backoffMs;
+    }
+    else if (!isAllowed)
+        _stats.rejected++;
+    CIRCUIT_UNLOCK();
+
+    if (isProbe) TRACE(F("CircuitBreaker: probing after %u ms\n"), _backoffMs);
+    return isAllowed;
+}
+
+
+void CircuitBreaker::recordSuccess()
+{
+    CIRCUIT_LOCK();
+    bool wasOpen = (_state != CircuitState::Closed);
+    _state = CircuitState::Closed;
+    _consecutiveFailures = 0;
+    _backoffMs = 0;
+    CIRCUIT_UNLOCK();
+
+    if (wasOpen) TRACE(F("CircuitBreaker: closed\n"));
+}
+
+
+void CircuitBreaker::recordFailure()
+{
+    recordFailure(millis());
+}
+
+
+void CircuitBreaker::recordFailure(uint32_t currentMillis)
+{
+    CIRCUIT_LOCK();
+    _stats.failures++;
+    if (_consecutiveFailures < UINT8_MAX) _consecutiveFailures++;
+
+    if ((_state == CircuitState::Closed) && (_consecutiveFailures < _failureThreshold))
+    {
+        CIRCUIT_UNLOCK();
+        return;
+    }
+
+    // Open the circuit or, if the probe failed, double the delay.
+    if (_state == CircuitState::Closed)
+    {
+        _stats.trips++;
+        _backoffMs = _minBackoffMs;
+    }
+    else
+        _backoffMs = std::min(_backoffMs * 2, _maxBackoffMs);
+
+    // Jitter of +/- 25% prevents peers from being probed in lockstep
+    uint32_t jitterMs = _backoffMs / 4;
+    uint32_t delayMs = _backoffMs - jitterMs + random(2 * jitterMs + 1);
+    _state = CircuitState::Open;
+    _retryMillis = currentMillis + delayMs;
+    CIRCUIT_UNLOCK();
+
+    TRACE(F("CircuitBreaker: open for %u ms\n"), delayMs);
+}
+
+
+void CircuitBreaker::reset()
+{
+    CIRCUIT_LOCK();
+    _state = CircuitState::Closed;
+    _consecutiveFailures = 0;
+    _backoffMs = 0;
+    CIRCUIT_UNLOCK();
+}
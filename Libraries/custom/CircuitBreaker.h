@@ -0,0 +1,65 @@
+#ifndef CIRCUIT_BREAKER_H
+#define CIRCUIT_BREAKER_H
+
+#include <stdint.h>
+#ifdef ESP32
+#include <freertos/FreeRTOS.h>
+#endif
+
+enum struct CircuitState : uint8_t
+{
+    Closed = 0, // Requests are allowed
+    Open, // Requests are rejected until the retry time
+    HalfOpen // A single probe request is in progress
+};
+
+struct CircuitBreakerStats
+{
+    uint32_t failures = 0;
+    uint32_t rejected = 0; // Requests not attempted because the circuit was open
+    uint32_t trips = 0; // Number of times the circuit opened
+};
+
+// Stops requests to a peer which is down, so a dead peer doesn't stall the caller with connect timeouts.
+// Opens after a number of consecutive failures and then probes with jittered exponential delays.
+// The state changes are guarded by a spinlock, so a breaker can be shared by a background task and the loop.
+class CircuitBreaker
+{
+    public:
+        CircuitBreaker(uint8_t failureThreshold = 3, uint32_t minBackoffMs = 5000, uint32_t maxBackoffMs = 300000)
+            : _failureThreshold(failureThreshold), _minBackoffMs(minBackoffMs), _maxBackoffMs(maxBackoffMs) {}
+
+        CircuitState getState() const { return _state; }
+        const char* getStateLabel() const;
+        bool isOpen() const { return _state != CircuitState::Closed; }
+        uint32_t getBackoffMs() const { return _backoffMs; }
+        uint32_t getRetryMillis() const { return _retryMillis; }
+        const CircuitBreakerStats& getStats() const { return _stats; }
+
+        // Returns false if the request should not be attempted.
+        // If the retry time has passed, one probe request is allowed.
+        bool allowRequest(uint32_t currentMillis);
+        bool allowRequest();
+
+        void recordSuccess();
+        void recordFailure(uint32_t currentMillis);
+        void recordFailure();
+
+        // Closes the circuit, e.g. after the peer's configuration changed.
+        void reset();
+
+    private:
+        uint8_t _failureThreshold;
+        uint32_t _minBackoffMs;
+        uint32_t _maxBackoffMs;
+        volatile CircuitState _state = CircuitState::Closed;
+        uint8_t _consecutiveFailures = 0;
+        uint32_t _backoffMs = 0;
+        uint32_t _retryMillis = 0;
+        CircuitBreakerStats _stats;
+#ifdef ESP32
+        portMUX_TYPE _mux = portMUX_INITIALIZER_UNLOCKED;
+#endif
+};
+
+#endif
@@ -0,0 +1,239 @@
+#include <Arduino.h>
+#include "FlightRecorder.h"
+#include <PSRAM.h>
+
+bool FlightRecorder::_isInitialized = false;
+bool FlightRecorder::_recordTrace = false;
+FlightRecorderData* FlightRecorder::_previousPtr = nullptr;
+
+#ifdef ESP32
+#if (ESP_ARDUINO_VERSION_MAJOR == 2)
+#include <esp_ota_ops.h>
+#define esp_app_get_description esp_ota_get_app_description
+#else
+#include <esp_app_desc.h>
+#endif
+
+RTC_NOINIT_ATTR FlightRecorderData _flightRecorderData;
+portMUX_TYPE _flightRecorderMux = portMUX_INITIALIZER_UNLOCKED;
+
+
+uint32_t FlightRecorder::getFirmwareId()
+{
+    uint32_t firmwareId;
+    memcpy(&firmwareId, esp_app_get_description()->app_elf_sha256, sizeof(firmwareId));
+    return firmwareId;
+}
+
+
+void FlightRecorder::begin(bool recordTrace)
+{
+    _recordTrace |= recordTrace;
+    if (_isInitialized) return;
+
+    FlightRecorderData& data = _flightRecorderData;
+    uint32_t bootCount = 0;
+    if ((data.magic == FLIGHT_RECORDER_MAGIC) && (esp_reset_reason() != ESP_RST_POWERON))
+    {
+        // Keep a copy of the previous run for the post-mortem report
+        _previousPtr = Memory::allocate<FlightRecorderData>(1);
+        if (_previousPtr != nullptr)
+            memcpy(_previousPtr, &data, sizeof(FlightRecorderData));
+        bootCount = data.bootCount + 1;
+    }
+
+    memset(&data, 0, sizeof(FlightRecorderData));
+    data.magic = FLIGHT_RECORDER_MAGIC;
+    data.bootCount = bootCount;
+    data.firmwareId = getFirmwareId();
+
+    _isInitialized = true;
+}
+
+
+IRAM_ATTR FlightRecorderEvent& FlightRecorder::claimEventSlot()
+{
+    // Copying the event can be done outside the critical section.
+    // The _SAFE variants also work if the event is logged from an ISR.
+    FlightRecorderData& data = _flightRecorderData;
+    portENTER_CRITICAL_SAFE(&_flightRecorderMux);
+    FlightRecorderEvent& entry = data.events[data.eventIndex];
+    data.eventIndex = (data.eventIndex + 1) % FLIGHT_RECORDER_EVENTS;
+    if (data.eventCount < FLIGHT_RECORDER_EVENTS) data.eventCount++;
+    portEXIT_CRITICAL_SAFE(&_flightRecorderMux);
+    return entry;
+}
+
+
+void FlightRecorder::recordEvent(const char* event)
+{
+    if (!_isInitialized) return;
+
+    FlightRecorderEvent& entry = claimEventSlot();
+    entry.type = FlightRecorderEventType::Text;
+    strncpy(entry.text, event, FLIGHT_RECORDER_EVENT_SIZE - 1);
+    entry.text[FLIGHT_RECORDER_EVENT_SIZE - 1] = 0;
+}
+
+
+IRAM_ATTR void FlightRecorder::recordEvent(const StructuredEvent& event)
+{
+    if (!_isInitialized) return;
+
+    // Arguments are kept in binary form; the event is formatted when the report is written.
+    FlightRecorderEvent& entry = claimEventSlot();
+    entry.type = FlightRecorderEventType::Structured;
+    memcpy(&entry.structured, &event, sizeof(StructuredEvent));
+}
+
+
+void FlightRecorder::recordTrace(const char* msg)
+{
+    // Note: callers serialize access (see Tracer::trace)
+    if (!_isInitialized || !_recordTrace) return;
+
+    FlightRecorderData& data = _flightRecorderData;
+    for (const char* charPtr = msg; *charPtr != 0; charPtr++)
+    {
+        data.trace[data.traceIndex++] = *charPtr;
+        if (data.traceIndex == FLIGHT_RECORDER_TRACE_SIZE)
+        {
+            data.traceIndex = 0;
+            data.traceWrapped = 1;
+        }
+    }
+}
+
+
+void FlightRecorder::recordLoop()
+{
+    if (!_isInitialized) return;
+
+    const char* taskName = pcTaskGetName(nullptr);
+    uint32_t currentMillis = millis();
+
+    FlightRecorderTask* taskPtr = nullptr;
+    for (int i = 0; i < FLIGHT_RECORDER_TASKS; i++)
+    {
+        FlightRecorderTask& task = _flightRecorderData.tasks[i];
+        if (task.name[0] == 0)
+        {
+            // Claim a free slot (another task may beat us to it)
+            portENTER_CRITICAL(&_flightRecorderMux);
+            if (task.name[0] == 0)
+                strncpy(task.name, taskName, sizeof(task.name) - 1);
+            portEXIT_CRITICAL(&_flightRecorderMux);
+        }
+        if (strncmp(task.name, taskName, sizeof(task.name) - 1) == 0)
+        {
+            taskPtr = &task;
+            break;
+        }
+    }
+    if (taskPtr == nullptr) return; // No free slots
+
+    if (taskPtr->lastLoopMillis != 0)
+        taskPtr->maxLoopMs = std::max(taskPtr->maxLoopMs, currentMillis - taskPtr->lastLoopMillis);
+    taskPtr->lastLoopMillis = currentMillis;
+}
+
+
+bool FlightRecorder::writeReport(Print& output)
+{
+    if (_previousPtr == nullptr)
+    {
+        output.println("No flight record available.");
+        return false;
+    }
+
+    FlightRecorderData& data = *_previousPtr;
+    output.printf("Flight record of boot #%lu\n", data.bootCount);
+
+    uint32_t lastMillis = 0;
+    for (int i = 0; i < FLIGHT_RECORDER_TASKS; i++)
+        lastMillis = std::max(lastMillis, data.tasks[i].lastLoopMillis);
+
+    output.println("Tasks:");
+    for (int i = 0; i < FLIGHT_RECORDER_TASKS; i++)
+    {
+        FlightRecorderTask& task = data.tasks[i];
+        if (task.name[0] == 0) break;
+        task.name[sizeof(task.name) - 1] = 0;
+        output.printf(
+            "  %-16s last loop @ %lu ms (-%lu ms). Max loop: %lu ms\n",
+            task.name,
+            task.lastLoopMillis,
+            lastMillis - task.lastLoopMillis,
+            task.maxLoopMs);
+    }
+
+    output.println("Events:");
+    bool isSameFirmware = (data.firmwareId == getFirmwareId());
+    uint16_t eventCount = std::min(data.eventCount, (uint16_t)FLIGHT_RECORDER_EVENTS);
+    uint16_t eventIndex = data.eventIndex + FLIGHT_RECORDER_EVENTS - eventCount;
+    for (int i = 0; i < eventCount; i++)
+    {
+        FlightRecorderEvent& event = data.events[(eventIndex + i) % FLIGHT_RECORDER_EVENTS];
+        if (event.type == FlightRecorderEventType::Structured)
+        {
+            if (isSameFirmware)
+            {
+                char eventText[FLIGHT_RECORDER_EVENT_SIZE];
+                event.structured.toString(eventText, sizeof(eventText));
+                output.printf("  %s\n", eventText);
+            }
+            else
+                output.println("  (event logged by previous firmware)");
+        }
+        else
+        {
+            event.text[FLIGHT_RECORDER_EVENT_SIZE - 1] = 0;
+            output.printf("  %s\n", event.text);
+        }
+    }
+
+    output.println("Trace:");
+    uint16_t traceIndex = data.traceIndex % FLIGHT_RECORDER_TRACE_SIZE;
+    uint16_t start = data.traceWrapped ? traceIndex : 0;
+    uint16_t length = data.traceWrapped ? FLIGHT_RECORDER_TRACE_SIZE : traceIndex;
+    for (uint16_t i = 0; i < length; i += 64)
+    {
+        // Write in small pieces so chunked responses can keep up
+        char piece[64];
+        uint16_t pieceLength = std::min(length - i, (int)sizeof(piece));
+        for (uint16_t j = 0; j < pieceLength; j++)
+            piece[j] = data.trace[(start + i + j) % FLIGHT_RECORDER_TRACE_SIZE];
+        output.write(reinterpret_cast<uint8_t*>(piece), pieceLength);
+    }
+    output.println();
+
+    return true;
+}
+
+#else
+void FlightRecorder::begin(bool recordTrace)
+{
+}
+
+void FlightRecorder::recordEvent(const char* event)
+{
+}
+
+void FlightRecorder::recordEvent(const StructuredEvent& event)
+{
+}
+
+void FlightRecorder::recordTrace(const char* msg)
+{
+}
+
+void FlightRecorder::recordLoop()
+{
+}
+
+bool FlightRecorder::writeReport(Print& output)
+{
+    output.println("Flight recorder not supported on ESP8266.");
+    return false;
+}
+#endif
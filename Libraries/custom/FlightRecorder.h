@@ -0,0 +1,77 @@
+#ifndef FLIGHT_RECORDER_H
+#define FLIGHT_RECORDER_H
+
+#include <stdint.h>
+#include <Print.h>
+#include <StructuredEventLog.h>
+
+constexpr uint32_t FLIGHT_RECORDER_MAGIC = 0xF1A61002;
+constexpr int FLIGHT_RECORDER_EVENTS = 16;
+constexpr int FLIGHT_RECORDER_EVENT_SIZE = 80;
+constexpr int FLIGHT_RECORDER_TRACE_SIZE = 768;
+constexpr int FLIGHT_RECORDER_TASKS = 8;
+
+struct FlightRecorderTask
+{
+    char name[16];
+    uint32_t lastLoopMillis;
+    uint32_t maxLoopMs;
+};
+
+enum struct FlightRecorderEventType : uint8_t
+{
+    Text,
+    Structured // Format string + packed arguments; only valid for the same firmware build
+};
+
+struct FlightRecorderEvent
+{
+    FlightRecorderEventType type;
+    union
+    {
+        char text[FLIGHT_RECORDER_EVENT_SIZE];
+        StructuredEvent structured;
+    };
+};
+
+// Lives in RTC memory which is not initialized on software/panic/watchdog resets.
+struct FlightRecorderData
+{
+    uint32_t magic;
+    uint32_t bootCount;
+    uint32_t firmwareId; // Structured events refer to format strings in flash
+    uint16_t eventIndex;
+    uint16_t eventCount;
+    uint16_t traceIndex;
+    uint16_t traceWrapped;
+    FlightRecorderEvent events[FLIGHT_RECORDER_EVENTS];
+    char trace[FLIGHT_RECORDER_TRACE_SIZE];
+    FlightRecorderTask tasks[FLIGHT_RECORDER_TASKS];
+};
+
+class FlightRecorder
+{
+    public:
+        // Preserves the record of the previous run (if any) and starts a new one.
+        static void begin(bool recordTrace = false);
+
+        static bool isTraceEnabled() { return _recordTrace; }
+        static bool hasPreviousRecord() { return _previousPtr != nullptr; }
+
+        static void recordEvent(const char* event);
+        static void recordEvent(const StructuredEvent& event); // Can be called from an ISR
+        static void recordTrace(const char* msg);
+        static void recordLoop(); // Called from each task's loop
+
+        static bool writeReport(Print& output);
+
+    private:
+        static bool _isInitialized;
+        static bool _recordTrace;
+        static FlightRecorderData* _previousPtr;
+
+        static uint32_t getFirmwareId();
+        static FlightRecorderEvent& claimEventSlot();
+};
+
+#endif
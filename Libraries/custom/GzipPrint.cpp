@@ -0,0 +1,262 @@
+#include <Arduino.h>
+#include "GzipPrint.h"
+#include <PSRAM.h>
+
+constexpr size_t MIN_MATCH = 3;
+constexpr size_t MAX_MATCH = 258;
+constexpr uint16_t END_OF_BLOCK = 256;
+
+static const uint16_t _lengthBase[] =
+{
+    3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+    35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+static const uint8_t _lengthExtraBits[] =
+{
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+    3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+static const uint16_t _distanceBase[] =
+{
+    1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+    257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577
+};
+static const uint8_t _distanceExtraBits[] =
+{
+    0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+    7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+};
+static const uint32_t _crcTable[] =
+{
+    0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+    0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+};
+
+static inline uint16_t hash3(const uint8_t* data)
+{
+    uint32_t value = (data[0] << 16) | (data[1] << 8) | data[2];
+    return (value * 2654435761U) >> (32 - GZIP_HASH_BITS);
+}
+
+
+GzipPrint::GzipPrint(Print& output)
+    : _output(output)
+{
+    _buffer = Memory::allocate<uint8_t>(GZIP_BUFFER_SIZE);
+    _hashHeads = Memory::allocate<uint16_t>(1 << GZIP_HASH_BITS);
+    if ((_buffer == nullptr) || (_hashHeads == nullptr))
+        _isError = true;
+    else
+        memset(_hashHeads, 0, sizeof(uint16_t) << GZIP_HASH_BITS);
+}
+
+
+GzipPrint::~GzipPrint()
+{
+    if (_buffer != nullptr) free(_buffer);
+    if (_hashHeads != nullptr) free(_hashHeads);
+}
+
+
+size_t GzipPrint::write(uint8_t data)
+{
+    return write(&data, 1);
+}
+
+
+size_t GzipPrint::write(const uint8_t* buffer, size_t size)
+{
+    if (_isError || _isFinished) return 0;
+    if (!_isStarted) start();
+
+    for (size_t i = 0; i < size; i++)
+    {
+        uint8_t data = buffer[i];
+        _crc ^= data;
+        _crc = (_crc >> 4) ^ _crcTable[_crc & 0x0F];
+        _crc = (_crc >> 4) ^ _crcTable[_crc & 0x0F];
+    }
+    _inputSize += size;
+
+    size_t written = 0;
+    while (written < size)
+    {
+        if (_end == GZIP_BUFFER_SIZE)
+        {
+            compress(false);
+            slideWindow();
+        }
+        size_t chunkSize = std::min(size - written, GZIP_BUFFER_SIZE - _end);
+        memcpy(_buffer + _end, buffer + written, chunkSize);
+        _end += chunkSize;
+        written += chunkSize;
+    }
+
+    return _isError ? 0 : size;
+}
+
+
+bool GzipPrint::finish()
+{
+    if (_isFinished) return !_isError;
+    if (!_isStarted) start();
+    if (_isError) return false;
+
+    compress(true);
+    writeLiteral(END_OF_BLOCK);
+    if (_bitCount > 0) writeBits(0, 8 - _bitCount); // Pad to a byte boundary
+
+    // Gzip trailer: CRC-32 and input size (little endian)
+    uint32_t crc = ~_crc;
+    for (int i = 0; i < 4; i++) writeByte((crc >> (i * 8)) & 0xFF);
+    for (int i = 0; i < 4; i++) writeByte((_inputSize >> (i * 8)) & 0xFF);
+    flushOutput();
+
+    _isFinished = true;
+    return !_isError;
+}
+
+
+void GzipPrint::start()
+{
+    // Gzip header: magic, deflate, no flags, no time, no extra flags, unknown OS
+    static const uint8_t header[] = { 0x1F, 0x8B, 0x08, 0x00, 0, 0, 0, 0, 0x00, 0xFF };
+    for (uint8_t data : header) writeByte(data);
+
+    // A single final block using fixed Huffman codes
+    writeBits(1, 1); // BFINAL
+    writeBits(1, 2); // BTYPE = 01
+
+    _isStarted = true;
+}
+
+
+void GzipPrint::compress(bool flush)
+{
+    size_t minLookahead = flush ? 1 : MAX_MATCH;
+    while (_end - _position >= minLookahead)
+    {
+        size_t available = _end - _position;
+        size_t matchLength = 0;
+        size_t matchDistance = 0;
+        if (available >= MIN_MATCH)
+        {
+            uint16_t hash = hash3(_buffer + _position);
+            size_t candidate = _hashHeads[hash]; // Position + 1
+            _hashHeads[hash] = _position + 1;
+            if ((candidate != 0) && (_position - (candidate - 1) <= GZIP_WINDOW_SIZE))
+            {
+                const uint8_t* matchPtr = _buffer + candidate - 1;
+                const uint8_t* dataPtr = _buffer + _position;
+                size_t maxLength = std::min(available, MAX_MATCH);
+                size_t length = 0;
+                while ((length < maxLength) && (matchPtr[length] == dataPtr[length])) length++;
+                if (length >= MIN_MATCH)
+                {
+                    matchLength = length;
+                    matchDistance = _position - (candidate - 1);
+                }
+            }
+        }
+
+        if (matchLength == 0)
+        {
+            writeLiteral(_buffer[_position++]);
+            continue;
+        }
+
+        writeMatch(matchLength, matchDistance);
+
+        // Index the positions within the match too; it improves subsequent matches.
+        size_t matchEnd = _position + matchLength;
+        for (_position++; _position < matchEnd; _position++)
+        {
+            if (_end - _position >= MIN_MATCH)
+                _hashHeads[hash3(_buffer + _position)] = _position + 1;
+        }
+    }
+}
+
+
+void GzipPrint::slideWindow()
+{
+    // Keep the last window of data as history
+    size_t shift = _position - GZIP_WINDOW_SIZE;
+    memmove(_buffer, _buffer + shift, _end - shift);
+    _position -= shift;
+    _end -= shift;
+
+    for (size_t i = 0; i < (1 << GZIP_HASH_BITS); i++)
+        _hashHeads[i] = (_hashHeads[i] > shift) ? _hashHeads[i] - shift : 0;
+}
+
+
+void GzipPrint::writeBits(uint32_t value, uint8_t count)
+{
+    _bitBuffer |= value << _bitCount;
+    _bitCount += count;
+    while (_bitCount >= 8)
+    {
+        writeByte(_bitBuffer & 0xFF);
+        _bitBuffer >>= 8;
+        _bitCount -= 8;
+    }
+}
+
+
+void GzipPrint::writeCode(uint16_t code, uint8_t length)
+{
+    // Huffman codes are packed starting with the most significant bit
+    uint16_t reversed = 0;
+    for (uint8_t i = 0; i < length; i++)
+    {
+        reversed = (reversed << 1) | (code & 1);
+        code >>= 1;
+    }
+    writeBits(reversed, length);
+}
+
+
+void GzipPrint::writeLiteral(uint16_t symbol)
+{
+    // Fixed Huffman codes (RFC 1951, 3.2.6)
+    if (symbol < 144)
+        writeCode(0x30 + symbol, 8);
+    else if (symbol < 256)
+        writeCode(0x190 + symbol - 144, 9);
+    else if (symbol < 280)
+        writeCode(symbol - 256, 7);
+    else
+        writeCode(0xC0 + symbol - 280, 8);
+}
+
+
+void GzipPrint::writeMatch(size_t length, size_t distance)
+{
+    int lengthCode = sizeof(_lengthBase) / sizeof(_lengthBase[0]) - 1;
+    while (_lengthBase[lengthCode] > length) lengthCode--;
+    writeLiteral(257 + lengthCode);
+    writeBits(length - _lengthBase[lengthCode], _lengthExtraBits[lengthCode]);
+
+    int distanceCode = sizeof(_distanceBase) / sizeof(_distanceBase[0]) - 1;
+    while (_distanceBase[distanceCode] > distance) distanceCode--;
+    writeCode(distanceCode, 5);
+    writeBits(distance - _distanceBase[distanceCode], _distanceExtraBits[distanceCode]);
+}
+
+
+void GzipPrint::writeByte(uint8_t data)
+{
+    _outputBuffer[_outputLength++] = data;
+    if (_outputLength == GZIP_OUTPUT_BUFFER_SIZE) flushOutput();
+}
+
+
+void GzipPrint::flushOutput()
+{
+    if (_outputLength == 0) return;
+    if (_output.write(_outputBuffer, _outputLength) != _outputLength)
+        _isError = true;
+    _outputSize += _outputLength;
+    _outputLength = 0;
+}
@@ -0,0 +1,62 @@
+#ifndef GZIP_PRINT_H
+#define GZIP_PRINT_H
+
+#include <Print.h>
+
+constexpr size_t GZIP_WINDOW_SIZE = 1024; // Max distance of a match
+constexpr size_t GZIP_BUFFER_SIZE = 2 * GZIP_WINDOW_SIZE;
+constexpr int GZIP_HASH_BITS = 9;
+constexpr size_t GZIP_OUTPUT_BUFFER_SIZE = 64;
+
+// Compresses everything written to it (gzip format) and writes the result to another Print.
+// Uses deflate with fixed Huffman codes and a small window, so the memory use is bounded (~3 kB).
+// That suits repetitive text like CSV exports. Call finish() after the last write.
+// Gzip members may be concatenated, so the output can be appended to an existing .gz file.
+class GzipPrint : public Print
+{
+    public:
+        GzipPrint(Print& output);
+        ~GzipPrint();
+
+        size_t write(uint8_t data) override;
+        size_t write(const uint8_t* buffer, size_t size) override;
+
+        // Compresses the remaining data and writes the gzip trailer.
+        // Returns false if memory allocation or writing to the output failed.
+        bool finish();
+
+        // True if the compression buffers could not be allocated (as opposed to an output failure).
+        bool isOutOfMemory() { return (_buffer == nullptr) || (_hashHeads == nullptr); }
+
+        size_t getInputSize() { return _inputSize; }
+        size_t getOutputSize() { return _outputSize; }
+
+    private:
+        Print& _output;
+        uint8_t* _buffer; // History (window) followed by data yet to compress
+        uint16_t* _hashHeads; // Last position (+1) in the buffer for each hash of 3 bytes
+        size_t _position = 0; // Next byte to compress
+        size_t _end = 0;
+        uint32_t _crc = 0xFFFFFFFF;
+        size_t _inputSize = 0;
+        size_t _outputSize = 0;
+        uint32_t _bitBuffer = 0;
+        uint8_t _bitCount = 0;
+        uint8_t _outputBuffer[GZIP_OUTPUT_BUFFER_SIZE];
+        size_t _outputLength = 0;
+        bool _isStarted = false;
+        bool _isFinished = false;
+        bool _isError = false;
+
+        void start();
+        void compress(bool flush);
+        void slideWindow();
+        void writeBits(uint32_t value, uint8_t count);
+        void writeCode(uint16_t code, uint8_t length);
+        void writeLiteral(uint16_t symbol);
+        void writeMatch(size_t length, size_t distance);
+        void writeByte(uint8_t data);
+        void flushOutput();
+};
+
+#endif
@@ -277,11 +277,17 @@ void HtmlWriter::writeSubmitButton(const String& label, const String& cssClass)
 
 void HtmlWriter::writeLabel(const String& label, const String& forId)
 {
-    if (label.length() == 0) return;
+    writeLabel(label.c_str(), forId.c_str());
+}
+
+
+void HtmlWriter::writeLabel(const char* label, const char* forId)
+{
+    if (label[0] == 0) return;
     _output.printf(
         F("<label for=\"%s\">%s</label>"), 
-        forId.c_str(),
-        label.c_str());
+        forId,
+        label);
 }
 
 
@@ -291,14 +297,25 @@ void HtmlWriter::writeTextBox(
     const String& value,
     uint16_t maxLength,
     const String& type)
+{
+    writeTextBox(name.c_str(), label.c_str(), value.c_str(), maxLength, type.c_str());
+}
+
+
+void HtmlWriter::writeTextBox(
+    const char* name,
+    const char* label,
+    const char* value,
+    uint16_t maxLength,
+    const char* type)
 {
     writeLabel(label, name);
     _output.printf(
         F("<input type=\"%s\" id=\"%s\" name=\"%s\" value=\"%s\" maxlength=\"%d\">\r\n"), 
-        type.c_str(),
-        name.c_str(),
-        name.c_str(),
-        value.c_str(),
+        type,
+        name,
+        name,
+        value,
         maxLength);
 }
 
@@ -310,6 +327,18 @@ void HtmlWriter::writeNumberBox(
     float minValue,
     float maxValue,
     int decimals)
+{
+    writeNumberBox(name.c_str(), label.c_str(), value, minValue, maxValue, decimals);
+}
+
+
+void HtmlWriter::writeNumberBox(
+    const char* name,
+    const char* label,
+    float value,
+    float minValue,
+    float maxValue,
+    int decimals)
 {
     float step = pow10f(-decimals);
 
@@ -323,8 +352,8 @@ void HtmlWriter::writeNumberBox(
     writeLabel(label, name);
     _output.printf(
         FPSTR(_strBuffer), 
-        name.c_str(),
-        name.c_str(),
+        name,
+        name,
         value,
         minValue,
         maxValue,
@@ -333,14 +362,20 @@ void HtmlWriter::writeNumberBox(
 
 
 void HtmlWriter::writeCheckbox(const String& name, const String& label, bool value)
+{
+    writeCheckbox(name.c_str(), label.c_str(), value);
+}
+
+
+void HtmlWriter::writeCheckbox(const char* name, const char* label, bool value)
 {
     const char* checked = value ? "checked" : "";
 
     writeLabel(label, name);
     _output.printf(
         F("<input type=\"checkbox\" id=\"%s\" name=\"%s\" value=\"true\" %s>\r\n"), 
-        name.c_str(),
-        name.c_str(),
+        name,
+        name,
         checked);
 }
 
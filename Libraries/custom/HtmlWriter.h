@@ -30,9 +30,13 @@ class HtmlWriter
         void writeSubmitButton();
         void writeSubmitButton(const String& label, const String& cssClass = String("submit"));
         void writeLabel(const String& label, const String& forId);
+        void writeLabel(const char* label, const char* forId);
         void writeTextBox(const String& name, const String& label, const String& value, uint16_t maxLength, const String& type = String("text"));
+        void writeTextBox(const char* name, const char* label, const char* value, uint16_t maxLength, const char* type = "text");
         void writeNumberBox(const String& name, const String& label, float value, float minValue, float maxValue, int decimals = 0);
+        void writeNumberBox(const char* name, const char* label, float value, float minValue, float maxValue, int decimals = 0);
         void writeCheckbox(const String& name, const String& label, bool value);
+        void writeCheckbox(const char* name, const char* label, bool value);
         void writeRadioButtons(const String& name, const String& label, const char** values, int numValues, int index);
         void writeSlider(const String& name, const String& label, const String& unitOfMeasure, int value, int minValue, int maxValue, int denominator = 1);
         void writeDropdown(const String& name, const String& label, const char** values, int numValues, int index = -1);
@@ -0,0 +1,189 @@
+#include "InfluxExporter.h"
+#include <GzipPrint.h>
+#include <Tracer.h>
+
+
+bool InfluxExporter::begin(const char* writeUrl, const char* token, const char* hostTag)
+{
+    Tracer tracer(F("InfluxExporter::begin"), writeUrl);
+
+    if (strncmp(writeUrl, "http://", 7) != 0)
+    {
+        _lastError = F("Only http:// is supported");
+        return false;
+    }
+
+    _writeUrl = writeUrl;
+    if (_writeUrl.indexOf(F("precision=")) < 0)
+    {
+        _writeUrl += (_writeUrl.indexOf('?') < 0) ? '?' : '&';
+        _writeUrl += F("precision=s");
+    }
+
+    if (token[0] != 0)
+    {
+        _authorization = F("Token ");
+        _authorization += token;
+    }
+
+    _hostTag = hostTag;
+    _circuitBreaker.reset();
+    return true;
+}
+
+
+void InfluxExporter::addSource(SyncCursor& syncCursor, InfluxBatchWriter batchWriter)
+{
+    Source source
+    {
+        .syncCursor = syncCursor,
+        .batchWriter = batchWriter
+    };
+    _sources.push_back(source);
+}
+
+
+bool InfluxExporter::run(time_t time)
+{
+    if (!isEnabled() || _sources.empty()) return false;
+
+    bool isFlushDue = (time - _lastFlushTime) >= _flushInterval;
+    for (size_t i = 0; i < _sources.size(); i++)
+    {
+        size_t sourceIndex = (_nextSource + i) % _sources.size();
+        Source& source = _sources[sourceIndex];
+        uint16_t unsentEntries = source.syncCursor.getUnsent();
+        if ((unsentEntries == 0) || ((unsentEntries < _batchSize) && !isFlushDue))
+            continue;
+
+        if (!_circuitBreaker.allowRequest()) return false;
+
+        // One batch per run; the sources take turns.
+        _nextSource = (sourceIndex + 1) % _sources.size();
+        return sendBatch(source, time);
+    }
+
+    // All sources are flushed
+    if (isFlushDue) _lastFlushTime = time;
+    return false;
+}
+
+
+bool InfluxExporter::sendBatch(Source& source, time_t time)
+{
+    Tracer tracer(F("InfluxExporter::sendBatch"));
+
+    _buffer.clear();
+    GzipPrint gzipOutput(_buffer);
+    InfluxLineWriter lineWriter(gzipOutput, _hostTag);
+    uint16_t entries = source.batchWriter(lineWriter, source.syncCursor.getUnsent(), _batchSize);
+    if (!gzipOutput.finish())
+    {
+        if (gzipOutput.isOutOfMemory() || _buffer.isAllocationFailed())
+        {
+            // Not a problem of the batch; keep the entries and back off like for a failed request.
+            _lastError = F("Out of memory");
+            _circuitBreaker.recordFailure();
+            _stats.failures++;
+            return false;
+        }
+        if (_batchSize > INFLUX_MIN_BATCH_SIZE)
+        {
+            // The compressed batch doesn't fit in the buffer; retry with a smaller batch.
+            TRACE(F("Batch of %u entries too large\n"), entries);
+            setBatchSize(_batchSize / 2);
+            return false;
+        }
+        // Even the smallest batch doesn't fit; skip it rather than blocking the export.
+        _lastError = F("Batch too large");
+        _stats.rejectedLines += lineWriter.getLines();
+        source.syncCursor.advance(entries);
+        source.syncCursor.acknowledge(time);
+        return false;
+    }
+    source.syncCursor.advance(entries);
+
+    uint32_t startMillis = millis();
+    int result = post();
+    uint32_t batchMs = millis() - startMillis;
+    TRACE(
+        F("Sent %u lines (%u -> %u bytes) in %u ms: %d\n"),
+        lineWriter.getLines(),
+        gzipOutput.getInputSize(),
+        gzipOutput.getOutputSize(),
+        batchMs,
+        result);
+
+    if ((result >= 200) && (result < 300))
+    {
+        source.syncCursor.acknowledge(time);
+        _circuitBreaker.recordSuccess();
+        _stats.batches++;
+        _stats.lines += lineWriter.getLines();
+        _stats.bytes += gzipOutput.getInputSize();
+        _stats.compressedBytes += gzipOutput.getOutputSize();
+        _stats.lastBatchLines = lineWriter.getLines();
+        _stats.lastBatchMs = batchMs;
+
+        // Full batch sent quickly; try a larger one next time.
+        if ((entries == _batchSize) && (batchMs < INFLUX_TARGET_BATCH_MS))
+            setBatchSize(_batchSize * 2);
+        return true;
+    }
+
+    if ((result == 400) || (result == 422))
+    {
+        // The server refuses the data (e.g. invalid line protocol); sending it again won't help.
+        _stats.rejectedLines += lineWriter.getLines();
+        source.syncCursor.acknowledge(time);
+        return false;
+    }
+
+    // Send the entries again when the circuit breaker allows.
+    source.syncCursor.rollback();
+    _circuitBreaker.recordFailure();
+    _stats.failures++;
+    if ((result < 0) || (result == 413))
+        setBatchSize(_batchSize / 2); // Timeout or payload too large
+    return false;
+}
+
+
+int InfluxExporter::post()
+{
+    if (!_httpClient.begin(_wifiClient, _writeUrl))
+    {
+        _lastError = F("Invalid URL");
+        return -1;
+    }
+
+    _httpClient.setReuse(true);
+    _httpClient.setTimeout(_timeoutMs);
+    _httpClient.addHeader(F("Content-Type"), F("text/plain; charset=utf-8"));
+    _httpClient.addHeader(F("Content-Encoding"), F("gzip"));
+    if (!_authorization.isEmpty())
+        _httpClient.addHeader(F("Authorization"), _authorization);
+
+    int result = _httpClient.POST(
+        reinterpret_cast<uint8_t*>(const_cast<char*>(_buffer.c_str())),
+        _buffer.length());
+
+    if (result < 0)
+        _lastError = HTTPClient::errorToString(result);
+    else if ((result < 200) || (result >= 300))
+    {
+        _lastError = F("HTTP ");
+        _lastError += result;
+        _lastError += F(": ");
+        _lastError += _httpClient.getString().substring(0, 64);
+    }
+
+    _httpClient.end();
+    return result;
+}
+
+
+void InfluxExporter::setBatchSize(uint16_t batchSize)
+{
+    _batchSize = std::min(std::max(batchSize, INFLUX_MIN_BATCH_SIZE), INFLUX_MAX_BATCH_SIZE);
+}
@@ -0,0 +1,93 @@
+#ifndef INFLUX_EXPORTER_H
+#define INFLUX_EXPORTER_H
+
+#include <ESPWiFi.h>
+#include <ESPHTTPClient.h>
+#include <functional>
+#include <vector>
+#include <StringBuilder.h>
+#include <CircuitBreaker.h>
+#include <SyncCursor.h>
+#include <InfluxLineWriter.h>
+
+constexpr size_t INFLUX_BUFFER_SIZE = 4096; // Compressed batch
+constexpr uint16_t INFLUX_MIN_BATCH_SIZE = 5;
+constexpr uint16_t INFLUX_MAX_BATCH_SIZE = 400;
+constexpr uint32_t INFLUX_TARGET_BATCH_MS = 500; // Batches taking longer are not enlarged
+
+// Writes the log entries starting at the given number of entries from the end (i.e. log.at(-unsentEntries)).
+// Returns the number of entries written, at most maxEntries.
+using InfluxBatchWriter = std::function<uint16_t(InfluxLineWriter& output, uint16_t unsentEntries, uint16_t maxEntries)>;
+
+struct InfluxExporterStats
+{
+    uint32_t batches = 0;
+    uint32_t lines = 0;
+    uint32_t bytes = 0; // Uncompressed
+    uint32_t compressedBytes = 0;
+    uint32_t failures = 0;
+    uint32_t rejectedLines = 0; // Dropped because the server refused them (HTTP 4xx)
+    uint16_t lastBatchLines = 0;
+    uint32_t lastBatchMs = 0;
+
+    float getLinesPerSecond() const { return (lastBatchMs == 0) ? 0 : 1000.0F * lastBatchLines / lastBatchMs; }
+    float getCompressionRatio() const { return (bytes == 0) ? 0 : float(compressedBytes) / bytes; }
+};
+
+// Exports log entries to InfluxDB (or a compatible receiver) using gzip compressed line protocol.
+// Each log has a sync cursor, so entries are only considered exported after the server accepted them;
+// the unacknowledged entries in the log act as the retry queue.
+// The batch size adapts: it grows while batches are sent quickly and shrinks on failures or buffer overflow.
+// If the buffers can't be allocated the batch is kept for a later retry, like after a failed request.
+class InfluxExporter
+{
+    public:
+        InfluxExporter(uint16_t timeoutMs, uint16_t flushInterval = 60)
+            : _timeoutMs(timeoutMs), _flushInterval(flushInterval) {}
+
+        bool isEnabled() { return !_writeUrl.isEmpty(); }
+        uint16_t getBatchSize() { return _batchSize; }
+        const InfluxExporterStats& getStats() { return _stats; }
+        const CircuitBreaker& getCircuitBreaker() { return _circuitBreaker; }
+        const String& getLastError() { return _lastError; }
+
+        // The write URL includes the database/bucket, e.g. http://influx:8086/api/v2/write?org=home&bucket=otgw
+        // or http://influx:8086/write?db=otgw (InfluxDB 1.x). The token may be empty.
+        bool begin(const char* writeUrl, const char* token, const char* hostTag);
+
+        // Adds a log to export.
+        void addSource(SyncCursor& syncCursor, InfluxBatchWriter batchWriter);
+
+        // Sends a batch if a full batch is available or the flush interval passed.
+        // Returns true if a batch was sent successfully.
+        bool run(time_t time);
+
+    private:
+        struct Source
+        {
+            SyncCursor& syncCursor;
+            InfluxBatchWriter batchWriter;
+        };
+
+        uint16_t _timeoutMs;
+        uint16_t _flushInterval;
+        String _writeUrl;
+        String _authorization;
+        const char* _hostTag = nullptr;
+        std::vector<Source> _sources;
+        size_t _nextSource = 0;
+        uint16_t _batchSize = INFLUX_MIN_BATCH_SIZE * 4;
+        time_t _lastFlushTime = 0;
+        StringBuilder _buffer = StringBuilder(INFLUX_BUFFER_SIZE);
+        WiFiClient _wifiClient;
+        HTTPClient _httpClient;
+        CircuitBreaker _circuitBreaker;
+        InfluxExporterStats _stats;
+        String _lastError;
+
+        bool sendBatch(Source& source, time_t time);
+        int post();
+        void setBatchSize(uint16_t batchSize);
+};
+
+#endif
@@ -0,0 +1,96 @@
+#include <Arduino.h>
+#include "InfluxLineWriter.h"
+
+static const char* _measurementSpecialChars = ", ";
+static const char* _keySpecialChars = ",= ";
+
+
+InfluxLineWriter::InfluxLineWriter(Print& output, const char* hostTag)
+    : _output(output), _hostTag(hostTag), _lineStart(INFLUX_LINE_START_SIZE)
+{
+    _lineStart.setBuffer(_lineStartBuffer, sizeof(_lineStartBuffer));
+}
+
+
+void InfluxLineWriter::beginLine(const char* measurement)
+{
+    _lineStart.clear();
+    writeEscaped(_lineStart, measurement, _measurementSpecialChars);
+    if (_hostTag != nullptr)
+        addTag("host", _hostTag);
+    _hasFields = false;
+}
+
+
+void InfluxLineWriter::addTag(const char* key, const char* value)
+{
+    _lineStart.print(',');
+    writeEscaped(_lineStart, key, _keySpecialChars);
+    _lineStart.print('=');
+    writeEscaped(_lineStart, value, _keySpecialChars);
+}
+
+
+void InfluxLineWriter::addField(const char* key, float value, int decimals)
+{
+    // NaN and infinity are not supported by line protocol; omit the field.
+    if (!isfinite(value) || !beginField(key)) return;
+    _output.print(value, decimals);
+}
+
+
+void InfluxLineWriter::addField(const char* key, int value)
+{
+    if (!beginField(key)) return;
+    _output.print(value);
+    _output.print('i');
+}
+
+
+void InfluxLineWriter::addField(const char* key, bool value)
+{
+    if (!beginField(key)) return;
+    _output.print(value ? 't' : 'f');
+}
+
+
+void InfluxLineWriter::endLine(time_t time)
+{
+    if (!_hasFields)
+    {
+        _skippedLines++;
+        return;
+    }
+    _output.print(' ');
+    _output.print(static_cast<uint32_t>(time));
+    _output.print('\n');
+    _lines++;
+    _hasFields = false;
+}
+
+
+bool InfluxLineWriter::beginField(const char* key)
+{
+    if (!_hasFields)
+    {
+        // A full buffer means the tags were truncated; omit the line rather than write wrong tags.
+        if (_lineStart.length() >= _lineStart.capacity() - 1) return false;
+        _output.write(reinterpret_cast<const uint8_t*>(_lineStart.c_str()), _lineStart.length());
+    }
+    _output.print(_hasFields ? ',' : ' ');
+    writeEscaped(_output, key, _keySpecialChars);
+    _output.print('=');
+    _hasFields = true;
+    return true;
+}
+
+
+void InfluxLineWriter::writeEscaped(Print& output, const char* str, const char* specialChars)
+{
+    for (const char* charPtr = str; *charPtr != 0; charPtr++)
+    {
+        if (strchr(specialChars, *charPtr) != nullptr)
+            output.print('\\');
+        output.print(*charPtr);
+    }
+}
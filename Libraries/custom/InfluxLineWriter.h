@@ -0,0 +1,44 @@
+#ifndef INFLUX_LINE_WRITER_H
+#define INFLUX_LINE_WRITER_H
+
+#include <Print.h>
+#include <time.h>
+#include <StringBuilder.h>
+
+constexpr size_t INFLUX_LINE_START_SIZE = 128; // Measurement and tags
+
+// Writes data points in InfluxDB line protocol, e.g.:
+// opentherm,host=otgw tBoiler=45.5,modulation=30i 1700000000
+// Timestamps are in seconds, so the write request must use precision=s.
+// Each line needs at least one field, so the measurement and tags are held back until the first field;
+// lines without fields (e.g. all values NaN) are skipped rather than rejecting the whole batch.
+class InfluxLineWriter
+{
+    public:
+        // The host tag (if any) is added to each line.
+        InfluxLineWriter(Print& output, const char* hostTag = nullptr);
+
+        uint16_t getLines() { return _lines; }
+        uint16_t getSkippedLines() { return _skippedLines; }
+
+        void beginLine(const char* measurement);
+        void addTag(const char* key, const char* value);
+        void addField(const char* key, float value, int decimals = 1);
+        void addField(const char* key, int value);
+        void addField(const char* key, bool value);
+        void endLine(time_t time);
+
+    private:
+        Print& _output;
+        const char* _hostTag;
+        char _lineStartBuffer[INFLUX_LINE_START_SIZE];
+        StringBuilder _lineStart;
+        uint16_t _lines = 0;
+        uint16_t _skippedLines = 0;
+        bool _hasFields = false;
+
+        bool beginField(const char* key);
+        static void writeEscaped(Print& output, const char* str, const char* specialChars);
+};
+
+#endif
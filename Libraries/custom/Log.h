@@ -2,10 +2,15 @@
 #define LOG_H
 
 #include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
 #include <iterator>
 #include <deque>
+#include <algorithm>
 #include <PSRAM.h>
 
+constexpr uint16_t STRING_LOG_FALLBACK_ENTRY_SIZE = 64;
+
 template<typename T>
 class Log
 {
@@ -78,10 +83,21 @@ class StaticLog
 
         ~StaticLog()
         {
-            if (_entries) free(_entries);
+            if (_entries && _ownsEntries) free(_entries);
         }
 
         int size() const { return _size; }
+        size_t entrySize() const { return sizeof(T); }
+
+        void setBuffer(T* entries, uint16_t size)
+        {
+            // Note: the buffer is not owned; typically it is part of a MemoryPlanner arena.
+            if (_entries && _ownsEntries) free(_entries);
+            _entries = entries;
+            _ownsEntries = false;
+            _size = size;
+            clear();
+        }
         uint16_t count() const { return _count; }
 
         void clear()
@@ -92,9 +108,10 @@ class StaticLog
             _iterator = 0;
         }
 
+        // Never returns nullptr, so callers can keep a pointer to the last entry.
         T* add(const T* entryPtr)
         {
-            if (!_entries) _entries = Memory::allocate<T>(_size, _memoryType);
+            if (!_entries) allocate();
 
             if ((_end == _start) && (_count != 0))
                 _start = (_start + 1) % _size;
@@ -246,6 +263,28 @@ class StaticLog
         uint16_t _count = 0;
         uint16_t _iterator = 0;
         T* _entries = nullptr;
+        bool _ownsEntries = false;
+        T _fallbackEntry; // Per log, so logs running out of memory don't overwrite each other's entry
+
+        void allocate()
+        {
+            // Rather a shorter log than none at all
+            for (uint16_t size = _size; size > 0; size /= 2)
+            {
+                _entries = Memory::allocate<T>(size, _memoryType);
+                if (_entries)
+                {
+                    _size = size;
+                    _ownsEntries = true;
+                    return;
+                }
+            }
+
+            // Out of memory; the log keeps only the last entry (overwriting the previous one).
+            _entries = &_fallbackEntry;
+            _size = 1;
+            _ownsEntries = false;
+        }
 };
 
 class StringLog
@@ -256,11 +295,22 @@ class StringLog
 
         ~StringLog()
         {
-            if (_entries) free(_entries);
+            if (_entries && _ownsEntries) free(_entries);
         }
 
         uint16_t size() const { return _size; }
         uint16_t count() const { return _count; }
+        uint16_t entrySize() const { return _entrySize; }
+
+        void setBuffer(char* entries, uint16_t size)
+        {
+            // Note: the buffer is not owned; typically it is part of a MemoryPlanner arena.
+            if (_entries && _ownsEntries) free(_entries);
+            _entries = entries;
+            _ownsEntries = false;
+            _size = size;
+            clear();
+        }
 
         void clear()
         {
@@ -270,9 +320,10 @@ class StringLog
             _iterator = 0;
         }
 
+        // Never returns nullptr.
         const char* add(const char* entry)
         {
-            if (!_entries) _entries = Memory::allocate<char>(_entrySize * _size, _memoryType);
+            if (!_entries) allocate();
 
             if ((_end == _start) && (_count != 0))
                 _start = (_start + 1) % _size;
@@ -425,6 +476,29 @@ class StringLog
         uint16_t _count = 0;
         uint16_t _iterator = 0; 
         char* _entries = nullptr;
+        bool _ownsEntries = false;
+        char _fallbackEntry[STRING_LOG_FALLBACK_ENTRY_SIZE]; // Per log, like StaticLog's
+
+        void allocate()
+        {
+            // Rather a shorter log than none at all
+            for (uint16_t size = _size; size > 0; size /= 2)
+            {
+                _entries = Memory::allocate<char>(_entrySize * size, _memoryType);
+                if (_entries)
+                {
+                    _size = size;
+                    _ownsEntries = true;
+                    return;
+                }
+            }
+
+            // Out of memory; the log keeps only the last entry (overwriting the previous one).
+            _entries = _fallbackEntry;
+            _entrySize = std::min(_entrySize, static_cast<uint16_t>(sizeof(_fallbackEntry)));
+            _size = 1;
+            _ownsEntries = false;
+        }
 };
 
 #endif
\ No newline at end of file
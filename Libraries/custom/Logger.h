@@ -8,6 +8,7 @@ class ILogger
     public:
         virtual void logEvent(const char* msg) = 0;
         virtual void logEvent(String format, ...) = 0;
+        virtual void logEvent(const __FlashStringHelper* format, ...) = 0;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,588 @@
+#include <Arduino.h>
+#include <algorithm>
+#include "MQTTPublisher.h"
+#include <Tracer.h>
+
+// Control packet types (MQTT 3.1.1)
+constexpr uint8_t MQTT_CONNECT = 0x10;
+constexpr uint8_t MQTT_CONNACK = 0x20;
+constexpr uint8_t MQTT_PUBLISH = 0x30;
+constexpr uint8_t MQTT_PUBACK = 0x40;
+constexpr uint8_t MQTT_PINGREQ = 0xC0;
+constexpr uint8_t MQTT_PINGRESP = 0xD0;
+constexpr uint8_t MQTT_DISCONNECT = 0xE0;
+
+static const char* _mqttStateLabels[] = { "Disconnected", "Connecting", "Connected" };
+
+
+// Discovery payloads are small and flat, so they are written directly (not all projects have ArduinoJson).
+static void addJsonString(String& json, const char* value)
+{
+    json += '"';
+    for (const char* c = value; *c != 0; c++)
+    {
+        if ((*c == '"') || (*c == '\\')) json += '\\';
+        json += *c;
+    }
+    json += '"';
+}
+
+
+static void addJsonProperty(String& json, const char* key, const char* value)
+{
+    if (json.length() > 1) json += ',';
+    addJsonString(json, key);
+    json += ':';
+    addJsonString(json, value);
+}
+
+
+const char* MQTTPublisher::getStateLabel()
+{
+    return _mqttStateLabels[static_cast<int>(_state)];
+}
+
+
+float MQTTPublisher::getMessagesPerSecond()
+{
+    if (!isConnected()) return 0;
+    uint32_t connectedMs = millis() - _connectedMillis;
+    return (connectedMs == 0) ? 0 : 1000.0F * _publishedSinceConnect / connectedMs;
+}
+
+
+bool MQTTPublisher::begin(const char* host, uint16_t port, const char* user, const char* password, const char* clientId)
+{
+    Tracer tracer(F("MQTTPublisher::begin"), host);
+
+    _host = host;
+    _port = port;
+    _user = user;
+    _password = password;
+    _clientId = clientId;
+    _availabilityTopic = clientId;
+    _availabilityTopic += F("/status");
+    _circuitBreaker.reset();
+
+    return (strlen(host) != 0) && (strlen(clientId) != 0);
+}
+
+
+void MQTTPublisher::end()
+{
+    if (_state != MQTTState::Disconnected)
+    {
+        if (beginPacket(MQTT_DISCONNECT, 0)) sendPacket();
+        _client.stop();
+        _state = MQTTState::Disconnected;
+    }
+    _host = nullptr;
+}
+
+
+int MQTTPublisher::addSensor(const char* name, const char* unit, const char* deviceClass, float deadband, uint8_t decimals)
+{
+    // Object IDs may only contain alphanumerics, underscores and hyphens.
+    String objectId;
+    for (const char* c = name; *c != 0; c++)
+        objectId += (isalnum(*c) || (*c == '-')) ? *c : '_';
+
+    MQTTSensor sensor
+    {
+        .objectId = objectId,
+        .name = name,
+        .unit = unit,
+        .deviceClass = deviceClass,
+        .deadband = deadband,
+        .decimals = decimals,
+        .lastValue = NAN,
+        .lastPayload = String(),
+        .lastPublishMillis = 0
+    };
+    _sensors.push_back(sensor);
+    return _sensors.size() - 1;
+}
+
+
+void MQTTPublisher::setValue(int sensorIndex, float value)
+{
+    if (!isEnabled() || (sensorIndex < 0) || (sensorIndex >= _sensors.size())) return;
+
+    MQTTSensor& sensor = _sensors[sensorIndex];
+    bool isRefreshDue = (sensor.lastPublishMillis == 0) || ((millis() - sensor.lastPublishMillis) >= MQTT_REFRESH_MS);
+    if (!isRefreshDue && (fabsf(value - sensor.lastValue) <= sensor.deadband))
+    {
+        _stats.suppressed++;
+        return;
+    }
+
+    sensor.lastValue = value;
+    publishSensor(sensor, String(value, static_cast<unsigned int>(sensor.decimals)));
+}
+
+
+void MQTTPublisher::setValue(int sensorIndex, const char* value)
+{
+    if (!isEnabled() || (sensorIndex < 0) || (sensorIndex >= _sensors.size())) return;
+
+    MQTTSensor& sensor = _sensors[sensorIndex];
+    bool isRefreshDue = (sensor.lastPublishMillis == 0) || ((millis() - sensor.lastPublishMillis) >= MQTT_REFRESH_MS);
+    if (!isRefreshDue && (sensor.lastPayload == value))
+    {
+        _stats.suppressed++;
+        return;
+    }
+
+    publishSensor(sensor, value);
+}
+
+
+void MQTTPublisher::publishSensor(MQTTSensor& sensor, const String& payload)
+{
+    // Values are retained, so subscribers get the current value right away.
+    if (enqueue(getStateTopic(sensor), payload, _qos, true))
+    {
+        sensor.lastPayload = payload;
+        uint32_t currentMillis = millis();
+        sensor.lastPublishMillis = std::max(currentMillis, uint32_t(1));
+    }
+}
+
+
+bool MQTTPublisher::publish(const String& topic, const String& payload, uint8_t qos, bool retain)
+{
+    if (!isEnabled()) return false;
+    return enqueue(topic, payload, std::min(qos, uint8_t(1)), retain);
+}
+
+
+bool MQTTPublisher::enqueue(const String& topic, const String& payload, uint8_t qos, bool retain)
+{
+    if ((topic.length() + payload.length() + 8) > MQTT_MAX_PACKET_SIZE)
+    {
+        _lastError = F("Message too large for ");
+        _lastError += topic;
+        _stats.dropped++;
+        return false;
+    }
+
+    // Replace a message for the same topic which is not sent yet
+    for (MQTTMessage& message : _queue)
+    {
+        if ((message.sentMillis == 0) && (message.topic == topic))
+        {
+            message.payload = payload;
+            message.qos = std::max(message.qos, qos);
+            message.retain = retain;
+            _stats.coalesced++;
+            return true;
+        }
+    }
+
+    if (_queue.size() >= MQTT_QUEUE_SIZE)
+    {
+        // Make room by dropping the oldest QoS 0 message which is not sent yet.
+        auto dropIterator = std::find_if(
+            _queue.begin(),
+            _queue.end(),
+            [](const MQTTMessage& message) { return (message.qos == 0) && (message.sentMillis == 0); });
+        _stats.dropped++;
+        if (dropIterator == _queue.end())
+            return false;
+        _queue.erase(dropIterator);
+    }
+
+    MQTTMessage message
+    {
+        .topic = topic,
+        .payload = payload,
+        .qos = qos,
+        .retain = retain,
+        .packetId = 0,
+        .sentMillis = 0
+    };
+    _queue.push_back(message);
+    _stats.queueHighWater = std::max(_stats.queueHighWater, uint16_t(_queue.size()));
+    return true;
+}
+
+
+String MQTTPublisher::getStateTopic(const MQTTSensor& sensor)
+{
+    String result = _clientId;
+    result += '/';
+    result += sensor.objectId;
+    return result;
+}
+
+
+void MQTTPublisher::queueDiscovery()
+{
+    // Discovery messages are queued while there is room, so they don't push out values.
+    while ((_nextDiscovery < _sensors.size()) && (_queue.size() < MQTT_QUEUE_SIZE / 2))
+    {
+        MQTTSensor& sensor = _sensors[_nextDiscovery++];
+
+        String uniqueId = _clientId;
+        uniqueId += '_';
+        uniqueId += sensor.objectId;
+
+        String payload = F("{");
+        addJsonProperty(payload, "name", sensor.name);
+        addJsonProperty(payload, "unique_id", uniqueId.c_str());
+        addJsonProperty(payload, "state_topic", getStateTopic(sensor).c_str());
+        addJsonProperty(payload, "availability_topic", _availabilityTopic.c_str());
+        if (sensor.unit != nullptr)
+            addJsonProperty(payload, "unit_of_measurement", sensor.unit);
+        if (sensor.deviceClass != nullptr)
+        {
+            addJsonProperty(payload, "device_class", sensor.deviceClass);
+            addJsonProperty(payload, "state_class", "measurement");
+        }
+        payload += F(",\"device\":{\"identifiers\":[");
+        addJsonString(payload, _clientId);
+        payload += F("],\"name\":");
+        addJsonString(payload, _clientId);
+        payload += F("}}");
+
+        String topic = F("homeassistant/sensor/");
+        topic += _clientId;
+        topic += '/';
+        topic += sensor.objectId;
+        topic += F("/config");
+
+        enqueue(topic, payload, 1, true);
+    }
+}
+
+
+void MQTTPublisher::run()
+{
+    if (!isEnabled()) return;
+
+    uint32_t currentMillis = millis();
+    switch (_state)
+    {
+        case MQTTState::Disconnected:
+            connect(currentMillis);
+            break;
+
+        case MQTTState::AwaitConnAck:
+            readPackets();
+            if ((_state == MQTTState::AwaitConnAck) && (currentMillis - _stateMillis >= _timeoutMs))
+                disconnect(F("No CONNACK"));
+            break;
+
+        case MQTTState::Connected:
+            if (!_client.connected())
+            {
+                disconnect(F("Connection lost"));
+                break;
+            }
+            readPackets();
+            queueDiscovery();
+            sendQueued(currentMillis);
+
+            if (_pingMillis != 0)
+            {
+                if (currentMillis - _pingMillis >= _timeoutMs)
+                    disconnect(F("No PINGRESP"));
+            }
+            else if ((currentMillis - _lastSendMillis) >= (MQTT_KEEP_ALIVE * 750UL))
+            {
+                if (beginPacket(MQTT_PINGREQ, 0) && sendPacket())
+                    _pingMillis = std::max(currentMillis, uint32_t(1));
+            }
+            break;
+    }
+}
+
+
+void MQTTPublisher::connect(uint32_t currentMillis)
+{
+    if (!_circuitBreaker.allowRequest(currentMillis)) return;
+
+    Tracer tracer(F("MQTTPublisher::connect"), _host);
+
+    if (!_client.connect(_host, _port))
+    {
+        _lastError = F("Cannot connect to ");
+        _lastError += _host;
+        _circuitBreaker.recordFailure(currentMillis);
+        return;
+    }
+    _client.setNoDelay(true);
+
+    bool hasUser = (_user != nullptr) && (_user[0] != 0);
+    bool hasPassword = hasUser && (_password != nullptr) && (_password[0] != 0);
+    const char* offline = "offline";
+
+    size_t remainingLength = 10 + 2 + strlen(_clientId) + 2 + _availabilityTopic.length() + 2 + strlen(offline);
+    if (hasUser) remainingLength += 2 + strlen(_user);
+    if (hasPassword) remainingLength += 2 + strlen(_password);
+
+    // Clean session with a retained will message on the availability topic
+    uint8_t flags = 0x02 | 0x04 | 0x08 | 0x20;
+    if (hasUser) flags |= 0x80;
+    if (hasPassword) flags |= 0x40;
+
+    if (!beginPacket(MQTT_CONNECT, remainingLength))
+    {
+        disconnect(F("CONNECT too large"));
+        return;
+    }
+    addString("MQTT", 4);
+    uint8_t protocolLevel = 4;
+    addBytes(&protocolLevel, 1);
+    addBytes(&flags, 1);
+    addUInt16(MQTT_KEEP_ALIVE);
+    addString(_clientId, strlen(_clientId));
+    addString(_availabilityTopic);
+    addString(offline, strlen(offline));
+    if (hasUser) addString(_user, strlen(_user));
+    if (hasPassword) addString(_password, strlen(_password));
+
+    if (!sendPacket())
+    {
+        disconnect(F("Unable to send CONNECT"));
+        return;
+    }
+    _state = MQTTState::AwaitConnAck;
+    _stateMillis = currentMillis;
+}
+
+
+void MQTTPublisher::onConnected(uint32_t currentMillis)
+{
+    TRACE(F("MQTT connected to %s\n"), _host);
+
+    _state = MQTTState::Connected;
+    _circuitBreaker.recordSuccess();
+    _stats.connects++;
+    _connectedMillis = currentMillis;
+    _publishedSinceConnect = 0;
+    _pingMillis = 0;
+
+    // (Re)publish discovery and all values; the broker may have lost retained messages.
+    _nextDiscovery = 0;
+    for (MQTTSensor& sensor : _sensors)
+        sensor.lastPublishMillis = 0;
+    enqueue(_availabilityTopic, F("online"), 1, true);
+}
+
+
+void MQTTPublisher::disconnect(const String& error)
+{
+    TRACE(F("MQTT disconnected: %s\n"), error.c_str());
+
+    _lastError = error;
+    _client.stop();
+    if (_state != MQTTState::Connected)
+        _circuitBreaker.recordFailure();
+    _state = MQTTState::Disconnected;
+
+    // Unacknowledged QoS 1 messages are sent again after reconnecting.
+    for (MQTTMessage& message : _queue)
+        message.sentMillis = 0;
+}
+
+
+void MQTTPublisher::sendQueued(uint32_t currentMillis)
+{
+    int inFlight = 0;
+    int sent = 0;
+    for (MQTTMessage& message : _queue)
+    {
+        if (sent == MQTT_SENDS_PER_RUN) break;
+
+        if (message.sentMillis != 0)
+        {
+            // Sent with QoS 1; awaiting PUBACK
+            inFlight++;
+            if ((currentMillis - message.sentMillis) >= MQTT_RETRY_MS)
+            {
+                if (!sendPublish(message, true)) return;
+                message.sentMillis = std::max(currentMillis, uint32_t(1));
+                _stats.retransmitted++;
+                sent++;
+            }
+            continue;
+        }
+
+        if ((message.qos > 0) && (inFlight >= MQTT_MAX_IN_FLIGHT)) continue;
+
+        if (message.qos > 0)
+        {
+            message.packetId = _nextPacketId++;
+            if (_nextPacketId == 0) _nextPacketId = 1;
+            inFlight++;
+        }
+        if (!sendPublish(message, false)) return;
+        message.sentMillis = std::max(currentMillis, uint32_t(1));
+        _stats.published++;
+        _publishedSinceConnect++;
+        sent++;
+    }
+
+    // QoS 0 messages are done once sent
+    _queue.erase(
+        std::remove_if(
+            _queue.begin(),
+            _queue.end(),
+            [](const MQTTMessage& message) { return (message.qos == 0) && (message.sentMillis != 0); }),
+        _queue.end());
+}
+
+
+bool MQTTPublisher::sendPublish(MQTTMessage& message, bool isDuplicate)
+{
+    uint8_t header = MQTT_PUBLISH | (message.qos << 1);
+    if (isDuplicate) header |= 0x08;
+    if (message.retain) header |= 0x01;
+
+    size_t remainingLength = 2 + message.topic.length() + message.payload.length();
+    if (message.qos > 0) remainingLength += 2;
+
+    if (!beginPacket(header, remainingLength)) return false;
+    addString(message.topic);
+    if (message.qos > 0) addUInt16(message.packetId);
+    addBytes(reinterpret_cast<const uint8_t*>(message.payload.c_str()), message.payload.length());
+    if (sendPacket()) return true;
+
+    disconnect(F("Unable to send PUBLISH"));
+    return false;
+}
+
+
+void MQTTPublisher::readPackets()
+{
+    while (_client.available() > 0)
+    {
+        int header = readByte();
+
+        // Remaining length is encoded in 1-4 bytes
+        uint32_t remainingLength = 0;
+        uint32_t multiplier = 1;
+        int encodedByte;
+        do
+        {
+            encodedByte = readByte();
+            if ((encodedByte < 0) || (multiplier > 128 * 128 * 128))
+            {
+                disconnect(F("Invalid packet"));
+                return;
+            }
+            remainingLength += (encodedByte & 0x7F) * multiplier;
+            multiplier *= 128;
+        }
+        while ((encodedByte & 0x80) != 0);
+
+        uint8_t data[4];
+        size_t dataLength = std::min(remainingLength, uint32_t(sizeof(data)));
+        for (size_t i = 0; i < remainingLength; i++)
+        {
+            int dataByte = readByte();
+            if (dataByte < 0)
+            {
+                disconnect(F("Timeout"));
+                return;
+            }
+            if (i < dataLength) data[i] = dataByte;
+        }
+
+        switch (header & 0xF0)
+        {
+            case MQTT_CONNACK:
+                if ((dataLength == 2) && (data[1] == 0))
+                    onConnected(millis());
+                else
+                {
+                    String error = F("Connection refused: ");
+                    error += (dataLength == 2) ? data[1] : -1;
+                    disconnect(error);
+                    return;
+                }
+                break;
+
+            case MQTT_PUBACK:
+                if (dataLength == 2)
+                {
+                    uint16_t packetId = (data[0] << 8) | data[1];
+                    auto messageIterator = std::find_if(
+                        _queue.begin(),
+                        _queue.end(),
+                        [packetId](const MQTTMessage& message) { return (message.sentMillis != 0) && (message.packetId == packetId); });
+                    if (messageIterator != _queue.end())
+                    {
+                        _queue.erase(messageIterator);
+                        _stats.acknowledged++;
+                    }
+                }
+                break;
+
+            case MQTT_PINGRESP:
+                _pingMillis = 0;
+                break;
+        }
+    }
+}
+
+
+int MQTTPublisher::readByte()
+{
+    // Packets from the broker are small, so the remainder should arrive shortly.
+    uint32_t startMillis = millis();
+    while (_client.available() == 0)
+    {
+        if (!_client.connected() || (millis() - startMillis >= _timeoutMs)) return -1;
+        delay(1);
+    }
+    return _client.read();
+}
+
+
+bool MQTTPublisher::beginPacket(uint8_t header, size_t remainingLength)
+{
+    if (remainingLength + 5 > MQTT_MAX_PACKET_SIZE) return false;
+
+    _packetLength = 0;
+    _packet[_packetLength++] = header;
+    do
+    {
+        uint8_t encodedByte = remainingLength % 128;
+        remainingLength /= 128;
+        if (remainingLength > 0) encodedByte |= 0x80;
+        _packet[_packetLength++] = encodedByte;
+    }
+    while (remainingLength > 0);
+    return true;
+}
+
+
+void MQTTPublisher::addBytes(const uint8_t* data, size_t size)
+{
+    memcpy(_packet + _packetLength, data, size);
+    _packetLength += size;
+}
+
+
+void MQTTPublisher::addString(const char* str, size_t length)
+{
+    addUInt16(length);
+    addBytes(reinterpret_cast<const uint8_t*>(str), length);
+}
+
+
+void MQTTPublisher::addUInt16(uint16_t value)
+{
+    _packet[_packetLength++] = value >> 8;
+    _packet[_packetLength++] = value & 0xFF;
+}
+
+
+bool MQTTPublisher::sendPacket()
+{
+    if (_client.write(_packet, _packetLength) != _packetLength) return false;
+    _lastSendMillis = millis();
+    return true;
+}
@@ -0,0 +1,142 @@
+#ifndef MQTT_PUBLISHER_H
+#define MQTT_PUBLISHER_H
+
+#include <ESPWiFi.h>
+#include <deque>
+#include <vector>
+#include <CircuitBreaker.h>
+
+constexpr uint16_t MQTT_DEFAULT_PORT = 1883;
+constexpr size_t MQTT_QUEUE_SIZE = 16;
+constexpr size_t MQTT_MAX_PACKET_SIZE = 512;
+constexpr uint8_t MQTT_MAX_IN_FLIGHT = 4; // Unacknowledged QoS 1 messages
+constexpr uint8_t MQTT_SENDS_PER_RUN = 4;
+constexpr uint16_t MQTT_KEEP_ALIVE = 60; // seconds
+constexpr uint32_t MQTT_RETRY_MS = 5000; // Retransmit unacknowledged QoS 1 messages
+constexpr uint32_t MQTT_REFRESH_MS = 10 * 60 * 1000; // Republish unchanged values
+
+enum struct MQTTState : uint8_t
+{
+    Disconnected = 0,
+    AwaitConnAck,
+    Connected
+};
+
+struct MQTTMessage
+{
+    String topic;
+    String payload;
+    uint8_t qos;
+    bool retain;
+    uint16_t packetId; // QoS 1 only
+    uint32_t sentMillis; // Last (re)transmission; 0 if not sent yet
+};
+
+struct MQTTSensor
+{
+    String objectId;
+    const char* name;
+    const char* unit;
+    const char* deviceClass;
+    float deadband;
+    uint8_t decimals;
+    float lastValue;
+    String lastPayload;
+    uint32_t lastPublishMillis;
+};
+
+struct MQTTPublisherStats
+{
+    uint32_t connects = 0;
+    uint32_t published = 0; // Excluding retransmissions
+    uint32_t acknowledged = 0;
+    uint32_t retransmitted = 0;
+    uint32_t suppressed = 0; // Values within the deadband
+    uint32_t coalesced = 0; // Queued messages replaced by a newer value for the same topic
+    uint32_t dropped = 0; // Queue full
+    uint16_t queueHighWater = 0;
+};
+
+// Publishes values to an MQTT (3.1.1) broker, including Home Assistant discovery messages.
+// Messages are queued in a bounded queue; a queued message which is not sent yet is replaced by
+// a newer one for the same topic. QoS 1 messages stay queued until the broker acknowledged them.
+class MQTTPublisher
+{
+    public:
+        MQTTPublisher(uint16_t timeoutMs = 3000) : _timeoutMs(timeoutMs) {}
+
+        bool isEnabled() { return _host != nullptr; }
+        bool isConnected() { return _state == MQTTState::Connected; }
+        MQTTState getState() { return _state; }
+        const char* getStateLabel();
+        size_t getQueueLength() { return _queue.size(); }
+        float getMessagesPerSecond();
+        const MQTTPublisherStats& getStats() { return _stats; }
+        const CircuitBreaker& getCircuitBreaker() { return _circuitBreaker; }
+        const String& getLastError() { return _lastError; }
+
+        // The client ID is also used as device name and topic prefix (e.g. the host name).
+        bool begin(const char* host, uint16_t port, const char* user, const char* password, const char* clientId);
+        void end();
+
+        // QoS used for sensor values (0 or 1); discovery messages always use QoS 1.
+        void setQoS(uint8_t qos) { _qos = qos; }
+
+        // Registers a sensor for Home Assistant discovery; returns its index.
+        int addSensor(const char* name, const char* unit = nullptr, const char* deviceClass = nullptr, float deadband = 0, uint8_t decimals = 1);
+
+        // Publishes the value if it changed more than the deadband or wasn't published for a while.
+        void setValue(int sensorIndex, float value);
+        void setValue(int sensorIndex, const char* value);
+
+        bool publish(const String& topic, const String& payload, uint8_t qos = 0, bool retain = false);
+
+        // Call repeatedly (e.g. from loop) while WiFi is connected.
+        void run();
+
+    private:
+        uint16_t _timeoutMs;
+        const char* _host = nullptr;
+        uint16_t _port;
+        const char* _user;
+        const char* _password;
+        const char* _clientId;
+        String _availabilityTopic;
+        uint8_t _qos = 0;
+        volatile MQTTState _state = MQTTState::Disconnected;
+        WiFiClient _client;
+        CircuitBreaker _circuitBreaker;
+        std::deque<MQTTMessage> _queue;
+        std::vector<MQTTSensor> _sensors;
+        size_t _nextDiscovery = 0;
+        uint16_t _nextPacketId = 1;
+        uint32_t _stateMillis = 0;
+        uint32_t _lastSendMillis = 0;
+        uint32_t _pingMillis = 0; // PINGREQ sent; 0 if not pending
+        uint32_t _connectedMillis = 0;
+        uint32_t _publishedSinceConnect = 0;
+        uint8_t _packet[MQTT_MAX_PACKET_SIZE];
+        size_t _packetLength = 0;
+        MQTTPublisherStats _stats;
+        String _lastError;
+
+        bool enqueue(const String& topic, const String& payload, uint8_t qos, bool retain);
+        void publishSensor(MQTTSensor& sensor, const String& payload);
+        void queueDiscovery();
+        void sendQueued(uint32_t currentMillis);
+        void connect(uint32_t currentMillis);
+        void disconnect(const String& error);
+        void onConnected(uint32_t currentMillis);
+        void readPackets();
+        int readByte();
+        bool beginPacket(uint8_t header, size_t remainingLength);
+        void addBytes(const uint8_t* data, size_t size);
+        void addString(const char* str, size_t length);
+        void addString(const String& str) { addString(str.c_str(), str.length()); }
+        void addUInt16(uint16_t value);
+        bool sendPacket();
+        bool sendPublish(MQTTMessage& message, bool isDuplicate);
+        String getStateTopic(const MQTTSensor& sensor);
+};
+
+#endif
@@ -0,0 +1,168 @@
+#include <Arduino.h>
+#include "MemoryPlanner.h"
+#include <Tracer.h>
+
+
+void MemoryPlanner::add(const char* name, size_t elementSize, size_t count, size_t minCount, std::function<void(void*, size_t)> assign)
+{
+    if (isCommitted())
+    {
+        TRACE(F("MemoryPlanner: '%s' added after commit; ignored.\n"), name);
+        return;
+    }
+
+    MemoryPlanEntry entry
+    {
+        .name = name,
+        .elementSize = elementSize,
+        .count = count,
+        .minCount = std::min(minCount, count),
+        .plannedCount = count,
+        .offset = 0,
+        .assign = assign
+    };
+    _entries.push_back(entry);
+}
+
+
+void MemoryPlanner::add(const char* name, StringLog& log, uint16_t minSize)
+{
+    add(
+        name,
+        log.entrySize(),
+        log.size(),
+        (minSize == 0) ? log.size() : minSize,
+        [&log](void* bufferPtr, size_t count) { log.setBuffer(static_cast<char*>(bufferPtr), count); });
+}
+
+
+void MemoryPlanner::add(const char* name, StructuredEventLog& log, uint16_t minSize)
+{
+    add(
+        name,
+        sizeof(StructuredEvent),
+        log.size(),
+        (minSize == 0) ? log.size() : minSize,
+        [&log](void* bufferPtr, size_t count) { log.setBuffer(static_cast<StructuredEvent*>(bufferPtr), count); });
+}
+
+
+void MemoryPlanner::add(const char* name, StringBuilder& builder, size_t minCapacity)
+{
+    add(
+        name,
+        1,
+        builder.capacity(),
+        (minCapacity == 0) ? builder.capacity() : minCapacity,
+        [&builder](void* bufferPtr, size_t count) { builder.setBuffer(static_cast<char*>(bufferPtr), count); });
+}
+
+
+size_t MemoryPlanner::layout(bool reduced)
+{
+    size_t offset = 0;
+    for (MemoryPlanEntry& entry : _entries)
+    {
+        entry.plannedCount = reduced ? entry.minCount : entry.count;
+        entry.offset = offset;
+        offset += (entry.getSize() + MEMORY_PLAN_ALIGNMENT - 1) & ~(MEMORY_PLAN_ALIGNMENT - 1);
+    }
+    return offset;
+}
+
+
+size_t MemoryPlanner::getInternalBudget()
+{
+#ifdef ESP8266
+    size_t largestBlock = ESP.getMaxFreeBlockSize();
+#else
+    size_t largestBlock = heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+#endif
+    // Leave at least half for WiFi, TLS and HTTP buffers
+    return largestBlock / 2;
+}
+
+
+bool MemoryPlanner::allocateArena(size_t size, MemoryType memoryType)
+{
+    _arenaPtr = Memory::allocate<uint8_t>(size, memoryType);
+    if (_arenaPtr == nullptr) return false;
+
+    _arenaSize = size;
+    _memoryType = memoryType;
+    return true;
+}
+
+
+bool MemoryPlanner::commit()
+{
+    Tracer tracer(F("MemoryPlanner::commit"));
+
+    if (isCommitted()) return true;
+
+    size_t arenaSize = layout(false);
+    bool success = false;
+#ifdef BOARD_HAS_PSRAM
+    success = allocateArena(arenaSize, MemoryType::External);
+#endif
+    if (!success)
+    {
+        size_t internalBudget = getInternalBudget();
+        TRACE(F("Internal memory budget: %u bytes\n"), internalBudget);
+        if (arenaSize <= internalBudget)
+            success = allocateArena(arenaSize, MemoryType::Internal);
+        if (!success)
+        {
+            _isReduced = true;
+            arenaSize = layout(true);
+            success = allocateArena(arenaSize, MemoryType::Internal);
+        }
+    }
+
+    if (!success)
+    {
+        // Buffers will be allocated lazily (if at all).
+        TRACE(F("Unable to allocate %u bytes\n"), arenaSize);
+        return false;
+    }
+
+    for (MemoryPlanEntry& entry : _entries)
+        entry.assign(_arenaPtr + entry.offset, entry.plannedCount);
+
+#ifdef DEBUG_ESP_PORT
+    writeLayout(DEBUG_ESP_PORT);
+#endif
+
+    return true;
+}
+
+
+void MemoryPlanner::writeLayout(Print& output) const
+{
+    if (!isCommitted())
+    {
+        output.println(F("Memory plan not committed."));
+        return;
+    }
+
+    output.printf(
+        "Memory plan: %u bytes %s%s @ %p\n",
+        _arenaSize,
+        (_memoryType == MemoryType::External) ? "external" : "internal",
+        _isReduced ? " (reduced)" : "",
+        _arenaPtr);
+
+    for (const MemoryPlanEntry& entry : _entries)
+    {
+        output.printf(
+            "%06X %-16s %5u x %4u = %6u",
+            entry.offset,
+            entry.name,
+            entry.plannedCount,
+            entry.elementSize,
+            entry.getSize());
+        if (entry.plannedCount < entry.count)
+            output.printf(" (of %u)", entry.count);
+        output.println();
+    }
+}
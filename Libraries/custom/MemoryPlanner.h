@@ -0,0 +1,70 @@
+#ifndef MEMORY_PLANNER_H
+#define MEMORY_PLANNER_H
+
+#include <stdint.h>
+#include <vector>
+#include <functional>
+#include <Print.h>
+#include <PSRAM.h>
+#include <Log.h>
+#include <StructuredEventLog.h>
+#include <StringBuilder.h>
+
+constexpr size_t MEMORY_PLAN_ALIGNMENT = 8;
+
+struct MemoryPlanEntry
+{
+    const char* name;
+    size_t elementSize;
+    size_t count; // Requested number of elements
+    size_t minCount; // Number of elements if memory is scarce
+    size_t plannedCount;
+    size_t offset;
+    std::function<void(void*, size_t)> assign;
+
+    size_t getSize() const { return elementSize * plannedCount; }
+};
+
+class MemoryPlanner
+{
+    public:
+        // Registers a buffer; assign() is called with the buffer and its planned count when the plan is committed.
+        void add(const char* name, size_t elementSize, size_t count, size_t minCount, std::function<void(void*, size_t)> assign);
+
+        template<typename T>
+        void add(const char* name, StaticLog<T>& log, uint16_t minSize = 0)
+        {
+            add(
+                name,
+                sizeof(T),
+                log.size(),
+                (minSize == 0) ? log.size() : minSize,
+                [&log](void* bufferPtr, size_t count) { log.setBuffer(static_cast<T*>(bufferPtr), count); });
+        }
+
+        void add(const char* name, StringLog& log, uint16_t minSize = 0);
+        void add(const char* name, StructuredEventLog& log, uint16_t minSize = 0);
+        void add(const char* name, StringBuilder& builder, size_t minCapacity = 0);
+
+        bool commit();
+
+        bool isCommitted() const { return _arenaPtr != nullptr; }
+        bool isReduced() const { return _isReduced; }
+        MemoryType getMemoryType() const { return _memoryType; }
+        size_t getArenaSize() const { return _arenaSize; }
+
+        void writeLayout(Print& output) const;
+
+    private:
+        std::vector<MemoryPlanEntry> _entries;
+        uint8_t* _arenaPtr = nullptr;
+        size_t _arenaSize = 0;
+        MemoryType _memoryType = MemoryType::Auto;
+        bool _isReduced = false;
+
+        size_t layout(bool reduced);
+        bool allocateArena(size_t size, MemoryType memoryType);
+        static size_t getInternalBudget();
+};
+
+#endif
@@ -1,11 +1,21 @@
 #ifndef PSRAM_H
 #define PSRAM_H
 
-#include <Tracer.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#ifdef ARDUINO
+    #include <Tracer.h>
+#elif !defined(TRACE)
+    // Host build (no Arduino core); tracing is compiled out.
+    #define TRACE(...)
+#endif
 
 #ifdef BOARD_HAS_PSRAM
     #define ESP_MALLOC(size) ps_malloc((size))
-#else
+#elif !defined(ESP_MALLOC)
+    // The host build provides its own, so tests can simulate out of memory.
     #define ESP_MALLOC(size) malloc((size))
 #endif
 
@@ -47,7 +57,7 @@ class Memory
             memoryPtr = heap_caps_malloc(size, caps);
             TRACE((caps & MALLOC_CAP_SPIRAM) ? " external" : " internal");            
 #else
-            memoryPtr = malloc(size);
+            memoryPtr = ESP_MALLOC(size);
 #endif
             TRACE(" (%p)\n", memoryPtr);
             return static_cast<T*>(memoryPtr);
@@ -1,342 +1,806 @@
 #include "PersistentDataBase.h"
 #include "Tracer.h"
 #include <EEPROM.h>
+#ifdef ESP32
+#include <Preferences.h>
+#endif
 
-constexpr uint32_t INITIALIZED_MAGIC = 0xCAFEBABE;
+constexpr uint32_t INITIALIZED_MAGIC = 0xCAFEBABE; // Legacy format: raw data
+constexpr uint32_t TLV_MAGIC = 0x544C5601; // Tag-length-value format, version 1
+constexpr size_t MIN_EEPROM_SIZE = 1024;
 
-// Constructor
-PersistentDataBase::PersistentDataBase(size_t dataSize)
-    : _dataSize(dataSize)
+// EEPROM layout (TLV format):
+//   uint32_t magic
+//   uint16_t schemaVersion
+//   uint16_t recordCount
+//   Records: { uint16_t tag, uint16_t size, uint16_t crc, uint8_t data[size] }
+constexpr size_t TLV_HEADER_SIZE = 8;
+constexpr size_t TLV_RECORD_HEADER_SIZE = 6;
+
+// NVS layout: schema version and a key per field ("f" + tag in hex) in a single namespace.
+// NVS has its own CRC per entry.
+constexpr const char* NVS_NAMESPACE = "settings";
+constexpr const char* NVS_SCHEMA_KEY = "schema";
+
+
+static uint16_t crc16(const uint8_t* data, size_t size, uint16_t crc = 0xFFFF)
 {
+    // CRC-16/CCITT-FALSE
+    for (size_t i = 0; i < size; i++)
+    {
+        crc ^= static_cast<uint16_t>(data[i]) << 8;
+        for (int bit = 0; bit < 8; bit++)
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : (crc << 1);
+    }
+    return crc;
 }
 
 
-// Destructor
-PersistentDataBase::~PersistentDataBase()
+template<typename T>
+static T readEEPROM(size_t address)
 {
-    EEPROM.end();
+    T value;
+    uint8_t* bytePtr = (uint8_t*) &value;
+    for (size_t i = 0; i < sizeof(T); i++)
+        *bytePtr++ = EEPROM.read(address + i);
+    return value;
 }
 
 
-void PersistentDataBase::begin()
+static void readEEPROM(size_t address, uint8_t* data, size_t size)
 {
-    Tracer tracer(F("PersistentDataBase::begin"));
-
-    EEPROM.begin(1024);
+    for (size_t i = 0; i < size; i++)
+        *data++ = EEPROM.read(address + i);
+}
 
-    if (readFromEEPROM())
-    {
-        validate();
-        return;
-    }
 
-    TRACE(F("EEPROM not initialized; initializing PersistentData with defaults.\n"));
-    initialize();
+static void writeEEPROM(size_t address, const uint8_t* data, size_t size)
+{
+    for (size_t i = 0; i < size; i++)
+        EEPROM.write(address + i, *data++);
 }
 
 
-void PersistentDataBase::writeToEEPROM()
+template<typename T>
+static void writeEEPROM(size_t address, T value)
 {
-    Tracer tracer(F("PersistentDataBase::writeToEEPROM"));
-
-    uint32_t magic = INITIALIZED_MAGIC;
+    writeEEPROM(address, (const uint8_t*) &value, sizeof(T));
+}
 
-    TRACE(F("Writing %u + %u bytes to EEPROM...\n"), _dataSize, sizeof(magic));
-    printData();
- 
-    // Write magic
-    uint8_t* bytePtr = (uint8_t*) &magic;
-    for (size_t i = 0; i < sizeof(magic); i++)
-        EEPROM.write(i, *bytePtr++);
 
-    // Write actual data
-    bytePtr = ((uint8_t*) &_dataSize) + sizeof(_dataSize);
-    for (size_t i = 0; i < _dataSize; i++)
-        EEPROM.write(i + sizeof(magic), *bytePtr++);
-    EEPROM.commit();
+// Constructor
+PersistentDataBase::PersistentDataBase()
+{
+    memset(_storedCRC, 0, sizeof(_storedCRC));
 }
 
 
-bool PersistentDataBase::readFromEEPROM()
+// Destructor
+PersistentDataBase::~PersistentDataBase()
 {
-    Tracer tracer(F("PersistentDataBase::readFromEEPROM"));
+    EEPROM.end();
+}
 
-    uint32_t magic;
-    TRACE(F("Reading %u + %u bytes from EEPROM...\n"), _dataSize, sizeof(magic)); 
 
-    // Read magic
-    uint8_t* bytePtr = (uint8_t*) &magic;
-    for (size_t i = 0; i < sizeof(magic); i++)
-        *bytePtr++ = EEPROM.read(i);
+uint16_t PersistentDataBase::getFieldTag(PGM_P label)
+{
+    // Same as PersistentDataField::getTag, but for labels in PROGMEM
+    uint16_t crc = 0xFFFF;
+    for (PGM_P charPtr = label; pgm_read_byte(charPtr) != 0; charPtr++)
+    {
+        uint8_t c = pgm_read_byte(charPtr);
+        crc = crc16(&c, 1, crc);
+    }
+    return crc;
+}
 
-    TRACE(F("Magic: %08X\n"), magic);
-    if (magic != INITIALIZED_MAGIC)
-        return false;
 
-    // Read actual data
-    bytePtr = ((uint8_t*) &_dataSize) + sizeof(_dataSize);
-    for (size_t i = 0; i < _dataSize; i++)
-        *bytePtr++ = EEPROM.read(i + sizeof(magic));
+void PersistentDataBase::addFields(const PersistentDataField* fields, size_t count)
+{
+    if ((_fieldTableCount == MAX_PERSISTENT_FIELD_TABLES) || (_fieldCount + count > MAX_PERSISTENT_FIELDS))
+    {
+        TRACE(F("ERROR: Too many persistent fields\n"));
+        return;
+    }
 
-    printData();
+    _fieldTables[_fieldTableCount++] = { fields, count };
+    _fieldCount += count;
 
-    return true;
+    // The legacy EEPROM image is the raw data following _dataSize (aligned to 4 bytes)
+    size_t dataOffset = getDataOffset();
+    for (size_t i = 0; i < count; i++)
+    {
+        PersistentDataField field;
+        memcpy_P(&field, fields + i, sizeof(PersistentDataField));
+        _dataSize = std::max(_dataSize, (field.offset + field.size - dataOffset + 3) & ~3);
+    }
 }
 
 
-void PersistentDataBase::printData()
+size_t PersistentDataBase::getDataOffset() const
 {
-    uint8_t* dataPtr = ((uint8_t*) &_dataSize) + sizeof(_dataSize);
-    Tracer::hexDump(dataPtr, _dataSize);
+    return (reinterpret_cast<const uint8_t*>(&_dataSize) + sizeof(_dataSize)) - reinterpret_cast<const uint8_t*>(this);
 }
 
 
-void PersistentDataBase::addField(PersistentDataField* fieldPtr, size_t dataSize)
+void PersistentDataBase::getField(size_t index, PersistentDataField& field) const
 {
-    _fields.push_back(fieldPtr);
-    _dataSize += dataSize;
+    for (size_t i = 0; i < _fieldTableCount; i++)
+    {
+        const FieldTable& table = _fieldTables[i];
+        if (index < table.count)
+        {
+            memcpy_P(&field, table.fields + index, sizeof(PersistentDataField));
+            return;
+        }
+        index -= table.count;
+    }
 }
 
 
-void PersistentDataBase::addStringField(char* value, size_t size, PGM_P label, PGM_P defaultValue)
+uint8_t* PersistentDataBase::getValuePtr(const PersistentDataField& field)
 {
-    PersistentStringField* fieldPtr = new PersistentStringField;
-    fieldPtr->value = value;
-    fieldPtr->size = size;
-    fieldPtr->label = label;
-    fieldPtr->defaultValue = defaultValue;
-    addField(fieldPtr, size);
+    // Field offsets are relative to the settings object. With single inheritance this base is at its start.
+    return reinterpret_cast<uint8_t*>(this) + field.offset;
 }
 
 
-void PersistentDataBase::addPasswordField(char* value, size_t size, PGM_P label)
+int PersistentDataBase::findField(uint16_t tag) const
 {
-    PersistentPasswordField* fieldPtr = new PersistentPasswordField;
-    fieldPtr->value = value;
-    fieldPtr->size = size;
-    fieldPtr->label = label;
-    fieldPtr->defaultValue = nullptr;
-    addField(fieldPtr, size);
+    PersistentDataField field;
+    for (size_t i = 0; i < _fieldCount; i++)
+    {
+        getField(i, field);
+        if (field.tag == tag) return i;
+    }
+    return -1;
 }
 
 
-void PersistentDataBase::addIntegerField(int& value, PGM_P label, int minValue, int maxValue, int defaultValue)
+size_t PersistentDataBase::getStorageSize()
 {
-    PersistentIntegerField* fieldPtr = new PersistentIntegerField;
-    fieldPtr->valuePtr = &value;
-    fieldPtr->label = label;
-    fieldPtr->minValue = minValue;
-    fieldPtr->maxValue = maxValue;
-    fieldPtr->defaultValue = defaultValue;
-    addField(fieldPtr, sizeof(int));
+    size_t result = TLV_HEADER_SIZE;
+    PersistentDataField field;
+    for (size_t i = 0; i < _fieldCount; i++)
+    {
+        getField(i, field);
+        result += TLV_RECORD_HEADER_SIZE + field.size;
+    }
+    return result;
 }
 
 
-void PersistentDataBase::addTimeSpanField(int& value, PGM_P label, int minValue, int maxValue, int defaultValue)
+void PersistentDataBase::begin(PersistentStorage storage)
 {
-    PersistentTimeSpanField* fieldPtr = new PersistentTimeSpanField;
-    fieldPtr->valuePtr = &value;
-    fieldPtr->label = label;
-    fieldPtr->minValue = minValue;
-    fieldPtr->maxValue = maxValue;
-    fieldPtr->defaultValue = defaultValue;
-    addField(fieldPtr, sizeof(int));
+    Tracer tracer(F("PersistentDataBase::begin"));
+
+#ifdef ESP32
+    _storage = storage;
+#else
+    if (storage == PersistentStorage::NVS)
+        TRACE(F("NVS not supported; using EEPROM.\n"));
+#endif
+
+    bool success = (_storage == PersistentStorage::NVS) && readFromNVS();
+    if (!success)
+    {
+        size_t requiredSize = std::max(getStorageSize(), sizeof(INITIALIZED_MAGIC) + _dataSize);
+        _eepromSize = std::max(MIN_EEPROM_SIZE, (requiredSize + 255) & ~255);
+        EEPROM.begin(_eepromSize);
+        success = readFromEEPROM();
+        if (_storage == PersistentStorage::NVS)
+        {
+            // Settings in EEPROM (if any) are migrated to NVS
+            EEPROM.end();
+            _isLayoutValid = false;
+        }
+    }
+
+    if (success)
+    {
+        validate();
+        if (!_isLayoutValid)
+        {
+            TRACE(F("Storage layout changed; rewriting all fields.\n"));
+            writeToEEPROM();
+        }
+        return;
+    }
+
+    TRACE(F("EEPROM not initialized; initializing PersistentData with defaults.\n"));
+    initialize();
 }
 
 
-void PersistentDataBase::addFloatField(float& value, PGM_P label, int decimals, float minValue, float maxValue, float defaultValue)
+void PersistentDataBase::writeToEEPROM()
 {
-    PersistentFloatField* fieldPtr = new PersistentFloatField;
-    fieldPtr->valuePtr = &value;
-    fieldPtr->label = label;
-    fieldPtr->decimals = decimals;
-    fieldPtr->minValue = minValue;
-    fieldPtr->maxValue = maxValue;
-    fieldPtr->defaultValue = defaultValue;
-    addField(fieldPtr, sizeof(float));
+    Tracer tracer(F("PersistentDataBase::writeToEEPROM"));
+
+    if (_storage == PersistentStorage::NVS)
+    {
+        writeToNVS();
+        return;
+    }
+
+    size_t storageSize = getStorageSize();
+    if (storageSize > _eepromSize)
+    {
+        TRACE(F("ERROR: %u bytes required, EEPROM size is %u bytes.\n"), storageSize, _eepromSize);
+        return;
+    }
+
+    if (_isLayoutValid)
+        writeChangedRecords();
+    else
+        writeRecords();
 }
 
 
-void PersistentDataBase::addBooleanField(bool& value, PGM_P label, bool defaultValue, size_t dataSize)
+void PersistentDataBase::writeRecords()
 {
-    PersistentBooleanField* fieldPtr = new PersistentBooleanField;
-    fieldPtr->valuePtr = &value;
-    fieldPtr->label = label;
-    fieldPtr->defaultValue = defaultValue;
-    addField(fieldPtr, dataSize);
+    TRACE(F("Writing %u fields (%u bytes) to EEPROM...\n"), _fieldCount, getStorageSize());
+    printData();
+
+    writeEEPROM(0, TLV_MAGIC);
+    writeEEPROM(4, _schemaVersion);
+    writeEEPROM(6, static_cast<uint16_t>(_fieldCount));
+
+    size_t address = TLV_HEADER_SIZE;
+    PersistentDataField field;
+    for (size_t i = 0; i < _fieldCount; i++)
+    {
+        getField(i, field);
+        uint8_t* valuePtr = getValuePtr(field);
+        uint16_t crc = crc16(valuePtr, field.size);
+        writeEEPROM(address, field.tag);
+        writeEEPROM(address + 2, field.size);
+        writeEEPROM(address + 4, crc);
+        writeEEPROM(address + TLV_RECORD_HEADER_SIZE, valuePtr, field.size);
+        address += TLV_RECORD_HEADER_SIZE + field.size;
+        _storedCRC[i] = crc;
+    }
+
+    if (EEPROM.commit())
+        _isLayoutValid = true;
+    else
+        TRACE(F("EEPROM commit failed\n"));
 }
 
 
-void PersistentDataBase::initialize()
+void PersistentDataBase::writeChangedRecords()
 {
-    for (PersistentDataField* fieldPtr : _fields)
-        fieldPtr->initialize();
+    // Only rewrite fields which have changed since they were read or written.
+    size_t changedFields = 0;
+    size_t address = TLV_HEADER_SIZE;
+    PersistentDataField field;
+    for (size_t i = 0; i < _fieldCount; i++)
+    {
+        getField(i, field);
+        uint8_t* valuePtr = getValuePtr(field);
+        uint16_t crc = crc16(valuePtr, field.size);
+        if (crc != _storedCRC[i])
+        {
+            TRACE(F("Field '%s' changed\n"), field.label);
+            writeEEPROM(address + 4, crc);
+            writeEEPROM(address + TLV_RECORD_HEADER_SIZE, valuePtr, field.size);
+            _storedCRC[i] = crc;
+            changedFields++;
+        }
+        address += TLV_RECORD_HEADER_SIZE + field.size;
+    }
+
+    TRACE(F("%u of %u fields changed\n"), changedFields, _fieldCount);
+    if ((changedFields != 0) && !EEPROM.commit())
+    {
+        TRACE(F("EEPROM commit failed\n"));
+        _isLayoutValid = false;
+    }
 }
 
 
-void PersistentDataBase::validate()
+bool PersistentDataBase::readFromEEPROM()
 {
-    for (PersistentDataField* fieldPtr : _fields)
-        fieldPtr->validate();
+    Tracer tracer(F("PersistentDataBase::readFromEEPROM"));
+
+    uint32_t magic = readEEPROM<uint32_t>(0);
+    TRACE(F("Magic: %08X\n"), magic);
+
+    if (magic == TLV_MAGIC)
+        return readRecords();
+    if (magic == INITIALIZED_MAGIC)
+        return readLegacyData();
+    return false;
 }
 
 
-void PersistentDataBase::writeHtmlForm(HtmlWriter& html)
+bool PersistentDataBase::readLegacyData()
 {
-    Tracer tracer(F("PersistentDataBase::writeHtmlForm"));
+    // Fields added after the legacy format are not in the image (EEPROM is erased there)
+    size_t legacySize = (_legacyDataEnd == 0) ? _dataSize : std::min(_dataSize, _legacyDataEnd - getDataOffset());
+    TRACE(F("Reading %u bytes of legacy data from EEPROM...\n"), legacySize);
+    initialize();
 
-    int i = 1;
-    for (PersistentDataField* fieldPtr : _fields)
-    {
-        String fieldId = "f";
-        fieldId += i++;
-        fieldPtr->writeHtml(html, fieldId);
-    }
+    // Read actual data
+    uint8_t* bytePtr = ((uint8_t*) &_dataSize) + sizeof(_dataSize);
+    readEEPROM(sizeof(INITIALIZED_MAGIC), bytePtr, legacySize);
+
+    printData();
+
+    migrate(0);
+    _isLayoutValid = false; // Convert to TLV format
+    return true;
 }
 
-void PersistentDataBase::parseHtmlFormData(std::function<String(const String&)> formDataById)
+
+bool PersistentDataBase::readRecords()
 {
-    Tracer tracer(F("PersistentDataBase::parseHtmlFormData"));
+    uint16_t schemaVersion = readEEPROM<uint16_t>(4);
+    uint16_t recordCount = readEEPROM<uint16_t>(6);
+    TRACE(F("Reading %u fields from EEPROM. Schema version %u\n"), recordCount, schemaVersion);
+
+    // Fields not present in EEPROM get their default value
+    initialize();
+
+    _isLayoutValid = (schemaVersion == _schemaVersion) && (recordCount == _fieldCount);
 
-    int i = 1;
-    for (PersistentDataField* fieldPtr : _fields)
+    std::vector<uint8_t> data;
+    size_t address = TLV_HEADER_SIZE;
+    for (uint16_t i = 0; i < recordCount; i++)
     {
-        String fieldLabel = FPSTR(fieldPtr->label);
-        String fieldId = "f";
-        fieldId += i++;
-        String fieldValue = formDataById(fieldId);
-        TRACE(F("'%s' = '%s'\n"), fieldLabel.c_str(), fieldValue.substring(0, 64).c_str());
-        fieldPtr->parse(fieldValue);
+        if (address + TLV_RECORD_HEADER_SIZE > _eepromSize)
+        {
+            TRACE(F("Record %u exceeds EEPROM size\n"), i);
+            _isLayoutValid = false;
+            break;
+        }
+        uint16_t tag = readEEPROM<uint16_t>(address);
+        uint16_t size = readEEPROM<uint16_t>(address + 2);
+        uint16_t crc = readEEPROM<uint16_t>(address + 4);
+        address += TLV_RECORD_HEADER_SIZE;
+        if (address + size > _eepromSize)
+        {
+            TRACE(F("Record %u exceeds EEPROM size\n"), i);
+            _isLayoutValid = false;
+            break;
+        }
+
+        data.resize(size);
+        readEEPROM(address, data.data(), size);
+        address += size;
+
+        if (crc16(data.data(), size) != crc)
+        {
+            TRACE(F("Record %u (tag %04X) has invalid CRC\n"), i, tag);
+            _isLayoutValid = false;
+            continue;
+        }
+
+        PersistentDataField field;
+        int fieldIndex = findField(tag);
+        if (fieldIndex >= 0)
+            getField(fieldIndex, field);
+
+        if ((fieldIndex != i) || ((fieldIndex >= 0) && (field.size != size)))
+            _isLayoutValid = false;
+
+        if ((fieldIndex >= 0) && field.load(data.data(), size, getValuePtr(field)))
+            _storedCRC[fieldIndex] = crc;
+        else if (!migrateField(tag, data.data(), size, schemaVersion))
+            TRACE(F("Record %u (tag %04X, %u bytes) dropped\n"), i, tag, size);
     }
+
+    if (schemaVersion < _schemaVersion)
+        migrate(schemaVersion);
+
+    printData();
+
+    return true;
 }
 
 
-void PersistentStringField::initialize()
+#ifdef ESP32
+static void getNVSKey(uint16_t tag, char* key, size_t size)
 {
-    if (defaultValue == nullptr)
-        value[0] = 0;
-    else
-        strncpy_P(value, defaultValue, size);
+    snprintf(key, size, "f%04X", tag);
 }
 
 
-void PersistentStringField::validate()
+bool PersistentDataBase::readFromNVS()
 {
-    // Ensure the string is null-terminated
-    value[size - 1] = 0;
+    Tracer tracer(F("PersistentDataBase::readFromNVS"));
+
+    Preferences nvs;
+    if (!nvs.begin(NVS_NAMESPACE, true))
+        return false;
+    if (!nvs.isKey(NVS_SCHEMA_KEY))
+    {
+        nvs.end();
+        return false;
+    }
+
+    uint16_t schemaVersion = nvs.getUShort(NVS_SCHEMA_KEY);
+    TRACE(F("Schema version %u\n"), schemaVersion);
+
+    // Fields not present in NVS get their default value
+    initialize();
+    _isLayoutValid = (schemaVersion == _schemaVersion);
+
+    // Only the fields which are registered are read; fields which are no longer used remain in NVS.
+    std::vector<uint8_t> data;
+    PersistentDataField field;
+    for (size_t i = 0; i < _fieldCount; i++)
+    {
+        getField(i, field);
+        char key[8];
+        getNVSKey(field.tag, key, sizeof(key));
+        size_t size = nvs.getBytesLength(key);
+        if (size == 0)
+        {
+            TRACE(F("Field '%s' not found\n"), field.label);
+            _isLayoutValid = false;
+            continue;
+        }
+
+        data.resize(size);
+        nvs.getBytes(key, data.data(), size);
+        uint8_t* valuePtr = getValuePtr(field);
+        if (field.load(data.data(), size, valuePtr))
+        {
+            if (size == field.size)
+                _storedCRC[i] = crc16(valuePtr, field.size);
+            else
+                _isLayoutValid = false; // Field was resized
+        }
+        else
+        {
+            _isLayoutValid = false;
+            if (!migrateField(field.tag, data.data(), size, schemaVersion))
+                TRACE(F("Field '%s' (%u bytes) dropped\n"), field.label, size);
+        }
+    }
+    nvs.end();
+
+    if (schemaVersion < _schemaVersion)
+        migrate(schemaVersion);
+
+    printData();
+
+    return true;
 }
 
 
-void PersistentStringField::writeHtml(HtmlWriter& html, const String& id)
+void PersistentDataBase::writeToNVS()
 {
-    html.writeTextBox(id, label, value, size - 1);
-}
+    Preferences nvs;
+    if (!nvs.begin(NVS_NAMESPACE, false))
+    {
+        TRACE(F("Unable to open NVS namespace\n"));
+        return;
+    }
+
+    bool success = true;
+    if (!_isLayoutValid)
+        success = nvs.putUShort(NVS_SCHEMA_KEY, _schemaVersion) != 0;
 
+    // Only write the fields which have changed (or all fields if the layout changed)
+    size_t changedFields = 0;
+    PersistentDataField field;
+    for (size_t i = 0; i < _fieldCount; i++)
+    {
+        getField(i, field);
+        uint8_t* valuePtr = getValuePtr(field);
+        uint16_t crc = crc16(valuePtr, field.size);
+        if (_isLayoutValid && (crc == _storedCRC[i])) continue;
+
+        char key[8];
+        getNVSKey(field.tag, key, sizeof(key));
+        if (nvs.putBytes(key, valuePtr, field.size) == field.size)
+        {
+            _storedCRC[i] = crc;
+            changedFields++;
+        }
+        else
+        {
+            TRACE(F("Unable to write field '%s'\n"), field.label);
+            success = false;
+        }
+    }
+    nvs.end();
 
-void PersistentStringField::parse(const String& str)
+    TRACE(F("%u of %u fields written to NVS\n"), changedFields, _fieldCount);
+    _isLayoutValid = success;
+}
+#else
+bool PersistentDataBase::readFromNVS()
 {
-    strncpy(value, str.c_str(), size);
-    value[size - 1] = 0;
+    return false;
 }
 
 
-void PersistentPasswordField::writeHtml(HtmlWriter& html, const String& id)
+void PersistentDataBase::writeToNVS()
 {
-    html.writeTextBox(id, label, value, size - 1, F("password"));
 }
+#endif
 
 
-void PersistentIntegerField::initialize()
+void PersistentDataBase::printData()
 {
-    *valuePtr = defaultValue;
+    uint8_t* dataPtr = ((uint8_t*) &_dataSize) + sizeof(_dataSize);
+    Tracer::hexDump(dataPtr, _dataSize);
 }
 
 
-void PersistentIntegerField::validate()
+void PersistentDataBase::initialize()
 {
-    *valuePtr = std::min(std::max(*valuePtr, minValue), maxValue);
+    PersistentDataField field;
+    for (size_t i = 0; i < _fieldCount; i++)
+    {
+        getField(i, field);
+        field.initialize(getValuePtr(field));
+    }
 }
 
 
-void PersistentIntegerField::writeHtml(HtmlWriter& html, const String& id)
+void PersistentDataBase::validate()
 {
-    html.writeNumberBox(id, label, *valuePtr, minValue, maxValue);
+    PersistentDataField field;
+    for (size_t i = 0; i < _fieldCount; i++)
+    {
+        getField(i, field);
+        field.validate(getValuePtr(field));
+    }
 }
 
 
-void PersistentIntegerField::parse(const String& str)
+void PersistentDataBase::writeHtmlForm(HtmlWriter& html)
 {
-    *valuePtr = str.toInt();
-}
+    Tracer tracer(F("PersistentDataBase::writeHtmlForm"));
 
+    char fieldId[8];
+    int id = 1;
+    PersistentDataField field;
+    for (size_t i = 0; i < _fieldCount; i++)
+    {
+        getField(i, field);
+        if (field.type == PersistentFieldType::Binary) continue;
+        snprintf(fieldId, sizeof(fieldId), "f%d", id++);
+        field.writeHtml(html, fieldId, getValuePtr(field));
+    }
+}
 
-void PersistentTimeSpanField::writeHtml(HtmlWriter& html, const String& id)
+void PersistentDataBase::parseHtmlFormData(std::function<String(const String&)> formDataById)
 {
-    int seconds = *valuePtr;
-    char timeSpan[16];
-    snprintf(
-        timeSpan,
-        sizeof(timeSpan),
-        "%02d:%02d:%02d",
-        seconds / 3600,
-        (seconds / 60) % 60,
-        seconds % 60);
-    html.writeTextBox(id, label, timeSpan, 8);
+    Tracer tracer(F("PersistentDataBase::parseHtmlFormData"));
+
+    char fieldId[8];
+    int id = 1;
+    PersistentDataField field;
+    for (size_t i = 0; i < _fieldCount; i++)
+    {
+        getField(i, field);
+        if (field.type == PersistentFieldType::Binary) continue;
+        snprintf(fieldId, sizeof(fieldId), "f%d", id++);
+        String fieldValue = formDataById(fieldId);
+        TRACE(F("'%s' = '%s'\n"), field.label, fieldValue.substring(0, 64).c_str());
+        field.parse(fieldValue, getValuePtr(field));
+    }
 }
 
 
-void PersistentTimeSpanField::parse(const String& str)
+void PersistentDataField::initialize(uint8_t* valuePtr) const
 {
-    tm time;
-    strptime(str.c_str(), "%H:%M:%S", &time);
-    int seconds = time.tm_hour * 3600 + time.tm_min * 60 + time.tm_sec;
-    *valuePtr = seconds;
+    switch (type)
+    {
+        case PersistentFieldType::String:
+        case PersistentFieldType::Password:
+            if (defaultValue.stringValue == nullptr)
+                valuePtr[0] = 0;
+            else
+                strncpy_P(reinterpret_cast<char*>(valuePtr), defaultValue.stringValue, size);
+            break;
+
+        case PersistentFieldType::Integer:
+        case PersistentFieldType::TimeSpan:
+            *reinterpret_cast<int*>(valuePtr) = defaultValue.intValue;
+            break;
+
+        case PersistentFieldType::Float:
+            *reinterpret_cast<float*>(valuePtr) = defaultValue.floatValue;
+            break;
+
+        case PersistentFieldType::Boolean:
+            *reinterpret_cast<bool*>(valuePtr) = defaultValue.intValue;
+            break;
+
+        case PersistentFieldType::Binary:
+            memset(valuePtr, 0, size);
+            break;
+    }
 }
 
 
-void PersistentFloatField::initialize()
+void PersistentDataField::validate(uint8_t* valuePtr) const
 {
-    *valuePtr = defaultValue;
+    switch (type)
+    {
+        case PersistentFieldType::String:
+        case PersistentFieldType::Password:
+            // Ensure the string is null-terminated
+            valuePtr[size - 1] = 0;
+            break;
+
+        case PersistentFieldType::Integer:
+        case PersistentFieldType::TimeSpan:
+        {
+            int& value = *reinterpret_cast<int*>(valuePtr);
+            value = std::min(std::max(value, minValue.intValue), maxValue.intValue);
+            break;
+        }
+
+        case PersistentFieldType::Float:
+        {
+            float& value = *reinterpret_cast<float*>(valuePtr);
+            value = std::min(std::max(value, minValue.floatValue), maxValue.floatValue);
+            break;
+        }
+
+        default:
+            // Nothing to do
+            break;
+    }
 }
 
 
-void PersistentFloatField::validate()
+void PersistentDataField::writeHtml(HtmlWriter& html, const char* id, const uint8_t* valuePtr) const
 {
-    *valuePtr = std::min(std::max(*valuePtr, minValue), maxValue);
+    switch (type)
+    {
+        case PersistentFieldType::String:
+            html.writeTextBox(id, label, reinterpret_cast<const char*>(valuePtr), size - 1);
+            break;
+
+        case PersistentFieldType::Password:
+            html.writeTextBox(id, label, reinterpret_cast<const char*>(valuePtr), size - 1, "password");
+            break;
+
+        case PersistentFieldType::Integer:
+            html.writeNumberBox(id, label, *reinterpret_cast<const int*>(valuePtr), minValue.intValue, maxValue.intValue);
+            break;
+
+        case PersistentFieldType::TimeSpan:
+        {
+            int seconds = *reinterpret_cast<const int*>(valuePtr);
+            char timeSpan[16];
+            snprintf(
+                timeSpan,
+                sizeof(timeSpan),
+                "%02d:%02d:%02d",
+                seconds / 3600,
+                (seconds / 60) % 60,
+                seconds % 60);
+            html.writeTextBox(id, label, timeSpan, 8);
+            break;
+        }
+
+        case PersistentFieldType::Float:
+            html.writeNumberBox(
+                id,
+                label,
+                *reinterpret_cast<const float*>(valuePtr),
+                minValue.floatValue,
+                maxValue.floatValue,
+                decimals);
+            break;
+
+        case PersistentFieldType::Boolean:
+            html.writeCheckbox(id, label, *reinterpret_cast<const bool*>(valuePtr));
+            break;
+
+        case PersistentFieldType::Binary:
+            // Not shown on the form
+            break;
+    }
 }
 
 
-void PersistentFloatField::writeHtml(HtmlWriter& html, const String& id)
+void PersistentDataField::parse(const String& str, uint8_t* valuePtr) const
 {
-    html.writeNumberBox(id, label, *valuePtr, minValue, maxValue, decimals);
+    switch (type)
+    {
+        case PersistentFieldType::String:
+        case PersistentFieldType::Password:
+        {
+            char* value = reinterpret_cast<char*>(valuePtr);
+            strncpy(value, str.c_str(), size);
+            value[size - 1] = 0;
+            break;
+        }
+
+        case PersistentFieldType::Integer:
+            *reinterpret_cast<int*>(valuePtr) = str.toInt();
+            break;
+
+        case PersistentFieldType::TimeSpan:
+        {
+            tm time;
+            strptime(str.c_str(), "%H:%M:%S", &time);
+            int seconds = time.tm_hour * 3600 + time.tm_min * 60 + time.tm_sec;
+            *reinterpret_cast<int*>(valuePtr) = seconds;
+            break;
+        }
+
+        case PersistentFieldType::Float:
+            *reinterpret_cast<float*>(valuePtr) = str.toFloat();
+            break;
+
+        case PersistentFieldType::Boolean:
+            *reinterpret_cast<bool*>(valuePtr) = str.length() > 0;
+            break;
+
+        case PersistentFieldType::Binary:
+            // Not on the form
+            break;
+    }
 }
 
 
-void PersistentFloatField::parse(const String& str)
+bool PersistentDataField::load(const uint8_t* data, size_t dataSize, uint8_t* valuePtr) const
 {
-    *valuePtr = str.toFloat();
+    if ((type == PersistentFieldType::String) || (type == PersistentFieldType::Password))
+    {
+        // Strings may have been resized; truncate if needed.
+        if (dataSize == 0) return false;
+        size_t copySize = std::min(dataSize, static_cast<size_t>(size));
+        memcpy(valuePtr, data, copySize);
+        valuePtr[copySize - 1] = 0;
+        return true;
+    }
+
+    if (dataSize != size) return false;
+    memcpy(valuePtr, data, size);
+    return true;
 }
 
 
-void PersistentBooleanField::initialize()
+PGM_P BasicWiFiSettings::_defaultHostName = nullptr;
+static const char DEFAULT_NTP_SERVER[] PROGMEM = "europe.pool.ntp.org";
+
+PERSISTENT_FIELD_TABLE_BEGIN
+static constexpr PersistentDataField BASIC_WIFI_SETTINGS_FIELDS[] PROGMEM =
 {
-    *valuePtr = defaultValue;
-}
+    PersistentDataField::stringField("WiFi SSID", PERSISTENT_FIELD(BasicWiFiSettings, wifiSSID)),
+    PersistentDataField::passwordField("WiFi key", PERSISTENT_FIELD(BasicWiFiSettings, wifiKey)),
+    PersistentDataField::stringField("Host name", PERSISTENT_FIELD(BasicWiFiSettings, hostName)),
+    PersistentDataField::stringField("NTP server", PERSISTENT_FIELD(BasicWiFiSettings, ntpServer), DEFAULT_NTP_SERVER)
+};
 
+static constexpr PersistentDataField WIFI_SETTINGS_WITH_FTP_FIELDS[] PROGMEM =
+{
+    PersistentDataField::stringField("FTP server", PERSISTENT_FIELD(WiFiSettingsWithFTP, ftpServer)),
+    PersistentDataField::stringField("FTP user", PERSISTENT_FIELD(WiFiSettingsWithFTP, ftpUser)),
+    PersistentDataField::passwordField("FTP password", PERSISTENT_FIELD(WiFiSettingsWithFTP, ftpPassword))
+};
+PERSISTENT_FIELD_TABLE_END
 
-void PersistentBooleanField::validate()
+
+BasicWiFiSettings::BasicWiFiSettings(PGM_P defaultHostName)
 {
-    // Nothing to do
+    _defaultHostName = defaultHostName;
+    addFields(BASIC_WIFI_SETTINGS_FIELDS);
 }
 
 
-void PersistentBooleanField::writeHtml(HtmlWriter& html, const String& id)
+void BasicWiFiSettings::initialize()
 {
-    html.writeCheckbox(id, label, *valuePtr);
+    PersistentDataBase::initialize();
+    // The default host name is passed at run-time, so it can't be in the field table
+    strncpy_P(hostName, _defaultHostName, sizeof(hostName) - 1);
+    hostName[sizeof(hostName) - 1] = 0;
 }
 
 
-void PersistentBooleanField::parse(const String& str)
+WiFiSettingsWithFTP::WiFiSettingsWithFTP(PGM_P defaultHostName)
+    : BasicWiFiSettings(defaultHostName)
 {
-    *valuePtr = str.length() > 0;
-}
\ No newline at end of file
+    addFields(WIFI_SETTINGS_WITH_FTP_FIELDS);
+}
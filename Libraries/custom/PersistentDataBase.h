@@ -6,105 +6,231 @@
 #include <vector>
 #include <HtmlWriter.h>
 
-struct PersistentDataField
+enum struct PersistentStorage
 {
-    PGM_P label;
-
-    virtual void initialize() = 0;
-    virtual void validate() = 0;
-    virtual void writeHtml(HtmlWriter& html, const String& id) = 0;
-    virtual void parse(const String& str) = 0;
+    EEPROM, // Single image in (emulated) EEPROM
+    NVS // ESP32 only: a key per field in Non-Volatile Storage
 };
 
-struct PersistentStringField : PersistentDataField
+enum struct PersistentFieldType : uint8_t
 {
-    char* value;
-    size_t size;
-    PGM_P defaultValue;
-
-    void initialize() override;
-    void validate() override;
-    void writeHtml(HtmlWriter& html, const String& id) override;
-    void parse(const String& str) override;
+    String,
+    Password,
+    Integer,
+    TimeSpan, // Integer (seconds) shown as hh:mm:ss
+    Float,
+    Boolean,
+    Binary // Not shown on the settings form
 };
 
-struct PersistentPasswordField : PersistentStringField
+constexpr size_t PERSISTENT_FIELD_LABEL_SIZE = 32;
+constexpr size_t MAX_PERSISTENT_FIELDS = 32;
+constexpr size_t MAX_PERSISTENT_FIELD_TABLES = 4;
+
+// The location of a field's value in the settings object; use PERSISTENT_FIELD(class, member).
+template<typename T>
+struct PersistentFieldLocation
 {
-    void writeHtml(HtmlWriter& html, const String& id) override;
+    size_t offset;
 };
 
-struct PersistentIntegerField : PersistentDataField
+// Settings classes have virtual methods, so they are not standard-layout and offsetof() is
+// "conditionally-supported". GCC supports it for classes without virtual bases.
+#define PERSISTENT_FIELD(type, member) PersistentFieldLocation<decltype(type::member)> { offsetof(type, member) }
+#define PERSISTENT_FIELD_TABLE_BEGIN \
+    _Pragma("GCC diagnostic push") \
+    _Pragma("GCC diagnostic ignored \"-Winvalid-offsetof\"")
+#define PERSISTENT_FIELD_TABLE_END _Pragma("GCC diagnostic pop")
+
+// Describes a persistent field. Field tables are constexpr arrays in flash (PROGMEM on ESP8266),
+// defined after the settings class and registered using PersistentDataBase::addFields:
+//
+//   PERSISTENT_FIELD_TABLE_BEGIN
+//   constexpr PersistentDataField MY_SETTINGS_FIELDS[] PROGMEM =
+//   {
+//       PersistentDataField::integerField("Interval", PERSISTENT_FIELD(MySettings, interval), 1, 3600, 60),
+//   };
+//   PERSISTENT_FIELD_TABLE_END
+struct PersistentDataField
 {
-    int* valuePtr;
-    int minValue;
-    int maxValue;
-    int defaultValue;
+    union Value
+    {
+        int intValue;
+        float floatValue;
+        PGM_P stringValue;
 
-    void initialize() override;
-    void validate() override;
-    void writeHtml(HtmlWriter& html, const String& id) override;
-    void parse(const String& str) override;
-};
+        constexpr Value() : intValue(0) {}
+        constexpr Value(int value) : intValue(value) {}
+        constexpr Value(float value) : floatValue(value) {}
+        constexpr Value(PGM_P value) : stringValue(value) {}
+    };
 
-struct PersistentTimeSpanField : PersistentIntegerField
-{
-    void writeHtml(HtmlWriter& html, const String& id) override;
-    void parse(const String& str) override;
-};
+    char label[PERSISTENT_FIELD_LABEL_SIZE]; // Part of the table, so it is in flash too
+    PersistentFieldType type;
+    uint8_t decimals;
+    uint16_t tag; // Identifies the field in EEPROM/NVS; derived from the label
+    uint16_t offset;
+    uint16_t size;
+    Value minValue;
+    Value maxValue;
+    Value defaultValue;
 
-struct PersistentFloatField : PersistentDataField
-{
-    float* valuePtr;
-    int decimals;
-    float minValue;
-    float maxValue;
-    float defaultValue;
+    constexpr PersistentDataField()
+        : label{}, type(PersistentFieldType::Binary), decimals(0), tag(0), offset(0), size(0) {}
 
-    void initialize() override;
-    void validate() override;
-    void writeHtml(HtmlWriter& html, const String& id) override;
-    void parse(const String& str) override;
-};
+    // A label which doesn't fit fails to compile (out of bounds in a constant expression).
+    constexpr PersistentDataField(
+        const char* label,
+        PersistentFieldType type,
+        size_t offset,
+        size_t size,
+        Value minValue = Value(),
+        Value maxValue = Value(),
+        Value defaultValue = Value(),
+        uint8_t decimals = 0)
+        : label{}, type(type), decimals(decimals), tag(getTag(label)), offset(offset), size(size),
+          minValue(minValue), maxValue(maxValue), defaultValue(defaultValue)
+    {
+        size_t i = 0;
+        for (; label[i] != 0; i++) this->label[i] = label[i];
+        this->label[i] = 0;
+    }
 
-struct PersistentBooleanField : PersistentDataField
-{
-    bool* valuePtr;
-    bool defaultValue;
+    template<size_t N>
+    static constexpr PersistentDataField stringField(
+        const char* label, PersistentFieldLocation<char[N]> location, PGM_P defaultValue = nullptr)
+    {
+        return PersistentDataField(label, PersistentFieldType::String, location.offset, N, Value(), Value(), defaultValue);
+    }
 
-    void initialize() override;
-    void validate() override;
-    void writeHtml(HtmlWriter& html, const String& id) override;
-    void parse(const String& str) override;
+    template<size_t N>
+    static constexpr PersistentDataField passwordField(const char* label, PersistentFieldLocation<char[N]> location)
+    {
+        return PersistentDataField(label, PersistentFieldType::Password, location.offset, N);
+    }
+
+    static constexpr PersistentDataField integerField(
+        const char* label, PersistentFieldLocation<int> location, int minValue, int maxValue, int defaultValue = 0)
+    {
+        return PersistentDataField(label, PersistentFieldType::Integer, location.offset, sizeof(int), minValue, maxValue, defaultValue);
+    }
+
+    static constexpr PersistentDataField timeSpanField(
+        const char* label, PersistentFieldLocation<int> location, int minValue, int maxValue, int defaultValue = 0)
+    {
+        return PersistentDataField(label, PersistentFieldType::TimeSpan, location.offset, sizeof(int), minValue, maxValue, defaultValue);
+    }
+
+    static constexpr PersistentDataField floatField(
+        const char* label, PersistentFieldLocation<float> location, int decimals, float minValue, float maxValue, float defaultValue = 0.0F)
+    {
+        return PersistentDataField(label, PersistentFieldType::Float, location.offset, sizeof(float), minValue, maxValue, defaultValue, decimals);
+    }
+
+    static constexpr PersistentDataField booleanField(
+        const char* label, PersistentFieldLocation<bool> location, bool defaultValue = false)
+    {
+        return PersistentDataField(label, PersistentFieldType::Boolean, location.offset, sizeof(bool), Value(), Value(), int(defaultValue));
+    }
+
+    // Not shown on the settings form; initialize it in an initialize() override.
+    template<typename T>
+    static constexpr PersistentDataField binaryField(const char* label, PersistentFieldLocation<T> location)
+    {
+        return PersistentDataField(label, PersistentFieldType::Binary, location.offset, sizeof(T));
+    }
+
+    // CRC-16/CCITT-FALSE of the label
+    static constexpr uint16_t getTag(const char* label)
+    {
+        uint16_t crc = 0xFFFF;
+        for (size_t i = 0; label[i] != 0; i++)
+        {
+            crc ^= static_cast<uint16_t>(static_cast<uint8_t>(label[i])) << 8;
+            for (int bit = 0; bit < 8; bit++)
+                crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : (crc << 1);
+        }
+        return crc;
+    }
+
+    // Field values are located relative to the settings object
+    void initialize(uint8_t* valuePtr) const;
+    void validate(uint8_t* valuePtr) const;
+    void writeHtml(HtmlWriter& html, const char* id, const uint8_t* valuePtr) const;
+    void parse(const String& str, uint8_t* valuePtr) const;
+    bool load(const uint8_t* data, size_t size, uint8_t* valuePtr) const;
 };
 
 struct PersistentDataBase
 {
     public:
-        PersistentDataBase(size_t dataSize = 0);
+        PersistentDataBase();
         ~PersistentDataBase();
 
-        void begin();
+        void begin(PersistentStorage storage = PersistentStorage::EEPROM);
         void writeToEEPROM();
         bool readFromEEPROM();
         void printData();
 
+        uint16_t getSchemaVersion() const { return _schemaVersion; }
+        PersistentStorage getStorage() const { return _storage; }
+        static uint16_t getFieldTag(PGM_P label);
+
         virtual void initialize();
         virtual void validate();
         virtual void writeHtmlForm(HtmlWriter& html);
         virtual void parseHtmlFormData(std::function<String(const String&)> formDataById);
 
     protected:
-        void addField(PersistentDataField* fieldPtr, size_t dataSize);
-        void addStringField(char* value, size_t size, PGM_P label, PGM_P defaultValue = nullptr);
-        void addPasswordField(char* value, size_t size, PGM_P label);
-        void addIntegerField(int& value, PGM_P label, int minValue, int maxValue, int defaultValue = 0);
-        void addTimeSpanField(int& value, PGM_P label, int minValue, int maxValue, int defaultValue = 0);
-        void addFloatField(float& value, PGM_P label, int decimals, float minValue, float maxValue, float defaultValue = 0.0);
-        void addBooleanField(bool& value, PGM_P label, bool defaultValue = false, size_t dataSize = sizeof(bool));
+        // Migration hooks; called while reading from EEPROM.
+        // migrateField() is called for stored fields which don't match a registered field (anymore).
+        // migrate() is called after all fields are read if the stored schema version is older.
+        // Schema version 0 is the legacy format (raw data without fields).
+        virtual bool migrateField(uint16_t tag, const uint8_t* data, size_t size, uint16_t schemaVersion) { return false; }
+        virtual void migrate(uint16_t fromSchemaVersion) {}
+
+        void setSchemaVersion(uint16_t schemaVersion) { _schemaVersion = schemaVersion; }
+
+        // Marks the first field which was added after the legacy format; use PERSISTENT_FIELD(class, member).
+        // Only the data before it is read from a legacy EEPROM image; later fields get their default value.
+        template<typename T>
+        void setLegacyDataEnd(PersistentFieldLocation<T> firstNewField) { _legacyDataEnd = firstNewField.offset; }
+
+        // Registers a (constexpr) field table; each class in the hierarchy adds its own.
+        void addFields(const PersistentDataField* fields, size_t count);
+
+        template<size_t N>
+        void addFields(const PersistentDataField (&fields)[N]) { addFields(fields, N); }
 
     private:
-        std::vector<PersistentDataField*> _fields;
-        size_t _dataSize;
+        struct FieldTable
+        {
+            const PersistentDataField* fields;
+            size_t count;
+        };
+
+        FieldTable _fieldTables[MAX_PERSISTENT_FIELD_TABLES];
+        uint8_t _fieldTableCount = 0;
+        uint8_t _fieldCount = 0;
+        uint16_t _storedCRC[MAX_PERSISTENT_FIELDS]; // CRC of the value last read or written
+        size_t _eepromSize = 0;
+        uint16_t _schemaVersion = 1;
+        PersistentStorage _storage = PersistentStorage::EEPROM;
+        bool _isLayoutValid = false; // EEPROM has the same fields (in the same order) as registered
+        size_t _legacyDataEnd = 0; // Offset of the first field not in the legacy image; 0 if all are
+        size_t _dataSize = 0; // Must be the last member; the (legacy) EEPROM image starts after it.
+
+        void getField(size_t index, PersistentDataField& field) const;
+        uint8_t* getValuePtr(const PersistentDataField& field);
+        size_t getDataOffset() const;
+        int findField(uint16_t tag) const;
+        size_t getStorageSize();
+        bool readLegacyData();
+        bool readRecords();
+        void writeRecords();
+        void writeChangedRecords();
+        bool readFromNVS();
+        void writeToNVS();
 };
 
 struct BasicWiFiSettings : public PersistentDataBase
@@ -114,14 +240,12 @@ struct BasicWiFiSettings : public PersistentDataBase
     char hostName[32];
     char ntpServer[32];
 
-    BasicWiFiSettings(PGM_P defaultHostName, size_t additionalDataSize = 0)
-        : PersistentDataBase(additionalDataSize)
-    {
-        addStringField(wifiSSID, sizeof(wifiSSID), PSTR("WiFi SSID"));
-        addPasswordField(wifiKey, sizeof(wifiKey), PSTR("WiFi key"));
-        addStringField(hostName, sizeof(hostName), PSTR("Host name"), defaultHostName);
-        addStringField(ntpServer, sizeof(ntpServer), PSTR("NTP server"), PSTR("europe.pool.ntp.org"));
-    }
+    BasicWiFiSettings(PGM_P defaultHostName);
+
+    void initialize() override;
+
+    private:
+        static PGM_P _defaultHostName; // Static, so it doesn't affect the (legacy) data layout
 };
 
 struct WiFiSettingsWithFTP : public BasicWiFiSettings
@@ -130,13 +254,7 @@ struct WiFiSettingsWithFTP : public BasicWiFiSettings
     char ftpUser[32];
     char ftpPassword[32];
 
-    WiFiSettingsWithFTP(PGM_P defaultHostName, size_t additionalDataSize = 0)
-        : BasicWiFiSettings(defaultHostName, additionalDataSize)
-    {
-        addStringField(ftpServer, sizeof(ftpServer), PSTR("FTP server"));
-        addStringField(ftpUser, sizeof(ftpUser), PSTR("FTP user"));
-        addPasswordField(ftpPassword, sizeof(ftpPassword), PSTR("FTP password"));
-    }
+    WiFiSettingsWithFTP(PGM_P defaultHostName);
 
     inline bool isFTPEnabled()
     {
@@ -0,0 +1,243 @@
+#include <Arduino.h>
+#include <algorithm>
+#include "PowerManager.h"
+#include <ESPWiFi.h>
+#include <Tracer.h>
+#ifdef ESP32
+#include <esp_sleep.h>
+#include <driver/gpio.h>
+#include <driver/uart.h>
+#elif defined(ESP8266)
+extern "C"
+{
+    #include <user_interface.h>
+}
+#endif
+
+static const char* _wakeCauseLabels[] = { "Timer", "UART", "GPIO", "WiFi", "Event", "Other" };
+
+
+float PowerManagerStats::getSleepPercent() const
+{
+    uint64_t totalUs = sleepUs + awakeUs;
+    return (totalUs == 0) ? 0 : 100.0F * sleepUs / totalUs;
+}
+
+
+float PowerManagerStats::getAvgWakeLatencyUs() const
+{
+    uint32_t timerWakes = wakes[static_cast<int>(WakeCause::Timer)];
+    return (timerWakes == 0) ? 0 : float(totalWakeLatencyUs) / timerWakes;
+}
+
+
+const char* PowerManager::getWakeCauseLabel(WakeCause cause)
+{
+    return _wakeCauseLabels[static_cast<int>(cause)];
+}
+
+
+void PowerManager::enableUartWakeup(Stream& serial, uint8_t uartNum, int threshold)
+{
+    _uartPtr = &serial;
+    _uartNum = uartNum;
+    _uartThreshold = threshold;
+}
+
+
+void PowerManager::enableGpioWakeup(uint8_t pin, bool wakeLevel, std::function<void()> onWake)
+{
+    _gpioPin = pin;
+    _gpioWakeLevel = wakeLevel;
+    _onGpioWake = onWake;
+}
+
+
+void PowerManager::setSleepLimits(uint32_t minSleepMs, uint32_t maxSleepMs)
+{
+    _minSleepMs = minSleepMs;
+    _maxSleepMs = std::max(maxSleepMs, minSleepMs);
+}
+
+
+bool PowerManager::begin()
+{
+    Tracer tracer(F("PowerManager::begin"));
+
+    if (!_sleepHook)
+    {
+#ifdef ESP32
+        // The AP buffers frames for us while the modem sleeps; they're picked up at the next beacon.
+        if (!WiFi.setSleep(WIFI_PS_MIN_MODEM))
+        {
+            TRACE(F("Unable to enable modem sleep\n"));
+            return false;
+        }
+        if (_uartPtr != nullptr)
+        {
+            uart_set_wakeup_threshold(static_cast<uart_port_t>(_uartNum), _uartThreshold);
+            esp_sleep_enable_uart_wakeup(_uartNum);
+        }
+        if (_gpioPin != NO_PIN)
+            esp_sleep_enable_gpio_wakeup();
+#if SOC_PM_SUPPORT_WIFI_WAKEUP
+        esp_sleep_enable_wifi_wakeup();
+#endif
+#elif defined(ESP8266)
+        if (!WiFi.setSleepMode(WIFI_LIGHT_SLEEP))
+        {
+            TRACE(F("Unable to enable light sleep\n"));
+            return false;
+        }
+        if (_uartPtr != nullptr)
+            wifi_enable_gpio_wakeup(3, GPIO_PIN_INTR_LOLEVEL); // RX pin; the start bit is low
+        if (_gpioPin != NO_PIN)
+            wifi_enable_gpio_wakeup(_gpioPin, _gpioWakeLevel ? GPIO_PIN_INTR_HILEVEL : GPIO_PIN_INTR_LOLEVEL);
+#endif
+    }
+
+    _lastWakeMicros = getMicros();
+    _isEnabled = true;
+    return true;
+}
+
+
+void PowerManager::end()
+{
+    if (!_isEnabled) return;
+    _isEnabled = false;
+
+    if (_sleepHook) return;
+#ifdef ESP32
+    esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_ALL);
+#elif defined(ESP8266)
+    wifi_disable_gpio_wakeup();
+    WiFi.setSleepMode(WIFI_MODEM_SLEEP);
+#endif
+}
+
+
+uint32_t PowerManager::getMicros()
+{
+    return (_clock == nullptr) ? micros() : _clock();
+}
+
+
+bool PowerManager::isWakeSourceActive()
+{
+    if ((_uartPtr != nullptr) && (_uartPtr->available() > 0)) return true;
+    if ((_gpioPin != NO_PIN) && !_sleepHook && (digitalRead(_gpioPin) == _gpioWakeLevel)) return true;
+    return false;
+}
+
+
+void PowerManager::sleep(uint32_t maxSleepMs)
+{
+    uint32_t sleepMs = std::min(std::min(_timers.getTimeToNext(), maxSleepMs), _maxSleepMs);
+    if (!_isEnabled || _keepAwake || (sleepMs < _minSleepMs) || isWakeSourceActive())
+    {
+        // A wake source which is still active (e.g. a long GPIO pulse) would end the sleep right away.
+        if (_isEnabled) _stats.skipped++;
+        _timers.sleep(maxSleepMs);
+        return;
+    }
+
+    uint32_t startMicros = getMicros();
+    _stats.awakeUs += startMicros - _lastWakeMicros;
+
+    WakeCause wakeCause = _sleepHook ? _sleepHook(sleepMs) : lightSleep(sleepMs);
+
+    _lastWakeMicros = getMicros();
+    uint32_t sleptUs = _lastWakeMicros - startMicros;
+    _lastWakeCause = wakeCause;
+    _stats.sleeps++;
+    _stats.sleepUs += sleptUs;
+    _stats.wakes[static_cast<int>(wakeCause)]++;
+
+    if (wakeCause == WakeCause::Timer)
+    {
+        uint32_t latencyUs = (sleptUs > sleepMs * 1000) ? sleptUs - sleepMs * 1000 : 0;
+        _stats.totalWakeLatencyUs += latencyUs;
+        _stats.maxWakeLatencyUs = std::max(_stats.maxWakeLatencyUs, latencyUs);
+    }
+    else if ((wakeCause == WakeCause::Gpio) && _onGpioWake)
+        _onGpioWake();
+}
+
+
+WakeCause PowerManager::lightSleep(uint32_t sleepMs)
+{
+#ifdef ESP32
+    esp_sleep_enable_timer_wakeup(uint64_t(sleepMs) * 1000);
+    if (_gpioPin != NO_PIN)
+    {
+        gpio_int_type_t wakeLevel = _gpioWakeLevel ? GPIO_INTR_HIGH_LEVEL : GPIO_INTR_LOW_LEVEL;
+        gpio_wakeup_enable(static_cast<gpio_num_t>(_gpioPin), wakeLevel);
+    }
+
+    esp_err_t result = esp_light_sleep_start();
+
+    if (_gpioPin != NO_PIN)
+        gpio_wakeup_disable(static_cast<gpio_num_t>(_gpioPin));
+    if (result != ESP_OK)
+    {
+        TRACE(F("Light sleep rejected: %d\n"), result);
+        return WakeCause::Other;
+    }
+
+    switch (esp_sleep_get_wakeup_cause())
+    {
+        case ESP_SLEEP_WAKEUP_TIMER:
+            return WakeCause::Timer;
+        case ESP_SLEEP_WAKEUP_UART:
+            return WakeCause::Uart;
+        case ESP_SLEEP_WAKEUP_GPIO:
+            return WakeCause::Gpio;
+#if SOC_PM_SUPPORT_WIFI_WAKEUP
+        case ESP_SLEEP_WAKEUP_WIFI:
+            return WakeCause::WiFi;
+#endif
+        default:
+            return WakeCause::Other;
+    }
+#else
+    // ESP8266: the SDK light-sleeps between DTIM beacons while the loop is delayed.
+    // It doesn't report what woke it, so poll the wake sources at short intervals.
+    uint32_t startMicros = getMicros();
+    uint32_t sleepUs = sleepMs * 1000;
+    uint32_t pollMs = (_uartPtr == nullptr) ? sleepMs : LIGHT_SLEEP_UART_POLL_MS;
+    while (getMicros() - startMicros < sleepUs)
+    {
+        uint32_t remainingMs = (sleepUs - (getMicros() - startMicros) + 999) / 1000;
+        if (_timers.sleep(std::min(remainingMs, pollMs))) return WakeCause::Event;
+        if ((_uartPtr != nullptr) && (_uartPtr->available() > 0)) return WakeCause::Uart;
+        if ((_gpioPin != NO_PIN) && (digitalRead(_gpioPin) == _gpioWakeLevel)) return WakeCause::Gpio;
+    }
+    return WakeCause::Timer;
+#endif
+}
+
+
+void PowerManager::resetStats()
+{
+    _stats = PowerManagerStats();
+    _lastWakeMicros = getMicros();
+}
+
+
+void PowerManager::writeText(Print& output)
+{
+    output.printf(
+        "Light sleep: %u sleeps (%u skipped), %0.1f %% of time asleep\n",
+        static_cast<unsigned int>(_stats.sleeps),
+        static_cast<unsigned int>(_stats.skipped),
+        _stats.getSleepPercent());
+    output.printf(
+        "Wake latency: %0.0f us avg, %u us max\n",
+        _stats.getAvgWakeLatencyUs(),
+        static_cast<unsigned int>(_stats.maxWakeLatencyUs));
+    output.print("Wake causes:");
+    for (int i = 0; i < static_cast<int>(WakeCause::_Count); i++)
+        output.printf(" %s=%u", _wakeCauseLabels[i], static_cast<unsigned int>(_stats.wakes[i]));
+    output.println();
+}
@@ -0,0 +1,104 @@
+#ifndef POWER_MANAGER_H
+#define POWER_MANAGER_H
+
+#include <stdint.h>
+#include <functional>
+#include <Stream.h>
+#include <TimerWheel.h>
+
+constexpr uint32_t LIGHT_SLEEP_MIN_MS = 10; // Shorter sleeps aren't worth the entry/exit overhead
+constexpr uint32_t LIGHT_SLEEP_MAX_MS = 300; // About 3 beacon intervals; keeps the AP association alive
+constexpr uint32_t LIGHT_SLEEP_UART_POLL_MS = 20; // ESP8266 only
+
+enum struct WakeCause : uint8_t
+{
+    Timer = 0,
+    Uart,
+    Gpio,
+    WiFi,
+    Event, // TimerWheel::wake()
+    Other,
+    _Count
+};
+
+struct PowerManagerStats
+{
+    uint32_t sleeps = 0;
+    uint32_t skipped = 0; // Not entered because kept awake, too short or a wake source was already active
+    uint64_t sleepUs = 0;
+    uint64_t awakeUs = 0;
+    uint32_t wakes[static_cast<int>(WakeCause::_Count)] = {0};
+    uint32_t maxWakeLatencyUs = 0; // Timer wakes: time between deadline and resume
+    uint64_t totalWakeLatencyUs = 0;
+
+    float getSleepPercent() const;
+    float getAvgWakeLatencyUs() const;
+};
+
+// Replaces the platform sleep (e.g. for host tests); returns the simulated wake cause.
+using PowerSleepHook = std::function<WakeCause(uint32_t sleepMs)>;
+
+// Puts the chip in light-sleep (WiFi modem asleep) until the next timer deadline or a wake event.
+// ESP32: manual light-sleep with timer, UART and GPIO wake-up (and WiFi wake-up where supported).
+// Sleeps are capped, so the station is awake for beacons often enough to keep its association.
+// ESP8266: the SDK's automatic light-sleep between DTIM beacons while the loop is delayed.
+class PowerManager
+{
+    public:
+        PowerManager(TimerWheel& timers) : _timers(timers) {}
+
+        // Micros clock used for the statistics; for host tests combine with a sleep hook.
+        void setClock(TimerClock microsClock) { _clock = microsClock; }
+        void setSleepHook(PowerSleepHook hook) { _sleepHook = hook; }
+
+        // Wake-up sources must be enabled before begin().
+        // UART wake-up loses the first character(s) received while asleep.
+        void enableUartWakeup(Stream& serial, uint8_t uartNum = 0, int threshold = 3);
+        // The pin must not have an interrupt of its own; onWake is called after a wake-up by the pin.
+        void enableGpioWakeup(uint8_t pin, bool wakeLevel, std::function<void()> onWake = nullptr);
+        void setSleepLimits(uint32_t minSleepMs, uint32_t maxSleepMs);
+
+        bool begin();
+        void end();
+        bool isEnabled() { return _isEnabled; }
+
+        // E.g. while an asynchronous transfer is in progress.
+        void setKeepAwake(bool keepAwake) { _keepAwake = keepAwake; }
+
+        // Sleeps until the next timer deadline (at most maxSleepMs) or a wake event.
+        // Falls back to a regular (interruptible) sleep if light-sleep isn't possible.
+        void sleep(uint32_t maxSleepMs);
+
+        WakeCause getLastWakeCause() { return _lastWakeCause; }
+        static const char* getWakeCauseLabel(WakeCause cause);
+        const PowerManagerStats& getStats() { return _stats; }
+        void resetStats();
+
+        void writeText(Print& output);
+
+    private:
+        static constexpr uint8_t NO_PIN = 0xFF;
+
+        TimerWheel& _timers;
+        TimerClock _clock = nullptr;
+        PowerSleepHook _sleepHook;
+        bool _isEnabled = false;
+        bool _keepAwake = false;
+        uint32_t _minSleepMs = LIGHT_SLEEP_MIN_MS;
+        uint32_t _maxSleepMs = LIGHT_SLEEP_MAX_MS;
+        Stream* _uartPtr = nullptr;
+        uint8_t _uartNum = 0;
+        int _uartThreshold = 3;
+        uint8_t _gpioPin = NO_PIN;
+        bool _gpioWakeLevel = false;
+        std::function<void()> _onGpioWake;
+        uint32_t _lastWakeMicros = 0;
+        WakeCause _lastWakeCause = WakeCause::Timer;
+        PowerManagerStats _stats;
+
+        uint32_t getMicros();
+        bool isWakeSourceActive();
+        WakeCause lightSleep(uint32_t sleepMs);
+};
+
+#endif
@@ -25,9 +25,11 @@ MemoryStream::MemoryStream(size_t size, MemoryType memoryType)
 
 
 MemoryStream::MemoryStream(const String& str)
+    : _memoryType(MemoryType::Auto)
 {
     size_t length = str.length();
     allocateBuffer(length + 1); // Keep room for string terminator
+    if (!_buffer) return;
     memcpy(_buffer, str.c_str(), length);
     _writePos = length;
     _buffer[_writePos] = 0;
@@ -37,14 +39,14 @@ MemoryStream::MemoryStream(const String& str)
 MemoryStream::~MemoryStream()
 {
     TRACE(F("MemoryStream::~MemoryStream() free %p\n"), _buffer);
-    free(_buffer);
+    if (_buffer) free(_buffer);
 }
 
 
 void MemoryStream::allocateBuffer(size_t size)
 {
     _buffer = Memory::allocate<uint8_t>(size, _memoryType);
-    _bufferSize = size;
+    _bufferSize = _buffer ? size : 0;
 }
 
 
@@ -72,9 +74,20 @@ size_t MemoryStream::write(const uint8_t* buffer, size_t size)
     {
         uint8_t* oldBuffer = _buffer;
         size_t oldBufferSize = _bufferSize;
-        allocateBuffer(_bufferSize * 2);
-        memcpy(_buffer, oldBuffer, oldBufferSize);
-        free(oldBuffer);
+        allocateBuffer(std::max(oldBufferSize * 2, _writePos + size + 1));
+        if (!_buffer)
+        {
+            // Allocation failed; keep the old buffer and truncate.
+            _buffer = oldBuffer;
+            _bufferSize = oldBufferSize;
+            if (!_buffer) return 0;
+            size = _bufferSize - _writePos - 1;
+        }
+        else if (oldBuffer)
+        {
+            memcpy(_buffer, oldBuffer, oldBufferSize);
+            free(oldBuffer);
+        }
     }
 
     memcpy(_buffer + _writePos, buffer, size);
@@ -84,3 +97,111 @@ size_t MemoryStream::write(const uint8_t* buffer, size_t size)
     return size;
 }
 
+
+int HttpBodyStream::available()
+{
+    if (_isEnd) return 0;
+    int result = _stream.available();
+    return (_remaining > 0) ? std::min(result, _remaining) : result;
+}
+
+
+int HttpBodyStream::peek()
+{
+    return isDataRemaining() ? _stream.peek() : -1;
+}
+
+
+int HttpBodyStream::read()
+{
+    char c;
+    return (readBytes(&c, 1) == 1) ? static_cast<uint8_t>(c) : -1;
+}
+
+
+size_t HttpBodyStream::readBytes(char* buffer, size_t length)
+{
+    size_t count = 0;
+    while ((count < length) && isDataRemaining())
+    {
+        size_t readSize = length - count;
+        if (_remaining > 0) readSize = std::min(readSize, static_cast<size_t>(_remaining));
+        readSize = _stream.readBytes(buffer + count, readSize);
+        if (readSize == 0)
+        {
+            // Timeout or connection closed
+            _isEnd = true;
+            break;
+        }
+        count += readSize;
+        if (_remaining > 0) _remaining -= readSize;
+    }
+    return count;
+}
+
+
+void HttpBodyStream::drain()
+{
+    // If the length is unknown the body ends when the server closes the connection; don't wait for that.
+    if (!_isChunked && (_remaining < 0)) return;
+
+    char buffer[64];
+    while (readBytes(buffer, sizeof(buffer)) > 0);
+}
+
+
+bool HttpBodyStream::isDataRemaining()
+{
+    if (_isEnd) return false;
+    if (_remaining != 0) return true; // Includes unknown length
+    if (_isChunked && readChunkHeader()) return true;
+    _isEnd = true;
+    return false;
+}
+
+
+bool HttpBodyStream::readChunkHeader()
+{
+    // Each chunk is followed by CRLF
+    if ((_chunkCount++ > 0) && (skipLine() < 0)) return false;
+
+    // Chunk size in hex, optionally followed by extensions (';')
+    int chunkSize = 0;
+    bool isSizeEnd = false;
+    char c;
+    while (true)
+    {
+        if (_stream.readBytes(&c, 1) != 1) return false;
+        if (c == '\n') break;
+        if (isSizeEnd || !isxdigit(c))
+        {
+            isSizeEnd = true;
+            continue;
+        }
+        chunkSize = chunkSize * 16 + (isdigit(c) ? c - '0' : (tolower(c) - 'a' + 10));
+    }
+
+    if (chunkSize == 0)
+    {
+        // Last chunk; skip trailer headers up to the empty line.
+        while (skipLine() > 0);
+        return false;
+    }
+
+    TRACE(F("HttpBodyStream: chunk of %d bytes\n"), chunkSize);
+    _remaining = chunkSize;
+    return true;
+}
+
+
+int HttpBodyStream::skipLine()
+{
+    int length = 0;
+    char c;
+    while (true)
+    {
+        if (_stream.readBytes(&c, 1) != 1) return -1;
+        if (c == '\n') return length;
+        if (c != '\r') length++;
+    }
+}
@@ -14,7 +14,7 @@ class MemoryStream : public Stream
         ~MemoryStream();
 
         size_t size() { return _writePos; }
-        const char* c_str() { return (const char*)_buffer; }
+        const char* c_str() { return _buffer ? (const char*)_buffer : ""; }
 
         int available() override;
         int read() override;
@@ -32,4 +32,36 @@ class MemoryStream : public Stream
         void allocateBuffer(size_t size);
 };
 
+
+// Reads an HTTP response body from a (socket) stream, decoding chunked transfer encoding if needed.
+// Reads block up to the timeout of the underlying stream, so use it from a background task.
+class HttpBodyStream : public Stream
+{
+    public:
+        // Content length -1 means unknown (body ends when the connection closes)
+        HttpBodyStream(Stream& stream, bool isChunked, int contentLength = -1)
+            : _stream(stream), _isChunked(isChunked), _remaining(isChunked ? 0 : contentLength) {}
+
+        // Skips the remainder of the body, so the connection can be reused for the next request.
+        void drain();
+
+        int available() override;
+        int read() override;
+        int peek() override;
+        size_t readBytes(char* buffer, size_t length) override;
+        size_t readBytes(uint8_t* buffer, size_t length) { return readBytes((char*)buffer, length); }
+        size_t write(uint8_t data) override { return 0; }
+
+    private:
+        Stream& _stream;
+        bool _isChunked;
+        bool _isEnd = false;
+        int _remaining; // Bytes remaining in current chunk or body
+        uint32_t _chunkCount = 0;
+
+        bool isDataRemaining();
+        bool readChunkHeader();
+        int skipLine();
+};
+
 #endif
\ No newline at end of file
@@ -3,7 +3,7 @@
 
 StringBuilder::~StringBuilder()
 {
-    if (_buffer) 
+    if (_buffer && _ownsBuffer) 
     {
         TRACE(F("StringBuilder::~StringBuilder() free %p\n"), _buffer);
         free(_buffer);
@@ -11,20 +11,45 @@ StringBuilder::~StringBuilder()
 }
 
 
+void StringBuilder::setBuffer(char* buffer, size_t capacity)
+{
+    // Note: the buffer is not owned; typically it is part of a MemoryPlanner arena.
+    if (_buffer && _ownsBuffer) free(_buffer);
+    _buffer = buffer;
+    _ownsBuffer = false;
+    _isAllocationFailed = false;
+    _capacity = capacity;
+    clear();
+}
+
 
 void StringBuilder::clear()
 {
-    if (!_buffer) _buffer = Memory::allocate<char>(_capacity, _memoryType);
+    _length = 0;
+
+    if (!_buffer)
+    {
+        // Retries a failed allocation (typically once per response), so a transient out of memory doesn't stick.
+        _buffer = Memory::allocate<char>(_capacity, _memoryType);
+        if (!_buffer)
+        {
+            if (!_isAllocationFailed) TRACE(F("StringBuilder: unable to allocate %u bytes\n"), _capacity);
+            _isAllocationFailed = true;
+            _space = 0;
+            return;
+        }
+        _ownsBuffer = true;
+        _isAllocationFailed = false;
+    }
 
     _buffer[0] = 0;
-    _length = 0;
     _space = _capacity;
 }
 
 
 void StringBuilder::printf(const __FlashStringHelper* fformat, ...)
 {
-    if (!_buffer) clear();
+    if (!_buffer && !_isAllocationFailed) clear();
 
     if (_space == 0) return;
 
@@ -47,7 +72,7 @@ size_t StringBuilder::write(uint8_t data)
 
 size_t StringBuilder::write(const uint8_t* dataPtr, size_t size)
 {
-    if (!_buffer) clear();
+    if (!_buffer && !_isAllocationFailed) clear();
 
     if (_space <= 1) return 0;
  
@@ -16,10 +16,12 @@ class StringBuilder : public Print
 
     size_t capacity() const { return _capacity; }
     size_t length() const { return _length; }
+    bool isAllocationFailed() const { return _isAllocationFailed; }
     const char* c_str() const { return _buffer ? _buffer : ""; }
     operator const char*() const { return c_str(); }
     void onLowSpace(std::function<void(size_t)> fn) { _lowSpaceFn = fn; }
 
+    void setBuffer(char* buffer, size_t capacity);
     void clear();
     void printf(const __FlashStringHelper* fformat, ...);
     
@@ -33,6 +35,8 @@ class StringBuilder : public Print
     size_t _space = 0;
     size_t _length = 0;
     char* _buffer = nullptr;
+    bool _ownsBuffer = false;
+    bool _isAllocationFailed = false; // Only clear() retries, not every write
     std::function<void(size_t)> _lowSpaceFn = nullptr;
     
     void adjustLength(size_t additional);
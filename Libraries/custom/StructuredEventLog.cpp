@@ -0,0 +1,433 @@
+#include <Arduino.h>
+#include "StructuredEventLog.h"
+
+#ifdef ESP32
+static portMUX_TYPE _eventLogMux = portMUX_INITIALIZER_UNLOCKED;
+#define EVENT_LOG_LOCK() portENTER_CRITICAL_SAFE(&_eventLogMux)
+#define EVENT_LOG_UNLOCK() portEXIT_CRITICAL_SAFE(&_eventLogMux)
+#define IN_ISR() xPortInIsrContext()
+#else
+#define EVENT_LOG_LOCK() noInterrupts()
+#define EVENT_LOG_UNLOCK() interrupts()
+#define IN_ISR() false
+#endif
+
+enum struct ArgType : uint8_t
+{
+    None, // Literal '%'
+    Int,
+    Long,
+    LongLong,
+    Double,
+    String,
+    Pointer,
+    Invalid
+};
+
+struct FormatSpec
+{
+    char text[16];
+    uint8_t length;
+    uint8_t starCount; // Width and/or precision passed as argument
+    ArgType type;
+};
+
+
+// Appends the current character to the specification and returns the next one.
+static IRAM_ATTR char nextSpecChar(PGM_P& formatPtr, FormatSpec& spec)
+{
+    char c = pgm_read_byte(formatPtr);
+    if (c == 0) return 0;
+    if (spec.length == sizeof(spec.text) - 1) return 0;
+    spec.text[spec.length++] = c;
+    spec.text[spec.length] = 0;
+    formatPtr++;
+    return pgm_read_byte(formatPtr);
+}
+
+
+// Parses a printf conversion specification; formatPtr points to the '%'.
+// Returns a pointer to the first character after the specification.
+// Used by addV, so it must be in IRAM too.
+static IRAM_ATTR PGM_P parseSpec(PGM_P formatPtr, FormatSpec& spec)
+{
+    spec.length = 0;
+    spec.starCount = 0;
+    spec.type = ArgType::Invalid;
+
+    char c = nextSpecChar(formatPtr, spec); // Skip '%'
+    if (c == '%')
+    {
+        nextSpecChar(formatPtr, spec);
+        spec.type = ArgType::None;
+        return formatPtr;
+    }
+
+    while (c && strchr("-+ #0", c)) c = nextSpecChar(formatPtr, spec);
+    if (c == '*')
+    {
+        spec.starCount++;
+        c = nextSpecChar(formatPtr, spec);
+    }
+    else
+        while (isdigit(c)) c = nextSpecChar(formatPtr, spec);
+    if (c == '.')
+    {
+        c = nextSpecChar(formatPtr, spec);
+        if (c == '*')
+        {
+            spec.starCount++;
+            c = nextSpecChar(formatPtr, spec);
+        }
+        else
+            while (isdigit(c)) c = nextSpecChar(formatPtr, spec);
+    }
+
+    int longCount = 0;
+    while (c && strchr("hlzjt", c))
+    {
+        if (c == 'l') longCount++;
+        else if (c == 'j') longCount = 2;
+        else if (c != 'h') longCount = 1; // size_t and ptrdiff_t have the size of long
+        c = nextSpecChar(formatPtr, spec);
+    }
+
+    if (c == 0) return formatPtr;
+    ArgType type = ArgType::Invalid;
+    if (strchr("diuxXoc", c))
+        type = (longCount == 0) ? ArgType::Int : (longCount == 1) ? ArgType::Long : ArgType::LongLong;
+    else if (strchr("fFeEgGaA", c))
+        type = ArgType::Double;
+    else if (c == 's')
+        type = ArgType::String;
+    else if (c == 'p')
+        type = ArgType::Pointer;
+
+    nextSpecChar(formatPtr, spec);
+    spec.type = type;
+    return formatPtr;
+}
+
+
+template<typename T>
+static IRAM_ATTR bool packArg(StructuredEvent& event, T value)
+{
+    if (event.argsSize + sizeof(T) > STRUCTURED_EVENT_ARGS_SIZE) return false;
+    memcpy(event.args + event.argsSize, &value, sizeof(T));
+    event.argsSize += sizeof(T);
+    return true;
+}
+
+
+static IRAM_ATTR bool packString(StructuredEvent& event, const char* str)
+{
+    if (str == nullptr) str = "(null)";
+    size_t available = STRUCTURED_EVENT_ARGS_SIZE - event.argsSize;
+    if (available == 0) return false;
+    size_t length = strlen(str);
+    size_t copyLength = (length < available) ? length : available - 1;
+    memcpy(event.args + event.argsSize, str, copyLength);
+    event.args[event.argsSize + copyLength] = 0;
+    event.argsSize += copyLength + 1;
+    return copyLength == length;
+}
+
+
+template<typename T>
+static bool unpackArg(const StructuredEvent& event, size_t& offset, T& value)
+{
+    if (offset + sizeof(T) > event.argsSize) return false;
+    memcpy(&value, event.args + offset, sizeof(T));
+    offset += sizeof(T);
+    return true;
+}
+
+
+size_t StructuredEvent::toString(char* buffer, size_t size) const
+{
+    if (size == 0) return 0;
+
+    size_t length;
+    if (flags & STRUCTURED_EVENT_EPOCH)
+    {
+        time_t time = timestamp;
+        struct tm tm;
+        length = strftime(buffer, size, "%F %H:%M:%S : ", localtime_r(&time, &tm));
+    }
+    else
+        length = snprintf(buffer, size, "@ %lu ms : ", timestamp);
+    length = std::min(length, size - 1);
+
+    auto append = [&](int n)
+    {
+        if (n > 0) length = std::min(length + n, size - 1);
+    };
+
+    size_t offset = 0;
+    PGM_P formatPtr = this->format;
+    char c;
+    while ((length < size - 1) && (c = pgm_read_byte(formatPtr)) != 0)
+    {
+        if (c != '%')
+        {
+            buffer[length++] = c;
+            formatPtr++;
+            continue;
+        }
+
+        FormatSpec spec;
+        formatPtr = parseSpec(formatPtr, spec);
+        if (spec.type == ArgType::None)
+        {
+            buffer[length++] = '%';
+            continue;
+        }
+        if (spec.type == ArgType::Invalid)
+            break;
+
+        // Substitute width/precision arguments in the specification
+        char specText[48];
+        int stars[2];
+        bool success = true;
+        for (int i = 0; i < spec.starCount; i++)
+            success &= unpackArg(*this, offset, stars[i]);
+        if (!success) break;
+        size_t specLength = 0;
+        int starIndex = 0;
+        for (int i = 0; i < spec.length; i++)
+        {
+            if (spec.text[i] == '*')
+                specLength += snprintf(specText + specLength, sizeof(specText) - specLength, "%d", stars[starIndex++]);
+            else
+                specText[specLength++] = spec.text[i];
+        }
+        specText[specLength] = 0;
+
+        char* outputPtr = buffer + length;
+        size_t available = size - length;
+        switch (spec.type)
+        {
+            case ArgType::Int:
+            {
+                int value;
+                if ((success = unpackArg(*this, offset, value)))
+                    append(snprintf(outputPtr, available, specText, value));
+                break;
+            }
+            case ArgType::Long:
+            {
+                long value;
+                if ((success = unpackArg(*this, offset, value)))
+                    append(snprintf(outputPtr, available, specText, value));
+                break;
+            }
+            case ArgType::LongLong:
+            {
+                long long value;
+                if ((success = unpackArg(*this, offset, value)))
+                    append(snprintf(outputPtr, available, specText, value));
+                break;
+            }
+            case ArgType::Double:
+            {
+                double value;
+                if ((success = unpackArg(*this, offset, value)))
+                    append(snprintf(outputPtr, available, specText, value));
+                break;
+            }
+            case ArgType::Pointer:
+            {
+                void* value;
+                if ((success = unpackArg(*this, offset, value)))
+                    append(snprintf(outputPtr, available, specText, value));
+                break;
+            }
+            case ArgType::String:
+            {
+                const char* value = reinterpret_cast<const char*>(args + offset);
+                size_t valueLength = strnlen(value, argsSize - std::min(offset, (size_t)argsSize));
+                if ((success = (offset + valueLength < argsSize)))
+                {
+                    append(snprintf(outputPtr, available, specText, value));
+                    offset += valueLength + 1;
+                }
+                break;
+            }
+            default:
+                break;
+        }
+        if (!success) break;
+    }
+
+    if ((flags & STRUCTURED_EVENT_TRUNCATED) && (length + 3 < size))
+    {
+        memcpy(buffer + length, "...", 3);
+        length += 3;
+    }
+
+    buffer[length] = 0;
+    return length;
+}
+
+
+void StructuredEventLog::setBuffer(StructuredEvent* entries, uint16_t size)
+{
+    // Note: the buffer is not owned; typically it is part of a MemoryPlanner arena.
+    if (_entries && _ownsEntries) free(_entries);
+    _entries = entries;
+    _ownsEntries = false;
+    _size = size;
+    clear();
+}
+
+
+void StructuredEventLog::clear()
+{
+    EVENT_LOG_LOCK();
+    _count = 0;
+    EVENT_LOG_UNLOCK();
+}
+
+
+IRAM_ATTR uint64_t StructuredEventLog::getUptimeMillis()
+{
+#ifdef ESP8266
+    return micros64() / 1000;
+#else
+    return esp_timer_get_time() / 1000;
+#endif
+}
+
+
+void StructuredEventLog::setCurrentTime(time_t currentTime)
+{
+    _bootTime = currentTime - getUptimeMillis() / 1000;
+}
+
+
+IRAM_ATTR bool StructuredEventLog::add(PGM_P format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    bool result = addV(format, args);
+    va_end(args);
+    return result;
+}
+
+
+IRAM_ATTR bool StructuredEventLog::add(const __FlashStringHelper* format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    bool result = addV(reinterpret_cast<PGM_P>(format), args);
+    va_end(args);
+    return result;
+}
+
+
+IRAM_ATTR bool StructuredEventLog::addV(PGM_P format, va_list args, StructuredEvent* eventPtr)
+{
+    if (_entries == nullptr)
+    {
+        // Can't allocate memory in an ISR; the first event should be logged from a task.
+        if (IN_ISR()) return false;
+        StructuredEvent* entries = Memory::allocate<StructuredEvent>(_size, _memoryType);
+        if (entries == nullptr) return false;
+        EVENT_LOG_LOCK();
+        bool isAllocated = (_entries != nullptr);
+        if (!isAllocated)
+        {
+            _entries = entries;
+            _ownsEntries = true;
+        }
+        EVENT_LOG_UNLOCK();
+        if (isAllocated) free(entries); // Another task beat us to it
+    }
+
+    StructuredEvent event;
+    event.format = format;
+    event.flags = 0;
+    event.argsSize = 0;
+
+    uint64_t uptimeMillis = getUptimeMillis();
+    if (_bootTime != 0)
+    {
+        event.timestamp = _bootTime + uptimeMillis / 1000;
+        event.flags |= STRUCTURED_EVENT_EPOCH;
+    }
+    else
+        event.timestamp = static_cast<uint32_t>(uptimeMillis);
+
+    // Pack the arguments according to the format string
+    bool success = true;
+    PGM_P formatPtr = format;
+    char c;
+    while (success && (c = pgm_read_byte(formatPtr)) != 0)
+    {
+        if (c != '%')
+        {
+            formatPtr++;
+            continue;
+        }
+
+        FormatSpec spec;
+        formatPtr = parseSpec(formatPtr, spec);
+        if (spec.type == ArgType::Invalid) break;
+
+        for (int i = 0; i < spec.starCount; i++)
+            success &= packArg(event, va_arg(args, int));
+        if (!success) break;
+
+        switch (spec.type)
+        {
+            case ArgType::Int:
+                success = packArg(event, va_arg(args, int));
+                break;
+            case ArgType::Long:
+                success = packArg(event, va_arg(args, long));
+                break;
+            case ArgType::LongLong:
+                success = packArg(event, va_arg(args, long long));
+                break;
+            case ArgType::Double:
+                success = packArg(event, va_arg(args, double));
+                break;
+            case ArgType::Pointer:
+                success = packArg(event, va_arg(args, void*));
+                break;
+            case ArgType::String:
+                success = packString(event, va_arg(args, const char*));
+                break;
+            default:
+                break;
+        }
+    }
+    if (!success) event.flags |= STRUCTURED_EVENT_TRUNCATED;
+    if (eventPtr != nullptr)
+        memcpy(eventPtr, &event, sizeof(StructuredEvent));
+
+    EVENT_LOG_LOCK();
+    memcpy(&_entries[_nextSequence % _size], &event, sizeof(StructuredEvent));
+    _nextSequence++;
+    if (_count < _size)
+        _count++;
+    else
+        _overwrittenCount++;
+    EVENT_LOG_UNLOCK();
+
+    return true;
+}
+
+
+bool StructuredEventLog::getEvent(uint32_t sequence, StructuredEvent& event)
+{
+    bool result = false;
+    EVENT_LOG_LOCK();
+    if ((_entries != nullptr) && (_nextSequence - sequence - 1 < _count))
+    {
+        memcpy(&event, &_entries[sequence % _size], sizeof(StructuredEvent));
+        result = true;
+    }
+    EVENT_LOG_UNLOCK();
+    return result;
+}
@@ -0,0 +1,132 @@
+#ifndef STRUCTURED_EVENT_LOG_H
+#define STRUCTURED_EVENT_LOG_H
+
+#include <stdint.h>
+#include <stdarg.h>
+#include <time.h>
+#include <iterator>
+#include <pgmspace.h>
+#include <PSRAM.h>
+
+constexpr size_t STRUCTURED_EVENT_ARGS_SIZE = 38;
+constexpr uint8_t STRUCTURED_EVENT_EPOCH = 1; // Timestamp is in seconds since epoch (else ms since boot)
+constexpr uint8_t STRUCTURED_EVENT_TRUNCATED = 2; // Not all arguments did fit
+
+// An event as stored in the log: the format string doubles as event ID.
+// Arguments are stored in binary form and only formatted when the event is rendered.
+struct StructuredEvent
+{
+    PGM_P format;
+    uint32_t timestamp;
+    uint8_t flags;
+    uint8_t argsSize;
+    uint8_t args[STRUCTURED_EVENT_ARGS_SIZE];
+
+    // Formats the event (including timestamp) like WiFiStateMachine::logEvent would have.
+    size_t toString(char* buffer, size_t size) const;
+};
+
+
+class StructuredEventLog
+{
+    public:
+        StructuredEventLog(uint16_t size, MemoryType memoryType = MemoryType::External)
+            : _memoryType(memoryType), _size(size) {}
+
+        ~StructuredEventLog()
+        {
+            if (_entries && _ownsEntries) free(_entries);
+        }
+
+        uint16_t size() const { return _size; }
+        uint16_t count() const { return _count; }
+        uint32_t getOverwrittenCount() const { return _overwrittenCount; }
+
+        // Sequence numbers of the oldest and next event (survive clear())
+        uint32_t getFirstSequence() const { return _nextSequence - _count; }
+        uint32_t getNextSequence() const { return _nextSequence; }
+
+        void setBuffer(StructuredEvent* entries, uint16_t size);
+        void clear();
+
+        // Establishes the relation between uptime and current time, so events get a real time stamp.
+        void setCurrentTime(time_t currentTime);
+
+        // Adds an event without formatting it. Can be called from any task or ISR (the code is in IRAM).
+        // The format string must remain valid (use F() or a literal); string arguments are copied.
+        // addV optionally returns a copy of the event as stored (e.g. for the FlightRecorder).
+        bool add(PGM_P format, ...);
+        bool add(const __FlashStringHelper* format, ...);
+        bool addV(PGM_P format, va_list args, StructuredEvent* eventPtr = nullptr);
+
+        // Copies an event to the given buffer; returns false if it was overwritten in the meantime.
+        bool getEvent(uint32_t sequence, StructuredEvent& event);
+
+        // Iterator support for range-based for loops.
+        // Events are copied while iterating, so the log can be written concurrently.
+        class iterator
+        {
+            public:
+                using iterator_category = std::forward_iterator_tag;
+                using value_type = StructuredEvent;
+                using difference_type = std::ptrdiff_t;
+                using pointer = const StructuredEvent*;
+                using reference = const StructuredEvent&;
+
+                iterator(StructuredEventLog& log, uint32_t sequence, uint32_t end)
+                    : _log(log), _sequence(sequence), _end(end)
+                {
+                    load();
+                }
+
+                reference operator*() const { return _event; }
+                pointer operator->() const { return &_event; }
+
+                iterator& operator++()
+                {
+                    _sequence++;
+                    load();
+                    return *this;
+                }
+
+                bool operator==(const iterator& other) const { return _sequence == other._sequence; }
+                bool operator!=(const iterator& other) const { return _sequence != other._sequence; }
+
+            private:
+                StructuredEventLog& _log;
+                uint32_t _sequence;
+                uint32_t _end;
+                StructuredEvent _event;
+
+                void load()
+                {
+                    // Skip events which got overwritten while iterating
+                    while ((_sequence != _end) && !_log.getEvent(_sequence, _event))
+                        _sequence++;
+                }
+        };
+
+        // Events added after begin() is called are not included in the iteration.
+        iterator begin()
+        {
+            _iteratorEnd = _nextSequence;
+            return iterator(*this, getFirstSequence(), _iteratorEnd);
+        }
+
+        iterator end() { return iterator(*this, _iteratorEnd, _iteratorEnd); }
+
+    private:
+        MemoryType _memoryType;
+        StructuredEvent* _entries = nullptr;
+        bool _ownsEntries = false;
+        uint16_t _size;
+        uint16_t _count = 0;
+        uint32_t _nextSequence = 0;
+        uint32_t _overwrittenCount = 0;
+        uint32_t _iteratorEnd = 0;
+        volatile uint32_t _bootTime = 0; // Seconds since epoch; 0 if unknown
+
+        static uint64_t getUptimeMillis();
+};
+
+#endif
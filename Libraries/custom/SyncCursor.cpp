@@ -0,0 +1,152 @@
+#include <Arduino.h>
+#include <stddef.h>
+#include "SyncCursor.h"
+#include <Tracer.h>
+#include <algorithm>
+
+#ifdef ESP8266
+constexpr uint32_t RTC_USER_MEMORY_OFFSET = 64; // In 32-bit blocks; below are eboot (OTA) and WiFiConnectCache
+#else
+RTC_NOINIT_ATTR SyncCursorData _syncCursorData[MAX_PERSISTENT_SYNC_CURSORS];
+#endif
+
+static_assert(sizeof(SyncCursorData) % 4 == 0, "RTC memory is accessed in 32-bit words");
+
+
+static uint32_t getChecksum(const SyncCursorData& data)
+{
+    // FNV-1a
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&data);
+    uint32_t hash = 2166136261;
+    for (size_t i = 0; i < offsetof(SyncCursorData, checksum); i++)
+    {
+        hash ^= bytes[i];
+        hash *= 16777619;
+    }
+    return hash;
+}
+
+
+bool SyncCursor::begin(uint8_t slot, uint16_t logCount)
+{
+    if (slot >= MAX_PERSISTENT_SYNC_CURSORS) return false;
+    _slot = slot;
+
+    SyncCursorData data;
+#ifdef ESP8266
+    uint32_t offset = RTC_USER_MEMORY_OFFSET + slot * sizeof(SyncCursorData) / 4;
+    if (!ESP.rtcUserMemoryRead(offset, reinterpret_cast<uint32_t*>(&data), sizeof(data)))
+        memset(&data, 0, sizeof(data));
+#else
+    memcpy(&data, &_syncCursorData[slot], sizeof(data));
+    if (esp_reset_reason() == ESP_RST_POWERON) data.magic = 0;
+#endif
+
+    // RTC memory contains garbage after a power cycle
+    bool isValid = (data.magic == SYNC_CURSOR_MAGIC) && (data.checksum == getChecksum(data));
+    if (isValid)
+    {
+        _headSeq = data.headSeq;
+        _ackedSeq = data.ackedSeq;
+        _lost = data.lost;
+        _lastAckTime = data.lastAckTime;
+        _resumeOffset = data.resumeOffset;
+
+        // Entries which didn't survive the reset can't be synced anymore
+        uint32_t oldestSeq = _headSeq - std::min(logCount, _logCapacity);
+        if ((_headSeq - _ackedSeq) > (_headSeq - oldestSeq))
+        {
+            _lost += oldestSeq - _ackedSeq;
+            _ackedSeq = oldestSeq;
+        }
+        _sentSeq = _ackedSeq; // A transfer in progress was not confirmed
+        TRACE(F("SyncCursor %u restored. Head: %u. Lost: %u\n"), slot, _headSeq, _lost);
+    }
+
+    store();
+    return isValid;
+}
+
+
+void SyncCursor::add()
+{
+    _headSeq++;
+    skipOverwritten(); // Keeps getLost() and the stored state current
+    store();
+}
+
+
+uint16_t SyncCursor::getUnsent()
+{
+    skipOverwritten();
+    return _headSeq - _sentSeq;
+}
+
+
+uint16_t SyncCursor::getLag()
+{
+    skipOverwritten();
+    return _headSeq - _ackedSeq;
+}
+
+
+void SyncCursor::advance(uint16_t count)
+{
+    skipOverwritten();
+    _sentSeq += std::min(count, uint16_t(_headSeq - _sentSeq));
+}
+
+
+void SyncCursor::acknowledge(time_t time)
+{
+    skipOverwritten();
+    _ackedSeq = _sentSeq;
+    _lastAckTime = time;
+    _resumeOffset = SYNC_CURSOR_NO_OFFSET;
+    store();
+}
+
+
+void SyncCursor::setResumeOffset(uint32_t offset)
+{
+    if (offset == _resumeOffset) return;
+    _resumeOffset = offset;
+    store();
+}
+
+
+void SyncCursor::store()
+{
+    if (_slot < 0) return;
+
+    SyncCursorData data;
+    data.magic = SYNC_CURSOR_MAGIC;
+    data.headSeq = _headSeq;
+    data.ackedSeq = _ackedSeq;
+    data.lost = _lost;
+    data.lastAckTime = _lastAckTime;
+    data.resumeOffset = _resumeOffset;
+    data.checksum = getChecksum(data);
+
+#ifdef ESP8266
+    uint32_t offset = RTC_USER_MEMORY_OFFSET + _slot * sizeof(SyncCursorData) / 4;
+    if (!ESP.rtcUserMemoryWrite(offset, reinterpret_cast<uint32_t*>(&data), sizeof(data)))
+        TRACE(F("Unable to write RTC memory\n"));
+#else
+    memcpy(&_syncCursorData[_slot], &data, sizeof(data));
+#endif
+}
+
+
+void SyncCursor::skipOverwritten()
+{
+    // Sequence numbers may wrap, so only their differences are compared.
+    if ((_headSeq - _ackedSeq) > _logCapacity)
+    {
+        uint32_t oldestSeq = _headSeq - _logCapacity;
+        _lost += oldestSeq - _ackedSeq;
+        _ackedSeq = oldestSeq;
+    }
+    if ((_headSeq - _sentSeq) > _logCapacity)
+        _sentSeq = _headSeq - _logCapacity;
+}
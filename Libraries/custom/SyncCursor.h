@@ -0,0 +1,78 @@
+#ifndef SYNC_CURSOR_H
+#define SYNC_CURSOR_H
+
+#include <stdint.h>
+#include <time.h>
+
+constexpr uint32_t SYNC_CURSOR_MAGIC = 0x5C0C0002;
+constexpr uint8_t MAX_PERSISTENT_SYNC_CURSORS = 4;
+constexpr uint32_t SYNC_CURSOR_NO_OFFSET = UINT32_MAX;
+
+// Lives in RTC memory which survives software/panic/watchdog resets, but not a power cycle.
+struct SyncCursorData
+{
+    uint32_t magic;
+    uint32_t headSeq;
+    uint32_t ackedSeq;
+    uint32_t lost;
+    uint32_t lastAckTime;
+    uint32_t resumeOffset;
+    uint32_t checksum;
+};
+
+// Tracks which entries of a circular log have been uploaded, using sequence numbers.
+// Entries only count as synced once the server acknowledged the transfer;
+// after a failed transfer the next one resumes at the oldest unacknowledged entry.
+// The cursor also remembers where those entries start in the remote file,
+// so a resend can overwrite what the failed transfer left instead of duplicating it.
+class SyncCursor
+{
+    public:
+        SyncCursor(uint16_t logCapacity) : _logCapacity(logCapacity) {}
+
+        // Keeps the sequence numbers in the given RTC memory slot (0 .. MAX_PERSISTENT_SYNC_CURSORS-1),
+        // so they survive a reset. logCount is the number of entries the log still holds (0 if it lives in RAM);
+        // unacknowledged entries which didn't survive count as lost. Returns true if the cursor was restored.
+        bool begin(uint8_t slot, uint16_t logCount = 0);
+
+        // Called when an entry is added to the log.
+        void add();
+
+        // Number of entries still to be sent, counted from the end of the log (i.e. log.at(-unsent)).
+        uint16_t getUnsent();
+
+        // Records that the given number of entries was written to the server.
+        void advance(uint16_t count);
+
+        // The server confirmed the transfer; all entries sent so far are synced.
+        void acknowledge(time_t time);
+
+        // The transfer failed; the unacknowledged entries will be sent again.
+        void rollback() { _sentSeq = _ackedSeq; }
+
+        // Number of entries in the log which are not acknowledged yet.
+        uint16_t getLag();
+
+        uint32_t getLost() const { return _lost; } // Entries overwritten before they were synced
+        time_t getLastAckTime() const { return _lastAckTime; }
+
+        // Offset in the remote file where the unacknowledged entries start,
+        // or SYNC_CURSOR_NO_OFFSET if no transfer started since the last acknowledge.
+        uint32_t getResumeOffset() const { return _resumeOffset; }
+        void setResumeOffset(uint32_t offset);
+
+    private:
+        uint16_t _logCapacity;
+        uint32_t _headSeq = 0; // Sequence number of the next entry to add
+        uint32_t _sentSeq = 0; // Next entry to send
+        uint32_t _ackedSeq = 0; // Oldest entry not acknowledged
+        uint32_t _lost = 0;
+        time_t _lastAckTime = 0;
+        uint32_t _resumeOffset = SYNC_CURSOR_NO_OFFSET;
+        int8_t _slot = -1; // RTC memory slot; -1 if not persisted
+
+        void skipOverwritten();
+        void store();
+};
+
+#endif
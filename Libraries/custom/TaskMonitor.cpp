@@ -0,0 +1,162 @@
+#include <Arduino.h>
+#include "TaskMonitor.h"
+
+uint32_t TaskMonitor::_lastLoopMillis = 0;
+uint32_t TaskMonitor::_loopCount = 0;
+uint32_t TaskMonitor::_maxLoopMs = 0;
+uint32_t TaskMonitor::_loopHistogram[LOOP_HISTOGRAM_BUCKETS];
+uint32_t TaskMonitor::_lastTotalRunTime = 0;
+std::vector<TaskMonitor::RunTimeSample> TaskMonitor::_lastRunTimes;
+
+
+void TaskMonitor::recordLoop()
+{
+    uint32_t currentMillis = millis();
+    if (_lastLoopMillis != 0)
+    {
+        uint32_t loopMs = currentMillis - _lastLoopMillis;
+        int bucket = 0;
+        while ((loopMs >> (bucket + 1)) && (bucket < LOOP_HISTOGRAM_BUCKETS - 1))
+            bucket++;
+        _loopHistogram[bucket]++;
+        _maxLoopMs = std::max(_maxLoopMs, loopMs);
+        _loopCount++;
+    }
+    _lastLoopMillis = currentMillis;
+}
+
+
+void TaskMonitor::resetLoopStats()
+{
+    memset(_loopHistogram, 0, sizeof(_loopHistogram));
+    _loopCount = 0;
+    _maxLoopMs = 0;
+}
+
+
+#if defined(ESP32) && (configUSE_TRACE_FACILITY == 1)
+std::vector<TaskInfo> TaskMonitor::getTasks()
+{
+    std::vector<TaskInfo> result;
+
+    UBaseType_t maxTasks = uxTaskGetNumberOfTasks() + 2; // Allow for tasks created in the meantime
+    TaskStatus_t* taskStatuses = new TaskStatus_t[maxTasks];
+    uint32_t totalRunTime = 0;
+    UBaseType_t numTasks = uxTaskGetSystemState(taskStatuses, maxTasks, &totalRunTime);
+
+    std::vector<RunTimeSample> runTimes;
+    uint32_t deltaTotalRunTime = (totalRunTime - _lastTotalRunTime) * portNUM_PROCESSORS;
+
+    for (UBaseType_t i = 0; i < numTasks; i++)
+    {
+        TaskStatus_t& taskStatus = taskStatuses[i];
+        float cpuPercent = -1;
+#if (configGENERATE_RUN_TIME_STATS == 1)
+        uint32_t runTime = taskStatus.ulRunTimeCounter;
+        uint32_t lastRunTime = 0;
+        for (RunTimeSample& sample : _lastRunTimes)
+        {
+            if (sample.handle == taskStatus.xHandle)
+            {
+                lastRunTime = sample.runTime;
+                break;
+            }
+        }
+        if (deltaTotalRunTime != 0)
+            cpuPercent = 100.0F * (runTime - lastRunTime) / deltaTotalRunTime;
+        runTimes.push_back(RunTimeSample { .handle = taskStatus.xHandle, .runTime = runTime });
+#endif
+
+        TaskInfo taskInfo
+        {
+            .name = taskStatus.pcTaskName,
+            .handle = taskStatus.xHandle,
+#if configTASKLIST_INCLUDE_COREID
+            .core = (taskStatus.xCoreID == tskNO_AFFINITY) ? -1 : static_cast<int>(taskStatus.xCoreID),
+#else
+            .core = -1,
+#endif
+            .priority = taskStatus.uxCurrentPriority,
+            .stackHeadroom = taskStatus.usStackHighWaterMark,
+            .cpuPercent = cpuPercent
+        };
+        result.push_back(taskInfo);
+    }
+
+    delete[] taskStatuses;
+
+    _lastRunTimes = runTimes;
+    _lastTotalRunTime = totalRunTime;
+
+    return result;
+}
+#else
+std::vector<TaskInfo> TaskMonitor::getTasks()
+{
+    // No FreeRTOS task statistics available
+    return std::vector<TaskInfo>();
+}
+#endif
+
+
+void TaskMonitor::writeText(Print& output)
+{
+    std::vector<TaskInfo> tasks = getTasks();
+
+    output.println(F("Task             Core Prio  CPU %  Stack free"));
+    for (TaskInfo& task : tasks)
+    {
+        output.printf("%-16s %4d %4lu ", task.name, task.core, task.priority);
+        if (task.cpuPercent < 0)
+            output.print(F("   n/a"));
+        else
+            output.printf("%6.1f", task.cpuPercent);
+        output.printf(" %11lu\n", task.stackHeadroom);
+    }
+
+    output.printf("\nLoop latency (%lu loops, max %lu ms):\n", _loopCount, _maxLoopMs);
+    for (int i = 0; i < LOOP_HISTOGRAM_BUCKETS; i++)
+    {
+        if (i == 0)
+            output.print(F("     < 2 ms"));
+        else if (i == LOOP_HISTOGRAM_BUCKETS - 1)
+            output.printf(" >= %4d ms", 1 << i);
+        else
+            output.printf("%4d-%4d ms", 1 << i, 1 << (i + 1));
+        output.printf(": %lu\n", _loopHistogram[i]);
+    }
+}
+
+
+void TaskMonitor::writeJson(Print& output)
+{
+    std::vector<TaskInfo> tasks = getTasks();
+
+    output.print(F("{ \"tasks\": ["));
+    bool first = true;
+    for (TaskInfo& task : tasks)
+    {
+        if (!first) output.print(',');
+        first = false;
+        output.printf(
+            "\n  { \"name\": \"%s\", \"core\": %d, \"priority\": %lu, \"stackFree\": %lu",
+            task.name,
+            task.core,
+            task.priority,
+            task.stackHeadroom);
+        if (task.cpuPercent >= 0)
+            output.printf(", \"cpu\": %0.1f", task.cpuPercent);
+        output.print(F(" }"));
+    }
+
+    output.printf(
+        "\n  ],\n  \"loop\": { \"count\": %lu, \"maxMs\": %lu, \"histogram\": [",
+        _loopCount,
+        _maxLoopMs);
+    for (int i = 0; i < LOOP_HISTOGRAM_BUCKETS; i++)
+    {
+        if (i > 0) output.print(F(", "));
+        output.print(_loopHistogram[i]);
+    }
+    output.println(F("] }\n}"));
+}
@@ -0,0 +1,51 @@
+#ifndef TASK_MONITOR_H
+#define TASK_MONITOR_H
+
+#include <stdint.h>
+#include <vector>
+#include <Print.h>
+
+constexpr int LOOP_HISTOGRAM_BUCKETS = 12; // Bucket i: [2^i, 2^(i+1)) ms; bucket 0 includes < 1 ms
+
+struct TaskInfo
+{
+    const char* name;
+    void* handle;
+    int core;
+    uint32_t priority;
+    uint32_t stackHeadroom; // bytes
+    float cpuPercent; // since previous sample; -1 if not available
+};
+
+class TaskMonitor
+{
+    public:
+        // Records the interval between consecutive loop() iterations
+        static void recordLoop();
+        static void resetLoopStats();
+
+        static uint32_t getLoopCount() { return _loopCount; }
+        static uint32_t getMaxLoopMs() { return _maxLoopMs; }
+        static const uint32_t* getLoopHistogram() { return _loopHistogram; }
+
+        static std::vector<TaskInfo> getTasks();
+
+        static void writeText(Print& output);
+        static void writeJson(Print& output);
+
+    private:
+        struct RunTimeSample
+        {
+            void* handle;
+            uint32_t runTime;
+        };
+
+        static uint32_t _lastLoopMillis;
+        static uint32_t _loopCount;
+        static uint32_t _maxLoopMs;
+        static uint32_t _loopHistogram[LOOP_HISTOGRAM_BUCKETS];
+        static uint32_t _lastTotalRunTime;
+        static std::vector<RunTimeSample> _lastRunTimes;
+};
+
+#endif
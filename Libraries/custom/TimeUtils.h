@@ -1,6 +1,7 @@
 #ifndef TIMEUTILS_H
 #define TIMEUTILS_H
 
+#include <stdint.h>
 #include <time.h>
 
 constexpr int SECONDS_PER_MINUTE = 60;
@@ -0,0 +1,372 @@
+#include "TimerWheel.h"
+#include <string.h>
+#include <algorithm>
+#include <Print.h>
+#ifdef ARDUINO
+#include <Arduino.h>
+#endif
+#ifdef ESP8266
+#include <coredecls.h>
+#endif
+
+constexpr uint8_t SLOT_MASK = TIMER_WHEEL_SLOTS - 1;
+constexpr uint32_t MAX_TICKS = uint32_t(1) << (TIMER_WHEEL_SLOT_BITS * TIMER_WHEEL_LEVELS);
+
+
+static uint32_t getDefaultTime()
+{
+#ifdef ARDUINO
+    return millis();
+#else
+    return 0; // Use setClock() to provide (virtual) time
+#endif
+}
+
+
+TimerWheel::TimerWheel(uint16_t tickMs)
+    : _tickMs(std::max(tickMs, uint16_t(1))), _clock(getDefaultTime)
+{
+    memset(_slots, 0xFF, sizeof(_slots)); // All -1
+    memset(_occupied, 0, sizeof(_occupied));
+}
+
+
+int TimerWheel::addJob(const char* name, TimerCallback callback, uint32_t intervalMs)
+{
+    Job job
+    {
+        .name = name,
+        .callback = callback,
+        .intervalMs = intervalMs,
+        .dueMillis = 0,
+        .dueTick = 0,
+        .lastRunMillis = 0,
+        .elapsedMs = 0,
+        .next = -1,
+        .prev = -1,
+        .level = -1,
+        .slot = 0,
+        .stats = TimerJobStats()
+    };
+    _jobs.push_back(job);
+    return _jobs.size() - 1;
+}
+
+
+int TimerWheel::addPeriodic(const char* name, uint32_t intervalMs, TimerCallback callback, uint32_t firstDelayMs)
+{
+    int jobId = addJob(name, callback, intervalMs);
+    schedule(jobId, firstDelayMs);
+    return jobId;
+}
+
+
+void TimerWheel::schedule(int jobId, uint32_t delayMs)
+{
+    uint32_t currentMillis = _clock();
+    if (!_isStarted) start(currentMillis);
+
+    if (_jobs[jobId].level >= 0) unlink(jobId);
+    _jobs[jobId].lastRunMillis = currentMillis;
+    setDue(jobId, currentMillis + delayMs);
+    insert(jobId);
+}
+
+
+void TimerWheel::cancel(int jobId)
+{
+    if (_jobs[jobId].level >= 0) unlink(jobId);
+}
+
+
+void TimerWheel::start(uint32_t currentMillis)
+{
+    _tickMillis = currentMillis;
+    _currentTick = 0;
+    _isStarted = true;
+}
+
+
+void TimerWheel::setDue(int jobId, uint32_t dueMillis)
+{
+    // Round up to the next tick boundary; the current tick has been processed already.
+    int32_t msFromTick = dueMillis - _tickMillis;
+    uint32_t ticks = (msFromTick <= 0) ? 0 : (msFromTick + _tickMs - 1) / _tickMs;
+
+    Job& job = _jobs[jobId];
+    job.dueMillis = dueMillis;
+    job.dueTick = _currentTick + std::max(ticks, uint32_t(1));
+}
+
+
+void TimerWheel::insert(int jobId)
+{
+    Job& job = _jobs[jobId];
+    uint32_t ticksToGo = job.dueTick - _currentTick;
+
+    uint8_t level = 0;
+    while ((level < TIMER_WHEEL_LEVELS - 1) && (ticksToGo >= (uint32_t(1) << (TIMER_WHEEL_SLOT_BITS * (level + 1)))))
+        level++;
+
+    uint8_t slot;
+    if (ticksToGo >= MAX_TICKS)
+    {
+        // Beyond the wheel; park it in the slot which comes up last.
+        slot = (_currentTick >> (TIMER_WHEEL_SLOT_BITS * level)) & SLOT_MASK;
+    }
+    else
+        slot = (job.dueTick >> (TIMER_WHEEL_SLOT_BITS * level)) & SLOT_MASK;
+
+    int16_t& head = _slots[level][slot];
+    job.level = level;
+    job.slot = slot;
+    job.prev = -1;
+    job.next = head;
+    if (head >= 0) _jobs[head].prev = jobId;
+    head = jobId;
+    _occupied[level] |= uint64_t(1) << slot;
+}
+
+
+void TimerWheel::unlink(int jobId)
+{
+    Job& job = _jobs[jobId];
+    if (job.prev >= 0)
+        _jobs[job.prev].next = job.next;
+    else
+    {
+        _slots[job.level][job.slot] = job.next;
+        if (job.next < 0) _occupied[job.level] &= ~(uint64_t(1) << job.slot);
+    }
+    if (job.next >= 0) _jobs[job.next].prev = job.prev;
+
+    job.level = -1;
+    job.next = -1;
+    job.prev = -1;
+}
+
+
+void TimerWheel::cascade(uint8_t level)
+{
+    uint8_t slot = (_currentTick >> (TIMER_WHEEL_SLOT_BITS * level)) & SLOT_MASK;
+
+    // Detach the slot first; parked jobs may be inserted in the same slot again.
+    int16_t jobId = _slots[level][slot];
+    _slots[level][slot] = -1;
+    _occupied[level] &= ~(uint64_t(1) << slot);
+
+    while (jobId >= 0)
+    {
+        int16_t nextJobId = _jobs[jobId].next;
+        insert(jobId);
+        _stats.cascades++;
+        jobId = nextJobId;
+    }
+}
+
+
+uint32_t TimerWheel::run(uint32_t currentMillis)
+{
+    if (!_isStarted) start(currentMillis);
+    advanceTo(currentMillis);
+    return getTimeToNext(currentMillis);
+}
+
+
+void TimerWheel::advanceTo(uint32_t currentMillis)
+{
+    while (int32_t(currentMillis - _tickMillis) >= _tickMs)
+    {
+        uint32_t elapsedTicks = (currentMillis - _tickMillis) / _tickMs;
+
+        // Skip ticks without jobs; stop at the next level 0 job or lap boundary (cascade).
+        uint32_t ticksToBoundary = TIMER_WHEEL_SLOTS - (_currentTick & SLOT_MASK);
+        uint32_t ticksToJob = ticksToBoundary;
+        int slot = findNextSlot(_occupied[0], (_currentTick + 1) & SLOT_MASK);
+        if (slot >= 0)
+            ticksToJob = ((slot - _currentTick - 1) & SLOT_MASK) + 1;
+
+        uint32_t ticks = std::min(std::min(ticksToJob, ticksToBoundary), elapsedTicks);
+        _currentTick += ticks;
+        _tickMillis += ticks * _tickMs;
+        if (ticks == std::min(ticksToJob, ticksToBoundary))
+            processTick(currentMillis);
+    }
+}
+
+
+void TimerWheel::processTick(uint32_t currentMillis)
+{
+    if ((_currentTick & SLOT_MASK) == 0)
+    {
+        // Higher levels first; their jobs may end up in a lower level slot which is also due now.
+        for (int level = TIMER_WHEEL_LEVELS - 1; level > 0; level--)
+        {
+            uint32_t lapMask = (uint32_t(1) << (TIMER_WHEEL_SLOT_BITS * level)) - 1;
+            if ((_currentTick & lapMask) == 0) cascade(level);
+        }
+    }
+
+    // Jobs are removed one at a time, so callbacks can safely (re)schedule or cancel jobs.
+    int16_t& head = _slots[0][_currentTick & SLOT_MASK];
+    while (head >= 0)
+    {
+        int jobId = head;
+        unlink(jobId);
+        runJob(jobId, currentMillis);
+    }
+}
+
+
+void TimerWheel::runJob(int jobId, uint32_t currentMillis)
+{
+    Job& job = _jobs[jobId];
+    uint32_t latenessMs = std::max(int32_t(currentMillis - job.dueMillis), int32_t(0));
+
+    if (job.intervalMs != 0)
+    {
+        // Next deadline is based on the previous one, so periodic jobs don't drift.
+        uint32_t dueMillis = job.dueMillis + job.intervalMs;
+        if (int32_t(currentMillis - dueMillis) >= 0)
+        {
+            uint32_t skippedPeriods = (currentMillis - job.dueMillis) / job.intervalMs;
+            job.stats.overruns += skippedPeriods;
+            dueMillis = job.dueMillis + (skippedPeriods + 1) * job.intervalMs;
+        }
+        setDue(jobId, dueMillis);
+        insert(jobId);
+    }
+
+    TimerCallback callback = job.callback; // The callback may add jobs (invalidating the reference)
+    uint32_t startMillis = _clock();
+    job.elapsedMs = startMillis - job.lastRunMillis;
+    job.lastRunMillis = startMillis;
+    callback();
+    uint32_t durationMs = _clock() - startMillis;
+
+    TimerJobStats& stats = _jobs[jobId].stats;
+    stats.runs++;
+    stats.totalLatenessMs += latenessMs;
+    stats.maxLatenessMs = std::max(stats.maxLatenessMs, latenessMs);
+    stats.lastDurationMs = durationMs;
+    stats.maxDurationMs = std::max(stats.maxDurationMs, durationMs);
+    _stats.runs++;
+}
+
+
+int TimerWheel::findNextSlot(uint64_t occupied, uint8_t fromSlot)
+{
+    if (occupied == 0) return -1;
+    uint64_t rotated = (occupied >> fromSlot) | ((fromSlot == 0) ? 0 : (occupied << (TIMER_WHEEL_SLOTS - fromSlot)));
+    return (fromSlot + __builtin_ctzll(rotated)) & SLOT_MASK;
+}
+
+
+bool TimerWheel::getNextDueTick(uint32_t& dueTick)
+{
+    // The first occupied slot of each level holds that level's earliest jobs.
+    uint32_t minTicksToGo = UINT32_MAX;
+    for (int level = 0; level < TIMER_WHEEL_LEVELS; level++)
+    {
+        uint8_t shift = TIMER_WHEEL_SLOT_BITS * level;
+        int slot = findNextSlot(_occupied[level], ((_currentTick >> shift) + 1) & SLOT_MASK);
+        if (slot < 0) continue;
+        for (int16_t jobId = _slots[level][slot]; jobId >= 0; jobId = _jobs[jobId].next)
+            minTicksToGo = std::min(minTicksToGo, _jobs[jobId].dueTick - _currentTick);
+    }
+
+    if (minTicksToGo == UINT32_MAX) return false;
+    dueTick = _currentTick + minTicksToGo;
+    return true;
+}
+
+
+uint32_t TimerWheel::getTimeToNext(uint32_t currentMillis)
+{
+    uint32_t dueTick;
+    if (!_isStarted || !getNextDueTick(dueTick)) return UINT32_MAX;
+
+    uint64_t dueOffsetMs = uint64_t(dueTick - _currentTick) * _tickMs;
+    uint32_t elapsedMs = currentMillis - _tickMillis;
+    if (dueOffsetMs <= elapsedMs) return 0;
+    return std::min(dueOffsetMs - elapsedMs, uint64_t(UINT32_MAX - 1));
+}
+
+
+bool TimerWheel::sleep(uint32_t maxSleepMs)
+{
+    uint32_t sleepMs = std::min(getTimeToNext(_clock()), maxSleepMs);
+    if (sleepMs == 0) return false;
+    _stats.sleeps++;
+
+    bool isWoken = false;
+#ifdef ESP32
+    // A wake() before the sleep is not lost; the pending notification ends the sleep immediately.
+    _loopTask = xTaskGetCurrentTaskHandle();
+    isWoken = ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(sleepMs)) > 0;
+#elif defined(ESP8266)
+    esp_delay(sleepMs, [this]() { return !_isWoken; }, sleepMs);
+    isWoken = _isWoken;
+    _isWoken = false;
+#endif
+
+    if (isWoken) _stats.wakeups++;
+    return isWoken;
+}
+
+
+void IRAM_ATTR TimerWheel::wake()
+{
+#ifdef ESP32
+    if (_loopTask != nullptr) xTaskNotifyGive(static_cast<TaskHandle_t>(_loopTask));
+#elif defined(ESP8266)
+    _isWoken = true;
+    esp_schedule();
+#endif
+}
+
+
+void IRAM_ATTR TimerWheel::wakeFromISR()
+{
+#ifdef ESP32
+    if (_loopTask == nullptr) return;
+    BaseType_t higherPriorityTaskWoken = pdFALSE;
+    vTaskNotifyGiveFromISR(static_cast<TaskHandle_t>(_loopTask), &higherPriorityTaskWoken);
+    if (higherPriorityTaskWoken) portYIELD_FROM_ISR();
+#else
+    wake();
+#endif
+}
+
+
+void TimerWheel::resetStats()
+{
+    _stats = TimerWheelStats();
+    for (Job& job : _jobs)
+        job.stats = TimerJobStats();
+}
+
+
+void TimerWheel::writeText(Print& output)
+{
+    output.println("Job              Interval   Runs  Overruns  Late avg/max  Duration last/max");
+    for (Job& job : _jobs)
+    {
+        output.printf(
+            "%-16s %8u %6u %9u %7.1f/%-5u %11u/%u\n",
+            job.name,
+            static_cast<unsigned int>(job.intervalMs),
+            static_cast<unsigned int>(job.stats.runs),
+            static_cast<unsigned int>(job.stats.overruns),
+            job.stats.getAvgLatenessMs(),
+            static_cast<unsigned int>(job.stats.maxLatenessMs),
+            static_cast<unsigned int>(job.stats.lastDurationMs),
+            static_cast<unsigned int>(job.stats.maxDurationMs));
+    }
+    output.printf(
+        "\n%u runs, %u cascades, %u sleeps (%u woken early)\n",
+        static_cast<unsigned int>(_stats.runs),
+        static_cast<unsigned int>(_stats.cascades),
+        static_cast<unsigned int>(_stats.sleeps),
+        static_cast<unsigned int>(_stats.wakeups));
+}
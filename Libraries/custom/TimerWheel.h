@@ -0,0 +1,132 @@
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <stdint.h>
+#include <functional>
+#include <vector>
+
+class Print;
+
+constexpr uint8_t TIMER_WHEEL_LEVELS = 3;
+constexpr uint8_t TIMER_WHEEL_SLOT_BITS = 6;
+constexpr uint8_t TIMER_WHEEL_SLOTS = 1 << TIMER_WHEEL_SLOT_BITS; // per level
+constexpr uint32_t TIMER_WHEEL_MAX_SLEEP_MS = 1000;
+
+using TimerCallback = std::function<void()>;
+using TimerClock = uint32_t (*)();
+
+struct TimerJobStats
+{
+    uint32_t runs = 0;
+    uint32_t overruns = 0; // Periods skipped because the job ran late by a whole interval or more
+    uint32_t maxLatenessMs = 0; // Jitter: time between deadline and actual start
+    uint32_t totalLatenessMs = 0;
+    uint32_t maxDurationMs = 0;
+    uint32_t lastDurationMs = 0;
+
+    float getAvgLatenessMs() const { return (runs == 0) ? 0 : float(totalLatenessMs) / runs; }
+};
+
+struct TimerWheelStats
+{
+    uint32_t runs = 0; // Jobs executed
+    uint32_t cascades = 0; // Jobs moved down to a finer level
+    uint32_t sleeps = 0;
+    uint32_t wakeups = 0; // Sleeps ended early by wake()
+};
+
+// Runs periodic and one-shot jobs at their deadlines, using a hierarchical timer wheel.
+// Level 0 has one slot per tick; each higher level has slots spanning a full lap of the level below.
+// Jobs further away than the highest level are parked in its last slot and re-inserted when it comes up.
+// Time is passed in by the caller, so the wheel can also be driven with virtual time on the host.
+class TimerWheel
+{
+    public:
+        TimerWheel(uint16_t tickMs = 1);
+
+        // The clock is used to measure job durations and by the run() and sleep() overloads without time.
+        void setClock(TimerClock clock) { _clock = clock; }
+
+        // Registers a job; it only runs once it is scheduled. A non-zero interval makes it periodic.
+        int addJob(const char* name, TimerCallback callback, uint32_t intervalMs = 0);
+        int addPeriodic(const char* name, uint32_t intervalMs, TimerCallback callback, uint32_t firstDelayMs = 0);
+
+        // (Re)schedules the job to run after the given delay; a periodic job then continues at its interval.
+        void schedule(int jobId, uint32_t delayMs);
+        void cancel(int jobId);
+        bool isScheduled(int jobId) const { return _jobs[jobId].level >= 0; }
+        void setInterval(int jobId, uint32_t intervalMs) { _jobs[jobId].intervalMs = intervalMs; }
+
+        // Runs all jobs which are due. Returns the number of milliseconds until the next deadline.
+        uint32_t run(uint32_t currentMillis);
+        uint32_t run() { return run(_clock()); }
+
+        // Milliseconds until the next deadline; UINT32_MAX if nothing is scheduled.
+        uint32_t getTimeToNext(uint32_t currentMillis);
+        uint32_t getTimeToNext() { return getTimeToNext(_clock()); }
+
+        // Sleeps until the next deadline (at most maxSleepMs) or until wake() is called.
+        // Returns true if the sleep was ended by wake().
+        bool sleep(uint32_t maxSleepMs = TIMER_WHEEL_MAX_SLEEP_MS);
+
+        // Ends the current sleep early, e.g. when an event needs handling.
+        // A wake before the sleep ends the next sleep right away (ESP32: once the loop task slept before).
+        // Use wake() from tasks or callbacks and wakeFromISR() from interrupt handlers; both are in IRAM.
+        void wake();
+        void wakeFromISR();
+
+        size_t getJobCount() const { return _jobs.size(); }
+        const char* getJobName(int jobId) const { return _jobs[jobId].name; }
+        uint32_t getJobInterval(int jobId) const { return _jobs[jobId].intervalMs; }
+
+        // Time from the start of the job's previous run (or from scheduling it) to the start of the current run.
+        // Periods are skipped when a job runs late, so jobs which integrate over time should use this.
+        uint32_t getElapsedMs(int jobId) const { return _jobs[jobId].elapsedMs; }
+        const TimerJobStats& getJobStats(int jobId) const { return _jobs[jobId].stats; }
+        const TimerWheelStats& getStats() const { return _stats; }
+        void resetStats();
+
+        void writeText(Print& output);
+
+    private:
+        struct Job
+        {
+            const char* name;
+            TimerCallback callback;
+            uint32_t intervalMs;
+            uint32_t dueMillis;
+            uint32_t dueTick;
+            uint32_t lastRunMillis; // Start of the previous run, or when the job was scheduled
+            uint32_t elapsedMs;
+            int16_t next;
+            int16_t prev;
+            int8_t level; // -1 if not scheduled
+            uint8_t slot;
+            TimerJobStats stats;
+        };
+
+        uint16_t _tickMs;
+        TimerClock _clock;
+        uint32_t _currentTick = 0;
+        uint32_t _tickMillis = 0; // Start of the current tick
+        bool _isStarted = false;
+        std::vector<Job> _jobs;
+        int16_t _slots[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];
+        uint64_t _occupied[TIMER_WHEEL_LEVELS]; // Bit per non-empty slot
+        TimerWheelStats _stats;
+        volatile bool _isWoken = false;
+        void* _loopTask = nullptr; // Task to notify on wake()
+
+        void start(uint32_t currentMillis);
+        void advanceTo(uint32_t currentMillis);
+        void setDue(int jobId, uint32_t dueMillis);
+        void insert(int jobId);
+        void unlink(int jobId);
+        void cascade(uint8_t level);
+        void processTick(uint32_t currentMillis);
+        void runJob(int jobId, uint32_t currentMillis);
+        bool getNextDueTick(uint32_t& dueTick);
+        static int findNextSlot(uint64_t occupied, uint8_t fromSlot);
+};
+
+#endif
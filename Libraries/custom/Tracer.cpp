@@ -1,11 +1,12 @@
 #include "Tracer.h"
 #include <Arduino.h>
+#include <FlightRecorder.h>
 
 Print* Tracer::_traceToPtr = nullptr;
 char _traceMsg[256];
 
 #ifdef ESP32
-SemaphoreHandle_t _traceMutex;
+SemaphoreHandle_t _traceMutex = xSemaphoreCreateMutex();
 #endif
 
 
@@ -13,15 +14,12 @@ SemaphoreHandle_t _traceMutex;
 void Tracer::traceTo(Print& dest)
 {
     _traceToPtr = &dest;
-#ifdef ESP32
-    _traceMutex = xSemaphoreCreateMutex();
-#endif
 }
 
 
 void Tracer::trace(String format, ...)
 {
-    if (_traceToPtr == nullptr)
+    if ((_traceToPtr == nullptr) && !FlightRecorder::isTraceEnabled())
         return;
 
 #ifdef ESP32
@@ -34,7 +32,9 @@ void Tracer::trace(String format, ...)
     _traceMsg[length] = 0;
     va_end(args);
 
-    _traceToPtr->print(_traceMsg);
+    if (_traceToPtr != nullptr)
+        _traceToPtr->print(_traceMsg);
+    FlightRecorder::recordTrace(_traceMsg);
 
 #ifdef ESP32
     xSemaphoreGive(_traceMutex);
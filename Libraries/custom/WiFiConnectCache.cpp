@@ -0,0 +1,162 @@
+#include <Arduino.h>
+#include <stddef.h>
+#include <time.h>
+#include <sys/time.h>
+#include "WiFiConnectCache.h"
+#include <ESPWiFi.h>
+#include <Tracer.h>
+
+#ifdef ESP8266
+extern "C"
+{
+    #include <user_interface.h>
+}
+constexpr uint32_t RTC_USER_MEMORY_OFFSET = 32; // In 32-bit blocks; the first 128 bytes are used by eboot (OTA)
+#else
+RTC_NOINIT_ATTR WiFiConnectCacheData _wifiConnectCacheData;
+#endif
+
+static_assert(sizeof(WiFiConnectCacheData) % 4 == 0, "RTC memory is accessed in 32-bit words");
+
+constexpr time_t MIN_VALID_TIME = 100000; // See WiFiNTP::endGetServerTime
+
+
+uint32_t WiFiConnectCache::getHash(const void* data, size_t size)
+{
+    // FNV-1a
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    uint32_t hash = 2166136261;
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= bytes[i];
+        hash *= 16777619;
+    }
+    return hash;
+}
+
+
+void WiFiConnectCache::read()
+{
+#ifdef ESP8266
+    if (!ESP.rtcUserMemoryRead(RTC_USER_MEMORY_OFFSET, reinterpret_cast<uint32_t*>(&_data), sizeof(_data)))
+        memset(&_data, 0, sizeof(_data));
+#else
+    memcpy(&_data, &_wifiConnectCacheData, sizeof(_data));
+#endif
+}
+
+
+void WiFiConnectCache::write()
+{
+#ifdef ESP8266
+    if (!ESP.rtcUserMemoryWrite(RTC_USER_MEMORY_OFFSET, reinterpret_cast<uint32_t*>(&_data), sizeof(_data)))
+        TRACE(F("Unable to write RTC memory\n"));
+#else
+    memcpy(&_wifiConnectCacheData, &_data, sizeof(_data));
+#endif
+}
+
+
+bool WiFiConnectCache::begin(const String& ssid)
+{
+    Tracer tracer(F("WiFiConnectCache::begin"));
+
+    _ssidHash = getHash(ssid.c_str(), ssid.length());
+    read();
+
+    // RTC memory contains garbage after a power cycle
+    _isValid = (_data.magic == WIFI_CONNECT_CACHE_MAGIC)
+        && (_data.checksum == getHash(&_data, offsetof(WiFiConnectCacheData, checksum)))
+        && (_data.ssidHash == _ssidHash)
+        && (_data.channel != 0);
+    if (!_isValid)
+        memset(&_data, 0, sizeof(_data));
+
+    TRACE(F("Valid: %d. Channel: %d. Lease: %d\n"), _isValid, _data.channel, _data.hasLease);
+    return _isValid;
+}
+
+
+bool WiFiConnectCache::getLease(IPAddress& ipAddress, IPAddress& gateway, IPAddress& subnetMask, IPAddress& dns)
+{
+    if (!_isValid || !_data.hasLease || (_data.refreshTime == 0))
+        return false;
+
+    // The lease was renewed by DHCP before the last refresh; it won't have expired shortly after.
+    time_t currentTime = time(nullptr);
+    time_t refreshTime = _data.refreshTime;
+    if ((currentTime < refreshTime) || (currentTime - refreshTime > WIFI_LEASE_REUSE_SECONDS))
+        return false;
+
+    ipAddress = _data.ipAddress;
+    gateway = _data.gateway;
+    subnetMask = _data.subnetMask;
+    dns = _data.dns;
+    return true;
+}
+
+
+bool WiFiConnectCache::restoreTime()
+{
+    if (time(nullptr) >= MIN_VALID_TIME)
+        return true;
+
+#ifdef ESP8266
+    if (!_isValid || (_data.refreshTime == 0))
+        return false;
+
+    // The RTC timer keeps running across resets. The calibration value is its period in us (Q12).
+    // It wraps after some hours; the cache is refreshed often enough for that not to matter.
+    uint32_t rtcTicks = system_get_rtc_time() - _data.rtcTicks;
+    uint64_t elapsedUs = (uint64_t(rtcTicks) * system_rtc_clock_cali_proc()) >> 12;
+    if (elapsedUs > uint64_t(WIFI_LEASE_REUSE_SECONDS) * 1000000)
+        return false;
+
+    timeval restoredTime;
+    restoredTime.tv_sec = _data.refreshTime + elapsedUs / 1000000;
+    restoredTime.tv_usec = elapsedUs % 1000000;
+    settimeofday(&restoredTime, nullptr);
+    TRACE(F("Restored time. %u ms since refresh.\n"), static_cast<uint32_t>(elapsedUs / 1000));
+    return true;
+#else
+    return false;
+#endif
+}
+
+
+void WiFiConnectCache::store(bool includeLease)
+{
+    const uint8_t* bssid = WiFi.BSSID();
+    if (bssid == nullptr) return;
+
+    _data.magic = WIFI_CONNECT_CACHE_MAGIC;
+    _data.ssidHash = _ssidHash;
+    memcpy(_data.bssid, bssid, sizeof(_data.bssid));
+    _data.channel = WiFi.channel();
+    _data.hasLease = includeLease;
+    if (includeLease)
+    {
+        _data.ipAddress = WiFi.localIP();
+        _data.gateway = WiFi.gatewayIP();
+        _data.subnetMask = WiFi.subnetMask();
+        _data.dns = WiFi.dnsIP();
+    }
+
+    time_t currentTime = time(nullptr);
+    _data.refreshTime = (currentTime < MIN_VALID_TIME) ? 0 : currentTime;
+#ifdef ESP8266
+    _data.rtcTicks = system_get_rtc_time();
+#endif
+    _data.checksum = getHash(&_data, offsetof(WiFiConnectCacheData, checksum));
+
+    write();
+    _isValid = true;
+}
+
+
+void WiFiConnectCache::invalidate()
+{
+    memset(&_data, 0, sizeof(_data));
+    write();
+    _isValid = false;
+}
@@ -0,0 +1,62 @@
+#ifndef WIFI_CONNECT_CACHE_H
+#define WIFI_CONNECT_CACHE_H
+
+#include <stdint.h>
+#include <WString.h>
+#include <IPAddress.h>
+
+constexpr uint32_t WIFI_CONNECT_CACHE_MAGIC = 0xCAC4E001;
+constexpr uint32_t WIFI_CONNECT_CACHE_REFRESH_SECONDS = 300;
+constexpr uint32_t WIFI_LEASE_REUSE_SECONDS = 600; // Max. time since the last refresh to reuse the IP lease
+
+// Lives in RTC memory which survives software/panic/watchdog resets, but not a power cycle.
+struct WiFiConnectCacheData
+{
+    uint32_t magic;
+    uint32_t ssidHash; // The cache only applies to the network it was stored for
+    uint8_t bssid[6];
+    uint8_t channel;
+    uint8_t hasLease; // Only set for DHCP leases which are renewed while connected
+    uint32_t ipAddress;
+    uint32_t gateway;
+    uint32_t subnetMask;
+    uint32_t dns;
+    uint32_t refreshTime; // Epoch time of the last refresh; 0 if not known
+    uint32_t rtcTicks; // ESP8266: RTC timer at the last refresh
+    uint32_t checksum;
+};
+
+// Remembers the last good Access Point, channel, IP lease and time across resets,
+// so the station can reconnect without a full scan and without waiting for DHCP and NTP.
+class WiFiConnectCache
+{
+    public:
+        // Loads the cache; returns false if there is none or it was stored for another SSID.
+        bool begin(const String& ssid);
+        bool isValid() { return _isValid; }
+
+        const uint8_t* getBSSID() { return _data.bssid; }
+        int32_t getChannel() { return _data.channel; }
+
+        // Returns false if there is no lease or it may have expired since it was stored.
+        bool getLease(IPAddress& ipAddress, IPAddress& gateway, IPAddress& subnetMask, IPAddress& dns);
+
+        // ESP32 keeps the system time across resets; ESP8266 gets it from the cache and the RTC timer.
+        // Returns true if the system time is valid.
+        bool restoreTime();
+
+        // Stores the current connection (and time). Only include a lease obtained using DHCP.
+        void store(bool includeLease);
+        void invalidate();
+
+    private:
+        WiFiConnectCacheData _data;
+        uint32_t _ssidHash = 0;
+        bool _isValid = false;
+
+        static uint32_t getHash(const void* data, size_t size);
+        void read();
+        void write();
+};
+
+#endif
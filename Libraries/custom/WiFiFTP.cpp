@@ -1,6 +1,32 @@
 #include "WiFiFTP.h"
 #include <Tracer.h>
-#include <ESPWifi.h>
+#include <ESPWiFi.h>
+
+// Counts the bytes written to a data connection
+class CountingPrint : public Print
+{
+    public:
+        size_t count = 0;
+
+        CountingPrint(Print& output) : _output(output) {}
+
+        size_t write(uint8_t data) override
+        {
+            size_t written = _output.write(data);
+            count += written;
+            return written;
+        }
+
+        size_t write(const uint8_t* buffer, size_t size) override
+        {
+            size_t written = _output.write(buffer, size);
+            count += written;
+            return written;
+        }
+
+    private:
+        Print& _output;
+};
 
 
 WiFiFTPClient::WiFiFTPClient(int timeoutMs)
@@ -26,15 +52,24 @@ bool WiFiFTPClient::begin(const char* host, const char* userName, const char* pa
     _startMillis = millis();
     _durationMs = 0;
 
+    if (!_circuitBreaker.allowRequest(_startMillis))
+    {
+        setLastError(F("%s:%d unreachable; retry in %u s"), host, port, (_circuitBreaker.getRetryMillis() - _startMillis) / 1000);
+        return false;
+    }
     if (!_controlClient.connect(host, port))
     {
+        _circuitBreaker.recordFailure();
         setLastError(F("Cannot connect to %s:%d"), host, port);
         return false;
     }
+    _circuitBreaker.recordSuccess();
     _host = host;
 
     bool success = initialize(userName, password);
-    if (!success)
+    if (success)
+        _stats.sessions++;
+    else
     {
         TRACE(F("Unable to initialize FTP server\n"));
         end();
@@ -61,6 +96,7 @@ void WiFiFTPClient::end()
         _controlClient.stop();
     }
 
+    _isLoggedIn = false;
     _durationMs = millis() - _startMillis;
     TRACE(F("Duration: %u ms\n"), _durationMs);
 
@@ -68,6 +104,34 @@ void WiFiFTPClient::end()
 }
 
 
+void WiFiFTPClient::closeIdleSession()
+{
+    if (!_isLoggedIn || (millis() - _lastActivityMillis < static_cast<uint32_t>(_idleTimeout) * 1000))
+        return;
+
+    TRACE(F("WiFiFTPClient: closing idle session\n"));
+    _startMillis = millis();
+    end();
+}
+
+
+void WiFiFTPClient::setLoggedIn()
+{
+    _isLoggedIn = true;
+    _stats.sessions++;
+    _sessionHost = _host;
+    _sessionPort = _port;
+    _sessionUserName = _userName;
+    _sessionPassword = _password;
+}
+
+
+bool WiFiFTPClient::isSessionFor(const char* host, uint16_t port, const char* userName, const char* password)
+{
+    return (_sessionHost == host) && (_sessionPort == port) && (_sessionUserName == userName) && (_sessionPassword == password);
+}
+
+
 void WiFiFTPClient::setLastError(String format, ...)
 {
     va_list args;
@@ -78,7 +142,11 @@ void WiFiFTPClient::setLastError(String format, ...)
 
     TRACE("ERROR: %s\n", _lastError);
 
-    if (_asyncState != AsyncFTPState::Idle) setAsyncState(AsyncFTPState::Error);
+    if (_asyncState != AsyncFTPState::Idle)
+    {
+        _isLoggedIn = false; // Don't reuse the session; its state is unknown
+        setAsyncState(AsyncFTPState::Error);
+    }
 }
 
 
@@ -94,6 +162,14 @@ void WiFiFTPClient::setUnexpectedResponse(const char* response)
 }
 
 
+void WiFiFTPClient::abortTransfer(const char* reason)
+{
+    if (_dataClient.connected())
+        _dataClient.stop();
+    setLastError(F("Upload aborted: %s"), reason);
+}
+
+
 bool WiFiFTPClient::initialize(const char* userName, const char* password)
 {
     Tracer Tracer(F("WiFiFTPClient::initialize"), userName);
@@ -281,6 +357,44 @@ WiFiClient& WiFiFTPClient::append(String filename)
 }
 
 
+int64_t WiFiFTPClient::getFileSize(const String& filename)
+{
+    int responseCode = sendCommand(F("SIZE"), filename.c_str());
+    if (responseCode == 213) return strtoul(_responseBuffer + 4, nullptr, 10);
+    if (responseCode == 550) return 0; // No such file
+    return -1;
+}
+
+
+WiFiClient& WiFiFTPClient::appendLog(String filename, SyncCursor& syncCursor)
+{
+    Tracer tracer(F("WiFiFTPClient::appendLog"), filename.c_str());
+
+    // SIZE and REST count bytes, so don't let the server convert line endings.
+    sendCommand(F("TYPE"), "I");
+    int64_t fileSize = getFileSize(filename);
+    if (fileSize < 0)
+    {
+        TRACE(F("SIZE not supported; can't resume\n"));
+        return append(filename);
+    }
+
+    // If no transfer started since the last acknowledge, or the file was replaced, the entries start at its end.
+    uint32_t offset = std::min<int64_t>(syncCursor.getResumeOffset(), fileSize);
+    syncCursor.setResumeOffset(offset);
+    if (offset == fileSize) return append(filename);
+
+    TRACE(F("Overwriting %u bytes of a failed transfer\n"), uint32_t(fileSize - offset));
+    if (sendCommand(F("REST"), String(offset).c_str()) != 350)
+    {
+        setUnexpectedResponse();
+        _dataClient.stop();
+        return _dataClient;
+    }
+    return store(filename);
+}
+
+
 void WiFiFTPClient::setAsyncState(AsyncFTPState state)
 {
     uint32_t currentMillis = millis();
@@ -302,6 +416,7 @@ void WiFiFTPClient::beginAsync(const char* host, const char* userName, const cha
 
     _lastCommand.clear();
     _asyncCommands.clear();
+    _transfers.clear();
     _startMillis = millis();
     _durationMs = 0;
     _asyncState = AsyncFTPState::Idle;
@@ -309,17 +424,59 @@ void WiFiFTPClient::beginAsync(const char* host, const char* userName, const cha
 }
 
 
-void WiFiFTPClient::appendAsync(String filename, std::function<void(Print&)> dataWriter)
+void WiFiFTPClient::appendAsync(String filename, std::function<void(Print&)> dataWriter, FTPTransferCallback onTransferred)
 {
     Tracer tracer(F("WiFiFTPClient::appendAsync"), filename.c_str());
+    auto chunkWriter = [dataWriter](Print& output) { dataWriter(output); return true; };
+    addAsyncCommand(filename, &WiFiFTPClient::append, chunkWriter, onTransferred);
+}
+
 
+void WiFiFTPClient::storeAsync(String filename, std::function<void(Print&)> dataWriter, FTPTransferCallback onTransferred)
+{
+    Tracer tracer(F("WiFiFTPClient::storeAsync"), filename.c_str());
+    auto chunkWriter = [dataWriter](Print& output) { dataWriter(output); return true; };
+    addAsyncCommand(filename, &WiFiFTPClient::store, chunkWriter, onTransferred);
+}
+
+
+void WiFiFTPClient::appendChunkedAsync(String filename, FTPChunkWriter chunkWriter, FTPTransferCallback onTransferred)
+{
+    Tracer tracer(F("WiFiFTPClient::appendChunkedAsync"), filename.c_str());
+    addAsyncCommand(filename, &WiFiFTPClient::append, chunkWriter, onTransferred);
+}
+
+
+void WiFiFTPClient::appendLogAsync(String filename, SyncCursor& syncCursor, std::function<void(Print&)> dataWriter, FTPTransferCallback onTransferred)
+{
+    Tracer tracer(F("WiFiFTPClient::appendLogAsync"), filename.c_str());
+    auto chunkWriter = [dataWriter](Print& output) { dataWriter(output); return true; };
+    addAsyncCommand(filename, [this, filename, &syncCursor]() -> WiFiClient& { return appendLog(filename, syncCursor); }, chunkWriter, onTransferred);
+}
+
+
+void WiFiFTPClient::appendLogChunkedAsync(String filename, SyncCursor& syncCursor, FTPChunkWriter chunkWriter, FTPTransferCallback onTransferred)
+{
+    Tracer tracer(F("WiFiFTPClient::appendLogChunkedAsync"), filename.c_str());
+    addAsyncCommand(filename, [this, filename, &syncCursor]() -> WiFiClient& { return appendLog(filename, syncCursor); }, chunkWriter, onTransferred);
+}
+
+
+void WiFiFTPClient::addAsyncCommand(String filename, WiFiClient& (WiFiFTPClient::*command)(String), FTPChunkWriter chunkWriter, FTPTransferCallback onTransferred)
+{
+    addAsyncCommand(filename, std::bind(command, this, filename), chunkWriter, onTransferred);
+}
+
+
+void WiFiFTPClient::addAsyncCommand(String filename, std::function<WiFiClient&()> execute, FTPChunkWriter chunkWriter, FTPTransferCallback onTransferred)
+{
     AsyncFTPCommand asyncCommand
     {
         .arg = filename,
-        .execute = nullptr,
-        .dataWriter = dataWriter
+        .execute = execute,
+        .chunkWriter = chunkWriter,
+        .onTransferred = onTransferred
     };
-    asyncCommand.execute = std::bind(&WiFiFTPClient::append, this, asyncCommand.arg),
     _asyncCommands.push_back(asyncCommand);
 
     if (_asyncState == AsyncFTPState::Idle) setAsyncState(AsyncFTPState::Connect);
@@ -346,16 +503,49 @@ bool WiFiFTPClient::runAsync()
     switch (_asyncState)
     {
         case AsyncFTPState::Idle:
+            closeIdleSession();
+            break;
+
         case AsyncFTPState::Done:
         case AsyncFTPState::Error:
             break; // Nothing to do
 
         case AsyncFTPState::Connect:
-            if (_controlClient.connect(_host, _port))
+        {
+            // Reuse the session if the server didn't close it (it would have sent a 421 response)
+            // and it is logged in to the same server with the same credentials (settings may have changed).
+            _isReusedSession = isSessionOpen() && (_controlClient.available() == 0)
+                && isSessionFor(_host, _port, _userName, _password);
+            if (_isReusedSession)
+            {
+                _stats.reusedSessions++;
+                sendCommand(F("PASV"), nullptr, false);
+                setAsyncState(AsyncFTPState::Passive);
+                break;
+            }
+            if (isSessionOpen())
+            {
+                TRACE(F("Closing session for %s:%d\n"), _sessionHost.c_str(), _sessionPort);
+                sendCommand(F("QUIT"), nullptr, false);
+            }
+            if (_controlClient.connected()) _controlClient.stop();
+            _isLoggedIn = false;
+
+            uint32_t currentMillis = millis();
+            if (!_circuitBreaker.allowRequest(currentMillis))
+                setLastError(F("%s:%d unreachable; retry in %u s"), _host, _port, (_circuitBreaker.getRetryMillis() - currentMillis) / 1000);
+            else if (_controlClient.connect(_host, _port))
+            {
+                _circuitBreaker.recordSuccess();
                 setAsyncState(AsyncFTPState::Welcome);
+            }
             else
+            {
+                _circuitBreaker.recordFailure();
                 setLastError(F("Cannot connect to %s:%d"), _host, _port);
+            }
             break;
+        }
 
         case AsyncFTPState::Welcome:
             // Retrieve server welcome message
@@ -374,6 +564,7 @@ bool WiFiFTPClient::runAsync()
             if (responseCode == 230)
             {
                 // No password required.
+                setLoggedIn();
                 sendCommand(F("PASV"), nullptr, false);
                 setAsyncState(AsyncFTPState::Passive);
             }
@@ -391,6 +582,7 @@ bool WiFiFTPClient::runAsync()
             responseCode = readServerResponse();
             if (responseCode == 230)
             {
+                setLoggedIn();
                 sendCommand(F("PASV"), nullptr, false);
                 setAsyncState(AsyncFTPState::Passive);
             }
@@ -410,6 +602,15 @@ bool WiFiFTPClient::runAsync()
                         setAsyncState(AsyncFTPState::ExecCommand);
                 }
             }
+            else if (_isReusedSession)
+            {
+                // The server closed the session in the meantime; log in again.
+                TRACE(F("Session expired\n"));
+                _isReusedSession = false;
+                _controlClient.stop();
+                _isLoggedIn = false;
+                setAsyncState(AsyncFTPState::Connect);
+            }
             else
                 setUnexpectedResponse();
             break;
@@ -420,13 +621,56 @@ bool WiFiFTPClient::runAsync()
             WiFiClient& dataClient = asyncCommand.execute();
             if (dataClient.connected())
             {
-                asyncCommand.dataWriter(dataClient);
-                dataClient.stop();
-                setAsyncState(AsyncFTPState::FinishCommand);
+                _transferStartMillis = millis();
+                _transferBytes = 0;
+                setAsyncState(AsyncFTPState::WriteData);
             }
             else
+            {
                 setAsyncState(AsyncFTPState::Error);
-            _asyncCommands.pop_front();
+                _asyncCommands.pop_front();
+            }
+            break;
+        }
+
+        case AsyncFTPState::WriteData:
+        {
+#ifdef ESP8266
+            // Don't block on a full TCP send buffer; try again next step.
+            if (_dataClient.availableForWrite() == 0) break;
+#endif
+            AsyncFTPCommand& asyncCommand = _asyncCommands.front();
+            CountingPrint countingPrint(_dataClient);
+            bool isDone = asyncCommand.chunkWriter(countingPrint);
+            _transferBytes += countingPrint.count;
+            if (_asyncState == AsyncFTPState::Error)
+            {
+                // The chunk writer aborted the transfer
+                _asyncCommands.pop_front();
+                break;
+            }
+            if (!_dataClient.connected())
+            {
+                setLastError(F("Data connection lost after %u bytes"), _transferBytes);
+                _asyncCommands.pop_front();
+                break;
+            }
+            if (!isDone) break;
+
+            _dataClient.stop();
+            uint32_t transferMs = millis() - _transferStartMillis;
+
+            FTPTransferStats transferStats
+            {
+                .filename = asyncCommand.arg,
+                .bytes = _transferBytes,
+                .durationMs = transferMs
+            };
+            _transfers.push_back(transferStats);
+            _stats.transfers++;
+            _stats.bytes += _transferBytes;
+
+            setAsyncState(AsyncFTPState::FinishCommand);
             break;
         }
 
@@ -434,6 +678,10 @@ bool WiFiFTPClient::runAsync()
             responseCode = readServerResponse();
             if (responseCode == 226)
             {
+                AsyncFTPCommand& asyncCommand = _asyncCommands.front();
+                if (asyncCommand.onTransferred != nullptr) asyncCommand.onTransferred();
+                _asyncCommands.pop_front();
+
                 if (_asyncCommands.size() == 0)
                     setAsyncState(AsyncFTPState::End);
                 else
@@ -447,7 +695,15 @@ bool WiFiFTPClient::runAsync()
             break;
 
         case AsyncFTPState::End:
-            end();
+            if (_idleTimeout == 0)
+                end();
+            else
+            {
+                // Keep the session for the next sync
+                _lastActivityMillis = millis();
+                _durationMs = _lastActivityMillis - _startMillis;
+                _printPtr = nullptr;
+            }
             setAsyncState(AsyncFTPState::Done);
             break;
     }
@@ -2,9 +2,12 @@
 #define WIFIFTP_H
 
 #include <deque>
+#include <vector>
 #include <stdint.h>
 #include <WiFiClient.h>
 #include <Print.h>
+#include <CircuitBreaker.h>
+#include <SyncCursor.h>
 
 constexpr uint16_t FTP_DEFAULT_CONTROL_PORT = 21;
 constexpr uint16_t FTP_DEFAULT_DATA_PORT = 22;
@@ -22,17 +25,43 @@ enum struct AsyncFTPState
     Password = 4,
     Passive = 5,
     ExecCommand = 6,
-    FinishCommand = 7,
-    End = 8,
-    Done = 9,
-    Error = 10
+    WriteData = 7,
+    FinishCommand = 8,
+    End = 9,
+    Done = 10,
+    Error = 11
+};
+
+// Writes (part of) the data for an async transfer; returns true when all data is written.
+// It is called once per run step, so a large transfer doesn't block the caller.
+using FTPChunkWriter = std::function<bool(Print&)>;
+
+// Called when the server confirmed that a file transfer completed.
+using FTPTransferCallback = std::function<void()>;
+
+struct FTPClientStats
+{
+    uint32_t sessions = 0; // Logins
+    uint32_t reusedSessions = 0; // Syncs using a session which was still logged in
+    uint32_t transfers = 0;
+    uint32_t bytes = 0;
+};
+
+struct FTPTransferStats
+{
+    String filename;
+    size_t bytes;
+    uint32_t durationMs;
+
+    float getKBps() const { return (durationMs == 0) ? 0 : float(bytes) / durationMs; }
 };
 
 struct AsyncFTPCommand
 {
     String arg;
     std::function<WiFiClient&()> execute;
-    std::function<void(Print&)> dataWriter;
+    FTPChunkWriter chunkWriter;
+    FTPTransferCallback onTransferred;
 };
 
 class WiFiFTPClient
@@ -43,6 +72,15 @@ class WiFiFTPClient
         bool begin(const char* host, const char* userName, const char* password, uint16_t port = FTP_DEFAULT_CONTROL_PORT, Print* printTo = nullptr);
         void end();
         uint32_t getDurationMs() { return _durationMs; }
+        const FTPClientStats& getStats() { return _stats; }
+
+        // Transfers of the last async sync
+        const std::vector<FTPTransferStats>& getTransfers() { return _transfers; }
+
+        // Keeps the async session logged in between syncs until idle for the given time.
+        // Zero (default) closes the session after each sync.
+        void setIdleTimeout(uint16_t seconds) { _idleTimeout = seconds; }
+        bool isSessionOpen() { return _isLoggedIn && _controlClient.connected(); }
 
         bool passive();
         int sendCommand(String cmd, const char* arg = nullptr, bool awaitResponse = true);
@@ -50,22 +88,35 @@ class WiFiFTPClient
         WiFiClient& getDataClient();
 
         const char* getLastError() { return _lastError; }
+        const CircuitBreaker& getCircuitBreaker() { return _circuitBreaker; }
 
         WiFiClient& store(String filename);
         WiFiClient& append(String filename);
 
+        // Appends the unsent entries of a synced log. If a failed transfer left (part of) the unacknowledged entries
+        // on the server, they are overwritten (SIZE + REST + STOR), so a resend doesn't duplicate them.
+        WiFiClient& appendLog(String filename, SyncCursor& syncCursor);
+
         // Support for async FTP:
         AsyncFTPState getAsyncState() { return _asyncState; }
         bool isAsyncPending() { return (_asyncState != AsyncFTPState::Idle) && (_asyncState < AsyncFTPState::Done); }
         bool isAsyncSuccess() { return _asyncState == AsyncFTPState::Done; }
         void beginAsync(const char* host, const char* userName, const char* password, uint16_t port = FTP_DEFAULT_CONTROL_PORT, Print* printTo = nullptr);
         void endAsync() { setAsyncState(AsyncFTPState::Idle); }
-        void appendAsync(String filename, std::function<void(Print&)> dataWriter);
+        void appendAsync(String filename, std::function<void(Print&)> dataWriter, FTPTransferCallback onTransferred = nullptr);
+        void storeAsync(String filename, std::function<void(Print&)> dataWriter, FTPTransferCallback onTransferred = nullptr);
+        void appendChunkedAsync(String filename, FTPChunkWriter chunkWriter, FTPTransferCallback onTransferred = nullptr);
+        void appendLogAsync(String filename, SyncCursor& syncCursor, std::function<void(Print&)> dataWriter, FTPTransferCallback onTransferred);
+        void appendLogChunkedAsync(String filename, SyncCursor& syncCursor, FTPChunkWriter chunkWriter, FTPTransferCallback onTransferred);
         bool runAsync();
         bool run();
 
         void setUnexpectedResponse(const char* response = nullptr);
 
+        // Aborts the current upload, e.g. if producing its data failed.
+        // An async transfer then fails without calling its onTransferred callback.
+        void abortTransfer(const char* reason);
+
     private:
         int _timeoutMs;
         WiFiClient _controlClient;
@@ -84,9 +135,28 @@ class WiFiFTPClient
         uint32_t _asyncStateChangeMillis;
         volatile AsyncFTPState _asyncState;
         std::deque<AsyncFTPCommand> _asyncCommands;
+        CircuitBreaker _circuitBreaker;
+        FTPClientStats _stats;
+        std::vector<FTPTransferStats> _transfers;
+        uint16_t _idleTimeout = 0;
+        bool _isLoggedIn = false;
+        bool _isReusedSession = false;
+        String _sessionHost; // Server and credentials of the logged-in session
+        uint16_t _sessionPort = 0;
+        String _sessionUserName;
+        String _sessionPassword;
+        uint32_t _lastActivityMillis = 0;
+        uint32_t _transferStartMillis = 0;
+        size_t _transferBytes = 0;
 
         bool initialize(const char* userName, const char* password);
+        int64_t getFileSize(const String& filename);
         bool parsePassiveResult();
+        void addAsyncCommand(String filename, WiFiClient& (WiFiFTPClient::*command)(String), FTPChunkWriter chunkWriter, FTPTransferCallback onTransferred);
+        void addAsyncCommand(String filename, std::function<WiFiClient&()> execute, FTPChunkWriter chunkWriter, FTPTransferCallback onTransferred);
+        void closeIdleSession();
+        void setLoggedIn();
+        bool isSessionFor(const char* host, uint16_t port, const char* userName, const char* password);
         void setAsyncState(AsyncFTPState state);
         void setLastError(String format, ...);
 };
@@ -4,6 +4,8 @@
 #include <ESPWiFi.h>
 #include <ESPFileSystem.h>
 #include <ESPCoreDump.h>
+#include <FlightRecorder.h>
+#include <TaskMonitor.h>
 #include <Tracer.h>
 #include <StringBuilder.h>
 
@@ -19,15 +21,24 @@
 #endif
 
 constexpr uint32_t CONNECT_TIMEOUT_MS = 10000;
+constexpr uint32_t FAST_CONNECT_TIMEOUT_MS = 3000;
 constexpr uint32_t MIN_RETRY_INTERVAL_MS = 5000;
 constexpr uint32_t MAX_RETRY_INTERVAL_MS = 300000;
+constexpr size_t MAX_EVENT_SIZE = 160;
 
 bool WiFiStateMachine::_staDisconnected = false;
-StringBuilder _responseBuilder(256);
+StringBuilder _responseBuilder(1024);
 
 
 WiFiStateMachine::WiFiStateMachine(LED& led, WiFiNTP& timeServer, ESPWebServer& webServer, StringLog& eventLog)
-    : _led(led), _timeServer(timeServer), _webServer(webServer), _eventLog(eventLog)
+    : _led(led), _timeServer(timeServer), _webServer(webServer), _eventLogPtr(&eventLog)
+{
+    memset(_handlers, 0, sizeof(_handlers));
+}
+
+
+WiFiStateMachine::WiFiStateMachine(LED& led, WiFiNTP& timeServer, ESPWebServer& webServer, StructuredEventLog& eventLog)
+    : _led(led), _timeServer(timeServer), _webServer(webServer), _structuredEventLogPtr(&eventLog)
 {
     memset(_handlers, 0, sizeof(_handlers));
 }
@@ -68,9 +79,13 @@ void WiFiStateMachine::begin(String ssid, String password, String hostName, uint
     _isTimeServerAvailable = false;
     _resetMillis = 0;
 
+    FlightRecorder::begin();
     logEvent(F("Booted from %s"), getResetReason().c_str());
     logEvent(F("CPU @ %d MHz"), ESP.getCpuFreqMHz());
 
+    _connectCache.begin(ssid);
+    _startupStats.isTimeRestored = _connectCache.restoreTime();
+
 #ifdef ESP32
     esp_core_dump_init();
 #if (ESP_ARDUINO_VERSION_MAJOR == 2)
@@ -121,6 +136,8 @@ void WiFiStateMachine::begin(String ssid, String password, String hostName, uint
 
     _webServer.on("/coredump", std::bind(&WiFiStateMachine::handleHttpCoreDump, this));
     _webServer.on("/memory", std::bind(&WiFiStateMachine::handleHttpMemory, this));
+    _webServer.on("/tasks", std::bind(&WiFiStateMachine::handleHttpTasks, this));
+    _webServer.on("/tasks.json", std::bind(&WiFiStateMachine::handleHttpTasksJson, this));
     _webServer.onNotFound(std::bind(&WiFiStateMachine::handleHttpNotFound, this));
 
     setState(WiFiInitState::Initializing);
@@ -183,41 +200,93 @@ void WiFiStateMachine::traceDiag()
 
 void WiFiStateMachine::logEvent(String format, ...)
 {
-    char logMessage[64];
-
     va_list args;
     va_start(args, format);
-    vsnprintf(logMessage, sizeof(logMessage), format.c_str(), args);
+    logEventV(format.c_str(), args, false);
     va_end(args);
+}
 
-    logMessage[sizeof(logMessage) -1 ] = 0; // Ensure the string is always null-terminated
 
-    logEvent(logMessage);
+IRAM_ATTR void WiFiStateMachine::logEvent(const __FlashStringHelper* format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    logEventV(reinterpret_cast<PGM_P>(format), args, true);
+    va_end(args);
 }
 
 
 void WiFiStateMachine::logEvent(const char* msg)
+{
+    if (_structuredEventLogPtr != nullptr)
+    {
+        TRACE("logEvent: %s\n", msg);
+        _structuredEventLogPtr->add("%s", msg);
+        FlightRecorder::recordEvent(msg);
+    }
+    else
+        addTimestampedEvent("%s", msg);
+}
+
+
+IRAM_ATTR void WiFiStateMachine::logEventV(PGM_P format, va_list args, bool isStaticFormat)
 {
 #ifdef ESP32
-    xSemaphoreTake(_logMutex, pdMS_TO_TICKS(100));
+    // From an ISR only events with a static format can be logged (in the structured event log)
+    if (xPortInIsrContext() && (!isStaticFormat || (_structuredEventLogPtr == nullptr)))
+        return;
 #endif
-    TRACE("logEvent: %s\n", msg);
 
-    size_t timestamp_size = 23; // strlen("2019-01-30 12:23:34 : ") + 1;
-    char* event = new char[timestamp_size + strlen(msg)];
+    if (_structuredEventLogPtr == nullptr)
+    {
+        char message[MAX_EVENT_SIZE];
+        vsnprintf_P(message, sizeof(message), format, args);
+        addTimestampedEvent("%s", message);
+        return;
+    }
 
+    if (isStaticFormat)
+    {
+        // Arguments are stored in binary form; formatting is deferred until the event log is rendered.
+        StructuredEvent event;
+        if (_structuredEventLogPtr->addV(format, args, &event))
+            FlightRecorder::recordEvent(event);
+    }
+    else
+    {
+        // The format string may not outlive this call, so we have to format it now.
+        char message[MAX_EVENT_SIZE];
+        vsnprintf(message, sizeof(message), format, args);
+        logEvent(message);
+    }
+}
+
+
+void WiFiStateMachine::addTimestampedEvent(const char* format, ...)
+{
+#ifdef ESP32
+    xSemaphoreTake(_logMutex, pdMS_TO_TICKS(100));
+#endif
+
+    char event[MAX_EVENT_SIZE];
+    size_t timestampLength;
     if (_isTimeServerAvailable)
     {
         time_t currentTime = _timeServer.getCurrentTime();
-        strftime(event, timestamp_size, "%F %H:%M:%S : ", localtime(&currentTime));
+        timestampLength = strftime(event, sizeof(event), "%F %H:%M:%S : ", localtime(&currentTime));
     }
     else
-        snprintf(event, timestamp_size, "@ %lu ms : ", static_cast<uint32_t>(millis()));
+        timestampLength = snprintf(event, sizeof(event), "@ %lu ms : ", static_cast<uint32_t>(millis()));
 
-    strcat(event, msg);
+    va_list args;
+    va_start(args, format);
+    vsnprintf(event + timestampLength, sizeof(event) - timestampLength, format, args);
+    va_end(args);
+
+    TRACE("logEvent: %s\n", event + timestampLength);
 
-    _eventLog.add(event);
-    delete[] event;
+    _eventLogPtr->add(event);
+    FlightRecorder::recordEvent(event);
 
 #ifdef ESP32
     xSemaphoreGive(_logMutex);
@@ -281,11 +350,48 @@ void WiFiStateMachine::initializeSTA()
         TRACE(F("Unable to set host name ('%s')\n"), _hostName.c_str());
     if (!WiFi.mode(WIFI_STA))
         TRACE(F("Unable to set WiFi mode (STA)\n"));
-    WiFi.setScanMethod(WIFI_ALL_CHANNEL_SCAN);
+    WiFi.setScanMethod(_isFastConnect ? WIFI_FAST_SCAN : WIFI_ALL_CHANNEL_SCAN);
     WiFi.setSortMethod(WIFI_CONNECT_AP_BY_SIGNAL);
 #endif
     ArduinoOTA.setHostname(_hostName.c_str());
-    WiFi.begin(_ssid.c_str(), _password.c_str());
+
+    if (_isFastConnect)
+    {
+        // Connect to the cached Access Point and channel directly and skip DHCP if the lease is recent.
+        IPAddress ipAddress, gateway, subnetMask, dns;
+        _isLeaseReused = _connectCache.getLease(ipAddress, gateway, subnetMask, dns)
+            && WiFi.config(ipAddress, gateway, subnetMask, dns);
+        TRACE(F("Fast connect on channel %d. Lease reused: %d\n"), _connectCache.getChannel(), _isLeaseReused);
+        WiFi.begin(_ssid.c_str(), _password.c_str(), _connectCache.getChannel(), _connectCache.getBSSID());
+    }
+    else
+    {
+        if (_isLeaseReused)
+        {
+            // Back to DHCP
+            if (!WiFi.config(IPAddress(), IPAddress(), IPAddress()))
+                TRACE(F("Unable to enable DHCP\n"));
+            _isLeaseReused = false;
+        }
+        WiFi.begin(_ssid.c_str(), _password.c_str());
+    }
+}
+
+
+void WiFiStateMachine::storeConnectCache()
+{
+    // A reused lease isn't renewed, so it shouldn't be reused again.
+    _connectCache.store(!_isLeaseReused);
+    _connectCacheMillis = millis();
+}
+
+
+void WiFiStateMachine::recordUpload()
+{
+    if (_startupStats.firstUploadMillis != 0) return;
+
+    _startupStats.firstUploadMillis = millis();
+    logEvent(F("First upload @ %u ms"), static_cast<unsigned int>(_startupStats.firstUploadMillis));
 }
 
 
@@ -296,6 +402,13 @@ void WiFiStateMachine::run()
     wl_status_t wifiStatus = WiFi.status();
     String event;
 
+    FlightRecorder::recordLoop();
+    TaskMonitor::recordLoop();
+
+    // Not done in logEvent, because that may be called from an ISR
+    if (_isTimeServerAvailable && (_structuredEventLogPtr != nullptr))
+        _structuredEventLogPtr->setCurrentTime(_timeServer.getCurrentTime());
+
     if ((_ledBlinkInterval != 0) && (currentMillis >= _ledBlinkMillis))
     {
         _ledBlinkMillis = currentMillis + _ledBlinkInterval;
@@ -317,6 +430,7 @@ void WiFiStateMachine::run()
             }
             else
             {
+                _isFastConnect = _connectCache.isValid();
                 initializeSTA();
                 _staDisconnected = false;
                 _isInAccessPointMode = false;
@@ -340,6 +454,15 @@ void WiFiStateMachine::run()
             blinkLED(300);
             if (wifiStatus == WL_CONNECTED)
                 setState(WiFiInitState::Connected);
+            else if (_isFastConnect
+                && ((wifiStatus == WL_CONNECT_FAILED) || (wifiStatus == WL_NO_SSID_AVAIL) || (currentStateMillis >= FAST_CONNECT_TIMEOUT_MS)))
+            {
+                // Fall back to a full scan right away (no backoff)
+                logEvent(F("Fast connect failed. Status: %d"), wifiStatus);
+                _connectCache.invalidate();
+                _isFastConnect = false;
+                setState(WiFiInitState::Initializing);
+            }
             else if (wifiStatus == WL_CONNECT_FAILED)
                 setState(WiFiInitState::ConnectFailed); 
             else if (currentStateMillis >= CONNECT_TIMEOUT_MS)
@@ -354,6 +477,7 @@ void WiFiStateMachine::run()
             {
                 traceDiag();
                 logEvent(F("WiFi reconnected. Access Point %s\n"), WiFi.BSSIDstr().c_str());
+                storeConnectCache();
                 if (_scanAccessPointsTime > 0)
                     _scanAccessPointsTime = std::max(_scanAccessPointsTime, (time_t)(getCurrentTime() + _scanAccessPointsInterval));
                 setState(WiFiInitState::Initialized);
@@ -380,6 +504,7 @@ void WiFiStateMachine::run()
             {
                 traceDiag();
                 logEvent(F("WiFi reconnected. Access Point %s"), WiFi.BSSIDstr().c_str());
+                storeConnectCache();
                 _staDisconnected = false;
                 setState(WiFiInitState::Initialized);
             }
@@ -390,10 +515,16 @@ void WiFiStateMachine::run()
 #ifdef ESP8266
                 if (!WiFi.forceSleepWake())
                     TRACE(F("forceSleepWake() failed.\n"));
+                // Don't stick to the cached Access Point; it may be the one that went away.
+                if (_isFastConnect)
+                    WiFi.begin(_ssid.c_str(), _password.c_str());
 #else
-                if (!WiFi.reconnect())
+                if (_isFastConnect)
+                    forceReconnect();
+                else if (!WiFi.reconnect())
                     TRACE(F("reconnect() failed.\n"));
 #endif
+                _isFastConnect = false;
                 TRACE(F("WiFi status: %d\n"), WiFi.status());
                 setState(WiFiInitState::Reconnecting);
             }
@@ -427,7 +558,17 @@ void WiFiStateMachine::run()
             traceDiag();
             _staDisconnected = false;
             _ipAddress = WiFi.localIP();
-            logEvent(F("WiFi connected. Access Point %s"), WiFi.BSSIDstr().c_str());
+            if (_startupStats.connectedMillis == 0)
+            {
+                _startupStats.connectedMillis = millis();
+                _startupStats.isFastConnect = _isFastConnect;
+                _startupStats.isLeaseReused = _isLeaseReused;
+            }
+            storeConnectCache();
+            logEvent(
+                F("WiFi connected%s. Access Point %s"),
+                _isFastConnect ? " (fast)" : "",
+                WiFi.BSSIDstr().c_str());
             ArduinoOTA.begin();
             _webServer.begin();
             setState(WiFiInitState::TimeServerInitializing);
@@ -443,7 +584,14 @@ void WiFiStateMachine::run()
             _initTime = _timeServer.endGetServerTime(); 
             if (_initTime != 0)
             {
-                logEvent(F("Time synchronized using NTP server: %s"), _timeServer.NTPServer);
+                if (_startupStats.timeSyncedMillis == 0)
+                    _startupStats.timeSyncedMillis = millis();
+                if (_structuredEventLogPtr != nullptr)
+                    _structuredEventLogPtr->setCurrentTime(_initTime);
+                if (_startupStats.isTimeRestored)
+                    logEvent(F("Time restored. NTP server: %s"), _timeServer.NTPServer);
+                else
+                    logEvent(F("Time synchronized using NTP server: %s"), _timeServer.NTPServer);
                 _isTimeServerAvailable = true;
                 blinkLED(0);
                 setState(WiFiInitState::TimeServerSynced);
@@ -472,9 +620,23 @@ void WiFiStateMachine::run()
                 }
                 setState(WiFiInitState::ConnectionLost);
             }
-            else if (_scanAccessPointsTime > 0)
-                scanForBetterAccessPoint();
-            
+            else
+            {
+                if (!_isInAccessPointMode && (currentMillis - _connectCacheMillis >= WIFI_CONNECT_CACHE_REFRESH_SECONDS * 1000))
+                {
+                    if (_isLeaseReused)
+                    {
+                        // The reused lease isn't renewed; let DHCP take over (which normally hands out the same address).
+                        TRACE(F("Switching from cached lease to DHCP\n"));
+                        if (!WiFi.config(IPAddress(), IPAddress(), IPAddress()))
+                            TRACE(F("Unable to enable DHCP\n"));
+                        _isLeaseReused = false;
+                    }
+                    storeConnectCache();
+                }
+                if (_scanAccessPointsTime > 0)
+                    scanForBetterAccessPoint();
+            }
             break;
 
         default:
@@ -487,10 +649,10 @@ void WiFiStateMachine::run()
     {
         _webServer.handleClient();
         ArduinoOTA.handle();
-        delay(activeDelay);
+        sleep(activeDelay);
     }
     else
-        delay(inactiveDelay);
+        sleep(inactiveDelay);
 
     if ((_resetMillis > 0) && (currentMillis >= _resetMillis))
     {
@@ -503,6 +665,24 @@ void WiFiStateMachine::run()
 }
 
 
+void WiFiStateMachine::sleep(uint32_t maxSleepMs)
+{
+    if (_timerWheelPtr == nullptr)
+    {
+        delay(maxSleepMs);
+        return;
+    }
+
+    // Wake up for the next job if it's due before the regular delay ends
+    _timerWheelPtr->run();
+    if ((_powerManagerPtr != nullptr) && (_state == WiFiInitState::Initialized))
+        _powerManagerPtr->sleep(maxSleepMs);
+    else
+        _timerWheelPtr->sleep(maxSleepMs);
+    _timerWheelPtr->run();
+}
+
+
 void WiFiStateMachine::scanForBetterAccessPoint()
 {
 
@@ -655,8 +835,10 @@ void WiFiStateMachine::handleHttpCoreDump()
     Tracer tracer("WiFiStateMachine::handleHttpCoreDump");
 
     _responseBuilder.clear();
+    ChunkedResponse response(_responseBuilder, _webServer, "text/plain");
     writeCoreDump(_responseBuilder);
-    _webServer.send(200, "text/plain", _responseBuilder.c_str());
+    _responseBuilder.println();
+    FlightRecorder::writeReport(_responseBuilder);
 }
 
 void WiFiStateMachine::handleHttpMemory()
@@ -683,11 +865,52 @@ void WiFiStateMachine::handleHttpMemory()
     _responseBuilder.printf(F("Max alloc: %u\n"), ESP.getMaxFreeBlockSize());
 #endif
 
+    if (_memoryPlanPtr != nullptr)
+        _memoryPlanPtr->writeLayout(_responseBuilder);
+
     _webServer.send(200, "text/plain", _responseBuilder.c_str());
 }
 
+
+void WiFiStateMachine::handleHttpTasks()
+{
+    Tracer tracer("WiFiStateMachine::handleHttpTasks");
+
+    _responseBuilder.clear();
+    ChunkedResponse response(_responseBuilder, _webServer, "text/plain");
+    TaskMonitor::writeText(_responseBuilder);
+    if (_timerWheelPtr != nullptr)
+    {
+        _responseBuilder.println();
+        _timerWheelPtr->writeText(_responseBuilder);
+    }
+    if (_powerManagerPtr != nullptr)
+    {
+        _responseBuilder.println();
+        _powerManagerPtr->writeText(_responseBuilder);
+    }
+
+    if (shouldPerformAction("reset"))
+    {
+        TaskMonitor::resetLoopStats();
+        if (_timerWheelPtr != nullptr) _timerWheelPtr->resetStats();
+        if (_powerManagerPtr != nullptr) _powerManagerPtr->resetStats();
+    }
+}
+
+
+void WiFiStateMachine::handleHttpTasksJson()
+{
+    Tracer tracer("WiFiStateMachine::handleHttpTasksJson");
+
+    _responseBuilder.clear();
+    ChunkedResponse response(_responseBuilder, _webServer, "application/json");
+    TaskMonitor::writeJson(_responseBuilder);
+}
+
+
 void WiFiStateMachine::handleHttpNotFound()
 {
-    logEvent("Unexpected HTTP request: %s", _webServer.uri().c_str());
+    logEvent(F("Unexpected HTTP request: %s"), _webServer.uri().c_str());
     _webServer.send(404, "text/plain", "Unexpected request.");
 }
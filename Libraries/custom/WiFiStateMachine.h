@@ -6,6 +6,11 @@
 #include <ESPWebServer.h>
 #include <WiFiNTP.h>
 #include <Log.h>
+#include <StructuredEventLog.h>
+#include <MemoryPlanner.h>
+#include <TimerWheel.h>
+#include <PowerManager.h>
+#include <WiFiConnectCache.h>
 #include <Logger.h>
 #include <LED.h>
 
@@ -28,6 +33,17 @@ enum struct WiFiInitState
     Updating = 14
 };
 
+// Milliseconds after boot at which the startup milestones were reached; 0 if not (yet) reached.
+struct WiFiStartupStats
+{
+    uint32_t connectedMillis = 0;
+    uint32_t timeSyncedMillis = 0;
+    uint32_t firstUploadMillis = 0;
+    bool isFastConnect = false; // Connected to the cached Access Point without a full scan
+    bool isLeaseReused = false; // Used the cached IP lease instead of waiting for DHCP
+    bool isTimeRestored = false; // System time was valid before NTP sync
+};
+
 
 class WiFiStateMachine : public ILogger
 {
@@ -36,10 +52,17 @@ class WiFiStateMachine : public ILogger
         uint32_t inactiveDelay = 100; // ms
 
         WiFiStateMachine(LED& led, WiFiNTP& timeServer, ESPWebServer& webServer, StringLog& eventLog);
+        // Events are stored unformatted; use F() format strings to avoid formatting while logging.
+        WiFiStateMachine(LED& led, WiFiNTP& timeServer, ESPWebServer& webServer, StructuredEventLog& eventLog);
 
         void on(WiFiInitState state, void (*handler)(void));
 
         void registerStaticFiles(PGM_P* files, size_t count);
+        void registerMemoryPlan(const MemoryPlanner& memoryPlan) { _memoryPlanPtr = &memoryPlan; }
+        // Runs the timer jobs and sleeps until the next deadline instead of a fixed delay.
+        void registerTimerWheel(TimerWheel& timerWheel) { _timerWheelPtr = &timerWheel; }
+        // Light-sleeps between timer deadlines once initialized; requires a timer wheel.
+        void registerPowerManager(PowerManager& powerManager) { _powerManagerPtr = &powerManager; }
  
         void begin(String ssid, String password, String hostName, uint32_t reconnectInterval = 60);
         void run();
@@ -48,9 +71,12 @@ class WiFiStateMachine : public ILogger
 
         void traceDiag();
         virtual void logEvent(String format, ...) override;
+        virtual void logEvent(const __FlashStringHelper* format, ...) override;
         virtual void logEvent(const char* msg) override;
         time_t getCurrentTime();
         bool shouldPerformAction(String name);
+        // To be called after each successful upload; the first one marks the end of startup.
+        void recordUpload();
 
         time_t getInitTime() { return _initTime; }
         uint32_t getUptime() { return getCurrentTime() - _initTime; }
@@ -58,6 +84,7 @@ class WiFiStateMachine : public ILogger
         bool isInAccessPointMode() { return _isInAccessPointMode; }
         String getIPAddress() { return _ipAddress.toString(); }
         bool isConnected() { return _state >= WiFiInitState::Connected; }
+        const WiFiStartupStats& getStartupStats() { return _startupStats; }
 
         void scanAccessPoints(uint32_t intervalSeconds = 900, uint32_t switchDelaySeconds = 0, int8_t rssiThreshold = 6)
         {
@@ -87,21 +114,36 @@ class WiFiStateMachine : public ILogger
         LED& _led;
         WiFiNTP& _timeServer;
         ESPWebServer& _webServer;
-        StringLog& _eventLog;
+        StringLog* _eventLogPtr = nullptr;
+        StructuredEventLog* _structuredEventLogPtr = nullptr;
+        const MemoryPlanner* _memoryPlanPtr = nullptr;
+        TimerWheel* _timerWheelPtr = nullptr;
+        PowerManager* _powerManagerPtr = nullptr;
         void (*_handlers[static_cast<int>(WiFiInitState::Updating) + 1])(void); // function pointers indexed by state
         bool _isTimeServerAvailable = false;
         bool _isInAccessPointMode = false;
         IPAddress _ipAddress;
+        WiFiConnectCache _connectCache;
+        WiFiStartupStats _startupStats;
+        bool _isFastConnect = false;
+        bool _isLeaseReused = false;
+        uint32_t _connectCacheMillis = 0;
 
         void initializeAP();
         void initializeSTA();
         void setState(WiFiInitState newState, bool callHandler = false);
+        void logEventV(PGM_P format, va_list args, bool isStaticFormat);
+        void addTimestampedEvent(const char* format, ...);
         void blinkLED(uint32_t interval);
         String getResetReason();
         void scanForBetterAccessPoint();
+        void storeConnectCache();
         void handleHttpCoreDump();
         void handleHttpMemory();
+        void handleHttpTasks();
+        void handleHttpTasksJson();
         void handleHttpNotFound();
+        void sleep(uint32_t maxSleepMs);
         
 #ifdef ESP8266
         WiFiEventHandler _staDisconnectedEvent; 
@@ -4,6 +4,8 @@
 
 #ifdef ESP32
 #include <HTTPClient.h>
+#include <WiFi.h>
+#include <FlightRecorder.h>
 #else
 #include <ESP8266HTTPClient.h>
 #endif
@@ -31,6 +33,16 @@ const char* _homeWizardCertificate = "-----BEGIN CERTIFICATE-----\n" \
 
 
 
+static const char* _v2BatteryKeys[] = 
+{
+    "mode",
+    "power_w",
+    "target_power_w",
+    "max_consumption_w",
+    "max_production_w"
+};
+
+
 bool HomeWizardP1V1Client::begin(const char* host)
 {
     Tracer tracer("HomeWizardP1V1Client::begin", host);
@@ -39,45 +51,17 @@ bool HomeWizardP1V1Client::begin(const char* host)
     url += host;
     url += "/api/v1/data";
 
+    // Only keep the properties we use; the document then stays small.
+    addP1MeasurementFilter(_filterDoc, P1ApiVersion::V1);
+    setStreamResponse(true);
+
     return RESTClient::begin(url);
 }
 
 bool HomeWizardP1V1Client::parseResponse(const JsonDocument& response)
 {
-    JsonDocument& responseDoc = const_cast<JsonDocument&>(response);
-
-    electricity.clear();
-
-    char propertyName[32];
-    for (int i = 1; i <= 3; i++)
-    {
-        String phaseName = "L";
-        phaseName += i;
-
-        snprintf(propertyName, sizeof(propertyName), "active_voltage_l%d_v", i);
-        JsonVariant voltageJson = responseDoc[propertyName];
-        if (voltageJson.isNull()) break;
-
-        snprintf(propertyName, sizeof(propertyName), "active_current_l%d_a", i);
-        JsonVariant currentJson = responseDoc[propertyName];
-
-        snprintf(propertyName, sizeof(propertyName), "active_power_l%d_w", i);
-        JsonVariant powerJson = responseDoc[propertyName];
-
-        PhaseData phaseData
-        {
-            .Name = phaseName,
-            .Voltage = voltageJson.as<float>(),
-            .Current = currentJson.as<float>(),
-            .Power = powerJson.as<float>()
-        };
-        electricity.push_back(phaseData);       
-    }
-
-    TRACE("Received data for %d phases\n", electricity.size());
-
-    gasM3 = responseDoc["total_gas_m3"];
-    gasTimestamp = responseDoc["gas_timestamp"];
+    parseP1Measurement(response.as<JsonObjectConst>(), P1ApiVersion::V1, measurement);
+    TRACE("Received data for %d phases\n", measurement.phaseCount);
     return true;
 }
 
@@ -86,10 +70,19 @@ bool HomeWizardP1V2Client::begin(const char* host)
 {
     Tracer tracer("HomeWizardP1V2Client::begin", host);
 
+#ifndef ESP8266
+    _hostName = host;
+#endif
+
     String baseUrl = "https://";
     baseUrl += host;
     baseUrl += "/api/";
 
+    addP1MeasurementFilter(_filterDoc, P1ApiVersion::V2);
+    for (const char* key : _v2BatteryKeys)
+        _filterDoc[key] = true;
+    setStreamResponse(true);
+
     bool success = RESTClient::begin(baseUrl);
     setHeader("X-Api-Version", "2");
     setContentType("application/json");
@@ -153,34 +146,140 @@ bool HomeWizardP1V2Client::parseResponse(const JsonDocument& response)
         return true;    
     }
 
-    electricity.clear();
+    parseP1Measurement(response.as<JsonObjectConst>(), P1ApiVersion::V2, measurement);
+    TRACE("Received data for %d phases\n", measurement.phaseCount);
+    return true;
+}
+
+
+#ifndef ESP8266
+constexpr size_t PUSH_MESSAGE_SIZE = 1024;
+constexpr uint32_t PUSH_TIMEOUT_MS = 10000; // Reconnect if no message is received for this long
+constexpr uint32_t PUSH_MIN_RETRY_MS = 2000;
+constexpr uint32_t PUSH_MAX_RETRY_MS = 60000;
+
+static portMUX_TYPE _pushMux = portMUX_INITIALIZER_UNLOCKED;
+
+
+bool HomeWizardP1V2Client::beginPush(const char* bearerToken)
+{
+    Tracer tracer("HomeWizardP1V2Client::beginPush");
+
+    if (_pushTaskHandle != nullptr) return true;
+    if (!isInitialized || (bearerToken == nullptr) || (bearerToken[0] == 0)) return false;
+
+    _pushToken = bearerToken;
 
-    char propertyName[32];
-    for (int i = 1; i <= 3; i++)
+    BaseType_t res = xTaskCreate(
+        runPushTask,
+        "P1Push",
+        6144, // Stack size
+        this,
+        tskIDLE_PRIORITY + 1, // Above RESTClient, so pushed measurements are handled promptly
+        &_pushTaskHandle);
+
+    return res == pdPASS;
+}
+
+
+bool HomeWizardP1V2Client::usePushedMeasurement(uint32_t maxAgeMs)
+{
+    if (!_isPushSubscribed) return false;
+
+    bool result = false;
+    portENTER_CRITICAL(&_pushMux);
+    if ((_pushedMillis != 0) && (millis() - _pushedMillis <= maxAgeMs))
     {
-        String phaseName = "L";
-        phaseName += i;
+        measurement = _pushedMeasurement;
+        result = true;
+    }
+    portEXIT_CRITICAL(&_pushMux);
+    return result;
+}
+
+
+void HomeWizardP1V2Client::runPush()
+{
+    NetworkClientSecure tlsClient;
+    tlsClient.setInsecure(); // Same as the REST API (self-signed device certificate)
+    WebSocketClient webSocket(tlsClient);
 
-        snprintf(propertyName, sizeof(propertyName), "voltage_l%d_v", i);
-        JsonVariant voltageJson = responseDoc[propertyName];
-        if (voltageJson.isNull()) break;
+    JsonDocument filterDoc;
+    filterDoc["type"] = true;
+    addP1MeasurementFilter(filterDoc["data"].to<JsonObject>(), P1ApiVersion::V2);
 
-        snprintf(propertyName, sizeof(propertyName), "current_l%d_a", i);
-        JsonVariant currentJson = responseDoc[propertyName];
+    JsonDocument messageDoc;
+    char* message = Memory::allocate<char>(PUSH_MESSAGE_SIZE);
+    uint32_t retryDelayMs = PUSH_MIN_RETRY_MS;
 
-        snprintf(propertyName, sizeof(propertyName), "power_l%d_w", i);
-        JsonVariant powerJson = responseDoc[propertyName];
+    while (true)
+    {
+        FlightRecorder::recordLoop();
+
+        if (!WiFi.isConnected() || (message == nullptr))
+        {
+            delay(1000);
+            continue;
+        }
 
-        PhaseData phaseData
+        if (webSocket.connect(_hostName, 443, "/api/ws"))
         {
-            .Name = phaseName,
-            .Voltage = voltageJson.as<float>(),
-            .Current = currentJson.as<float>(),
-            .Power = powerJson.as<float>()
-        };
-        electricity.push_back(phaseData);       
+            _pushConnectCount++;
+            while (true)
+            {
+                FlightRecorder::recordLoop();
+                int length = webSocket.receive(message, PUSH_MESSAGE_SIZE, PUSH_TIMEOUT_MS);
+                if (length <= 0) break; // Closed or stale
+                if (!handlePushMessage(webSocket, message, messageDoc, filterDoc)) break;
+                if (_isPushSubscribed) retryDelayMs = PUSH_MIN_RETRY_MS;
+            }
+            _isPushSubscribed = false;
+            webSocket.close();
+        }
+        TRACE("P1 push disconnected: %s\n", webSocket.getLastError().c_str());
+
+        delay(retryDelayMs);
+        retryDelayMs = std::min(retryDelayMs * 2, PUSH_MAX_RETRY_MS);
     }
+}
 
-    TRACE("Received data for %d phases\n", electricity.size());
-    return true;
+
+bool HomeWizardP1V2Client::handlePushMessage(
+    WebSocketClient& webSocket,
+    const char* message,
+    JsonDocument& messageDoc,
+    const JsonDocument& filterDoc)
+{
+    if (deserializeJson(messageDoc, message, DeserializationOption::Filter(filterDoc)) != DeserializationError::Ok)
+        return true; // Ignore
+
+    const char* type = messageDoc["type"];
+    if (type == nullptr) return true;
+
+    if (strcmp(type, "measurement") == 0)
+    {
+        P1Measurement newMeasurement;
+        parseP1Measurement(messageDoc["data"].as<JsonObjectConst>(), P1ApiVersion::V2, newMeasurement);
+        portENTER_CRITICAL(&_pushMux);
+        _pushedMeasurement = newMeasurement;
+        _pushedMillis = millis();
+        portEXIT_CRITICAL(&_pushMux);
+        _pushCount++;
+        _isPushSubscribed = true;
+        return true;
+    }
+
+    char request[96];
+    if (strcmp(type, "authorization_requested") == 0)
+    {
+        snprintf(request, sizeof(request), "{\"type\":\"authorization\",\"data\":\"%s\"}", _pushToken.c_str());
+        return webSocket.sendText(request);
+    }
+    if (strcmp(type, "authorized") == 0)
+        return webSocket.sendText("{\"type\":\"subscribe\",\"data\":\"measurement\"}");
+
+    TRACE("P1 push: unexpected message '%s'\n", type);
+    return strcmp(type, "error") != 0;
 }
+#endif
+
@@ -2,14 +2,8 @@
 #define HWP1_CLIENT_H
 
 #include <RESTClient.h>
-
-struct PhaseData
-{
-    String Name;
-    float Voltage;
-    float Current;
-    float Power;
-};
+#include <WebSocketClient.h>
+#include <HomeWizardP1Measurement.h>
 
 struct BatteryInfo
 {
@@ -25,9 +19,7 @@ struct BatteryInfo
 class HomeWizardP1V1Client : public RESTClient
 {
     public:
-        std::vector<PhaseData> electricity;
-        float gasM3;
-        uint64_t gasTimestamp;
+        P1Measurement measurement;
 
         // Constructor
         HomeWizardP1V1Client(uint16_t timeout = 5) : RESTClient(timeout) {}
@@ -42,7 +34,7 @@ class HomeWizardP1V1Client : public RESTClient
 class HomeWizardP1V2Client : public RESTClient
 {
     public:
-        std::vector<PhaseData> electricity;
+        P1Measurement measurement;
         BatteryInfo batteries;
 
         // Constructor
@@ -52,6 +44,18 @@ class HomeWizardP1V2Client : public RESTClient
         String getBearerToken(const String& name);
         bool setBatteryMode(bool enable);
 
+#ifndef ESP8266
+        // Subscribes to measurements pushed over the WebSocket API (about once per second).
+        // A background task keeps the connection open and reconnects if needed.
+        bool beginPush(const char* bearerToken);
+        bool isPushSubscribed() { return _isPushSubscribed; }
+        uint32_t getPushCount() { return _pushCount; }
+        uint32_t getPushConnectCount() { return _pushConnectCount; }
+
+        // Copies the last pushed measurement to `measurement` if it is not older than maxAgeMs.
+        bool usePushedMeasurement(uint32_t maxAgeMs = 2000);
+#endif
+
         int requestData(const String& urlSuffix = "") override
         {
             if (urlSuffix.isEmpty())
@@ -62,6 +66,25 @@ class HomeWizardP1V2Client : public RESTClient
 
     protected:
         bool parseResponse(const JsonDocument& response) override;
+
+#ifndef ESP8266
+    private:
+        String _hostName;
+        String _pushToken;
+        TaskHandle_t _pushTaskHandle = nullptr;
+        P1Measurement _pushedMeasurement;
+        volatile uint32_t _pushedMillis = 0;
+        volatile bool _isPushSubscribed = false;
+        uint32_t _pushCount = 0;
+        uint32_t _pushConnectCount = 0;
+
+        void runPush();
+        bool handlePushMessage(WebSocketClient& webSocket, const char* message, JsonDocument& messageDoc, const JsonDocument& filterDoc);
+        static void runPushTask(void* taskParam)
+        {
+            static_cast<HomeWizardP1V2Client*>(taskParam)->runPush();
+        }
+#endif
 };
 
 #endif
\ No newline at end of file
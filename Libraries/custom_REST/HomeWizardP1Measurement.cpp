@@ -0,0 +1,146 @@
+#include <Arduino.h>
+#include "HomeWizardP1Measurement.h"
+
+
+enum struct P1Field : uint8_t
+{
+    Voltage,
+    Current,
+    Power,
+    Timestamp,
+    GasM3,
+    GasTimestamp
+};
+
+struct P1Key
+{
+    const char* name;
+    P1Field field;
+    uint8_t phase;
+};
+
+static const char* _phaseNames[P1_MAX_PHASES] = { "L1", "L2", "L3" };
+
+static const P1Key _v1Keys[] =
+{
+    { "active_voltage_l1_v", P1Field::Voltage, 0 },
+    { "active_voltage_l2_v", P1Field::Voltage, 1 },
+    { "active_voltage_l3_v", P1Field::Voltage, 2 },
+    { "active_current_l1_a", P1Field::Current, 0 },
+    { "active_current_l2_a", P1Field::Current, 1 },
+    { "active_current_l3_a", P1Field::Current, 2 },
+    { "active_power_l1_w", P1Field::Power, 0 },
+    { "active_power_l2_w", P1Field::Power, 1 },
+    { "active_power_l3_w", P1Field::Power, 2 },
+    { "total_gas_m3", P1Field::GasM3, 0 },
+    { "gas_timestamp", P1Field::GasTimestamp, 0 }
+};
+
+static const P1Key _v2Keys[] =
+{
+    { "voltage_l1_v", P1Field::Voltage, 0 },
+    { "voltage_l2_v", P1Field::Voltage, 1 },
+    { "voltage_l3_v", P1Field::Voltage, 2 },
+    { "current_l1_a", P1Field::Current, 0 },
+    { "current_l2_a", P1Field::Current, 1 },
+    { "current_l3_a", P1Field::Current, 2 },
+    { "power_l1_w", P1Field::Power, 0 },
+    { "power_l2_w", P1Field::Power, 1 },
+    { "power_l3_w", P1Field::Power, 2 },
+    { "timestamp", P1Field::Timestamp, 0 }
+};
+
+
+
+template<size_t N>
+static void addFilter(JsonVariant filter, const P1Key (&keys)[N])
+{
+    for (const P1Key& key : keys)
+        filter[key.name] = true;
+}
+
+
+static time_t parseTimestamp(const char* timestamp)
+{
+    // Format: "YYYY-MM-DDThh:mm:ss" (local time)
+    struct tm tm;
+    memset(&tm, 0, sizeof(tm));
+    if (timestamp == nullptr) return 0;
+    if (sscanf(timestamp, "%d-%d-%dT%d:%d:%d", &tm.tm_year, &tm.tm_mon, &tm.tm_mday, &tm.tm_hour, &tm.tm_min, &tm.tm_sec) != 6)
+        return 0;
+    tm.tm_year -= 1900;
+    tm.tm_mon -= 1;
+    tm.tm_isdst = -1;
+    return mktime(&tm);
+}
+
+
+// Walks the JSON object once, looking up each property in the given key table.
+template<size_t N>
+static void parseMeasurement(JsonObjectConst json, const P1Key (&keys)[N], P1Measurement& measurement)
+{
+    // Properties missing from the response must not keep their previous value
+    measurement = P1Measurement();
+    for (int i = 0; i < P1_MAX_PHASES; i++)
+        measurement.phases[i].Name = _phaseNames[i];
+
+    for (JsonPairConst property : json)
+    {
+        const char* name = property.key().c_str();
+        const P1Key* keyPtr = nullptr;
+        for (const P1Key& key : keys)
+        {
+            if (strcmp(name, key.name) == 0)
+            {
+                keyPtr = &key;
+                break;
+            }
+        }
+        if (keyPtr == nullptr) continue;
+
+        JsonVariantConst value = property.value();
+        PhaseData& phaseData = measurement.phases[keyPtr->phase];
+        switch (keyPtr->field)
+        {
+            case P1Field::Voltage:
+                phaseData.Voltage = value.as<float>();
+                measurement.phaseCount = std::max(measurement.phaseCount, static_cast<uint8_t>(keyPtr->phase + 1));
+                break;
+            case P1Field::Current:
+                phaseData.Current = value.as<float>();
+                break;
+            case P1Field::Power:
+                phaseData.Power = value.as<float>();
+                break;
+            case P1Field::Timestamp:
+                measurement.timestamp = parseTimestamp(value.as<const char*>());
+                break;
+            case P1Field::GasM3:
+                measurement.gasM3 = value.as<float>();
+                break;
+            case P1Field::GasTimestamp:
+                measurement.gasTimestamp = value.as<uint64_t>();
+                break;
+        }
+    }
+
+    if (measurement.timestamp == 0) measurement.timestamp = time(nullptr);
+}
+
+
+void addP1MeasurementFilter(JsonVariant filter, P1ApiVersion version)
+{
+    if (version == P1ApiVersion::V1)
+        addFilter(filter, _v1Keys);
+    else
+        addFilter(filter, _v2Keys);
+}
+
+
+void parseP1Measurement(JsonObjectConst json, P1ApiVersion version, P1Measurement& measurement)
+{
+    if (version == P1ApiVersion::V1)
+        parseMeasurement(json, _v1Keys, measurement);
+    else
+        parseMeasurement(json, _v2Keys, measurement);
+}
@@ -0,0 +1,45 @@
+#ifndef HWP1_MEASUREMENT_H
+#define HWP1_MEASUREMENT_H
+
+#include <ArduinoJson.h>
+#include <time.h>
+
+constexpr int P1_MAX_PHASES = 3;
+
+struct PhaseData
+{
+    const char* Name;
+    float Voltage;
+    float Current;
+    float Power;
+};
+
+// Measurement as received from either API version; filled without heap allocations.
+struct P1Measurement
+{
+    PhaseData phases[P1_MAX_PHASES];
+    uint8_t phaseCount = 0;
+    time_t timestamp = 0; // Measurement time (V2) or time received (V1)
+    float gasM3 = 0; // V1 only
+    uint64_t gasTimestamp = 0; // V1 only (YYMMDDhhmmss)
+
+    size_t size() const { return phaseCount; }
+    PhaseData& operator[](int index) { return phases[index]; }
+    PhaseData* begin() { return phases; }
+    PhaseData* end() { return phases + phaseCount; }
+};
+
+enum struct P1ApiVersion : uint8_t
+{
+    V1,
+    V2
+};
+
+// Adds the measurement properties of the given API version to a JSON filter.
+void addP1MeasurementFilter(JsonVariant filter, P1ApiVersion version);
+
+// Parses a measurement response (or the data of a pushed V2 measurement).
+// The whole measurement is reset first, so properties missing from the response are zero.
+void parseP1Measurement(JsonObjectConst json, P1ApiVersion version, P1Measurement& measurement);
+
+#endif
@@ -1,7 +1,11 @@
 #include <RESTClient.h>
 #include <Tracer.h>
 #include <StreamUtils.h>
+#include <FlightRecorder.h>
 
+#ifndef ESP8266
+static const char* TRANSFER_ENCODING_HEADER = "Transfer-Encoding";
+#endif
 
 bool RESTClient::begin(const String& baseUrl, const char* certificate)
 {
@@ -14,11 +18,14 @@ bool RESTClient::begin(const String& baseUrl, const char* certificate)
     uint32_t timeoutMs = static_cast<uint32_t>(_timeout) * 1000;
     _httpClient.setTimeout(timeoutMs);
     _httpClient.setConnectTimeout(timeoutMs);
+    const char* headerKeys[] = { TRANSFER_ENCODING_HEADER };
+    _httpClient.collectHeaders(headerKeys, 1);
+    if (_queueMutex == nullptr) _queueMutex = xSemaphoreCreateMutex();
 
     BaseType_t res = xTaskCreate(
         run,
         "RESTClient",
-        4096, // Stack size
+        6144, // Stack size (JSON is parsed on this task)
         this,
         tskIDLE_PRIORITY, // Minimal priority
         &_taskHandle);
@@ -89,28 +96,35 @@ int RESTClient::requestData(const String& urlSuffix)
 
     TRACE(F("_filterDoc.size()=%d\n"), _filterDoc.size());
 
-    JsonDocument jsonDoc;
     DeserializationError jsonError = DeserializationError::EmptyInput;
     if (_responsePtr)
     {
         jsonError = (_filterDoc.size() == 0)
-            ? deserializeJson(jsonDoc, _responsePtr->c_str())
-            : deserializeJson(jsonDoc, _responsePtr->c_str(), DeserializationOption::Filter(_filterDoc));
+            ? deserializeJson(_responseDoc, _responsePtr->c_str())
+            : deserializeJson(_responseDoc, _responsePtr->c_str(), DeserializationOption::Filter(_filterDoc));
 
         delete _responsePtr;
         _responsePtr = nullptr;
     }
+#ifndef ESP8266
+    else if (_isResponseParsed)
+    {
+        jsonError = _jsonError; // Parsed by the background task
+        _isResponseParsed = false;
+    }
+#endif
         
     if (jsonError != DeserializationError::Ok)
     {
+        _responseDoc.clear();
         _lastError = F("JSON error: "); 
         _lastError += jsonError.c_str();
         return RESPONSE_PARSING_FAILED;
     }
 
-    return parseResponse(jsonDoc)
-        ? HTTP_OK
-        : RESPONSE_PARSING_FAILED;
+    bool success = parseResponse(_responseDoc);
+    _responseDoc.clear(); // Release the memory until the next response
+    return success ? HTTP_OK : RESPONSE_PARSING_FAILED;
 }
 
 
@@ -128,28 +142,18 @@ int RESTClient::awaitData(const String& urlSuffix)
 }
 
 
-int RESTClient::request(RequestMethod method, const String& urlSuffix, const String& payload, JsonDocument& response)
-{
-    String responseStr;
-    int rc = request(method, urlSuffix, payload, responseStr);
-    if (rc != HTTP_OK) return rc;
-
-    DeserializationError parseError = deserializeJson(response, responseStr);
-    if (parseError != DeserializationError::Ok)
-    {
-        setLastError(String("JSON error: ") + parseError.c_str());
-        return RESPONSE_PARSING_FAILED;
-    }
-
-    return HTTP_OK;
-}
-
-
 #ifdef ESP8266
 int RESTClient::startRequest(const String& url)
 {
     Tracer tracer(F("RESTClient::startRequest"), url.c_str());
 
+    if (!_circuitBreaker.allowRequest())
+    {
+        _lastError = F("Circuit open");
+        return HTTP_CIRCUIT_OPEN;
+    }
+
+    _stats.requests++;
     if (!_asyncHttpRequest.open("GET", url.c_str()))
     {
         _lastError = F("Open failed");
@@ -179,6 +183,12 @@ int RESTClient::getResponse()
         _responsePtr = new MemoryStream(_asyncHttpRequest.responseText());
     else if (result < 0)
         _lastError = _asyncHttpRequest.responseHTTPString();
+
+    // Any HTTP response means the server is reachable
+    if (result < 0)
+        _circuitBreaker.recordFailure();
+    else
+        _circuitBreaker.recordSuccess();
     return result;
 }
 
@@ -188,17 +198,64 @@ int RESTClient::request(RequestMethod method, const String& urlSuffix, const Str
     return HTTP_OPEN_FAILED; // TODO
 }
 
+
+int RESTClient::request(RequestMethod method, const String& urlSuffix, const String& payload, JsonDocument& response)
+{
+    String responseStr;
+    int rc = request(method, urlSuffix, payload, responseStr);
+    if (rc != HTTP_OK) return rc;
+
+    DeserializationError parseError = deserializeJson(response, responseStr);
+    if (parseError != DeserializationError::Ok)
+    {
+        setLastError(String("JSON error: ") + parseError.c_str());
+        return RESPONSE_PARSING_FAILED;
+    }
+
+    return HTTP_OK;
+}
+
 void RESTClient::resetTLS() 
 {
 }
 
 #else
-int RESTClient::startRequest(const String& url)
+static bool parseUrl(const String& url, String& host, uint16_t& port, bool& isSecure)
+{
+    int hostStart = url.indexOf("://");
+    if (hostStart < 0) return false;
+    isSecure = url.startsWith("https:");
+    hostStart += 3;
+
+    int hostEnd = url.indexOf('/', hostStart);
+    if (hostEnd < 0) hostEnd = url.length();
+    String hostPort = url.substring(hostStart, hostEnd);
+    int atIndex = hostPort.indexOf('@');
+    if (atIndex >= 0) hostPort = hostPort.substring(atIndex + 1);
+
+    int colonIndex = hostPort.indexOf(':');
+    if (colonIndex >= 0)
+    {
+        host = hostPort.substring(0, colonIndex);
+        port = hostPort.substring(colonIndex + 1).toInt();
+    }
+    else
+    {
+        host = hostPort;
+        port = isSecure ? 443 : 80;
+    }
+    return true;
+}
+
+
+bool RESTClient::beginRequest(const String& url)
 {
-    TRACE("RESTClient::startRequest(\"%s\")\n", url.c_str());
+    TRACE("RESTClient::beginRequest(\"%s\")\n", url.c_str());
+
+    bool isSecure;
+    if (!parseUrl(url, _host, _port, isSecure)) return false;
 
-    bool success;
-    if (url.startsWith("https:"))
+    if (isSecure)
     {
         if (!_tlsClientPtr)
         {
@@ -207,111 +264,546 @@ int RESTClient::startRequest(const String& url)
                 _tlsClientPtr->setInsecure(); // Skip certificate validation
             else
                 _tlsClientPtr->setCACert(_certificate);
+            _tlsClientPtr->setHandshakeTimeout(_timeout);
         }
-        success = _httpClient.begin(*_tlsClientPtr, url); 
+        _activeClientPtr = _tlsClientPtr;
     }
     else
-        success = _httpClient.begin(url);
-
-    if (!success)
     {
-        _lastError = F("Open failed");
-        return HTTP_OPEN_FAILED;
+        if (!_tcpClientPtr)
+            _tcpClientPtr = new NetworkClient();
+        _activeClientPtr = _tcpClientPtr;
     }
 
-    _httpResult = 0;
-    return HTTP_REQUEST_PENDING;
+    _httpClient.setReuse(_idleTimeout != 0);
+    return _httpClient.begin(*_activeClientPtr, url);
+}
+
+
+int RESTClient::startRequest(const String& url)
+{
+    int result;
+    _dataRequestPtr = enqueue(RequestMethod::GET, url, "", nullptr, RequestPriority::Normal, 0, true, result);
+    return result;
 }
 
 
 bool RESTClient::isResponseAvailable()
 {
-    return _httpResult != 0;
+    return (_dataRequestPtr != nullptr) && (_dataRequestPtr->state == RequestState::Done);
 }
 
 
 int RESTClient::getResponse()
 {
-    return _httpResult;
+    QueuedRequest& request = *_dataRequestPtr;
+    _dataRequestPtr = nullptr;
+    int result = takeResponse(request, _responseDoc);
+    _isResponseParsed = (result == HTTP_OK);
+    return result;
 }
 
 
-void RESTClient::runHttpRequests()
+int RESTClient::queueRequest(
+    RequestMethod method,
+    const String& urlSuffix,
+    const String& payload,
+    RESTCallback callback,
+    RequestPriority priority,
+    uint32_t deadlineMs)
 {
-    while (true)
+    String url = urlSuffix.startsWith("http") ? urlSuffix : _baseUrl + urlSuffix;
+    int result;
+    enqueue(method, url, payload, callback, priority, deadlineMs, false, result);
+    return result;
+}
+
+
+int RESTClient::queueDataRequest(
+    const String& urlSuffix,
+    RESTDataCallback callback,
+    RequestPriority priority,
+    uint32_t deadlineMs)
+{
+    RESTCallback parseCallback = [this, callback](int result, const JsonDocument& response)
+    {
+        if ((result == HTTP_OK) && !parseResponse(response))
+        {
+            _lastError = F("Unexpected response");
+            result = RESPONSE_PARSING_FAILED;
+        }
+        callback(result);
+    };
+
+    int result;
+    enqueue(RequestMethod::GET, _baseUrl + urlSuffix, "", parseCallback, priority, deadlineMs, true, result);
+    return result;
+}
+
+
+RESTClient::QueuedRequest* RESTClient::enqueue(
+    RequestMethod method,
+    const String& url,
+    const String& payload,
+    RESTCallback callback,
+    RequestPriority priority,
+    uint32_t deadlineMs,
+    bool useFilter,
+    int& result)
+{
+    if (!isInitialized)
     {
-        if (isRequestPending())
+        _lastError = F("Not initialized");
+        result = HTTP_OPEN_FAILED;
+        return nullptr;
+    }
+
+    if (!_circuitBreaker.allowRequest())
+    {
+        _lastError = F("Circuit open");
+        result = HTTP_CIRCUIT_OPEN;
+        return nullptr;
+    }
+
+    uint32_t deadlineMillis = (deadlineMs == 0) ? 0 : std::max<uint32_t>(millis() + deadlineMs, 1);
+    QueuedRequest* requestPtr = nullptr;
+    xSemaphoreTake(_queueMutex, portMAX_DELAY);
+    if (method == RequestMethod::GET)
+    {
+        // Coalesce with an identical GET request which is not started yet
+        for (QueuedRequest& request : _queue)
         {
-            int httpResult = _httpClient.GET();
-            _responseTimeMs = millis() - _requestMillis; 
-            if (httpResult == HTTP_OK)
+            if ((request.state == RequestState::Queued) && (request.method == method)
+                && (request.useFilter == useFilter) && (request.url == url))
             {
-                int size = _httpClient.getSize();
-                if (size < 0) size = 4095;
-                _responsePtr = new MemoryStream(size, _memoryType);
-                _httpClient.writeToStream(_responsePtr);
+                request.priority = std::max(request.priority, priority);
+                if ((request.deadlineMillis != 0) && ((deadlineMillis == 0) || (int32_t)(deadlineMillis - request.deadlineMillis) > 0))
+                    request.deadlineMillis = deadlineMillis;
+                requestPtr = &request;
+                _stats.coalescedRequests++;
+                break;
             }
-            else if (httpResult < 0)
-                _lastError = HTTPClient::errorToString(httpResult);
-            _httpClient.end();
-            _httpResult = httpResult;
         }
-        delay(10);
     }
+    if (requestPtr == nullptr)
+    {
+        for (QueuedRequest& request : _queue)
+        {
+            if (request.state == RequestState::Free)
+            {
+                request.method = method;
+                request.priority = priority;
+                request.useFilter = useFilter;
+                request.pollCount = 0;
+                request.sequence = _requestSequence++;
+                request.deadlineMillis = deadlineMillis;
+                request.url = url;
+                request.payload = payload;
+                request.callbacks.clear();
+                request.state = RequestState::Queued;
+                requestPtr = &request;
+                break;
+            }
+        }
+    }
+    if (requestPtr != nullptr)
+    {
+        if (callback)
+            requestPtr->callbacks.push_back(callback);
+        else
+            requestPtr->pollCount++;
+    }
+    xSemaphoreGive(_queueMutex);
+
+    if (requestPtr == nullptr)
+    {
+        _lastError = F("Request queue full");
+        result = HTTP_QUEUE_FULL;
+    }
+    else
+        result = HTTP_REQUEST_PENDING;
+
+    return requestPtr;
 }
 
 
-int RESTClient::request(RequestMethod method, const String& urlSuffix, const String& payload, String& response)
+RESTClient::QueuedRequest* RESTClient::dequeue()
 {
-    Tracer tracer(F("RESTClient::request"), urlSuffix.c_str());
+    QueuedRequest* result = nullptr;
+    uint32_t currentMillis = millis();
+    xSemaphoreTake(_queueMutex, portMAX_DELAY);
+    for (QueuedRequest& request : _queue)
+    {
+        if (request.state != RequestState::Queued) continue;
+        if ((request.deadlineMillis != 0) && (int32_t)(currentMillis - request.deadlineMillis) > 0)
+        {
+            request.result = HTTP_DEADLINE_EXCEEDED;
+            request.error = F("Deadline exceeded");
+            request.responseTimeMs = 0;
+            request.state = RequestState::Done;
+            _stats.expiredRequests++;
+            continue;
+        }
+        if ((result == nullptr) || (request.priority > result->priority)
+            || ((request.priority == result->priority) && (int32_t)(request.sequence - result->sequence) < 0))
+            result = &request;
+    }
+    if (result != nullptr)
+        result->state = RequestState::Busy;
+    xSemaphoreGive(_queueMutex);
+    return result;
+}
 
-    String url = urlSuffix.startsWith("http") ? urlSuffix : _baseUrl + urlSuffix;
-    int startResult = startRequest(url);
-    if (startResult != HTTP_REQUEST_PENDING) return startResult;
 
-    int result = -1;
-    switch (method)
+int RESTClient::getCallbackResult(const QueuedRequest& request)
+{
+    if ((request.result == HTTP_OK) && (request.jsonError != DeserializationError::Ok))
+        return RESPONSE_PARSING_FAILED;
+    return request.result;
+}
+
+
+int RESTClient::takeResponse(QueuedRequest& request, JsonDocument& response)
+{
+    // The callbacks are invoked without holding the mutex; they may queue new requests.
+    std::vector<RESTCallback> callbacks;
+    xSemaphoreTake(_queueMutex, portMAX_DELAY);
+    int result = request.result;
+    int callbackResult = getCallbackResult(request);
+    _responseTimeMs = request.responseTimeMs;
+    _jsonError = request.jsonError;
+    if (result != HTTP_OK) _lastError = request.error;
+    callbacks.swap(request.callbacks);
+
+    if (--request.pollCount == 0)
+    {
+        response = std::move(request.response);
+        request.response.clear();
+        request.state = RequestState::Free;
+    }
+    else
+        response = request.response; // Another caller awaits the same request
+    xSemaphoreGive(_queueMutex);
+
+    for (RESTCallback& callback : callbacks)
+        callback(callbackResult, response);
+
+    return result;
+}
+
+
+void RESTClient::processCallbacks()
+{
+    for (QueuedRequest& request : _queue)
+    {
+        std::vector<RESTCallback> callbacks;
+        JsonDocument response;
+        int result = HTTP_REQUEST_PENDING;
+        xSemaphoreTake(_queueMutex, portMAX_DELAY);
+        if ((request.state == RequestState::Done) && !request.callbacks.empty())
+        {
+            result = getCallbackResult(request);
+            if (result < 0) _lastError = request.error;
+            callbacks.swap(request.callbacks);
+            if (request.pollCount == 0)
+            {
+                response = std::move(request.response);
+                request.response.clear();
+                request.state = RequestState::Free;
+            }
+            else
+                response = request.response; // Also awaited by a polling caller
+        }
+        xSemaphoreGive(_queueMutex);
+
+        for (RESTCallback& callback : callbacks)
+            callback(result, response);
+    }
+}
+
+
+int RESTClient::getQueueLength()
+{
+    int result = 0;
+    for (QueuedRequest& request : _queue)
+    {
+        if ((request.state == RequestState::Queued) || (request.state == RequestState::Busy))
+            result++;
+    }
+    return result;
+}
+
+
+bool RESTClient::connect(bool& isReused)
+{
+    // Reuse the connection if it is still open and to the same host.
+    isReused = false;
+    NetworkClient* otherClientPtr = (_activeClientPtr == _tlsClientPtr) ? _tcpClientPtr : _tlsClientPtr;
+    if (otherClientPtr && otherClientPtr->connected())
+        otherClientPtr->stop();
+    if (_activeClientPtr->connected())
+    {
+        if ((_host == _connectedHost) && (_port == _connectedPort) && (_idleTimeout != 0))
+        {
+            _stats.reusedConnections++;
+            isReused = true;
+            return true;
+        }
+        _activeClientPtr->stop();
+    }
+
+    // Connect explicitly (instead of letting HTTPClient do it) to measure the connect/handshake time.
+    uint32_t startMillis = millis();
+    if (!_activeClientPtr->connect(_host.c_str(), _port))
+    {
+        _stats.connectFailures++;
+        _connectedHost.clear();
+        return false;
+    }
+    uint32_t connectMs = millis() - startMillis;
+    TRACE(F("RESTClient: connected to %s:%u in %u ms\n"), _host.c_str(), _port, connectMs);
+
+    _connectedHost = _host;
+    _connectedPort = _port;
+    _stats.connects++;
+    _stats.lastConnectMs = connectMs;
+    _stats.maxConnectMs = std::max(_stats.maxConnectMs, connectMs);
+    _stats.totalConnectMs += connectMs;
+    return true;
+}
+
+
+void RESTClient::checkIdleConnection()
+{
+    if ((_activeClientPtr == nullptr) || !_activeClientPtr->connected()) return;
+    if ((millis() - _lastActivityMillis) < static_cast<uint32_t>(_idleTimeout) * 1000) return;
+
+    // Close the idle connection to free the (TLS) buffers
+    TRACE(F("RESTClient: closing idle connection to %s\n"), _connectedHost.c_str());
+    _activeClientPtr->stop();
+    _stats.idleDisconnects++;
+}
+
+
+int RESTClient::sendRequest(QueuedRequest& request)
+{
+    switch (request.method)
     {
         case RequestMethod::GET:
-            result = _httpClient.GET();
-            break;
+            return _httpClient.GET();
         case RequestMethod::POST:
-            result = _httpClient.POST(payload);
-            break;
+            return _httpClient.POST(request.payload);
         case RequestMethod::PUT:
-            result = _httpClient.PUT(payload);
+            return _httpClient.PUT(request.payload);
+        case RequestMethod::DELETE:
+            return _httpClient.sendRequest("DELETE", request.payload);
+    }
+    return HTTP_SEND_FAILED;
+}
+
+
+void RESTClient::executeRequest(QueuedRequest& request)
+{
+    uint32_t startMillis = millis();
+    _stats.requests++;
+    request.error.clear();
+    request.jsonError = DeserializationError::EmptyInput;
+
+    int result;
+    bool isConnected;
+    bool isReusedConnection = false;
+    do
+    {
+        if (isReusedConnection)
+        {
+            // The server may close a kept-alive connection just before it is reused.
+            // Retry once on a new connection before reporting an error.
+            TRACE(F("RESTClient: reused connection failed (%d). Reconnecting.\n"), result);
+            _activeClientPtr->stop();
+            _stats.reconnects++;
+        }
+        isConnected = false;
+        if (!beginRequest(request.url))
+        {
+            request.error = F("Open failed");
+            result = HTTP_OPEN_FAILED;
             break;
-        default:
-            TRACE("Unexpected Request method");
-            return false;
+        }
+        if (!connect(isReusedConnection))
+        {
+            _httpClient.end();
+            result = HTTPC_ERROR_CONNECTION_REFUSED;
+            request.error = HTTPClient::errorToString(result);
+            break;
+        }
+
+        // Negative results are send or (first) read failures; no response was received.
+        isConnected = true;
+        result = sendRequest(request);
     }
-    response = _httpClient.getString();
-    _httpClient.end();
-    TRACE("HTTP %d:\n%s\n", result, response.c_str());
+    while ((result < 0) && isReusedConnection);
 
-    if (result != HTTP_OK)
+    if (isConnected)
     {
-        if (result < 0)
-            _lastError = HTTPClient::errorToString(result);
+        if (result == HTTP_OK)
+            readResponse(request);
+        else if (result < 0)
+            request.error = HTTPClient::errorToString(result);
         else
         {
-            _lastError = "HTTP ";
-            _lastError += result;
-            _lastError += ": ";
-            _lastError += response;
+            request.error = F("HTTP ");
+            request.error += result;
+            request.error += F(": ");
+            request.error += _httpClient.getString().substring(0, 100);
         }
+        _httpClient.end(); // Keeps the connection open if the server allows
     }
+
+    _lastActivityMillis = millis();
+    request.responseTimeMs = _lastActivityMillis - startMillis;
+    request.result = result;
+
+    // Any HTTP response means the server is reachable
+    if (result < 0)
+        _circuitBreaker.recordFailure(_lastActivityMillis);
+    else
+        _circuitBreaker.recordSuccess();
+    TRACE(F("HTTP %d response after %u ms\n"), result, request.responseTimeMs);
+
+    // Release large buffers before the response is handed over
+    request.payload.clear();
+    xSemaphoreTake(_queueMutex, portMAX_DELAY);
+    if ((request.pollCount == 0) && request.callbacks.empty())
+    {
+        // The caller stopped waiting (see request)
+        request.response.clear();
+        request.state = RequestState::Free;
+    }
+    else
+        request.state = RequestState::Done;
+    xSemaphoreGive(_queueMutex);
+}
+
+
+void RESTClient::readResponse(QueuedRequest& request)
+{
+    const JsonDocument* filterPtr = (request.useFilter && (_filterDoc.size() != 0)) ? &_filterDoc : nullptr;
+    if (_streamResponse)
+    {
+        // Feed the socket directly into the JSON parser (with filter)
+        HttpBodyStream bodyStream(
+            _httpClient.getStream(),
+            _httpClient.header(TRANSFER_ENCODING_HEADER).equalsIgnoreCase("chunked"),
+            _httpClient.getSize());
+        request.jsonError = (filterPtr == nullptr)
+            ? deserializeJson(request.response, bodyStream)
+            : deserializeJson(request.response, bodyStream, DeserializationOption::Filter(*filterPtr));
+        bodyStream.drain();
+    }
+    else
+    {
+        int size = _httpClient.getSize();
+        if (size < 0) size = 4095;
+        MemoryStream buffer(size, _memoryType);
+        _httpClient.writeToStream(&buffer);
+        request.jsonError = (filterPtr == nullptr)
+            ? deserializeJson(request.response, buffer.c_str())
+            : deserializeJson(request.response, buffer.c_str(), DeserializationOption::Filter(*filterPtr));
+    }
+
+    if (request.jsonError != DeserializationError::Ok)
+    {
+        request.error = F("JSON error: ");
+        request.error += request.jsonError.c_str();
+    }
+}
+
+
+void RESTClient::runHttpRequests()
+{
+    while (true)
+    {
+        FlightRecorder::recordLoop();
+        if (_isTLSResetPending)
+        {
+            _isTLSResetPending = false;
+            deleteTLSClient();
+        }
+        QueuedRequest* requestPtr = dequeue();
+        if (requestPtr != nullptr)
+            executeRequest(*requestPtr);
+        else
+        {
+            checkIdleConnection();
+            delay(10);
+        }
+    }
+}
+
+
+int RESTClient::request(RequestMethod method, const String& urlSuffix, const String& payload, JsonDocument& response)
+{
+    Tracer tracer(F("RESTClient::request"), urlSuffix.c_str());
+
+    String url = urlSuffix.startsWith("http") ? urlSuffix : _baseUrl + urlSuffix;
+    int result;
+    QueuedRequest* requestPtr = enqueue(method, url, payload, nullptr, RequestPriority::High, 0, false, result);
+    if (requestPtr == nullptr) return result;
+
+    uint32_t startMillis = millis();
+    uint32_t timeoutMs = static_cast<uint32_t>(_timeout) * 1000;
+    while (requestPtr->state != RequestState::Done)
+    {
+        if ((millis() - startMillis) >= timeoutMs)
+        {
+            // Stop waiting; the request is freed when it completes (or right away if not started yet).
+            xSemaphoreTake(_queueMutex, portMAX_DELAY);
+            if (requestPtr->state != RequestState::Done)
+            {
+                if ((--requestPtr->pollCount == 0) && requestPtr->callbacks.empty()
+                    && (requestPtr->state == RequestState::Queued))
+                    requestPtr->state = RequestState::Free;
+                requestPtr = nullptr;
+            }
+            xSemaphoreGive(_queueMutex);
+            if (requestPtr == nullptr)
+            {
+                _lastError = F("Request timeout");
+                return HTTP_REQUEST_TIMEOUT;
+            }
+            break; // Completed just now
+        }
+        delay(10);
+    }
+
+    result = takeResponse(*requestPtr, response);
+    if ((result == HTTP_OK) && (_jsonError != DeserializationError::Ok))
+    {
+        setLastError(String("JSON error: ") + _jsonError.c_str());
+        return RESPONSE_PARSING_FAILED;
+    }
+
     return result;
 }
 
 void RESTClient::resetTLS() 
+{
+    // The background task may be using the TLS client; let it delete the client.
+    _isTLSResetPending = true;
+}
+
+
+void RESTClient::deleteTLSClient()
 {
     if (_tlsClientPtr)
     {
+        TRACE(F("RESTClient: deleting TLS client\n"));
         if (_tlsClientPtr->connected()) _tlsClientPtr->stop();
+        if (_activeClientPtr == _tlsClientPtr) _activeClientPtr = nullptr;
         delete _tlsClientPtr;
         _tlsClientPtr = nullptr;
     }
+    _connectedHost.clear();
 }
 
 #endif
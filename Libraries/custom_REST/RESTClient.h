@@ -3,6 +3,9 @@
 
 #include <ArduinoJson.h>
 #include <StreamUtils.h>
+#include <CircuitBreaker.h>
+#include <functional>
+#include <vector>
 
 #ifdef ESP8266
 #include <AsyncHTTPRequest_Generic.hpp>
@@ -16,6 +19,28 @@ constexpr int HTTP_OK = 200;
 constexpr int HTTP_OPEN_FAILED = -100;
 constexpr int HTTP_SEND_FAILED = -101;
 constexpr int RESPONSE_PARSING_FAILED = -102;
+constexpr int HTTP_QUEUE_FULL = -103;
+constexpr int HTTP_DEADLINE_EXCEEDED = -104;
+constexpr int HTTP_CIRCUIT_OPEN = -105;
+constexpr int HTTP_REQUEST_TIMEOUT = -106;
+constexpr int REST_QUEUE_SIZE = 4;
+
+struct RESTClientStats
+{
+    uint32_t requests = 0;
+    uint32_t connects = 0; // New connections (incl. TLS handshake)
+    uint32_t reusedConnections = 0; // Requests using a kept-alive connection
+    uint32_t reconnects = 0; // Reused connections which failed and were retried on a new connection
+    uint32_t connectFailures = 0;
+    uint32_t idleDisconnects = 0;
+    uint32_t coalescedRequests = 0; // Identical GET requests served by one HTTP request
+    uint32_t expiredRequests = 0; // Requests not started before their deadline
+    uint32_t lastConnectMs = 0;
+    uint32_t maxConnectMs = 0;
+    uint32_t totalConnectMs = 0;
+
+    uint32_t getAvgConnectMs() const { return (connects == 0) ? 0 : totalConnectMs / connects; }
+};
 
 enum struct RequestMethod
 {
@@ -25,6 +50,16 @@ enum struct RequestMethod
     DELETE
 };
 
+enum struct RequestPriority : uint8_t
+{
+    Low,
+    Normal,
+    High
+};
+
+using RESTCallback = std::function<void(int result, const JsonDocument& response)>;
+using RESTDataCallback = std::function<void(int result)>;
+
 class RESTClient
 {
     public:
@@ -38,12 +73,52 @@ class RESTClient
         bool isResponsePending() { return _requestMillis != 0; }
         bool isRequestPending() { return isResponsePending() && !isResponseAvailable(); }
         uint32_t getResponseTimeMs() { return _responseTimeMs; }
+        const RESTClientStats& getStats() { return _stats; }
+        const CircuitBreaker& getCircuitBreaker() { return _circuitBreaker; }
+
+        // Connections are kept alive between requests to the same host until idle for the given time.
+        // Zero disables keep-alive (a new connection per request).
+        void setIdleTimeout(uint16_t seconds) { _idleTimeout = seconds; }
+
+        // Parse the JSON response directly from the connection (applying the filter) instead of buffering it first.
+        // Reduces peak memory for large responses. Only on ESP32; ignored on ESP8266.
+        void setStreamResponse(bool streamResponse) { _streamResponse = streamResponse; }
 
         void setBearerToken(const String& bearerToken);
         virtual int requestData(const String& urlSuffix = "");
         int awaitData(const String& urlSuffix = "");
+
+        // Releases the TLS client (and its buffers), e.g. when WiFi is disconnected.
+        // On ESP32 the background task does this before it starts the next request.
         void resetTLS();
 
+#ifndef ESP8266
+        // Queues a request for the background task. Requests are handled in order of priority.
+        // An identical GET request which is still queued is reused (the callbacks of both are invoked).
+        // If the request can't be started within deadlineMs (0 = no deadline) it fails with HTTP_DEADLINE_EXCEEDED.
+        // Returns HTTP_REQUEST_PENDING if queued, or an error code (e.g. HTTP_QUEUE_FULL).
+        int queueRequest(
+            RequestMethod method,
+            const String& urlSuffix,
+            const String& payload,
+            RESTCallback callback,
+            RequestPriority priority = RequestPriority::Normal,
+            uint32_t deadlineMs = 0);
+
+        // Queues a GET request like requestData(), but without polling: the response is filtered and parsed
+        // by parseResponse() and the callback is invoked from processCallbacks().
+        int queueDataRequest(
+            const String& urlSuffix,
+            RESTDataCallback callback,
+            RequestPriority priority = RequestPriority::Normal,
+            uint32_t deadlineMs = 0);
+
+        // Invokes the callbacks of completed requests; call this from the task which queued them (i.e. loop).
+        void processCallbacks();
+
+        int getQueueLength();
+#endif
+
     protected:
         JsonDocument _filterDoc;
 
@@ -52,18 +127,81 @@ class RESTClient
         void setContentType(const String& contentType) { setHeader("Content-Type", contentType); }
         virtual bool parseResponse(const JsonDocument& response) = 0;
         void setLastError(const String& message) { _lastError = message; }
+#ifdef ESP8266
         int request(RequestMethod method, const String& urlSuffix, const String& payload, String& response);
+#endif
+        // Sends a request with high priority and waits for the response (at most the timeout).
         int request(RequestMethod method, const String& urlSuffix, const String& payload, JsonDocument& response);
 
     private:
 #ifdef ESP8266    
         AsyncHTTPRequest _asyncHttpRequest;
 #else
+        enum struct RequestState : uint8_t
+        {
+            Free,
+            Queued,
+            Busy,
+            Done
+        };
+
+        struct QueuedRequest
+        {
+            volatile RequestState state = RequestState::Free;
+            RequestMethod method;
+            RequestPriority priority;
+            bool useFilter;
+            uint8_t pollCount; // Number of callers awaiting the request (instead of using a callback)
+            uint32_t sequence; // Preserves the order of requests with the same priority
+            uint32_t deadlineMillis; // 0 means no deadline
+            String url;
+            String payload;
+            std::vector<RESTCallback> callbacks;
+            int result;
+            uint32_t responseTimeMs;
+            String error;
+            DeserializationError jsonError;
+            JsonDocument response;
+        };
+
         TaskHandle_t _taskHandle;
+        SemaphoreHandle_t _queueMutex = nullptr;
+        QueuedRequest _queue[REST_QUEUE_SIZE];
+        QueuedRequest* _dataRequestPtr = nullptr; // Request started by requestData()
+        uint32_t _requestSequence = 0;
         NetworkClientSecure* _tlsClientPtr = nullptr;
+        NetworkClient* _tcpClientPtr = nullptr;
+        NetworkClient* _activeClientPtr = nullptr;
         HTTPClient _httpClient;
-        volatile int _httpResult;
+        String _host;
+        uint16_t _port = 0;
+        String _connectedHost;
+        uint16_t _connectedPort = 0;
+        uint32_t _lastActivityMillis = 0;
+        volatile bool _isTLSResetPending = false; // The clients are only used by the background task
+
+        bool _isResponseParsed = false;
+        DeserializationError _jsonError;
 
+        QueuedRequest* enqueue(
+            RequestMethod method,
+            const String& url,
+            const String& payload,
+            RESTCallback callback,
+            RequestPriority priority,
+            uint32_t deadlineMs,
+            bool useFilter,
+            int& result);
+        QueuedRequest* dequeue();
+        int takeResponse(QueuedRequest& request, JsonDocument& response);
+        static int getCallbackResult(const QueuedRequest& request);
+        bool beginRequest(const String& url);
+        bool connect(bool& isReused);
+        void checkIdleConnection();
+        void deleteTLSClient();
+        int sendRequest(QueuedRequest& request);
+        void executeRequest(QueuedRequest& request);
+        void readResponse(QueuedRequest& request);
         void runHttpRequests();
         inline static void run(void* taskParam)
         {
@@ -77,9 +215,14 @@ class RESTClient
         String _lastError;
         MemoryType _memoryType;
         uint16_t _timeout;
+        uint16_t _idleTimeout = 30;
+        bool _streamResponse = false;
+        RESTClientStats _stats;
+        CircuitBreaker _circuitBreaker;
         volatile uint32_t _requestMillis = 0;
         uint32_t _responseTimeMs = 0;
         MemoryStream* _responsePtr = nullptr;
+        JsonDocument _responseDoc;
 
         int startRequest(const String& url);
         bool isResponseAvailable();
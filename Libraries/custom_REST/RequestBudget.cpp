@@ -0,0 +1,82 @@
+#include <Arduino.h>
+#include "RequestBudget.h"
+#include <Tracer.h>
+
+constexpr uint32_t DEFAULT_RETRY_AFTER = 60; // seconds
+
+
+uint32_t RequestBudget::getRemaining() const
+{
+    uint32_t remaining = (_used < _limit) ? _limit - _used : 0;
+    if (_reportedRemaining >= 0)
+        remaining = std::min(remaining, static_cast<uint32_t>(_reportedRemaining));
+    return remaining;
+}
+
+
+void RequestBudget::checkPeriod(time_t time)
+{
+    time_t periodStart = time - (time % _periodSeconds);
+    if (periodStart == _periodStart) return;
+
+    TRACE(F("RequestBudget: new period. Used %u of %u\n"), _used, _limit);
+    _periodStart = periodStart;
+    _used = 0;
+    _reportedRemaining = -1;
+}
+
+
+bool RequestBudget::tryAcquire(time_t time, bool isUrgent)
+{
+    checkPeriod(time);
+
+    if ((time < _retryAfterTime) || ((time < _nextRequestTime) && !isUrgent))
+    {
+        _stats.deferred++;
+        return false;
+    }
+
+    // Urgent requests may use the reserve, but not exceed the limit.
+    uint32_t remaining = getRemaining();
+    if ((remaining == 0) || (!isUrgent && (remaining <= _reserve)))
+    {
+        _nextRequestTime = _periodStart + _periodSeconds;
+        _stats.deferred++;
+        return false;
+    }
+
+    _used++;
+    if (_reportedRemaining > 0) _reportedRemaining--;
+    _stats.requests++;
+    scheduleNextRequest(time);
+    return true;
+}
+
+
+void RequestBudget::update(time_t time, uint32_t limit, uint32_t remaining)
+{
+    checkPeriod(time);
+    if (limit != 0) _limit = limit;
+    _reportedRemaining = remaining;
+    scheduleNextRequest(time);
+}
+
+
+void RequestBudget::rateLimited(time_t time, uint32_t retryAfter)
+{
+    _stats.rateLimited++;
+    if (retryAfter == 0) retryAfter = DEFAULT_RETRY_AFTER;
+    _retryAfterTime = std::max(_retryAfterTime, time + static_cast<time_t>(retryAfter));
+}
+
+
+void RequestBudget::scheduleNextRequest(time_t time)
+{
+    // Spread the remaining requests (minus the reserve) over the remainder of the period
+    uint32_t remaining = getRemaining();
+    time_t periodEnd = _periodStart + _periodSeconds;
+    if (remaining <= _reserve)
+        _nextRequestTime = periodEnd;
+    else
+        _nextRequestTime = std::max(_nextRequestTime, time + (periodEnd - time) / static_cast<time_t>(remaining - _reserve));
+}
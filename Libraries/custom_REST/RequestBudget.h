@@ -0,0 +1,54 @@
+#ifndef REQUEST_BUDGET_H
+#define REQUEST_BUDGET_H
+
+#include <stdint.h>
+#include <time.h>
+#include <algorithm>
+
+struct RequestBudgetStats
+{
+    uint32_t requests = 0;
+    uint32_t deferred = 0; // Requests not allowed because of the budget
+    uint32_t rateLimited = 0; // HTTP 429 responses
+};
+
+// Spreads a request quota (e.g. a daily limit of a cloud API) evenly over its period.
+// The quota period is aligned with the epoch, so a daily quota resets at midnight UTC.
+class RequestBudget
+{
+    public:
+        RequestBudget(uint32_t limit, uint32_t periodSeconds, uint32_t reserve)
+            : _limit(limit), _periodSeconds(periodSeconds), _reserve(reserve) {}
+
+        uint32_t getLimit() const { return _limit; }
+        uint32_t getUsed() const { return _used; }
+        uint32_t getRemaining() const;
+        time_t getNextRequestTime() const { return std::max(_nextRequestTime, _retryAfterTime); }
+        const RequestBudgetStats& getStats() const { return _stats; }
+
+        // Returns true and consumes a request if the budget allows one now.
+        // Urgent requests (e.g. discovery) are not spread, but still respect the reserve and Retry-After.
+        bool tryAcquire(time_t time, bool isUrgent = false);
+
+        // Updates the budget using the limits reported by the server (0 if not reported).
+        void update(time_t time, uint32_t limit, uint32_t remaining);
+
+        // Handles a HTTP 429 (Too Many Requests) response; retryAfter is in seconds (0 if not specified).
+        void rateLimited(time_t time, uint32_t retryAfter);
+
+    private:
+        uint32_t _limit;
+        uint32_t _periodSeconds;
+        uint32_t _reserve; // Requests kept for urgent use
+        uint32_t _used = 0;
+        int32_t _reportedRemaining = -1; // As reported by the server; -1 if unknown
+        time_t _periodStart = 0;
+        time_t _nextRequestTime = 0;
+        time_t _retryAfterTime = 0; // Applies to urgent requests too
+        RequestBudgetStats _stats;
+
+        void checkPeriod(time_t time);
+        void scheduleNextRequest(time_t time);
+};
+
+#endif
@@ -0,0 +1,65 @@
+#include <Arduino.h>
+#include "ResponseCache.h"
+
+
+ResponseCacheEntry* ResponseCache::find(const String& key)
+{
+    for (ResponseCacheEntry* entryPtr : _entries)
+    {
+        if (entryPtr->key == key) return entryPtr;
+    }
+    return nullptr;
+}
+
+
+bool ResponseCache::get(const String& key, time_t time, JsonDocument& doc, uint32_t maxAge)
+{
+    if (maxAge == 0) maxAge = _ttlSeconds;
+
+    ResponseCacheEntry* entryPtr = find(key);
+    if ((entryPtr == nullptr) || (static_cast<uint32_t>(time - entryPtr->time) > maxAge))
+    {
+        _misses++;
+        return false;
+    }
+
+    doc.set(entryPtr->doc);
+    _hits++;
+    return true;
+}
+
+
+void ResponseCache::put(const String& key, time_t time, const JsonDocument& doc)
+{
+    ResponseCacheEntry* entryPtr = find(key);
+    if (entryPtr == nullptr)
+    {
+        if (_entries.size() < _size)
+        {
+            entryPtr = new ResponseCacheEntry(_allocator);
+            _entries.push_back(entryPtr);
+        }
+        else
+        {
+            // Replace the oldest entry
+            entryPtr = _entries[0];
+            for (ResponseCacheEntry* otherEntryPtr : _entries)
+            {
+                if (otherEntryPtr->time < entryPtr->time) entryPtr = otherEntryPtr;
+            }
+        }
+        entryPtr->key = key;
+    }
+
+    entryPtr->time = time;
+    entryPtr->doc.set(doc);
+    entryPtr->doc.shrinkToFit();
+}
+
+
+void ResponseCache::clear()
+{
+    for (ResponseCacheEntry* entryPtr : _entries)
+        delete entryPtr;
+    _entries.clear();
+}
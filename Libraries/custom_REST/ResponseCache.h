@@ -0,0 +1,46 @@
+#ifndef RESPONSE_CACHE_H
+#define RESPONSE_CACHE_H
+
+#include <ArduinoJson.h>
+#include <vector>
+
+struct ResponseCacheEntry
+{
+    String key;
+    time_t time = 0;
+    JsonDocument doc;
+
+    ResponseCacheEntry(ArduinoJson::Allocator* allocator) : doc(allocator) {}
+};
+
+// Caches parsed JSON responses by URL path, so repeated reads don't consume a request budget.
+// The least recently stored entry is replaced when the cache is full.
+class ResponseCache
+{
+    public:
+        ResponseCache(size_t size, uint32_t ttlSeconds, ArduinoJson::Allocator* allocator)
+            : _size(size), _ttlSeconds(ttlSeconds), _allocator(allocator) {}
+
+        ~ResponseCache() { clear(); }
+
+        uint32_t getHits() const { return _hits; }
+        uint32_t getMisses() const { return _misses; }
+
+        // Copies a cached response to the given document.
+        // If maxAge is zero the TTL is used; use UINT32_MAX to accept any age.
+        bool get(const String& key, time_t time, JsonDocument& doc, uint32_t maxAge = 0);
+        void put(const String& key, time_t time, const JsonDocument& doc);
+        void clear();
+
+    private:
+        size_t _size;
+        uint32_t _ttlSeconds;
+        ArduinoJson::Allocator* _allocator;
+        std::vector<ResponseCacheEntry*> _entries;
+        uint32_t _hits = 0;
+        uint32_t _misses = 0;
+
+        ResponseCacheEntry* find(const String& key);
+};
+
+#endif
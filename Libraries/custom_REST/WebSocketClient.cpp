@@ -0,0 +1,300 @@
+#ifndef ESP8266
+#include <Arduino.h>
+#include "WebSocketClient.h"
+#include <Tracer.h>
+#include <mbedtls/base64.h>
+#include <mbedtls/sha1.h>
+#include <esp_random.h>
+
+constexpr const char* WEBSOCKET_GUID = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+constexpr size_t MAX_CONTROL_PAYLOAD = 125;
+constexpr uint64_t MAX_DRAIN_PAYLOAD = 4096;
+
+
+bool WebSocketClient::connect(const String& host, uint16_t port, const char* path, uint32_t timeoutMs)
+{
+    Tracer tracer(F("WebSocketClient::connect"), host.c_str());
+
+    if (_client.connected()) _client.stop();
+    if (!_client.connect(host.c_str(), port))
+    {
+        _lastError = F("Connect failed");
+        return false;
+    }
+
+    uint8_t nonce[16];
+    esp_fill_random(nonce, sizeof(nonce));
+    char key[32];
+    size_t keyLength;
+    mbedtls_base64_encode(reinterpret_cast<uint8_t*>(key), sizeof(key), &keyLength, nonce, sizeof(nonce));
+    key[keyLength] = 0;
+
+    _client.printf(
+        "GET %s HTTP/1.1\r\nHost: %s\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+        "Sec-WebSocket-Key: %s\r\nSec-WebSocket-Version: 13\r\n\r\n",
+        path,
+        host.c_str(),
+        key);
+
+    // The server must reply with base64(SHA1(key + GUID))
+    char acceptSource[64];
+    snprintf(acceptSource, sizeof(acceptSource), "%s%s", key, WEBSOCKET_GUID);
+    uint8_t acceptHash[20];
+    mbedtls_sha1(reinterpret_cast<uint8_t*>(acceptSource), strlen(acceptSource), acceptHash);
+    char expectedAccept[32];
+    size_t acceptLength;
+    mbedtls_base64_encode(reinterpret_cast<uint8_t*>(expectedAccept), sizeof(expectedAccept), &acceptLength, acceptHash, sizeof(acceptHash));
+    expectedAccept[acceptLength] = 0;
+
+    char line[128];
+    if (!readLine(line, sizeof(line), timeoutMs) || (strstr(line, " 101") == nullptr))
+    {
+        _lastError = F("Upgrade failed: ");
+        _lastError += line;
+        _client.stop();
+        return false;
+    }
+
+    bool isAccepted = false;
+    while (readLine(line, sizeof(line), timeoutMs) && (line[0] != 0))
+    {
+        const char* acceptHeader = "Sec-WebSocket-Accept:";
+        size_t headerLength = strlen(acceptHeader);
+        if (strncasecmp(line, acceptHeader, headerLength) == 0)
+        {
+            const char* value = line + headerLength;
+            while (*value == ' ') value++;
+            isAccepted = (strcmp(value, expectedAccept) == 0);
+        }
+    }
+
+    if (!isAccepted)
+    {
+        _lastError = F("Invalid Sec-WebSocket-Accept");
+        _client.stop();
+        return false;
+    }
+
+    _lastError.clear();
+    return true;
+}
+
+
+void WebSocketClient::close(uint16_t statusCode)
+{
+    if (!_client.connected()) return;
+    uint8_t payload[2] = { static_cast<uint8_t>(statusCode >> 8), static_cast<uint8_t>(statusCode & 0xFF) };
+    sendFrame(WebSocketOpcode::Close, payload, (statusCode == 0) ? 0 : sizeof(payload));
+    _client.stop();
+}
+
+
+bool WebSocketClient::sendText(const char* text)
+{
+    return sendFrame(WebSocketOpcode::Text, reinterpret_cast<const uint8_t*>(text), strlen(text));
+}
+
+
+int WebSocketClient::receive(char* buffer, size_t size, uint32_t timeoutMs)
+{
+    size_t length = 0;
+    bool isTruncated = false;
+    bool isReassembling = false;
+    uint32_t startMillis = millis();
+    while (true)
+    {
+        if (_client.available() < 2)
+        {
+            if (!_client.connected()) return -1;
+            if (millis() - startMillis >= timeoutMs)
+            {
+                if (!isReassembling) return 0;
+                // The remaining fragments didn't arrive in time; the connection is out of sync now.
+                _lastError = F("Fragment timeout");
+                close();
+                return -1;
+            }
+            delay(10);
+            continue;
+        }
+
+        uint8_t header[2];
+        if (!readBytes(header, sizeof(header))) return -1;
+        bool isFinal = (header[0] & 0x80) != 0;
+        WebSocketOpcode opcode = static_cast<WebSocketOpcode>(header[0] & 0x0F);
+        bool isMasked = (header[1] & 0x80) != 0;
+        uint64_t payloadLength = header[1] & 0x7F;
+        if (payloadLength >= 126)
+        {
+            uint8_t extendedLength[8];
+            size_t extendedSize = (payloadLength == 126) ? 2 : 8;
+            if (!readBytes(extendedLength, extendedSize)) return -1;
+            payloadLength = 0;
+            for (size_t i = 0; i < extendedSize; i++)
+                payloadLength = (payloadLength << 8) | extendedLength[i];
+        }
+        uint8_t mask[4];
+        if (isMasked && !readBytes(mask, sizeof(mask))) return -1;
+
+        // Control frames can't be fragmented and have a small payload (RFC 6455, 5.5).
+        // Data frames must continue a fragmented message, or start a new one.
+        bool isControlFrame = (static_cast<uint8_t>(opcode) & 0x08) != 0;
+        bool isProtocolError = isControlFrame
+            ? (!isFinal || (payloadLength > MAX_CONTROL_PAYLOAD))
+            : ((opcode == WebSocketOpcode::Continuation) != isReassembling);
+        if (isProtocolError)
+        {
+            // Drain the payload first; closing with unread data resets the connection (dropping the close frame).
+            _lastError = F("Protocol error");
+            if (payloadLength <= MAX_DRAIN_PAYLOAD) skipBytes(payloadLength);
+            close(WEBSOCKET_PROTOCOL_ERROR);
+            return -1;
+        }
+
+        switch (opcode)
+        {
+            case WebSocketOpcode::Ping:
+            {
+                uint8_t payload[MAX_CONTROL_PAYLOAD];
+                size_t pingLength = payloadLength;
+                if (!readBytes(payload, pingLength)) return -1;
+                for (size_t i = 0; isMasked && (i < pingLength); i++)
+                    payload[i] ^= mask[i % 4];
+                if (!sendFrame(WebSocketOpcode::Pong, payload, pingLength)) return -1;
+                break;
+            }
+
+            case WebSocketOpcode::Close:
+                TRACE(F("WebSocket closed by server\n"));
+                skipBytes(payloadLength);
+                sendFrame(WebSocketOpcode::Close, nullptr, 0);
+                _client.stop();
+                return -1;
+
+            case WebSocketOpcode::Text:
+            case WebSocketOpcode::Binary:
+            case WebSocketOpcode::Continuation:
+            {
+                size_t copyLength = std::min(payloadLength, (uint64_t)(size - 1 - length));
+                if (!readBytes(reinterpret_cast<uint8_t*>(buffer + length), copyLength)) return -1;
+                for (size_t i = 0; isMasked && (i < copyLength); i++)
+                    buffer[length + i] ^= mask[i % 4];
+                length += copyLength;
+                if (copyLength < payloadLength)
+                {
+                    if (!skipBytes(payloadLength - copyLength)) return -1;
+                    isTruncated = true;
+                }
+                if (!isFinal)
+                {
+                    // The reassembly deadline starts at the first fragment
+                    if (!isReassembling) startMillis = millis();
+                    isReassembling = true;
+                    break;
+                }
+                isReassembling = false;
+
+                if (isTruncated)
+                {
+                    // Drop the message; a partial message is of no use.
+                    _lastError = F("Message too large");
+                    length = 0;
+                    isTruncated = false;
+                    break;
+                }
+                buffer[length] = 0;
+                return length;
+            }
+
+            default:
+                if (!skipBytes(payloadLength)) return -1;
+                break;
+        }
+    }
+}
+
+
+bool WebSocketClient::readLine(char* buffer, size_t size, uint32_t timeoutMs)
+{
+    size_t length = 0;
+    uint32_t startMillis = millis();
+    buffer[0] = 0;
+    while (millis() - startMillis < timeoutMs)
+    {
+        int c = _client.read();
+        if (c < 0)
+        {
+            if (!_client.connected()) return false;
+            delay(1);
+            continue;
+        }
+        if (c == '\n')
+        {
+            buffer[length] = 0;
+            return true;
+        }
+        if ((c != '\r') && (length < size - 1))
+            buffer[length++] = c;
+    }
+    buffer[length] = 0;
+    return false;
+}
+
+
+bool WebSocketClient::readBytes(uint8_t* buffer, size_t length)
+{
+    return _client.readBytes(buffer, length) == length;
+}
+
+
+bool WebSocketClient::skipBytes(size_t length)
+{
+    uint8_t buffer[64];
+    while (length > 0)
+    {
+        size_t chunkLength = std::min(length, sizeof(buffer));
+        if (!readBytes(buffer, chunkLength)) return false;
+        length -= chunkLength;
+    }
+    return true;
+}
+
+
+bool WebSocketClient::sendFrame(WebSocketOpcode opcode, const uint8_t* payload, size_t length)
+{
+    // Client frames must be masked
+    uint8_t header[8];
+    size_t headerLength = 0;
+    header[headerLength++] = 0x80 | static_cast<uint8_t>(opcode); // Final fragment
+    if (length < 126)
+        header[headerLength++] = 0x80 | length;
+    else if (length <= 0xFFFF)
+    {
+        header[headerLength++] = 0x80 | 126;
+        header[headerLength++] = length >> 8;
+        header[headerLength++] = length & 0xFF;
+    }
+    else
+    {
+        _lastError = F("Frame too large");
+        return false;
+    }
+    uint32_t maskValue = esp_random();
+    uint8_t* mask = header + headerLength;
+    memcpy(mask, &maskValue, 4);
+    headerLength += 4;
+
+    if (_client.write(header, headerLength) != headerLength) return false;
+
+    uint8_t buffer[64];
+    for (size_t offset = 0; offset < length; offset += sizeof(buffer))
+    {
+        size_t chunkLength = std::min(length - offset, sizeof(buffer));
+        for (size_t i = 0; i < chunkLength; i++)
+            buffer[i] = payload[offset + i] ^ mask[(offset + i) % 4];
+        if (_client.write(buffer, chunkLength) != chunkLength) return false;
+    }
+    return true;
+}
+
+#endif
@@ -0,0 +1,49 @@
+#ifndef WEBSOCKET_CLIENT_H
+#define WEBSOCKET_CLIENT_H
+
+#ifndef ESP8266
+#include <NetworkClient.h>
+
+constexpr uint16_t WEBSOCKET_PROTOCOL_ERROR = 1002; // Close status code
+
+enum struct WebSocketOpcode : uint8_t
+{
+    Continuation = 0,
+    Text = 1,
+    Binary = 2,
+    Close = 8,
+    Ping = 9,
+    Pong = 10
+};
+
+// Minimal WebSocket client (RFC 6455) exchanging text messages over a (TLS) connection.
+// All calls block, so use it from a background task.
+class WebSocketClient
+{
+    public:
+        WebSocketClient(NetworkClient& client) : _client(client) {}
+
+        bool connect(const String& host, uint16_t port, const char* path, uint32_t timeoutMs = 5000);
+        bool isConnected() { return _client.connected(); }
+        void close(uint16_t statusCode = 0);
+        bool sendText(const char* text);
+
+        // Receives the next text message into the buffer (null-terminated); control frames are handled here.
+        // Returns the message length, 0 if no message arrived within the timeout or -1 if the connection is closed.
+        // A fragmented message must be completed within the timeout after its first fragment; else the connection is closed.
+        int receive(char* buffer, size_t size, uint32_t timeoutMs);
+
+        const String& getLastError() { return _lastError; }
+
+    private:
+        NetworkClient& _client;
+        String _lastError;
+
+        bool readLine(char* buffer, size_t size, uint32_t timeoutMs);
+        bool readBytes(uint8_t* buffer, size_t length);
+        bool skipBytes(size_t length);
+        bool sendFrame(WebSocketOpcode opcode, const uint8_t* payload, size_t length);
+};
+
+#endif
+#endif
@@ -9,17 +9,35 @@ struct PersistentSettings : WiFiSettingsWithFTP
     char otgwHost[32];
     int solarPumpPWMDeltaT;
     int solarPumpPWMChangeRatePct;
+    char mqttBroker[32];
+    char mqttUser[32];
+    char mqttPassword[32];
 
-    PersistentSettings() : WiFiSettingsWithFTP(PSTR("AquaMon"))
-    {
-        addIntegerField(ftpSyncEntries, PSTR("FTP sync entries"), 1, 250, 50);
-        addIntegerField(solarPumpPWMDeltaT, PSTR("Solar pump PWM ΔT"), 0, 50, 10);
-        addIntegerField(solarPumpPWMChangeRatePct, PSTR("Solar pump PWM rate"), 1, 10, 5);
-        addIntegerField(antiFreezeTemp, PSTR("Anti-freeze temperature"), 1, 10, 5);
-        addBooleanField(logPacketErrors, PSTR("Log packet errors"), false, 4); // 4 bytes for alignment
-        addFloatField(zone1Offset, PSTR("Zone1 offset"), 1, -5.0F, 5.0F);
-        addStringField(otgwHost, sizeof(otgwHost), PSTR("OTGW host"));
-    }
+    PersistentSettings();
 };
 
+PERSISTENT_FIELD_TABLE_BEGIN
+constexpr PersistentDataField PERSISTENT_SETTINGS_FIELDS[] PROGMEM =
+{
+    PersistentDataField::integerField("FTP sync entries", PERSISTENT_FIELD(PersistentSettings, ftpSyncEntries), 1, 250, 50),
+    PersistentDataField::integerField("Solar pump PWM ΔT", PERSISTENT_FIELD(PersistentSettings, solarPumpPWMDeltaT), 0, 50, 10),
+    PersistentDataField::integerField("Solar pump PWM rate", PERSISTENT_FIELD(PersistentSettings, solarPumpPWMChangeRatePct), 1, 10, 5),
+    PersistentDataField::integerField("Anti-freeze temperature", PERSISTENT_FIELD(PersistentSettings, antiFreezeTemp), 1, 10, 5),
+    PersistentDataField::booleanField("Log packet errors", PERSISTENT_FIELD(PersistentSettings, logPacketErrors), false),
+    PersistentDataField::floatField("Zone1 offset", PERSISTENT_FIELD(PersistentSettings, zone1Offset), 1, -5.0F, 5.0F),
+    PersistentDataField::stringField("OTGW host", PERSISTENT_FIELD(PersistentSettings, otgwHost)),
+    PersistentDataField::stringField("MQTT broker", PERSISTENT_FIELD(PersistentSettings, mqttBroker)),
+    PersistentDataField::stringField("MQTT user", PERSISTENT_FIELD(PersistentSettings, mqttUser)),
+    PersistentDataField::passwordField("MQTT password", PERSISTENT_FIELD(PersistentSettings, mqttPassword))
+};
+// The fields from here on were added after the legacy EEPROM format
+constexpr auto PERSISTENT_SETTINGS_LEGACY_DATA_END = PERSISTENT_FIELD(PersistentSettings, mqttBroker);
+PERSISTENT_FIELD_TABLE_END
+
+PersistentSettings::PersistentSettings() : WiFiSettingsWithFTP(PSTR("AquaMon"))
+{
+    addFields(PERSISTENT_SETTINGS_FIELDS);
+    setLegacyDataEnd(PERSISTENT_SETTINGS_LEGACY_DATA_END);
+}
+
 PersistentSettings PersistentData;
@@ -5,6 +5,9 @@
 #include <WiFiStateMachine.h>
 #include <WiFiNTP.h>
 #include <WiFiFTP.h>
+#include <GzipPrint.h>
+#include <SyncCursor.h>
+#include <MQTTPublisher.h>
 #include <TimeUtils.h>
 #include <Tracer.h>
 #include <StringBuilder.h>
@@ -69,6 +72,7 @@ const char* Files[] PROGMEM =
 ESPWebServer WebServer(80); // Default HTTP port
 WiFiNTP TimeServer;
 WiFiFTPClient FTPClient(FTP_TIMEOUT_MS);
+MQTTPublisher MQTT(FTP_TIMEOUT_MS);
 OTGWClient OTGW;
 StringBuilder HttpResponse(4 * 1024); // 4 kB HTTP response buffer (we're using chunked responses)
 HtmlWriter Html(HttpResponse, Files[Logo], Files[Styles]);
@@ -87,7 +91,8 @@ int topicLogAggregations = 0;
 TopicLogEntry* lastTopicLogEntryPtr = nullptr;
 DayStatsEntry* lastDayStatsEntryPtr = nullptr;
 
-uint16_t ftpSyncEntries = 0;
+SyncCursor topicLogSyncCursor(TOPIC_LOG_SIZE);
+int mqttSensors[NUMBER_OF_MONITORED_TOPICS];
 uint16_t heatPumpOnCount = 0;
 bool isDefrosting = false;
 bool antiFreezeActivated = false;
@@ -237,8 +242,10 @@ void updateTopicLog()
 
         newTopicLogEntry.time = currentTime;
 
-        ftpSyncEntries = std::min(uint16_t(ftpSyncEntries + 1), TOPIC_LOG_SIZE);
-        if (PersistentData.isFTPEnabled() && ftpSyncEntries == PersistentData.ftpSyncEntries)
+        topicLogSyncCursor.add();
+        for (int i = 0; i < NUMBER_OF_MONITORED_TOPICS; i++)
+            MQTT.setValue(mqttSensors[i], lastTopicLogEntryPtr->topicValues[i]);
+        if (PersistentData.isFTPEnabled() && topicLogSyncCursor.getLag() == PersistentData.ftpSyncEntries)
             syncFTPTime = currentTime;
     }
 
@@ -316,7 +323,7 @@ bool trySyncFTP(Print* printTo)
     Tracer tracer(F("trySyncFTP"));
 
     char filename[40];
-    snprintf(filename, sizeof(filename), "%s.csv", PersistentData.hostName);
+    snprintf(filename, sizeof(filename), "%s.csv.gz", PersistentData.hostName);
 
     if (!FTPClient.begin(
         PersistentData.ftpServer,
@@ -329,20 +336,30 @@ bool trySyncFTP(Print* printTo)
     }
 
     bool success = false;
-    WiFiClient& dataClient = FTPClient.append(filename);
+    bool isAborted = false;
+    WiFiClient& dataClient = FTPClient.appendLog(filename, topicLogSyncCursor);
     if (dataClient.connected())
     {
-        if (ftpSyncEntries > 0)
+        uint16_t unsentEntries = topicLogSyncCursor.getUnsent();
+        if (unsentEntries > 0)
         {
-            writeTopicLogCsv(ftpSyncEntries, dataClient);
-            ftpSyncEntries = 0;
+            GzipPrint gzipClient(dataClient);
+            writeTopicLogCsv(unsentEntries, gzipClient);
+            isAborted = !gzipClient.finish();
+            if (isAborted)
+                FTPClient.abortTransfer("gzip failed"); // The cursor stays, so the entries are sent again.
+            else
+                topicLogSyncCursor.advance(unsentEntries);
         }
         else if (printTo != nullptr)
             printTo->println("Nothing to sync.");
         dataClient.stop();
 
-        if (FTPClient.readServerResponse() == 226)
+        if (isAborted)
+            success = false;
+        else if (FTPClient.readServerResponse() == 226)
         {
+            topicLogSyncCursor.acknowledge(currentTime);
             lastFTPSyncTime = currentTime;
             success = true;
         }
@@ -352,6 +369,9 @@ bool trySyncFTP(Print* printTo)
 
     FTPClient.end();
 
+    // Entries which were sent but not acknowledged are sent again in the next sync.
+    if (!success) topicLogSyncCursor.rollback();
+
     return success;
 }
 
@@ -434,7 +454,21 @@ void handleHttpRootRequest()
     Html.writeRow(F("Last packet"), lastPacket);
     Html.writeRow(F("Packet errors"), F("%0.1f %%"), HeatPump.getPacketErrorRatio() * 100);
     Html.writeRow(F("FTP Sync"), ftpSync);
-    Html.writeRow(F("Sync entries"), F("%d / %d"), ftpSyncEntries, PersistentData.ftpSyncEntries);
+    Html.writeRow(
+        F("Sync lag"),
+        F("%u / %d entries (%u lost)"),
+        topicLogSyncCursor.getLag(),
+        PersistentData.ftpSyncEntries,
+        topicLogSyncCursor.getLost());
+    if (MQTT.isEnabled())
+    {
+        Html.writeRow(
+            F("MQTT"),
+            F("%s, %u msg, %u queued"),
+            MQTT.getStateLabel(),
+            MQTT.getStats().published,
+            MQTT.getQueueLength());
+    }
     Html.writeTableEnd();
     Html.writeSectionEnd();
 
@@ -877,6 +911,7 @@ void onWiFiInitialized()
         if (trySyncFTP(nullptr))
         {
             WiFiSM.logEvent(F("FTP sync"));
+            WiFiSM.recordUpload();
             syncFTPTime = 0;
         }
         else
@@ -885,6 +920,8 @@ void onWiFiInitialized()
             syncFTPTime = currentTime + FTP_RETRY_INTERVAL;
         }
     }
+
+    MQTT.run();
 }
 
 // Boot code
@@ -901,6 +938,10 @@ void setup()
     BuiltinLED.begin();
 
     PersistentData.begin();
+
+    // Keep the log sync positions across resets (RTC memory slots)
+    topicLogSyncCursor.begin(0);
+
     TimeServer.NTPServer = PersistentData.ntpServer;
     Html.setTitlePrefix(PersistentData.hostName);
 
@@ -984,6 +1025,29 @@ void setup()
         OTGW.begin(PersistentData.otgwHost);
     }
 
+    if (PersistentData.mqttBroker[0] != 0)
+    {
+        // Publish changes of more than half the displayed resolution
+        int i = 0;
+        for (MonitoredTopic& topic : MonitoredTopics)
+        {
+            bool isTemperature = strcmp(topic.unitOfMeasure, "°C") == 0;
+            mqttSensors[i++] = MQTT.addSensor(
+                topic.label,
+                (topic.unitOfMeasure[0] == 0) ? nullptr : topic.unitOfMeasure,
+                isTemperature ? "temperature" : nullptr,
+                0.5F / powf(10, topic.decimals),
+                topic.decimals);
+        }
+        if (!MQTT.begin(
+            PersistentData.mqttBroker,
+            MQTT_DEFAULT_PORT,
+            PersistentData.mqttUser,
+            PersistentData.mqttPassword,
+            PersistentData.hostName))
+            WiFiSM.logEvent(F("Unable to initialize MQTT publisher"));
+    }
+
     SolarPump.begin();
  
     BuiltinLED.setOff();
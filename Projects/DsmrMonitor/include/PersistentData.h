@@ -7,15 +7,37 @@ struct PersistentSettings : WiFiSettingsWithFTP
     int maxPhaseCurrent; // A (per phase)
     int powerLogDelta;
     float gasCalorificValue; // kWh per m3
+    char influxUrl[96];
+    char influxToken[96];
+    char mqttBroker[32];
+    char mqttUser[32];
+    char mqttPassword[32];
 
-    PersistentSettings() : WiFiSettingsWithFTP(PSTR("DsmrMonitor"))
-    {
-        addIntegerField(ftpSyncEntries, PSTR("FTP Sync entries"), 0, 250, 50);
-        addIntegerField(phaseCount, PSTR("#Phases"), 1, 3, 1);
-        addIntegerField(maxPhaseCurrent, PSTR("Max phase current"), 25, 75, 25);
-        addIntegerField(powerLogDelta, PSTR("Power log delta (W)"), 0, 1000, 10);
-        addFloatField(gasCalorificValue, PSTR("Gas calorific (kWh/m3)"), 3, 1, 15, 9.769);
-    }
+    PersistentSettings();
 };
 
+PERSISTENT_FIELD_TABLE_BEGIN
+constexpr PersistentDataField PERSISTENT_SETTINGS_FIELDS[] PROGMEM =
+{
+    PersistentDataField::integerField("FTP Sync entries", PERSISTENT_FIELD(PersistentSettings, ftpSyncEntries), 0, 250, 50),
+    PersistentDataField::integerField("#Phases", PERSISTENT_FIELD(PersistentSettings, phaseCount), 1, 3, 1),
+    PersistentDataField::integerField("Max phase current", PERSISTENT_FIELD(PersistentSettings, maxPhaseCurrent), 25, 75, 25),
+    PersistentDataField::integerField("Power log delta (W)", PERSISTENT_FIELD(PersistentSettings, powerLogDelta), 0, 1000, 10),
+    PersistentDataField::floatField("Gas calorific (kWh/m3)", PERSISTENT_FIELD(PersistentSettings, gasCalorificValue), 3, 1, 15, 9.769),
+    PersistentDataField::stringField("InfluxDB write URL", PERSISTENT_FIELD(PersistentSettings, influxUrl)),
+    PersistentDataField::passwordField("InfluxDB token", PERSISTENT_FIELD(PersistentSettings, influxToken)),
+    PersistentDataField::stringField("MQTT broker", PERSISTENT_FIELD(PersistentSettings, mqttBroker)),
+    PersistentDataField::stringField("MQTT user", PERSISTENT_FIELD(PersistentSettings, mqttUser)),
+    PersistentDataField::passwordField("MQTT password", PERSISTENT_FIELD(PersistentSettings, mqttPassword))
+};
+// The fields from here on were added after the legacy EEPROM format
+constexpr auto PERSISTENT_SETTINGS_LEGACY_DATA_END = PERSISTENT_FIELD(PersistentSettings, influxUrl);
+PERSISTENT_FIELD_TABLE_END
+
+PersistentSettings::PersistentSettings() : WiFiSettingsWithFTP(PSTR("DsmrMonitor"))
+{
+    addFields(PERSISTENT_SETTINGS_FIELDS);
+    setLegacyDataEnd(PERSISTENT_SETTINGS_LEGACY_DATA_END);
+}
+
 PersistentSettings PersistentData;
@@ -1,7 +1,24 @@
+#include <InfluxLineWriter.h>
+
 struct PowerLogEntry
 {
     time_t time;
     uint16_t powerDelivered[3];
     uint16_t powerReturned[3];
     uint16_t powerGas;
-};
\ No newline at end of file
+
+    void writeInfluxLine(InfluxLineWriter& output, int phaseCount)
+    {
+        static const char* deliveredKeys[] = { "deliveredL1", "deliveredL2", "deliveredL3" };
+        static const char* returnedKeys[] = { "returnedL1", "returnedL2", "returnedL3" };
+
+        output.beginLine("power");
+        for (int phase = 0; phase < phaseCount; phase++)
+        {
+            output.addField(deliveredKeys[phase], powerDelivered[phase]);
+            output.addField(returnedKeys[phase], powerReturned[phase]);
+        }
+        output.addField("gas", powerGas);
+        output.endLine(time);
+    }
+};
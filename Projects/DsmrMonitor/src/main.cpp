@@ -4,6 +4,10 @@
 #include <ESPFileSystem.h>
 #include <WiFiNTP.h>
 #include <WiFiFTP.h>
+#include <GzipPrint.h>
+#include <SyncCursor.h>
+#include <InfluxExporter.h>
+#include <MQTTPublisher.h>
 #include <TimeUtils.h>
 #include <Tracer.h>
 #include <StringBuilder.h>
@@ -20,6 +24,7 @@
 
 #define REFRESH_INTERVAL 30
 #define FTP_RETRY_INTERVAL (15 * SECONDS_PER_MINUTE)
+#define INFLUX_FLUSH_INTERVAL (5 * SECONDS_PER_MINUTE)
 #define MAX_POWER_LOG_SIZE 250
 #define POWER_LOG_PAGE_SIZE 50
 #define POWER_LOG_INTERVAL 60
@@ -73,6 +78,8 @@ const char* Units[] PROGMEM =
 ESPWebServer WebServer(80); // Default HTTP port
 WiFiNTP TimeServer;
 WiFiFTPClient FTPClient(2000); // 2 sec timeout
+InfluxExporter Influx(2000, INFLUX_FLUSH_INTERVAL); // 2 sec timeout
+MQTTPublisher MQTT(2000); // 2 sec timeout
 StringBuilder HttpResponse(16384); // 16KB HTTP response buffer
 HtmlWriter Html(HttpResponse, Files[Logo], Files[Styles], 45);
 Log<const char> EventLog(50); // Max 50 log entries
@@ -103,7 +110,13 @@ time_t lastFTPSyncTime = 0;
 PhaseData phaseData[3];
 PhaseData total;
 GasData gasData;
-int logEntriesToSync = 0;
+SyncCursor powerLogSyncCursor(MAX_POWER_LOG_SIZE);
+SyncCursor powerLogInfluxCursor(MAX_POWER_LOG_SIZE);
+
+// MQTT sensor indices (per phase)
+int mqttVoltage[3];
+int mqttCurrent[3];
+int mqttPower[3];
 
 
 void newEnergyPerHourLogEntry()
@@ -150,6 +163,17 @@ void newEnergyPerMonthLogEntry()
 }
 
 
+void publishMQTTValues()
+{
+    for (int phase = 0; phase < PersistentData.phaseCount; phase++)
+    {
+        MQTT.setValue(mqttVoltage[phase], phaseData[phase].voltage);
+        MQTT.setValue(mqttCurrent[phase], phaseData[phase].current);
+        MQTT.setValue(mqttPower[phase], phaseData[phase].powerDelivered - phaseData[phase].powerReturned);
+    }
+}
+
+
 void updateStatistics(P1Telegram& p1Telegram, float hoursSinceLastUpdate)
 {
     Tracer tracer(F("updateStatistics"));
@@ -182,6 +206,7 @@ void updateStatistics(P1Telegram& p1Telegram, float hoursSinceLastUpdate)
     total.current = phaseData[0].current + phaseData[1].current + phaseData[2].current;
     total.powerDelivered = phaseData[0].powerDelivered + phaseData[1].powerDelivered + phaseData[2].powerDelivered;
     total.powerReturned = phaseData[0].powerReturned + phaseData[1].powerReturned + phaseData[2].powerReturned;
+    publishMQTTValues();
 
     String gasTimestamp;
     float gasEnergy = p1Telegram.getFloatValue(P1Telegram::PropertyId::Gas, &gasTimestamp) * PersistentData.gasCalorificValue;
@@ -257,8 +282,9 @@ void updatePowerLog(time_t time)
 
         powerLogEntryPtr = PowerLog.add(&newPowerLogEntry);
 
-        logEntriesToSync = std::min(logEntriesToSync + 1, MAX_POWER_LOG_SIZE);
-        if (PersistentData.isFTPEnabled() && (logEntriesToSync == PersistentData.ftpSyncEntries))
+        powerLogSyncCursor.add();
+        powerLogInfluxCursor.add();
+        if (PersistentData.isFTPEnabled() && (powerLogSyncCursor.getLag() == PersistentData.ftpSyncEntries))
             syncFTPTime = currentTime;
     }
     else
@@ -335,12 +361,21 @@ void writeCsvPowerLogEntries(PowerLogEntry* logEntryPtr, Print& destination)
 }
 
 
+uint16_t writeInfluxLines(InfluxLineWriter& output, uint16_t unsentEntries, uint16_t maxEntries)
+{
+    uint16_t entries = 0;
+    for (auto i = PowerLog.at(-unsentEntries); (i != PowerLog.end()) && (entries < maxEntries); ++i, ++entries)
+        i->writeInfluxLine(output, PersistentData.phaseCount);
+    return entries;
+}
+
+
 bool trySyncFTP(Print* printTo)
 {
     Tracer tracer(F("trySyncFTP"));
 
     char filename[40];
-    snprintf(filename, sizeof(filename), "%s.csv", PersistentData.hostName);
+    snprintf(filename, sizeof(filename), "%s.csv.gz", PersistentData.hostName);
 
     if (!FTPClient.begin(
         PersistentData.ftpServer,
@@ -353,21 +388,31 @@ bool trySyncFTP(Print* printTo)
     }
 
     bool success = false;
-    WiFiClient& dataClient = FTPClient.append(filename);
+    bool isAborted = false;
+    WiFiClient& dataClient = FTPClient.appendLog(filename, powerLogSyncCursor);
     if (dataClient.connected())
     {
-        if (logEntriesToSync > 0)
+        uint16_t unsentEntries = powerLogSyncCursor.getUnsent();
+        if (unsentEntries > 0)
         {
-            PowerLogEntry* firstLogEntryPtr = PowerLog.getEntryFromEnd(logEntriesToSync);
-            writeCsvPowerLogEntries(firstLogEntryPtr, dataClient);
-            logEntriesToSync = 0;
+            PowerLogEntry* firstLogEntryPtr = PowerLog.getEntryFromEnd(unsentEntries);
+            GzipPrint gzipClient(dataClient);
+            writeCsvPowerLogEntries(firstLogEntryPtr, gzipClient);
+            isAborted = !gzipClient.finish();
+            if (isAborted)
+                FTPClient.abortTransfer("gzip failed"); // The cursor stays, so the entries are sent again.
+            else
+                powerLogSyncCursor.advance(unsentEntries);
         }
         else if (printTo != nullptr)
             printTo->println(F("Nothing to sync."));
         dataClient.stop();
 
-        if (FTPClient.readServerResponse() == 226)
+        if (isAborted)
+            success = false;
+        else if (FTPClient.readServerResponse() == 226)
         {
+            powerLogSyncCursor.acknowledge(currentTime);
             lastFTPSyncTime = currentTime;
             success = true;
         }
@@ -377,6 +422,9 @@ bool trySyncFTP(Print* printTo)
 
     FTPClient.end();
 
+    // Entries which were sent but not acknowledged are sent again in the next sync.
+    if (!success) powerLogSyncCursor.rollback();
+
     return success;
 }
 
@@ -562,7 +610,43 @@ void handleHttpRootRequest()
     Html.writeRow(F("Gas update"), formatTime("%H:%M:%S", gasData.time));
     Html.writeRow(F("FTP Sync"), ftpSync);
     if (PersistentData.isFTPEnabled())
-        Html.writeRow(F("Sync entries"), F("%d / %d"), logEntriesToSync, PersistentData.ftpSyncEntries);
+        Html.writeRow(
+            F("Sync lag"),
+            F("%u / %d entries (%u lost)"),
+            powerLogSyncCursor.getLag(),
+            PersistentData.ftpSyncEntries,
+            powerLogSyncCursor.getLost());
+    if (Influx.isEnabled())
+    {
+        const InfluxExporterStats& influxStats = Influx.getStats();
+        Html.writeRow(
+            F("InfluxDB"),
+            F("%u lines, %0.0f lines/s, batch %u"),
+            influxStats.lines,
+            influxStats.getLinesPerSecond(),
+            Influx.getBatchSize());
+        Html.writeRow(
+            F("InfluxDB lag"),
+            F("%u entries (%s)"),
+            powerLogInfluxCursor.getLag(),
+            Influx.getCircuitBreaker().getStateLabel());
+    }
+    if (MQTT.isEnabled())
+    {
+        const MQTTPublisherStats& mqttStats = MQTT.getStats();
+        Html.writeRow(
+            F("MQTT"),
+            F("%s, %u msg, %0.2f msg/s"),
+            MQTT.getStateLabel(),
+            mqttStats.published,
+            MQTT.getMessagesPerSecond());
+        Html.writeRow(
+            F("MQTT queue"),
+            F("%u (max %u), %u dropped"),
+            MQTT.getQueueLength(),
+            mqttStats.queueHighWater,
+            mqttStats.dropped);
+    }
     Html.writeTableEnd();
     Html.writeSectionEnd();
 
@@ -846,6 +930,7 @@ void onWiFiInitialized()
         if (trySyncFTP(nullptr))
         {
             WiFiSM.logEvent(F("FTP sync"));
+            WiFiSM.recordUpload();
             syncFTPTime = 0;
         }
         else
@@ -854,6 +939,9 @@ void onWiFiInitialized()
             syncFTPTime = currentTime + FTP_RETRY_INTERVAL;
         }
     }
+
+    if (Influx.run(currentTime)) WiFiSM.recordUpload();
+    MQTT.run();
 }
 
 
@@ -878,6 +966,11 @@ void setup()
     BuiltinLED.begin();
 
     PersistentData.begin();
+
+    // Keep the log sync positions across resets (RTC memory slots)
+    powerLogSyncCursor.begin(0);
+    powerLogInfluxCursor.begin(1);
+
     TimeServer.NTPServer = PersistentData.ntpServer;
     Html.setTitlePrefix(PersistentData.hostName);
 
@@ -930,6 +1023,40 @@ void setup()
 
     WebServer.on("/json", handleHttpJsonRequest);
 
+    if (PersistentData.influxUrl[0] != 0)
+    {
+        if (Influx.begin(PersistentData.influxUrl, PersistentData.influxToken, PersistentData.hostName))
+        {
+            Influx.addSource(powerLogInfluxCursor, writeInfluxLines);
+            WiFiSM.logEvent(F("InfluxDB exporter initialized"));
+        }
+        else
+            WiFiSM.logEvent(F("InfluxDB: %s"), Influx.getLastError().c_str());
+    }
+
+    if (PersistentData.mqttBroker[0] != 0)
+    {
+        // Sensor names are not copied
+        static const char* voltageNames[] = { "Voltage L1", "Voltage L2", "Voltage L3" };
+        static const char* currentNames[] = { "Current L1", "Current L2", "Current L3" };
+        static const char* powerNames[] = { "Power L1", "Power L2", "Power L3" };
+        for (int phase = 0; phase < PersistentData.phaseCount; phase++)
+        {
+            mqttVoltage[phase] = MQTT.addSensor(voltageNames[phase], "V", "voltage", 1.0F, 1);
+            mqttCurrent[phase] = MQTT.addSensor(currentNames[phase], "A", "current", 0.5F, 0);
+            mqttPower[phase] = MQTT.addSensor(powerNames[phase], "W", "power", 25.0F, 0);
+        }
+        if (MQTT.begin(
+            PersistentData.mqttBroker,
+            MQTT_DEFAULT_PORT,
+            PersistentData.mqttUser,
+            PersistentData.mqttPassword,
+            PersistentData.hostName))
+            WiFiSM.logEvent(F("MQTT publisher initialized"));
+        else
+            WiFiSM.logEvent(F("Unable to initialize MQTT publisher"));
+    }
+
     WiFiSM.registerStaticFiles(Files, _LastFile);
     WiFiSM.on(WiFiInitState::TimeServerSynced, onTimeServerSynced);
     WiFiSM.on(WiFiInitState::Initialized, onWiFiInitialized);
@@ -1,3 +1,5 @@
+#include <InfluxLineWriter.h>
+
 struct ChargeLogEntry
 {
     time_t time;
@@ -56,4 +58,13 @@ struct ChargeLogEntry
         html.writeCell(temperature);
         html.writeRowEnd();
     }
-};
\ No newline at end of file
+
+    void writeInfluxLine(InfluxLineWriter& output)
+    {
+        output.beginLine("charge");
+        output.addField("currentLimit", currentLimit);
+        output.addField("outputCurrent", outputCurrent);
+        output.addField("temperature", temperature);
+        output.endLine(time);
+    }
+};
@@ -22,28 +22,13 @@ struct Settings : WiFiSettingsWithFTP
     int solarPowerThreshold;
     int solarOnOffDelay;
     char p1BearerToken[36];
+    char influxUrl[96];
+    char influxToken[96];
+    char mqttBroker[32];
+    char mqttUser[32];
+    char mqttPassword[32];
 
-    static constexpr size_t ADDITIONAL_DATA_SIZE =
-        sizeof(tempSensorAddress) +
-        sizeof(currentScale) +
-        sizeof(currentZero) +
-        sizeof(registeredBeaconCount) +
-        sizeof(registeredBeacons);
-
-    Settings() : WiFiSettingsWithFTP("EVSE", ADDITIONAL_DATA_SIZE)
-    {
-        addIntegerField(ftpSyncEntries, "FTP Sync Entries", 0, 200);
-        addStringField(p1Meter, sizeof(p1Meter), "P1 Meter");
-        addStringField(p1BearerToken, sizeof(p1BearerToken), "P1 Auth Token");
-        addIntegerField(evsePhase, "EVSE Phase", 1, 3, 3);
-        addIntegerField(currentLimit, "Current Limit", 6, 25, 16);
-        addTimeSpanField(authorizeTimeout, "Authorize Timeout", 0, 3600, 15 * 60);
-        addIntegerField(tempLimit, "Temperature Limit", 40, 60, 50);
-        addFloatField(tempSensorOffset, "Temperature Offset", 1, -5.0, 5.0);
-        addFloatField(noCurrentThreshold, "No current threshold", 2, 0, 1, 0.5);
-        addIntegerField(solarPowerThreshold, "Solar power threshold", 0, 1000, 100);
-        addTimeSpanField(solarOnOffDelay, "Solar on/off delay", SECONDS_PER_MINUTE, SECONDS_PER_HOUR, SECONDS_PER_HOUR);
-    }
+    Settings();
 
     void initialize() override
     {
@@ -61,4 +46,39 @@ struct Settings : WiFiSettingsWithFTP
     }
 };
 
+PERSISTENT_FIELD_TABLE_BEGIN
+constexpr PersistentDataField SETTINGS_FIELDS[] PROGMEM =
+{
+    PersistentDataField::integerField("FTP Sync Entries", PERSISTENT_FIELD(Settings, ftpSyncEntries), 0, 200),
+    PersistentDataField::stringField("P1 Meter", PERSISTENT_FIELD(Settings, p1Meter)),
+    PersistentDataField::stringField("P1 Auth Token", PERSISTENT_FIELD(Settings, p1BearerToken)),
+    PersistentDataField::integerField("EVSE Phase", PERSISTENT_FIELD(Settings, evsePhase), 1, 3, 3),
+    PersistentDataField::integerField("Current Limit", PERSISTENT_FIELD(Settings, currentLimit), 6, 25, 16),
+    PersistentDataField::timeSpanField("Authorize Timeout", PERSISTENT_FIELD(Settings, authorizeTimeout), 0, 3600, 15 * 60),
+    PersistentDataField::integerField("Temperature Limit", PERSISTENT_FIELD(Settings, tempLimit), 40, 60, 50),
+    PersistentDataField::floatField("Temperature Offset", PERSISTENT_FIELD(Settings, tempSensorOffset), 1, -5.0, 5.0),
+    PersistentDataField::floatField("No current threshold", PERSISTENT_FIELD(Settings, noCurrentThreshold), 2, 0, 1, 0.5),
+    PersistentDataField::integerField("Solar power threshold", PERSISTENT_FIELD(Settings, solarPowerThreshold), 0, 1000, 100),
+    PersistentDataField::timeSpanField("Solar on/off delay", PERSISTENT_FIELD(Settings, solarOnOffDelay), SECONDS_PER_MINUTE, SECONDS_PER_HOUR, SECONDS_PER_HOUR),
+    PersistentDataField::binaryField("Temperature sensor", PERSISTENT_FIELD(Settings, tempSensorAddress)),
+    PersistentDataField::binaryField("Current scale", PERSISTENT_FIELD(Settings, currentScale)),
+    PersistentDataField::binaryField("Current zero", PERSISTENT_FIELD(Settings, currentZero)),
+    PersistentDataField::binaryField("Beacon count", PERSISTENT_FIELD(Settings, registeredBeaconCount)),
+    PersistentDataField::binaryField("Beacons", PERSISTENT_FIELD(Settings, registeredBeacons)),
+    PersistentDataField::stringField("InfluxDB write URL", PERSISTENT_FIELD(Settings, influxUrl)),
+    PersistentDataField::passwordField("InfluxDB token", PERSISTENT_FIELD(Settings, influxToken)),
+    PersistentDataField::stringField("MQTT broker", PERSISTENT_FIELD(Settings, mqttBroker)),
+    PersistentDataField::stringField("MQTT user", PERSISTENT_FIELD(Settings, mqttUser)),
+    PersistentDataField::passwordField("MQTT password", PERSISTENT_FIELD(Settings, mqttPassword))
+};
+// The fields from here on were added after the legacy EEPROM format
+constexpr auto SETTINGS_LEGACY_DATA_END = PERSISTENT_FIELD(Settings, influxUrl);
+PERSISTENT_FIELD_TABLE_END
+
+Settings::Settings() : WiFiSettingsWithFTP("EVSE")
+{
+    addFields(SETTINGS_FIELDS);
+    setLegacyDataEnd(SETTINGS_LEGACY_DATA_END);
+}
+
 Settings PersistentData;
@@ -6,6 +6,9 @@
 #include <WiFiStateMachine.h>
 #include <WiFiNTP.h>
 #include <WiFiFTP.h>
+#include <SyncCursor.h>
+#include <InfluxExporter.h>
+#include <MQTTPublisher.h>
 #include <Ticker.h>
 #include <TimeUtils.h>
 #include <Tracer.h>
@@ -29,6 +32,7 @@
 #include "ChargeStatsEntry.h"
 
 constexpr int FTP_RETRY_INTERVAL = 15 * SECONDS_PER_MINUTE;
+constexpr int INFLUX_FLUSH_INTERVAL = 5 * SECONDS_PER_MINUTE;
 constexpr int HTTP_POLL_INTERVAL = 60;
 constexpr int TEMP_POLL_INTERVAL = 10;
 constexpr int AUTO_RESUME_INTERVAL = 5 * SECONDS_PER_MINUTE;
@@ -108,6 +112,8 @@ const char* ActionClass = "action";
 ESPWebServer WebServer(80); // Default HTTP port
 WiFiNTP TimeServer;
 WiFiFTPClient FTPClient(2000); // 2s timeout
+InfluxExporter Influx(2000, INFLUX_FLUSH_INTERVAL); // 2s timeout
+MQTTPublisher MQTT(2000); // 2s timeout
 BLE Bluetooth;
 StringBuilder HttpResponse(8192); // 8KB HTTP response buffer
 HtmlWriter Html(HttpResponse, Files[Logo], Files[Styles], 60);
@@ -136,6 +142,7 @@ bool isRelayActivated = false;
 bool isWebAuthorized = false;
 bool isMeasuringTemp = false;
 bool ftpSyncChargeStats = false;
+bool wasWiFiConnected = false;
 
 time_t currentTime = 0;
 time_t stateChangeTime = 0;
@@ -150,6 +157,13 @@ time_t autoResumeTime = 0;
 int logEntriesToSync = 0;
 ChargeLogEntry newChargeLogEntry;
 ChargeLogEntry* lastChargeLogEntryPtr = nullptr;
+SyncCursor chargeLogInfluxCursor(CHARGE_LOG_SIZE);
+
+// MQTT sensor indices
+int mqttState;
+int mqttCurrentLimit;
+int mqttOutputCurrent;
+int mqttTemperature;
 ChargeStatsEntry* lastChargeStatsPtr = nullptr;
 
 char* minChargeTimeOptions[MIN_CHARGE_TIME_OPTIONS];
@@ -333,7 +347,8 @@ float determineCurrentLimit(bool awaitSmartMeter)
 
     if (!WiFiSM.isConnected()) return result;
 
-    if (awaitSmartMeter)
+    // Use the pushed measurement if it is recent and no poll is pending; else (finish the) poll.
+    if (awaitSmartMeter && (SmartMeter.isResponsePending() || !SmartMeter.usePushedMeasurement()))
     {
         if (SmartMeter.awaitData() != HTTP_CODE_OK)
         {
@@ -342,7 +357,7 @@ float determineCurrentLimit(bool awaitSmartMeter)
         }
     }
 
-    PhaseData& phase = SmartMeter.electricity[PersistentData.evsePhase - 1];
+    PhaseData& phase = SmartMeter.measurement[PersistentData.evsePhase - 1];
     outputVoltage = phase.Voltage; 
     float phaseCurrent = phase.Power / phase.Voltage; 
     if (state == EVSEState::Charging) 
@@ -504,6 +519,7 @@ void chargeControl()
         if (lastChargeLogEntryPtr == nullptr || !newChargeLogEntry.equals(lastChargeLogEntryPtr))
         {
             lastChargeLogEntryPtr = ChargeLog.add(&newChargeLogEntry);
+            chargeLogInfluxCursor.add();
 
             logEntriesToSync = std::min(logEntriesToSync + 1, CHARGE_LOG_SIZE);
             if (PersistentData.isFTPEnabled() && (logEntriesToSync == PersistentData.ftpSyncEntries))
@@ -674,9 +690,14 @@ void runEVSEStateMachine()
                 setUnexpectedControlPilotStatus();
             else if ((autoResumeTime != 0) && (currentTime >= chargeControlTime) && WiFiSM.isConnected())
             {
-                int httpResult = SmartMeter.batteries.isInitialized() 
-                    ? SmartMeter.requestData("batteries")
-                    : SmartMeter.requestData();
+                // Use the pushed measurement if it is recent; else poll. Battery info is not pushed.
+                int httpResult;
+                if (SmartMeter.batteries.isInitialized())
+                    httpResult = SmartMeter.requestData("batteries");
+                else if (!SmartMeter.isResponsePending() && SmartMeter.usePushedMeasurement())
+                    httpResult = HTTP_OK;
+                else
+                    httpResult = SmartMeter.requestData();
                 if (httpResult != HTTP_REQUEST_PENDING)
                 {
                     if (httpResult == HTTP_OK)
@@ -685,7 +706,7 @@ void runEVSEStateMachine()
                             solarPower = std::max(SmartMeter.batteries.targetPower, 0);
                         else
                         {
-                            PhaseData& phaseData = SmartMeter.electricity[PersistentData.evsePhase - 1];
+                            PhaseData& phaseData = SmartMeter.measurement[PersistentData.evsePhase - 1];
                             solarPower = std::max(-phaseData.Power, 0.0F);
                         }
 
@@ -837,6 +858,26 @@ void test(String message)
 }
 
 
+void publishMQTTValues()
+{
+    MQTT.setValue(mqttState, EVSEStateNames[state]);
+    MQTT.setValue(mqttCurrentLimit, currentLimit);
+    MQTT.setValue(mqttOutputCurrent, outputCurrent);
+    MQTT.setValue(mqttTemperature, temperature);
+}
+
+
+uint16_t writeInfluxLines(InfluxLineWriter& output, uint16_t unsentEntries, uint16_t maxEntries)
+{
+    // The charge log is cleared when a new charging session starts; skip unsent entries which were cleared.
+    uint16_t clearedEntries = (unsentEntries > ChargeLog.count()) ? unsentEntries - ChargeLog.count() : 0;
+    uint16_t entries = std::min(clearedEntries, maxEntries);
+    for (auto i = ChargeLog.at(-unsentEntries); (i != ChargeLog.end()) && (entries < maxEntries); ++i, ++entries)
+        i->writeInfluxLine(output);
+    return entries;
+}
+
+
 bool trySyncFTP(Print* printTo)
 {
     Tracer tracer(F(__func__));
@@ -972,8 +1013,21 @@ void onWiFiInitialized()
         }
     }
 
-    if (SmartMeter.isInitialized && !WiFiSM.isConnected())
+    if (WiFiSM.isConnected())
+    {
+        Influx.run(currentTime);
+        if (MQTT.isEnabled())
+        {
+            publishMQTTValues();
+            MQTT.run();
+        }
+    }
+
+    // Release the TLS client once when the connection is lost
+    bool isWiFiConnected = WiFiSM.isConnected();
+    if (SmartMeter.isInitialized && wasWiFiConnected && !isWiFiConnected)
         SmartMeter.resetTLS();
+    wasWiFiConnected = isWiFiConnected;
 }
 
 
@@ -1219,6 +1273,21 @@ void handleHttpSmartMeterRequest()
         if (dsmrResult == HTTP_CODE_OK)
         {
             Html.writeParagraph("Received response in %d ms.", SmartMeter.getResponseTimeMs());
+            Html.writeParagraph("Measured at %s.", formatTime("%H:%M:%S", SmartMeter.measurement.timestamp));
+            Html.writeParagraph(
+                "Push: %s. Measurements: %u. Connects: %u.",
+                SmartMeter.isPushSubscribed() ? "subscribed" : "not subscribed",
+                SmartMeter.getPushCount(),
+                SmartMeter.getPushConnectCount());
+            const RESTClientStats& stats = SmartMeter.getStats();
+            Html.writeParagraph(
+                "Connects: %u (avg %u ms, max %u ms). Reused: %u. Reconnects: %u. Idle disconnects: %u.",
+                stats.connects,
+                stats.getAvgConnectMs(),
+                stats.maxConnectMs,
+                stats.reusedConnections,
+                stats.reconnects,
+                stats.idleDisconnects);
 
             Html.writeTableStart();
             Html.writeRowStart();
@@ -1227,7 +1296,7 @@ void handleHttpSmartMeterRequest()
             Html.writeHeaderCell("Current");
             Html.writeHeaderCell("Power");
             Html.writeRowEnd();
-            for (PhaseData& phaseData : SmartMeter.electricity)
+            for (PhaseData& phaseData : SmartMeter.measurement)
             {
                 Html.writeRowStart();
                 Html.writeCell(phaseData.Name);
@@ -1249,10 +1318,10 @@ void handleHttpSmartMeterRequest()
                 Html.writeTableEnd();
             }
 
-            PhaseData& monitoredPhaseData = SmartMeter.electricity[PersistentData.evsePhase - 1];
+            PhaseData& monitoredPhaseData = SmartMeter.measurement[PersistentData.evsePhase - 1];
             Html.writeParagraph(
                 "Phase '%s' current: %0.1f A",
-                monitoredPhaseData.Name.c_str(),
+                monitoredPhaseData.Name,
                 monitoredPhaseData.Power / monitoredPhaseData.Voltage);
         }
         else
@@ -1378,7 +1447,10 @@ void handleHttpConfigFormRequest()
         {
             String bearerToken = SmartMeter.getBearerToken(PersistentData.hostName);
             if (bearerToken.length() > 0)
+            {
                 strncpy(PersistentData.p1BearerToken, bearerToken.c_str(), sizeof(PersistentData.p1BearerToken));
+                SmartMeter.beginPush(PersistentData.p1BearerToken);
+            }
             else
                 Html.writeParagraph(
                     "Unable to retrieve P1 Token: %s",
@@ -1642,6 +1714,37 @@ void handleHttpRootRequest()
     Html.writeRow(L10N("FTP Sync"), ftpSync);
     if (PersistentData.isFTPEnabled())
         Html.writeRow(L10N("Sync entries"), "%d / %d", logEntriesToSync, PersistentData.ftpSyncEntries);
+    if (Influx.isEnabled())
+    {
+        const InfluxExporterStats& influxStats = Influx.getStats();
+        Html.writeRow(
+            "InfluxDB",
+            "%u lines, %0.0f lines/s, batch %u",
+            influxStats.lines,
+            influxStats.getLinesPerSecond(),
+            Influx.getBatchSize());
+        Html.writeRow(
+            "InfluxDB lag",
+            "%u entries (%s)",
+            chargeLogInfluxCursor.getLag(),
+            Influx.getCircuitBreaker().getStateLabel());
+    }
+    if (MQTT.isEnabled())
+    {
+        const MQTTPublisherStats& mqttStats = MQTT.getStats();
+        Html.writeRow(
+            "MQTT",
+            "%s, %u msg, %0.2f msg/s",
+            MQTT.getStateLabel(),
+            mqttStats.published,
+            MQTT.getMessagesPerSecond());
+        Html.writeRow(
+            "MQTT queue",
+            "%u (max %u), %u dropped",
+            MQTT.getQueueLength(),
+            mqttStats.queueHighWater,
+            mqttStats.dropped);
+    }
     Html.writeTableEnd();
     Html.writeSectionEnd();
     
@@ -1742,6 +1845,36 @@ void setup()
 
     WebServer.on("/bt/json", handleHttpBluetoothJsonRequest);
     WebServer.on("/current", handleHttpCurrentRequest);
+
+    // Keep the InfluxDB export position across resets (RTC memory slot)
+    chargeLogInfluxCursor.begin(0);
+    if (PersistentData.influxUrl[0] != 0)
+    {
+        if (Influx.begin(PersistentData.influxUrl, PersistentData.influxToken, PersistentData.hostName))
+        {
+            Influx.addSource(chargeLogInfluxCursor, writeInfluxLines);
+            WiFiSM.logEvent("InfluxDB exporter initialized");
+        }
+        else
+            WiFiSM.logEvent("InfluxDB: %s", Influx.getLastError().c_str());
+    }
+
+    if (PersistentData.mqttBroker[0] != 0)
+    {
+        mqttState = MQTT.addSensor("EVSE state");
+        mqttCurrentLimit = MQTT.addSensor("Current limit", "A", "current", 0.5F);
+        mqttOutputCurrent = MQTT.addSensor("Output current", "A", "current", 0.2F);
+        mqttTemperature = MQTT.addSensor("Temperature", "°C", "temperature", 0.5F);
+        if (MQTT.begin(
+            PersistentData.mqttBroker,
+            MQTT_DEFAULT_PORT,
+            PersistentData.mqttUser,
+            PersistentData.mqttPassword,
+            PersistentData.hostName))
+            WiFiSM.logEvent("MQTT publisher initialized");
+        else
+            WiFiSM.logEvent("Unable to initialize MQTT publisher");
+    }
     
     WiFiSM.registerStaticFiles(Files, _LastFileId);
     WiFiSM.on(WiFiInitState::TimeServerSynced, onWiFiTimeSynced);
@@ -1770,7 +1903,11 @@ void setup()
     if (PersistentData.p1Meter[0] != 0)
     {
         if (SmartMeter.begin(PersistentData.p1Meter))
+        {
             SmartMeter.setBearerToken(PersistentData.p1BearerToken);
+            if ((PersistentData.p1BearerToken[0] != 0) && !SmartMeter.beginPush(PersistentData.p1BearerToken))
+                WiFiSM.logEvent("Failed starting Smart Meter push");
+        }
         else
             setFailure("Failed initializing Smart Meter");
     }
@@ -5,10 +5,7 @@ struct Settings : public WiFiSettingsWithFTP
 {
     int ftpSyncEntries;
 
-    Settings() : WiFiSettingsWithFTP(PSTR("EnergyMeter"))
-    {
-        addIntegerField(ftpSyncEntries, "FTP sync entries", 0, POWER_LOG_SIZE);
-    }
+    Settings();
 
     void initialize() override
     {
@@ -21,4 +18,16 @@ struct Settings : public WiFiSettingsWithFTP
     }
 };
 
+PERSISTENT_FIELD_TABLE_BEGIN
+constexpr PersistentDataField SETTINGS_FIELDS[] PROGMEM =
+{
+    PersistentDataField::integerField("FTP sync entries", PERSISTENT_FIELD(Settings, ftpSyncEntries), 0, POWER_LOG_SIZE)
+};
+PERSISTENT_FIELD_TABLE_END
+
+Settings::Settings() : WiFiSettingsWithFTP(PSTR("EnergyMeter"))
+{
+    addFields(SETTINGS_FIELDS);
+}
+
 Settings PersistentData;
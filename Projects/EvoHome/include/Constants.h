@@ -12,6 +12,9 @@ constexpr size_t PAGE_SIZE = 50;
 
 constexpr int FTP_RETRY_INTERVAL = 15 * SECONDS_PER_MINUTE;
 constexpr int FTP_TIMEOUT_MS = 5000;
+constexpr uint16_t INFLUX_TIMEOUT_MS = 2000;
+constexpr uint16_t INFLUX_FLUSH_INTERVAL = 5 * SECONDS_PER_MINUTE;
+constexpr uint16_t MQTT_TIMEOUT_MS = 2000;
 
 #ifdef ARDUINO_LOLIN_D32
 constexpr int8_t CC1101_CSN_PIN = SS;
@@ -2,6 +2,8 @@
 #include <algorithm>
 #include <Log.h>
 #include <HtmlWriter.h>
+#include <SyncCursor.h>
+#include <InfluxLineWriter.h>
 #include <RAMSES2.h>
 
 constexpr size_t EVOHOME_MAX_ZONES = 8;
@@ -60,6 +62,19 @@ struct ZoneData
         else
             output.printf("%0.1f;", value);
     }
+
+    bool hasValues() const
+    {
+        return (setpoint >= 0) || (override >= 0) || (temperature >= 0) || (heatDemand >= 0);
+    }
+
+    void writeInfluxFields(InfluxLineWriter& output)
+    {
+        if (setpoint >= 0) output.addField("setpoint", setpoint);
+        if (override >= 0) output.addField("override", override);
+        if (temperature >= 0) output.addField("temperature", temperature);
+        if (heatDemand >= 0) output.addField("heatDemand", heatDemand, 0);
+    }
 };
 
 struct ZoneDataLogEntry
@@ -286,8 +301,9 @@ class EvoHomeInfo
         uint8_t zoneCount = 0;
         size_t zoneDataLogEntriesToSync = 0;
         StaticLog<ZoneDataLogEntry> zoneDataLog;
+        SyncCursor zoneDataLogInfluxCursor;
 
-        EvoHomeInfo() : zoneDataLog(EVOHOME_LOG_SIZE)
+        EvoHomeInfo() : zoneDataLog(EVOHOME_LOG_SIZE), zoneDataLogInfluxCursor(EVOHOME_LOG_SIZE)
         {}
 
         void processPacket(const RAMSES2Packet* packetPtr)
@@ -343,6 +359,7 @@ class EvoHomeInfo
                 _currentLogEntry.time = packetPtr->timestamp;
                 _lastLogEntryPtr = zoneDataLog.add(&_currentLogEntry);
                 zoneDataLogEntriesToSync = std::min(zoneDataLogEntriesToSync + 1, EVOHOME_LOG_SIZE);
+                zoneDataLogInfluxCursor.add();
             }
         }
 
@@ -428,6 +445,31 @@ class EvoHomeInfo
             return true;
         }
 
+        // Writes a line per zone (tagged with the zone name) and a line for the boiler.
+        uint16_t writeInfluxLines(InfluxLineWriter& output, uint16_t unsentEntries, uint16_t maxEntries)
+        {
+            uint16_t entries = 0;
+            for (auto i = zoneDataLog.at(-unsentEntries); (i != zoneDataLog.end()) && (entries < maxEntries); ++i, ++entries)
+            {
+                for (int zoneId = 0; zoneId < zoneCount; zoneId++)
+                {
+                    ZoneData& zoneData = i->zones[zoneId];
+                    if (!zoneData.hasValues()) continue;
+                    output.beginLine("zone");
+                    output.addTag("zone", getZoneInfo(zoneId)->name.c_str());
+                    zoneData.writeInfluxFields(output);
+                    output.endLine(i->time);
+                }
+                if (i->boilerHeatDemand >= 0)
+                {
+                    output.beginLine("boiler");
+                    output.addField("heatDemand", i->boilerHeatDemand);
+                    output.endLine(i->time);
+                }
+            }
+            return entries;
+        }
+
         ZoneInfo* getZoneInfo(uint8_t domainId)
         {
             ZoneInfo* result;
@@ -6,14 +6,36 @@ struct Settings : public WiFiSettingsWithFTP
     bool ftpSyncPacketLog;
     int maxHeaderBitErrors;
     int maxManchesterBitErrors;
+    char influxUrl[96];
+    char influxToken[96];
+    char mqttBroker[32];
+    char mqttUser[32];
+    char mqttPassword[32];
 
-    Settings() : WiFiSettingsWithFTP("EvoHome")
-    {
-        addIntegerField(ftpSyncEntries, "FTP sync entries", 0, RAMSES_PACKET_LOG_SIZE);
-        addBooleanField(ftpSyncPacketLog, "FTP sync Packet Log", false, 4);
-        addIntegerField(maxHeaderBitErrors, "Max header bit errors", 0, 5, 0);
-        addIntegerField(maxManchesterBitErrors, "Max manchester bit errors", 0, 10, 1);
-    }
+    Settings();
 };
 
+PERSISTENT_FIELD_TABLE_BEGIN
+constexpr PersistentDataField SETTINGS_FIELDS[] PROGMEM =
+{
+    PersistentDataField::integerField("FTP sync entries", PERSISTENT_FIELD(Settings, ftpSyncEntries), 0, RAMSES_PACKET_LOG_SIZE),
+    PersistentDataField::booleanField("FTP sync Packet Log", PERSISTENT_FIELD(Settings, ftpSyncPacketLog), false),
+    PersistentDataField::integerField("Max header bit errors", PERSISTENT_FIELD(Settings, maxHeaderBitErrors), 0, 5, 0),
+    PersistentDataField::integerField("Max manchester bit errors", PERSISTENT_FIELD(Settings, maxManchesterBitErrors), 0, 10, 1),
+    PersistentDataField::stringField("InfluxDB write URL", PERSISTENT_FIELD(Settings, influxUrl)),
+    PersistentDataField::passwordField("InfluxDB token", PERSISTENT_FIELD(Settings, influxToken)),
+    PersistentDataField::stringField("MQTT broker", PERSISTENT_FIELD(Settings, mqttBroker)),
+    PersistentDataField::stringField("MQTT user", PERSISTENT_FIELD(Settings, mqttUser)),
+    PersistentDataField::passwordField("MQTT password", PERSISTENT_FIELD(Settings, mqttPassword))
+};
+// The fields from here on were added after the legacy EEPROM format
+constexpr auto SETTINGS_LEGACY_DATA_END = PERSISTENT_FIELD(Settings, influxUrl);
+PERSISTENT_FIELD_TABLE_END
+
+Settings::Settings() : WiFiSettingsWithFTP("EvoHome")
+{
+    addFields(SETTINGS_FIELDS);
+    setLegacyDataEnd(SETTINGS_LEGACY_DATA_END);
+}
+
 Settings PersistentData;
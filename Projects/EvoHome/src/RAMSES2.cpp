@@ -23,13 +23,13 @@ bool RAMSES2::begin(bool startReceive)
 
     if (!_cc1101.begin())
     {
-        _logger.logEvent("CC1101 initialization failed");
+        _logger.logEvent(F("CC1101 initialization failed"));
         return false;
     }
 
     if (!_cc1101.setTxPower(CC1101TxPower::High))
     {
-        _logger.logEvent("Unable to set CC1101 Tx power");
+        _logger.logEvent(F("Unable to set CC1101 Tx power"));
         return false;
     }
 
@@ -48,7 +48,7 @@ bool RAMSES2::begin(bool startReceive)
 
     if (res != pdPASS)
     {
-        _logger.logEvent("RAMSES2: xTaskCreate returned %d\n", res);
+        _logger.logEvent(F("RAMSES2: xTaskCreate returned %d"), res);
         return false;
     }
 
@@ -119,7 +119,7 @@ bool RAMSES2::sendPacket(const RAMSES2Packet& packet)
         _switchToIdle = true; // Signal worker thread
         if (!_cc1101.awaitMode(CC1101Mode::Idle, 100))
         {
-            _logger.logEvent("Timeout waiting for CC1101 idle");
+            _logger.logEvent(F("Timeout waiting for CC1101 idle"));
             return false;
         }
     }
@@ -136,7 +136,7 @@ bool RAMSES2::sendPacket(const RAMSES2Packet& packet)
 
     if (!_cc1101.setMode(CC1101Mode::Idle))
     {
-        _logger.logEvent("Unable to set CC1101 to idle");
+        _logger.logEvent(F("Unable to set CC1101 to idle"));
         return false;
     }
 
@@ -154,7 +154,7 @@ bool RAMSES2::sendFrame(size_t size)
 
     if (!_cc1101.writeRegister(CC1101Register::PKTLEN, size))
     {
-        _logger.logEvent("Error setting PKTLEN");
+        _logger.logEvent(F("Error setting PKTLEN"));
         return false;
     }
 
@@ -164,13 +164,13 @@ bool RAMSES2::sendFrame(size_t size)
     TRACE("writeFIFO:%d\n", bytesWritten);
     if (bytesWritten <= 0)
     {
-        _logger.logEvent("Error writing to CC1101 FIFO: %d", bytesWritten);
+        _logger.logEvent(F("Error writing to CC1101 FIFO: %d"), bytesWritten);
         return false;
     }
 
     if (!_cc1101.setMode(CC1101Mode::Transmit))
     {
-        _logger.logEvent("Unable to set CC1101 in transmit mode");
+        _logger.logEvent(F("Unable to set CC1101 in transmit mode"));
         return false;
     }
 
@@ -181,7 +181,7 @@ bool RAMSES2::sendFrame(size_t size)
         bytesWritten = _cc1101.writeFIFO(_sendBuffer + i, size - i);
         if (bytesWritten < 0)
         {
-            _logger.logEvent("Error writing to CC1101 FIFO: %d", bytesWritten);
+            _logger.logEvent(F("Error writing to CC1101 FIFO: %d"), bytesWritten);
             return false;
         }
         i += bytesWritten;
@@ -200,7 +200,7 @@ bool RAMSES2::sendFrame(size_t size)
         delay(delayMs);
     }
     if (timeout)
-        _logger.logEvent("Timeout waiting for transmit");
+        _logger.logEvent(F("Timeout waiting for transmit"));
 
     return !timeout;
 }
@@ -271,7 +271,7 @@ void RAMSES2::resetFrame(bool success)
     {
         _switchToIdle = false;
         if (!_cc1101.setMode(CC1101Mode::Idle))
-            _logger.logEvent("Unable to set CC1101 to idle");
+            _logger.logEvent(F("Unable to set CC1101 to idle"));
         return;
     }
 }
@@ -344,7 +344,7 @@ void RAMSES2::doWork()
                 _switchToReceiveMillis = 0;
                 _frameIndex = -sizeof(_frameHeader);
                 if (!_cc1101.setMode(CC1101Mode::Receive))
-                    _logger.logEvent("Unable to set CC1101 in receive mode");
+                    _logger.logEvent(F("Unable to set CC1101 in receive mode"));
             }
             break;
 
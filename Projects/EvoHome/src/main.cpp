@@ -5,6 +5,8 @@
 #include <ESPFileSystem.h>
 #include <WiFiNTP.h>
 #include <WiFiFTP.h>
+#include <InfluxExporter.h>
+#include <MQTTPublisher.h>
 #include <TimeUtils.h>
 #include <Tracer.h>
 #include <StringBuilder.h>
@@ -55,9 +57,11 @@ SimpleLED BuiltinLED(LED_BUILTIN);
 ESPWebServer WebServer(80); // Default HTTP port
 WiFiNTP TimeServer;
 WiFiFTPClient FTPClient(FTP_TIMEOUT_MS);
+InfluxExporter Influx(INFLUX_TIMEOUT_MS, INFLUX_FLUSH_INTERVAL);
+MQTTPublisher MQTT(MQTT_TIMEOUT_MS);
 StringBuilder HttpResponse(8 * 1024); // 8 kB HTTP response buffer (we use chunked responses)
 HtmlWriter Html(HttpResponse, Files[Logo], Files[Styles]);
-StringLog EventLog(MAX_EVENT_LOG_SIZE, 96);
+StructuredEventLog EventLog(MAX_EVENT_LOG_SIZE);
 WiFiStateMachine WiFiSM(BuiltinLED, TimeServer, WebServer, EventLog);
 Navigation Nav;
 CC1101 Radio(HSPI, CC1101_SCK_PIN, CC1101_MISO_PIN, CC1101_MOSI_PIN, CC1101_CSN_PIN, CC1101_GDO2_PIN, CC1101_GDO0_PIN);
@@ -77,6 +81,8 @@ time_t lastPacketReceivedTime = 0;
 time_t syncFTPTime = 0;
 time_t lastFTPSyncTime = 0;
 
+int mqttZoneTemperature[EVOHOME_MAX_ZONES]; // MQTT sensor indices; -1 if not added yet
+
 
 void onPacketReceived(const RAMSES2Packet* packetPtr)
 {
@@ -85,7 +91,7 @@ void onPacketReceived(const RAMSES2Packet* packetPtr)
     {
         PacketStats.resetRSSI();
         EvoHome.resetZoneStatistics(currentTime);
-        WiFiSM.logEvent("Reset stats");
+        WiFiSM.logEvent(F("Reset stats"));
     }
     lastPacketReceivedTime = currentTime;
 
@@ -159,7 +165,21 @@ void onTimeServerSynced()
     RAMSES.maxHeaderBitErrors = PersistentData.maxHeaderBitErrors;
     RAMSES.maxManchesterBitErrors = PersistentData.maxManchesterBitErrors;
     if (RAMSES.begin(true))
-        WiFiSM.logEvent("RAMSES2 initialized");
+        WiFiSM.logEvent(F("RAMSES2 initialized"));
+}
+
+
+void publishMQTTValues()
+{
+    // Zones are discovered from the received packets, so their sensors are added once they report a temperature.
+    for (int zoneId = 0; zoneId < EvoHome.zoneCount; zoneId++)
+    {
+        ZoneInfo* zoneInfoPtr = EvoHome.getZoneInfo(zoneId);
+        if (zoneInfoPtr->current.temperature < 0) continue;
+        if (mqttZoneTemperature[zoneId] < 0)
+            mqttZoneTemperature[zoneId] = MQTT.addSensor(zoneInfoPtr->name.c_str(), "°C", "temperature", 0.1F, 1);
+        MQTT.setValue(mqttZoneTemperature[zoneId], zoneInfoPtr->current.temperature);
+    }
 }
 
 
@@ -178,17 +198,26 @@ void onWiFiInitialized()
         {
             if (FTPClient.isAsyncSuccess())
             {
-                WiFiSM.logEvent("FTP sync");
+                WiFiSM.logEvent(F("FTP sync"));
                 lastFTPSyncTime = currentTime;
             }
             else
             {
-                WiFiSM.logEvent("FTP sync failed: %s", FTPClient.getLastError());
+                WiFiSM.logEvent(F("FTP sync failed: %s"), FTPClient.getLastError());
                 syncFTPTime = currentTime + FTP_RETRY_INTERVAL;
             }
             FTPClient.endAsync();
         }
     }
+
+    Influx.run(currentTime);
+
+    if (MQTT.isEnabled())
+    {
+        // Packets are received on another task, so values are published from here.
+        publishMQTTValues();
+        MQTT.run();
+    }
 }
 
 
@@ -225,11 +254,15 @@ void handleHttpEventLogRequest()
     if (WiFiSM.shouldPerformAction("clear"))
     {
         EventLog.clear();
-        WiFiSM.logEvent("Event log cleared.");
+        WiFiSM.logEvent(F("Event log cleared."));
     }
 
-    for (const char* event : EventLog)
-        Html.writeDiv("%s", event);
+    char eventText[128];
+    for (const StructuredEvent& event : EventLog)
+    {
+        event.toString(eventText, sizeof(eventText));
+        Html.writeDiv("%s", eventText);
+    }
 
     Html.writeActionLink("clear", "Clear event log", currentTime, ButtonClass);
 
@@ -635,6 +668,37 @@ void handleHttpRootRequest()
         "Sync Entries", "%d / %d",
         std::max(packetLogEntriesToSync, EvoHome.zoneDataLogEntriesToSync),
         PersistentData.ftpSyncEntries);
+    if (Influx.isEnabled())
+    {
+        const InfluxExporterStats& influxStats = Influx.getStats();
+        Html.writeRow(
+            "InfluxDB",
+            "%u lines, %0.0f lines/s, batch %u",
+            influxStats.lines,
+            influxStats.getLinesPerSecond(),
+            Influx.getBatchSize());
+        Html.writeRow(
+            "InfluxDB lag",
+            "%u entries (%s)",
+            EvoHome.zoneDataLogInfluxCursor.getLag(),
+            Influx.getCircuitBreaker().getStateLabel());
+    }
+    if (MQTT.isEnabled())
+    {
+        const MQTTPublisherStats& mqttStats = MQTT.getStats();
+        Html.writeRow(
+            "MQTT",
+            "%s, %u msg, %0.2f msg/s",
+            MQTT.getStateLabel(),
+            mqttStats.published,
+            MQTT.getMessagesPerSecond());
+        Html.writeRow(
+            "MQTT queue",
+            "%u (max %u), %u dropped",
+            MQTT.getQueueLength(),
+            mqttStats.queueHighWater,
+            mqttStats.dropped);
+    }
     Html.writeTableEnd();
     Html.writeSectionEnd();
 
@@ -815,7 +879,7 @@ void setup()
 
     BuiltinLED.begin();
 
-    PersistentData.begin();
+    PersistentData.begin(PersistentStorage::NVS);
     TimeServer.begin(PersistentData.ntpServer);
     Html.setTitlePrefix(PersistentData.hostName);
     
@@ -891,6 +955,38 @@ void setup()
     WebServer.on("/packets/json", handleHttpPacketLogJsonRequest);
     WebServer.on("/json", handleHttpZoneInfoJsonRequest);
 
+    // Keep the InfluxDB export position across resets (RTC memory slot)
+    EvoHome.zoneDataLogInfluxCursor.begin(0);
+    if (PersistentData.influxUrl[0] != 0)
+    {
+        if (Influx.begin(PersistentData.influxUrl, PersistentData.influxToken, PersistentData.hostName))
+        {
+            Influx.addSource(
+                EvoHome.zoneDataLogInfluxCursor,
+                [](InfluxLineWriter& output, uint16_t unsentEntries, uint16_t maxEntries)
+                {
+                    return EvoHome.writeInfluxLines(output, unsentEntries, maxEntries);
+                });
+            WiFiSM.logEvent(F("InfluxDB exporter initialized"));
+        }
+        else
+            WiFiSM.logEvent(F("InfluxDB: %s"), Influx.getLastError().c_str());
+    }
+
+    if (PersistentData.mqttBroker[0] != 0)
+    {
+        std::fill(std::begin(mqttZoneTemperature), std::end(mqttZoneTemperature), -1);
+        if (MQTT.begin(
+            PersistentData.mqttBroker,
+            MQTT_DEFAULT_PORT,
+            PersistentData.mqttUser,
+            PersistentData.mqttPassword,
+            PersistentData.hostName))
+            WiFiSM.logEvent(F("MQTT publisher initialized"));
+        else
+            WiFiSM.logEvent(F("Unable to initialize MQTT publisher"));
+    }
+
     WiFiSM.registerStaticFiles(Files, _LastFile);
     WiFiSM.on(WiFiInitState::TimeServerSynced, onTimeServerSynced);
     WiFiSM.on(WiFiInitState::Initialized, onWiFiInitialized);
@@ -1,3 +1,5 @@
+#include <InfluxLineWriter.h>
+
 #define NUMBER_OF_TOPICS 7
 
 enum TopicId
@@ -50,6 +52,8 @@ struct HeatLogEntry
             topicStats[i].update(topicValues[i]);
         }
     }
+
+    void writeInfluxLine(InfluxLineWriter& output);
 };
 
 
@@ -90,4 +94,24 @@ MonitoredTopic MonitoredTopics[] =
     { TopicId::FlowRate, "Flow", "Flow rate", "l/min", "flow", 1, 0, 15 },
     { TopicId::POut, "Pout", "P<sub>out</sub>", "kW", "power", 1, 0, 10 },
     { TopicId::PIn, "Pin", "P<sub>in</sub>", "kW", "pIn", 2, 0, 4 },
-};
\ No newline at end of file
+};
+
+
+void HeatLogEntry::writeInfluxLine(InfluxLineWriter& output)
+{
+    if (count == 0) return;
+
+    char key[16];
+    output.beginLine("heat");
+    for (int i = 0; i < NUMBER_OF_TOPICS; i++)
+    {
+        const MonitoredTopic& topic = MonitoredTopics[i];
+        output.addField(topic.label, getAverage(topic.id), topic.decimals);
+        snprintf(key, sizeof(key), "%sMin", topic.label);
+        output.addField(key, topicStats[i].min, topic.decimals);
+        snprintf(key, sizeof(key), "%sMax", topic.label);
+        output.addField(key, topicStats[i].max, topic.decimals);
+    }
+    output.addField("valveSeconds", static_cast<int>(valveActivatedSeconds));
+    output.endLine(time);
+}
@@ -7,15 +7,12 @@ struct Settings : WiFiSettingsWithFTP
     float tBufferMaxDelta;
     DeviceAddress tempSensorAddress[3];
     float tempSensorOffset[3];
+    char influxUrl[96];
+    char influxToken[96];
 
     bool isBufferEnabled() { return tBufferMax != 0; }
 
-    Settings()
-        : WiFiSettingsWithFTP(PSTR("HeatMon"), sizeof(tempSensorAddress) + sizeof(tempSensorOffset))
-    {
-        addFloatField(tBufferMax, PSTR("T<sub>buffer, max</sub>"), 1, 0, 90, 0);
-        addFloatField(tBufferMaxDelta, PSTR("T<sub>buffer, delta</sub>"), 1, 1, 10, 5);
-    }
+    Settings();
 
     void initialize() override
     {
@@ -33,4 +30,24 @@ struct Settings : WiFiSettingsWithFTP
     }
 };
 
+PERSISTENT_FIELD_TABLE_BEGIN
+constexpr PersistentDataField SETTINGS_FIELDS[] PROGMEM =
+{
+    PersistentDataField::floatField("T<sub>buffer, max</sub>", PERSISTENT_FIELD(Settings, tBufferMax), 1, 0, 90, 0),
+    PersistentDataField::floatField("T<sub>buffer, delta</sub>", PERSISTENT_FIELD(Settings, tBufferMaxDelta), 1, 1, 10, 5),
+    PersistentDataField::binaryField("Temperature sensors", PERSISTENT_FIELD(Settings, tempSensorAddress)),
+    PersistentDataField::binaryField("Temperature offsets", PERSISTENT_FIELD(Settings, tempSensorOffset)),
+    PersistentDataField::stringField("InfluxDB write URL", PERSISTENT_FIELD(Settings, influxUrl)),
+    PersistentDataField::passwordField("InfluxDB token", PERSISTENT_FIELD(Settings, influxToken))
+};
+// The fields from here on were added after the legacy EEPROM format
+constexpr auto SETTINGS_LEGACY_DATA_END = PERSISTENT_FIELD(Settings, influxUrl);
+PERSISTENT_FIELD_TABLE_END
+
+Settings::Settings() : WiFiSettingsWithFTP(PSTR("HeatMon"))
+{
+    addFields(SETTINGS_FIELDS);
+    setLegacyDataEnd(SETTINGS_LEGACY_DATA_END);
+}
+
 Settings PersistentData;
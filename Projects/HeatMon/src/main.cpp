@@ -5,6 +5,8 @@
 #include <WiFiStateMachine.h>
 #include <WiFiNTP.h>
 #include <WiFiFTP.h>
+#include <SyncCursor.h>
+#include <InfluxExporter.h>
 #include <TimeUtils.h>
 #include <Tracer.h>
 #include <StringBuilder.h>
@@ -12,6 +14,8 @@
 #include <Navigation.h>
 #include <LED.h>
 #include <Log.h>
+#include <MemoryPlanner.h>
+#include <TimerWheel.h>
 #include <FlowSensor.h>
 #include <EnergyMeter.h>
 #include <OneWire.h>
@@ -26,7 +30,13 @@ constexpr uint16_t HTTP_RESPONSE_BUFFER_SIZE = 8 * 1024;
 constexpr int EVENT_LOG_LENGTH = 50;
 constexpr int FTP_TIMEOUT_MS = 2000;
 constexpr uint32_t FTP_RETRY_INTERVAL = 15 * SECONDS_PER_MINUTE;
+constexpr uint32_t FTP_AWAIT_CONNECTION_MS = 10 * 1000;
+constexpr uint32_t SAMPLE_INTERVAL_MS = 1000;
 constexpr uint32_t HEAT_LOG_INTERVAL = 30 * SECONDS_PER_MINUTE;
+constexpr uint16_t HEAT_LOG_SIZE = 24 * 2; // 24 hrs
+constexpr int INFLUX_TIMEOUT_MS = 2000;
+constexpr int INFLUX_FLUSH_INTERVAL = 5 * SECONDS_PER_MINUTE;
+constexpr uint32_t INFLUX_RUN_INTERVAL_MS = 10 * 1000;
 constexpr float DS18_INIT_VALUE_C = 85.0;
 
 constexpr uint8_t MAX_TEMP_VALVE_PIN = D8;
@@ -63,14 +73,17 @@ const char* Files[] PROGMEM =
 ESPWebServer WebServer(80); // Default HTTP port
 WiFiNTP TimeServer;
 WiFiFTPClient FTPClient(FTP_TIMEOUT_MS);
+InfluxExporter Influx(INFLUX_TIMEOUT_MS, INFLUX_FLUSH_INTERVAL);
 StringBuilder HttpResponse(HTTP_RESPONSE_BUFFER_SIZE);
 HtmlWriter Html(HttpResponse, Files[Logo], Files[Styles]);
 StringLog EventLog(EVENT_LOG_LENGTH, 96);
-StaticLog<HeatLogEntry> HeatLog(24 * 2); // 24 hrs
+StaticLog<HeatLogEntry> HeatLog(HEAT_LOG_SIZE);
 StaticLog<DayStatsEntry> DayStats(31); // 31 days
 SimpleLED BuiltinLED(LED_BUILTIN, true);
 WiFiStateMachine WiFiSM(BuiltinLED, TimeServer, WebServer, EventLog);
 Navigation Nav;
+MemoryPlanner MemoryPlan;
+TimerWheel Timers;
 
 OneWire OneWireBus(D7);
 DallasTemperature TempSensors(&OneWireBus);
@@ -79,11 +92,13 @@ FlowSensor Flow_Sensor(D6);
 EnergyMeter Energy_Meter(D2);
 
 time_t currentTime = 0;
-time_t heatLogTime = 0;
-time_t syncFTPTime = 0;
+int sampleJob;
+int syncFTPJob;
+uint32_t sampleRemainderMs = 0; // Sample time not accounted for yet (less than a second)
 time_t lastFTPSyncTime = 0;
 
 HeatLogEntry* lastHeatLogEntryPtr = nullptr;
+SyncCursor heatLogInfluxCursor(HEAT_LOG_SIZE - 1); // Only completed entries
 DayStatsEntry* lastDayStatsEntryPtr = nullptr;
 
 bool newSensorFound = false;
@@ -194,9 +209,13 @@ void readTempSensors()
 
 void newHeatLogEntry()
 {
+    bool isPreviousCompleted = (lastHeatLogEntryPtr != nullptr);
+
     HeatLogEntry newHeatLogEntry;
     newHeatLogEntry.time = currentTime - (currentTime % HEAT_LOG_INTERVAL);
     lastHeatLogEntryPtr = HeatLog.add(&newHeatLogEntry);
+
+    if (isPreviousCompleted) heatLogInfluxCursor.add();
 }
 
 
@@ -265,6 +284,17 @@ float calcPower(float flowRate, float deltaT)
 }
 
 
+uint16_t writeInfluxLines(InfluxLineWriter& output, uint16_t unsentEntries, uint16_t maxEntries)
+{
+    // The last entry is still being aggregated; the cursor only counts the completed entries before it.
+    uint16_t entries = 0;
+    auto i = HeatLog.at(-(unsentEntries + 1));
+    for (; (entries < unsentEntries) && (entries < maxEntries); ++i, ++entries)
+        i->writeInfluxLine(output);
+    return entries;
+}
+
+
 void calculateValues()
 {
     if (!testOverrides[TopicId::DeltaT])
@@ -283,30 +313,30 @@ void calculateValues()
 }
 
 
-void updateHeatLog()
+void updateHeatLog(uint32_t elapsedSeconds)
 {
     if (currentTime >= lastHeatLogEntryPtr->time + HEAT_LOG_INTERVAL)
     {
         newHeatLogEntry();
     }
 
-    uint32_t valveSeconds = maxTempValveActivated ? 1 : 0;
+    uint32_t valveSeconds = maxTempValveActivated ? elapsedSeconds : 0;
     lastHeatLogEntryPtr->update(currentValues, valveSeconds);
 }
 
 
-void updateDayStats()
+void updateDayStats(uint32_t elapsedSeconds)
 {
     if (currentTime >= lastDayStatsEntryPtr->time + SECONDS_PER_DAY)
     {
         Energy_Meter.resetEnergy();
         newDayStatsEntry();
         if (PersistentData.isFTPEnabled())
-            syncFTPTime = currentTime;
+            Timers.schedule(syncFTPJob, 0);
     }
 
-    if (maxTempValveActivated) lastDayStatsEntryPtr->valveActivatedSeconds++;
-    lastDayStatsEntryPtr->energyOut += currentValues[TopicId::POut] / 3600;
+    if (maxTempValveActivated) lastDayStatsEntryPtr->valveActivatedSeconds += elapsedSeconds;
+    lastDayStatsEntryPtr->energyOut += currentValues[TopicId::POut] * elapsedSeconds / 3600;
     lastDayStatsEntryPtr->energyIn = Energy_Meter.getEnergy();
 }
 
@@ -426,7 +456,7 @@ void handleHttpFtpSyncRequest()
     if (success)
     {
         Html.writeParagraph(F("Success!"));
-        syncFTPTime = 0; // Cancel scheduled sync (if any)
+        Timers.cancel(syncFTPJob); // Cancel scheduled sync (if any)
     }
     else
         Html.writeParagraph(F("Failed: %s"), FTPClient.getLastError());
@@ -863,6 +893,15 @@ void handleHttpRootRequest()
     Html.writeRow(F("WiFi RSSI"), F("%d dBm"), static_cast<int>(WiFi.RSSI()));
     Html.writeRow(F("Free Heap"), F("%0.1f kB"), float(ESP.getFreeHeap()) / 1024);
     Html.writeRow(F("Uptime"), F("%0.1f days"), float(WiFiSM.getUptime()) / SECONDS_PER_DAY);
+    const WiFiStartupStats& startupStats = WiFiSM.getStartupStats();
+    if (startupStats.firstUploadMillis == 0)
+        Html.writeRow(F("First upload"), F("Not yet"));
+    else
+        Html.writeRow(
+            F("First upload"),
+            F("%0.1f s%s"),
+            float(startupStats.firstUploadMillis) / 1000,
+            startupStats.isFastConnect ? " (fast connect)" : "");
     if (PersistentData.isBufferEnabled())
     {
         Html.writeRow(F("T<sub>buffer,max</sub>"), F("%0.1f °C"), PersistentData.tBufferMax);
@@ -873,6 +912,21 @@ void handleHttpRootRequest()
         Html.writeCellEnd();
         Html.writeRowEnd();
     }
+    if (Influx.isEnabled())
+    {
+        const InfluxExporterStats& influxStats = Influx.getStats();
+        Html.writeRow(
+            F("InfluxDB"),
+            F("%u lines, %0.0f lines/s, batch %u"),
+            influxStats.lines,
+            influxStats.getLinesPerSecond(),
+            Influx.getBatchSize());
+        Html.writeRow(
+            F("InfluxDB lag"),
+            F("%u entries (%s)"),
+            heatLogInfluxCursor.getLag(),
+            Influx.getCircuitBreaker().getStateLabel());
+    }
     Html.writeTableEnd();
     Html.writeSectionEnd();
 
@@ -886,36 +940,56 @@ void handleHttpRootRequest()
 
 void onTimeServerSynced()
 {
-    heatLogTime = currentTime;
     newHeatLogEntry();
     newDayStatsEntry();
+    sampleRemainderMs = 0;
+    Timers.schedule(sampleJob, SAMPLE_INTERVAL_MS);
 }
 
 
-void onWiFiInitialized()
+void onSampleTimer()
 {
-    if (currentTime >= heatLogTime)
+    // The timer wheel skips sample periods if a sample runs late (e.g. during FTP sync),
+    // so the valve time and energy are integrated over the measured time instead of counted per sample.
+    uint32_t elapsedMs = sampleRemainderMs + Timers.getElapsedMs(sampleJob);
+    uint32_t elapsedSeconds = elapsedMs / 1000;
+    sampleRemainderMs = elapsedMs % 1000;
+
+    currentTime = WiFiSM.getCurrentTime();
+    calculateValues();
+    updateHeatLog(elapsedSeconds);
+    updateDayStats(elapsedSeconds);
+}
+
+
+void onSyncFTPTimer()
+{
+    if (!WiFiSM.isConnected())
     {
-        heatLogTime++;
-        calculateValues();
-        updateHeatLog();
-        updateDayStats();
+        Timers.schedule(syncFTPJob, FTP_AWAIT_CONNECTION_MS);
+        return;
     }
 
-    if ((syncFTPTime != 0) && (currentTime >= syncFTPTime) && WiFiSM.isConnected())
+    currentTime = WiFiSM.getCurrentTime();
+    if (trySyncFTP(nullptr))
     {
-        if (trySyncFTP(nullptr))
-        {
-            WiFiSM.logEvent(F("FTP sync"));
-            syncFTPTime = 0;
-        }
-        else
-        {
-            WiFiSM.logEvent(F("FTP sync failed: %s"), FTPClient.getLastError());
-            syncFTPTime += FTP_RETRY_INTERVAL;
-        }
+        WiFiSM.logEvent(F("FTP sync"));
+        WiFiSM.recordUpload();
+    }
+    else
+    {
+        WiFiSM.logEvent(F("FTP sync failed: %s"), FTPClient.getLastError());
+        Timers.schedule(syncFTPJob, FTP_RETRY_INTERVAL * 1000);
     }
+}
+
+
+void onInfluxTimer()
+{
+    if (!WiFiSM.isConnected()) return;
 
+    currentTime = WiFiSM.getCurrentTime();
+    if (Influx.run(currentTime)) WiFiSM.recordUpload();
 }
 
 
@@ -933,6 +1007,12 @@ void setup()
 
     BuiltinLED.begin(); // Turn built-in LED on
 
+    MemoryPlan.add("EventLog", EventLog, EVENT_LOG_LENGTH / 2);
+    MemoryPlan.add("HeatLog", HeatLog);
+    MemoryPlan.add("DayStats", DayStats, 7);
+    MemoryPlan.add("HttpResponse", HttpResponse);
+    MemoryPlan.commit();
+
     PersistentData.begin();
     TimeServer.begin(PersistentData.ntpServer);
     Html.setTitlePrefix(PersistentData.hostName);
@@ -1002,11 +1082,28 @@ void setup()
     WebServer.on("/json", handleHttpJsonRequest);
 
     WiFiSM.registerStaticFiles(Files, _LastFile);    
+    WiFiSM.registerMemoryPlan(MemoryPlan);
+    WiFiSM.registerTimerWheel(Timers);
     WiFiSM.on(WiFiInitState::TimeServerSynced, onTimeServerSynced);
-    WiFiSM.on(WiFiInitState::Initialized, onWiFiInitialized);
     WiFiSM.scanAccessPoints();
     WiFiSM.begin(PersistentData.wifiSSID, PersistentData.wifiKey, PersistentData.hostName);
 
+    // Sampling starts once the time is synchronized
+    sampleJob = Timers.addJob("Sample", onSampleTimer, SAMPLE_INTERVAL_MS);
+    syncFTPJob = Timers.addJob("FTP sync", onSyncFTPTimer);
+
+    if (PersistentData.influxUrl[0] != 0)
+    {
+        if (Influx.begin(PersistentData.influxUrl, PersistentData.influxToken, PersistentData.hostName))
+        {
+            Influx.addSource(heatLogInfluxCursor, writeInfluxLines);
+            Timers.addPeriodic("Influx", INFLUX_RUN_INTERVAL_MS, onInfluxTimer, INFLUX_RUN_INTERVAL_MS);
+            WiFiSM.logEvent(F("InfluxDB exporter initialized"));
+        }
+        else
+            WiFiSM.logEvent(F("InfluxDB: %s"), Influx.getLastError().c_str());
+    }
+
     Flow_Sensor.begin(5.0, 6.6); // 5 sec measure interval, 6.6 Hz @ 1 l/min
     Energy_Meter.begin(100, 1000, 10); // 100 W resolution, 1000 pulses per kWh, max 10 aggregations (=> 6 minutes max)
     TempSensors.begin();
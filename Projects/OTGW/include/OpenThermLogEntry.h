@@ -1,4 +1,5 @@
 #include <OTGW.h>
+#include <InfluxLineWriter.h>
 
 struct OpenThermLogEntry
 {
@@ -64,6 +65,27 @@ struct OpenThermLogEntry
         destination.println();
     }
 
+    void writeInfluxLine(InfluxLineWriter& output)
+    {
+        output.beginLine("opentherm");
+        output.addField("masterStatus", boilerStatus >> 8);
+        output.addField("slaveStatus", boilerStatus & 0xFF);
+        output.addField("maxModulation", OpenThermGateway::getInteger(thermostatMaxRelModulation));
+        output.addField("thermostatTSet", OpenThermGateway::getInteger(thermostatTSet));
+        output.addField("boilerTSet", OpenThermGateway::getInteger(boilerTSet));
+        output.addField("tBoiler", OpenThermGateway::getDecimal(tBoiler));
+        output.addField("tReturn", OpenThermGateway::getDecimal(tReturn));
+        output.addField("tBuffer", OpenThermGateway::getDecimal(tBuffer));
+        output.addField("tOutside", OpenThermGateway::getDecimal(tOutside));
+        output.addField("pHeatPump", OpenThermGateway::getDecimal(pHeatPump), 2);
+        output.addField("pressure", OpenThermGateway::getDecimal(pressure), 2);
+        output.addField("modulation", OpenThermGateway::getInteger(boilerRelModulation));
+        output.addField("flowRate", OpenThermGateway::getDecimal(flowRate));
+        output.addField("tRoom", OpenThermGateway::getDecimal(tRoom));
+        output.addField("deviationHours", deviationHours, 2);
+        output.endLine(time);
+    }
+
     void writeRow(HtmlWriter& html)
     {
         html.writeRowStart();
@@ -13,21 +13,43 @@ struct PersistentSettings : WiFiSettingsWithFTP
     int flameTimeout; // seconds
     char evoHomeHost[32];
     float deviationHoursThreshold;
+    char influxUrl[96];
+    char influxToken[96];
+    char mqttBroker[32];
+    char mqttUser[32];
+    char mqttPassword[32];
 
-    PersistentSettings() : WiFiSettingsWithFTP(PSTR("OTGW"))
-    {
-        addIntegerField(ftpSyncEntries, PSTR("FTP sync entries"), 1, 250, 50);
-        addStringField(heatmonHost, sizeof(heatmonHost), PSTR("Heatmon host"));
-        addStringField(evoHomeHost, sizeof(evoHomeHost), PSTR("EvoHome host"));
-        addStringField(weatherApiKey, sizeof(weatherApiKey), PSTR("Weather API key"));
-        addStringField(weatherLocation, sizeof(weatherLocation), PSTR("Weather location"));
-        addIntegerField(maxTSet, PSTR("Max TSet"), 40, 80, 60);
-        addIntegerField(minTSet, PSTR("Min TSet"), 20, 40, 40);
-        addBooleanField(usePumpModulation, PSTR("Use pump modulation"), true, 4); // 4 bytes for alignment
-        addTimeSpanField(boilerOnDelay, PSTR("Boiler on delay"), 0, 2 * 3600);
-        addTimeSpanField(flameTimeout, PSTR("Flame timeout"), 0, 12 * 3600);
-        addFloatField(deviationHoursThreshold, PSTR("Max error"), 1, 0, 10, 1);
-    }
+    PersistentSettings();
 };
 
+PERSISTENT_FIELD_TABLE_BEGIN
+constexpr PersistentDataField PERSISTENT_SETTINGS_FIELDS[] PROGMEM =
+{
+    PersistentDataField::integerField("FTP sync entries", PERSISTENT_FIELD(PersistentSettings, ftpSyncEntries), 1, 250, 50),
+    PersistentDataField::stringField("Heatmon host", PERSISTENT_FIELD(PersistentSettings, heatmonHost)),
+    PersistentDataField::stringField("EvoHome host", PERSISTENT_FIELD(PersistentSettings, evoHomeHost)),
+    PersistentDataField::stringField("Weather API key", PERSISTENT_FIELD(PersistentSettings, weatherApiKey)),
+    PersistentDataField::stringField("Weather location", PERSISTENT_FIELD(PersistentSettings, weatherLocation)),
+    PersistentDataField::integerField("Max TSet", PERSISTENT_FIELD(PersistentSettings, maxTSet), 40, 80, 60),
+    PersistentDataField::integerField("Min TSet", PERSISTENT_FIELD(PersistentSettings, minTSet), 20, 40, 40),
+    PersistentDataField::booleanField("Use pump modulation", PERSISTENT_FIELD(PersistentSettings, usePumpModulation), true),
+    PersistentDataField::timeSpanField("Boiler on delay", PERSISTENT_FIELD(PersistentSettings, boilerOnDelay), 0, 2 * 3600),
+    PersistentDataField::timeSpanField("Flame timeout", PERSISTENT_FIELD(PersistentSettings, flameTimeout), 0, 12 * 3600),
+    PersistentDataField::floatField("Max error", PERSISTENT_FIELD(PersistentSettings, deviationHoursThreshold), 1, 0, 10, 1),
+    PersistentDataField::stringField("InfluxDB write URL", PERSISTENT_FIELD(PersistentSettings, influxUrl)),
+    PersistentDataField::passwordField("InfluxDB token", PERSISTENT_FIELD(PersistentSettings, influxToken)),
+    PersistentDataField::stringField("MQTT broker", PERSISTENT_FIELD(PersistentSettings, mqttBroker)),
+    PersistentDataField::stringField("MQTT user", PERSISTENT_FIELD(PersistentSettings, mqttUser)),
+    PersistentDataField::passwordField("MQTT password", PERSISTENT_FIELD(PersistentSettings, mqttPassword))
+};
+// The fields from here on were added after the legacy EEPROM format
+constexpr auto PERSISTENT_SETTINGS_LEGACY_DATA_END = PERSISTENT_FIELD(PersistentSettings, influxUrl);
+PERSISTENT_FIELD_TABLE_END
+
+PersistentSettings::PersistentSettings() : WiFiSettingsWithFTP(PSTR("OTGW"))
+{
+    addFields(PERSISTENT_SETTINGS_FIELDS);
+    setLegacyDataEnd(PERSISTENT_SETTINGS_LEGACY_DATA_END);
+}
+
 PersistentSettings PersistentData;
@@ -8,6 +8,7 @@ bool WeatherAPI::begin(const char* apiKey, const char* location)
     Tracer tracer(F("WeatherAPI::begin"), apiKey);
 
     _filterDoc["liveweer"][0]["temp"] = true;
+    setStreamResponse(true);
 
     String url = F("http://weerlive.nl/api/json-data-10min.php?key=");
     url += apiKey;
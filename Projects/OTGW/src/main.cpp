@@ -5,6 +5,10 @@
 #include <WiFiStateMachine.h>
 #include <WiFiNTP.h>
 #include <WiFiFTP.h>
+#include <GzipPrint.h>
+#include <SyncCursor.h>
+#include <InfluxExporter.h>
+#include <MQTTPublisher.h>
 #include <TimeUtils.h>
 #include <Tracer.h>
 #include <StringBuilder.h>
@@ -36,6 +40,7 @@ constexpr int WEATHER_SERVICE_POLL_INTERVAL = 15 * SECONDS_PER_MINUTE;
 constexpr int FTP_RETRY_INTERVAL = 15 * SECONDS_PER_MINUTE;
 constexpr int HEATMON_POLL_INTERVAL = 1 * SECONDS_PER_MINUTE;
 constexpr int EVOHOME_POLL_INTERVAL = 5 * SECONDS_PER_MINUTE;
+constexpr int INFLUX_FLUSH_INTERVAL = 5 * SECONDS_PER_MINUTE;
 constexpr float MIN_TEMP = 20;
 constexpr float MAX_HEATPUMP_POWER = 4.0; // kW
 constexpr float MAX_PRESSURE = 3.0; // bar
@@ -143,6 +148,8 @@ WiFiFTPClient FTPClient(3000); // 3s timeout
 HeatMonClient HeatMon;
 EvoHomeClient EvoHome;
 WeatherAPI WeatherService;
+InfluxExporter Influx(3000, INFLUX_FLUSH_INTERVAL); // 3s timeout
+MQTTPublisher MQTT(3000); // 3s timeout
 StringBuilder HttpResponse(8 * 1024, MEMORY_TYPE); // 8KB HTTP response buffer
 HtmlWriter Html(HttpResponse, Files[FileId::Logo], Files[FileId::Styles], 40);
 StringLog EventLog(EVENT_LOG_LENGTH, 96, MEMORY_TYPE);
@@ -182,7 +189,17 @@ OpenThermLogEntry newOTLogEntry;
 OpenThermLogEntry* lastOTLogEntryPtr = nullptr;
 StatusLogEntry* lastStatusLogEntryPtr = nullptr;
 
-uint16_t otLogEntriesToSync = 0;
+SyncCursor otLogSyncCursor(OT_LOG_LENGTH);
+SyncCursor otLogInfluxCursor(OT_LOG_LENGTH);
+
+// MQTT sensor indices
+int mqttTBoiler;
+int mqttTReturn;
+int mqttTOutside;
+int mqttTSet;
+int mqttModulation;
+int mqttPressure;
+int mqttBoilerStatus;
 time_t syncFTPTime = 0;
 time_t lastFTPSyncTime = 0;
 
@@ -373,6 +390,19 @@ void updateStatusLog(time_t time, uint16_t status)
 }
 
 
+void publishMQTTValues(const OpenThermLogEntry& logEntry)
+{
+    MQTT.setValue(mqttTBoiler, OpenThermGateway::getDecimal(logEntry.tBoiler));
+    MQTT.setValue(mqttTReturn, OpenThermGateway::getDecimal(logEntry.tReturn));
+    if (logEntry.tOutside != DATA_VALUE_NONE)
+        MQTT.setValue(mqttTOutside, OpenThermGateway::getDecimal(logEntry.tOutside));
+    MQTT.setValue(mqttTSet, OpenThermGateway::getDecimal(logEntry.boilerTSet));
+    MQTT.setValue(mqttModulation, OpenThermGateway::getDecimal(logEntry.boilerRelModulation));
+    MQTT.setValue(mqttPressure, OpenThermGateway::getDecimal(logEntry.pressure));
+    MQTT.setValue(mqttBoilerStatus, OpenThermGateway::getSlaveStatus(logEntry.boilerStatus));
+}
+
+
 void logOpenThermValues(bool forceCreate)
 {
     newOTLogEntry.time = currentTime;
@@ -402,8 +432,10 @@ void logOpenThermValues(bool forceCreate)
     if ((lastOTLogEntryPtr == nullptr) || !newOTLogEntry.equals(lastOTLogEntryPtr) || forceCreate)
     {
         lastOTLogEntryPtr = OpenThermLog.add(&newOTLogEntry);
-        otLogEntriesToSync = std::min(otLogEntriesToSync + 1, OT_LOG_LENGTH);
-        if (PersistentData.isFTPEnabled() && otLogEntriesToSync == PersistentData.ftpSyncEntries)
+        otLogSyncCursor.add();
+        otLogInfluxCursor.add();
+        publishMQTTValues(newOTLogEntry);
+        if (PersistentData.isFTPEnabled() && otLogSyncCursor.getLag() == PersistentData.ftpSyncEntries)
             syncFTPTime = currentTime;
     }
 }
@@ -431,6 +463,15 @@ void writeCsvDataLines(uint16_t count, Print& destination)
 }
 
 
+uint16_t writeInfluxLines(InfluxLineWriter& output, uint16_t unsentEntries, uint16_t maxEntries)
+{
+    uint16_t entries = 0;
+    for (auto i = OpenThermLog.at(-unsentEntries); (i != OpenThermLog.end()) && (entries < maxEntries); ++i, ++entries)
+        i->writeInfluxLine(output);
+    return entries;
+}
+
+
 bool trySyncFTP(Print* printTo)
 {
     Tracer tracer(F("trySyncFTP"));
@@ -442,26 +483,38 @@ bool trySyncFTP(Print* printTo)
         FTP_DEFAULT_CONTROL_PORT,
         printTo);
 
+    // The sync cursor only advances when the server confirmed the transfer.
     auto otLogWriter = [printTo](Print& output)
     {
-        if (otLogEntriesToSync > 0)
+        uint16_t unsentEntries = otLogSyncCursor.getUnsent();
+        if (unsentEntries > 0)
         {
-            writeCsvDataLines(otLogEntriesToSync, output);
-            otLogEntriesToSync = 0;
+            GzipPrint gzipOutput(output);
+            writeCsvDataLines(unsentEntries, gzipOutput);
+            if (!gzipOutput.finish())
+            {
+                FTPClient.abortTransfer("gzip failed"); // The cursor stays, so the entries are sent again.
+                return;
+            }
+            TRACE(F("Compressed %u to %u bytes\n"), gzipOutput.getInputSize(), gzipOutput.getOutputSize());
+            otLogSyncCursor.advance(unsentEntries);
         }
         else if (printTo != nullptr)
             printTo->println(F("Nothing to sync."));
     };
 
     String filename = PersistentData.hostName;
-    filename += ".csv";
-    FTPClient.appendAsync(filename, otLogWriter);
+    filename += ".csv.gz";
+    FTPClient.appendLogAsync(filename, otLogSyncCursor, otLogWriter, []() { otLogSyncCursor.acknowledge(currentTime); });
 
    if (printTo == nullptr) return true; // Run async
 
     // Run synchronously
     bool success = FTPClient.run();
-    if (success) lastFTPSyncTime = currentTime;
+    if (success)
+        lastFTPSyncTime = currentTime;
+    else
+        otLogSyncCursor.rollback();
     return success;
 }
 
@@ -961,7 +1014,43 @@ void handleHttpRootRequest()
     Html.writeRow(F("OTGW Errors"), F("%u"), otgwErrors);
     Html.writeRow(F("OTGW Resets"), F("%u"), OTGW.resets);
     Html.writeRow(F("FTP Sync"), F("%s"), ftpSyncTime.c_str());
-    Html.writeRow(F("Sync entries"), F("%d / %d"), otLogEntriesToSync, PersistentData.ftpSyncEntries);
+    Html.writeRow(
+        F("Sync lag"),
+        F("%u / %d entries (%u lost)"),
+        otLogSyncCursor.getLag(),
+        PersistentData.ftpSyncEntries,
+        otLogSyncCursor.getLost());
+    if (Influx.isEnabled())
+    {
+        const InfluxExporterStats& influxStats = Influx.getStats();
+        Html.writeRow(
+            F("InfluxDB"),
+            F("%u lines, %0.0f lines/s, batch %u"),
+            influxStats.lines,
+            influxStats.getLinesPerSecond(),
+            Influx.getBatchSize());
+        Html.writeRow(
+            F("InfluxDB lag"),
+            F("%u entries (%s)"),
+            otLogInfluxCursor.getLag(),
+            Influx.getCircuitBreaker().getStateLabel());
+    }
+    if (MQTT.isEnabled())
+    {
+        const MQTTPublisherStats& mqttStats = MQTT.getStats();
+        Html.writeRow(
+            F("MQTT"),
+            F("%s, %u msg, %0.2f msg/s"),
+            MQTT.getStateLabel(),
+            mqttStats.published,
+            MQTT.getMessagesPerSecond());
+        Html.writeRow(
+            F("MQTT queue"),
+            F("%u (max %u), %u dropped"),
+            MQTT.getQueueLength(),
+            mqttStats.queueHighWater,
+            mqttStats.dropped);
+    }
     if (lastHeatmonUpdateTime != 0)
         Html.writeRow(F("HeatMon"), F("%s"), formatTime("%T", lastHeatmonUpdateTime));
     if (lastEvoHomeUpdateTime != 0)
@@ -1172,7 +1261,7 @@ void handleHttpFTPSyncRequest()
 
     Html.writeParagraph(
         F("Sending %d OpenTherm log entries to FTP server (%s) ..."),
-        otLogEntriesToSync,
+        otLogSyncCursor.getLag(),
         PersistentData.ftpServer);
 
     Html.writePreStart();
@@ -1472,16 +1561,21 @@ void onWiFiInitialized()
             if (FTPClient.isAsyncSuccess())
             {
                 WiFiSM.logEvent("FTP sync");
+                WiFiSM.recordUpload();
                 lastFTPSyncTime = currentTime;
             }
             else
             {
                 WiFiSM.logEvent("FTP sync failed: %s", FTPClient.getLastError());
+                otLogSyncCursor.rollback();
                 syncFTPTime = currentTime + FTP_RETRY_INTERVAL;
             }
             FTPClient.endAsync();
         }
     }
+
+    if (Influx.run(currentTime)) WiFiSM.recordUpload();
+    MQTT.run();
 }
 
 
@@ -1503,6 +1597,11 @@ void setup()
     OTGW.begin(OTGW_RESPONSE_TIMEOUT_MS, OTGW_SETPOINT_OVERRIDE_TIMEOUT);
 
     PersistentData.begin();
+
+    // Keep the log sync positions across resets (RTC memory slots)
+    otLogSyncCursor.begin(0);
+    otLogInfluxCursor.begin(1);
+
     TimeServer.begin(PersistentData.ntpServer);
     Html.setTitlePrefix(PersistentData.hostName);
     initBoilerLevels();
@@ -1593,6 +1692,37 @@ void setup()
             WiFiSM.logEvent(F("Unable to initialize EvoHome client"));
     }
 
+    if (PersistentData.influxUrl[0] != 0)
+    {
+        if (Influx.begin(PersistentData.influxUrl, PersistentData.influxToken, PersistentData.hostName))
+        {
+            Influx.addSource(otLogInfluxCursor, writeInfluxLines);
+            WiFiSM.logEvent(F("InfluxDB exporter initialized"));
+        }
+        else
+            WiFiSM.logEvent(F("InfluxDB: %s"), Influx.getLastError().c_str());
+    }
+
+    if (PersistentData.mqttBroker[0] != 0)
+    {
+        mqttTBoiler = MQTT.addSensor("T boiler", "°C", "temperature", 0.2F);
+        mqttTReturn = MQTT.addSensor("T return", "°C", "temperature", 0.2F);
+        mqttTOutside = MQTT.addSensor("T outside", "°C", "temperature", 0.5F);
+        mqttTSet = MQTT.addSensor("TSet", "°C", "temperature", 0.5F, 0);
+        mqttModulation = MQTT.addSensor("Modulation", "%", nullptr, 1.0F, 0);
+        mqttPressure = MQTT.addSensor("Pressure", "bar", "pressure", 0.05F, 2);
+        mqttBoilerStatus = MQTT.addSensor("Boiler status");
+        if (MQTT.begin(
+            PersistentData.mqttBroker,
+            MQTT_DEFAULT_PORT,
+            PersistentData.mqttUser,
+            PersistentData.mqttPassword,
+            PersistentData.hostName))
+            WiFiSM.logEvent(F("MQTT publisher initialized"));
+        else
+            WiFiSM.logEvent(F("Unable to initialize MQTT publisher"));
+    }
+
     if (PersistentData.weatherApiKey[0] != 0)
     {
         if (WeatherService.begin(PersistentData.weatherApiKey, PersistentData.weatherLocation))
@@ -21,6 +21,8 @@ constexpr uint32_t CALIBRATE_TIME = SECONDS_PER_MINUTE;
 constexpr uint32_t IAQ_POLL_INTERVAL = 3; // seconds
 constexpr uint32_t IAQ_SAMPLES_PER_MINUTE = SECONDS_PER_MINUTE / IAQ_POLL_INTERVAL;
 
+constexpr uint32_t LIGHT_SLEEP_ACTIVE_DELAY_MS = 100; // Max. web server latency while light-sleeping
+
 constexpr int FAN_LOG_SIZE = 150;
 constexpr int FAN_LOG_PAGE_SIZE = 50;
 
@@ -10,17 +10,31 @@ struct Settings : public WiFiSettingsWithFTP
     float tOffset;
     float dacScale;
     float adcScale;
+    bool lightSleep;
 
-    Settings() : WiFiSettingsWithFTP(PSTR("SmartFan"))
-    {
-        addIntegerField(ftpSyncEntries, "FTP sync entries", 0, FAN_LOG_SIZE, 50);
-        addIntegerField(maxLevel, "Max level (%)", 1, 100, 50);
-        addTimeSpanField(maxLevelDuration, "Max level duration", 0, SECONDS_PER_HOUR, 15*SECONDS_PER_MINUTE);
-        addIntegerField(humidityThreshold, "Humidity theshold (%)", 50, 100, 75);
-        addFloatField(tOffset, "T<sub>offset</sub>", 1, -10, 10);
-        addFloatField(dacScale, "DAC scale", 2, 10, 30, 20.7);
-        addFloatField(adcScale, "ADC scale", 2, 250, 300, 267);
-    }
+    Settings();
 };
 
+PERSISTENT_FIELD_TABLE_BEGIN
+constexpr PersistentDataField SETTINGS_FIELDS[] PROGMEM =
+{
+    PersistentDataField::integerField("FTP sync entries", PERSISTENT_FIELD(Settings, ftpSyncEntries), 0, FAN_LOG_SIZE, 50),
+    PersistentDataField::integerField("Max level (%)", PERSISTENT_FIELD(Settings, maxLevel), 1, 100, 50),
+    PersistentDataField::timeSpanField("Max level duration", PERSISTENT_FIELD(Settings, maxLevelDuration), 0, SECONDS_PER_HOUR, 15*SECONDS_PER_MINUTE),
+    PersistentDataField::integerField("Humidity theshold (%)", PERSISTENT_FIELD(Settings, humidityThreshold), 50, 100, 75),
+    PersistentDataField::floatField("T<sub>offset</sub>", PERSISTENT_FIELD(Settings, tOffset), 1, -10, 10),
+    PersistentDataField::floatField("DAC scale", PERSISTENT_FIELD(Settings, dacScale), 2, 10, 30, 20.7),
+    PersistentDataField::floatField("ADC scale", PERSISTENT_FIELD(Settings, adcScale), 2, 250, 300, 267),
+    PersistentDataField::booleanField("Light sleep", PERSISTENT_FIELD(Settings, lightSleep), false)
+};
+// The fields from here on were added after the legacy EEPROM format
+constexpr auto SETTINGS_LEGACY_DATA_END = PERSISTENT_FIELD(Settings, lightSleep);
+PERSISTENT_FIELD_TABLE_END
+
+Settings::Settings() : WiFiSettingsWithFTP(PSTR("SmartFan"))
+{
+    addFields(SETTINGS_FIELDS);
+    setLegacyDataEnd(SETTINGS_LEGACY_DATA_END);
+}
+
 Settings PersistentData;
@@ -11,6 +11,9 @@
 #include <StringBuilder.h>
 #include <LED.h>
 #include <Log.h>
+#include <MemoryPlanner.h>
+#include <TimerWheel.h>
+#include <PowerManager.h>
 #include <WiFiStateMachine.h>
 #include <HtmlWriter.h>
 #include <Navigation.h>
@@ -54,6 +57,9 @@ HtmlWriter Html(HttpResponse, Files[Logo], Files[Styles]);
 StringLog EventLog(MAX_EVENT_LOG_SIZE, 128);
 WiFiStateMachine WiFiSM(BuiltinLED, TimeServer, WebServer, EventLog);
 Navigation Nav;
+MemoryPlanner MemoryPlan;
+TimerWheel Timers;
+PowerManager PowerMgr(Timers);
 FanControlClass FanControl(FAN_DAC_PIN, FAN_ADC_PIN);
 MovingAverage HumidityBaseline(100); // 100 points; 5 minutes @ 3s sample rate
 
@@ -66,7 +72,7 @@ int fanLogEntriesToSync = 0;
 
 time_t currentTime = 0;
 time_t calibrateUntil = 0;
-time_t iaqPollTime = 0;
+int iaqPollJob;
 time_t syncFTPTime = 0;
 time_t lastFTPSyncTime = 0;
 
@@ -148,7 +154,7 @@ void updateIAQSensorValues()
     if ((lastFanLogEntryPtr == nullptr) || !NewFanLogEntry.equals(lastFanLogEntryPtr))
     {
         lastFanLogEntryPtr = FanLog.add(&NewFanLogEntry);
-        fanLogEntriesToSync = std::min(fanLogEntriesToSync + 1, FAN_LOG_SIZE);
+        fanLogEntriesToSync = std::min(fanLogEntriesToSync + 1, FanLog.size());
         if ((fanLogEntriesToSync == PersistentData.ftpSyncEntries) && PersistentData.isFTPEnabled())
             syncFTPTime = currentTime;
     }
@@ -240,29 +246,33 @@ bool trySyncFTP(Print* printTo)
 void onTimeServerSynced()
 {
     currentTime = TimeServer.getCurrentTime();
-    iaqPollTime = currentTime;
     initializeIAQSensor();
+    Timers.schedule(iaqPollJob, 0);
 }
 
 
-void onWiFiInitialized()
+void onIAQPollTimer()
 {
-    if (currentTime >= iaqPollTime)
+    currentTime = WiFiSM.getCurrentTime();
+    BuiltinLED.setOn();
+    if (checkIAQStatus())
     {
-        iaqPollTime = currentTime + IAQ_POLL_INTERVAL;
-        BuiltinLED.setOn();
-        if (checkIAQStatus())
+        IAQSensor.setOpMode(BME68X_FORCED_MODE);
+        delay((IAQSensor.getMeasDur() / 1000) + 1);
+        if (IAQSensor.fetchData())
         {
-            IAQSensor.setOpMode(BME68X_FORCED_MODE);
-            delay((IAQSensor.getMeasDur() / 1000) + 1);
-            if (IAQSensor.fetchData())
-            {
-                IAQSensor.getData(IAQData);
-                updateIAQSensorValues();
-            }
+            IAQSensor.getData(IAQData);
+            updateIAQSensorValues();
         }
-        BuiltinLED.setOff();
     }
+    BuiltinLED.setOff();
+}
+
+
+void onWiFiInitialized()
+{
+    // The FTP transfer runs from the loop; don't sleep in between.
+    PowerMgr.setKeepAwake(FTPClient.isAsyncPending());
 
     if (!WiFiSM.isConnected()) return;
 
@@ -276,6 +286,7 @@ void onWiFiInitialized()
         if (FTPClient.isAsyncSuccess())
         {
             WiFiSM.logEvent("FTP sync");
+            WiFiSM.recordUpload();
             lastFTPSyncTime = currentTime;
         }
         else
@@ -497,8 +508,19 @@ void handleHttpRootRequest()
     Html.writeRow("WiFi RSSI", "%d dBm", static_cast<int>(WiFi.RSSI()));
     Html.writeRow("Free Heap", "%0.1f kB", float(ESP.getFreeHeap()) / 1024);
     Html.writeRow("Uptime", "%0.1f days", float(WiFiSM.getUptime()) / SECONDS_PER_DAY);
+    const WiFiStartupStats& startupStats = WiFiSM.getStartupStats();
+    if (startupStats.firstUploadMillis == 0)
+        Html.writeRow("First upload", "Not yet");
+    else
+        Html.writeRow(
+            "First upload",
+            "%0.1f s%s",
+            float(startupStats.firstUploadMillis) / 1000,
+            startupStats.isFastConnect ? " (fast connect)" : "");
     Html.writeRow("FTP Sync", ftpSync);
     Html.writeRow("Sync entries", "%d / %d", fanLogEntriesToSync, PersistentData.ftpSyncEntries);
+    if (PowerMgr.isEnabled())
+        Html.writeRow("Light sleep", "%0.1f %%", PowerMgr.getStats().getSleepPercent());
     Html.writeTableEnd();
     Html.writeSectionEnd();
 
@@ -574,7 +596,11 @@ void setup()
 #endif
 
     BuiltinLED.begin();
-    EventLog.begin();
+
+    MemoryPlan.add("EventLog", EventLog, MAX_EVENT_LOG_SIZE / 2);
+    MemoryPlan.add("FanLog", FanLog, FAN_LOG_SIZE / 3);
+    MemoryPlan.add("HttpResponse", HttpResponse);
+    MemoryPlan.commit();
 
     PersistentData.begin();
     TimeServer.begin(PersistentData.ntpServer);
@@ -637,11 +663,31 @@ void setup()
     WebServer.on("/level", handleHttpLevelRequest);
 
     WiFiSM.registerStaticFiles(Files, _LastFile);
+    WiFiSM.registerMemoryPlan(MemoryPlan);
+    WiFiSM.registerTimerWheel(Timers);
     WiFiSM.on(WiFiInitState::TimeServerSynced, onTimeServerSynced);
     WiFiSM.on(WiFiInitState::Initialized, onWiFiInitialized);
     WiFiSM.scanAccessPoints();
     WiFiSM.begin(PersistentData.wifiSSID, PersistentData.wifiKey, PersistentData.hostName);
 
+    // IAQ polling starts once the time is synchronized
+    iaqPollJob = Timers.addJob("IAQ poll", onIAQPollTimer, IAQ_POLL_INTERVAL * 1000);
+
+    // Serial requests end the loop's sleep, so they're handled right away (called by the UART event task)
+    Serial.onReceive([]() { Timers.wake(); });
+
+    if (PersistentData.lightSleep)
+    {
+        PowerMgr.enableUartWakeup(Serial);
+        if (PowerMgr.begin())
+        {
+            WiFiSM.activeDelay = LIGHT_SLEEP_ACTIVE_DELAY_MS;
+            WiFiSM.registerPowerManager(PowerMgr);
+        }
+        else
+            WiFiSM.logEvent("Unable to enable light sleep");
+    }
+
     Tracer::traceFreeHeap();
 
     BuiltinLED.setOff();    
@@ -4,7 +4,7 @@
 #include <TimeUtils.h>
 
 constexpr int DEBUG_BAUDRATE = 115200;
-const char* DEFAULT_DTU_SERIAL = "199990100000";
+constexpr char DEFAULT_DTU_SERIAL[] = "199990100000";
 
 constexpr size_t HTTP_RESPONSE_BUFFER_SIZE = 8 * 1024;
 constexpr size_t HOYMILES_OUTPUT_BUFFER_SIZE = 7 * 1024;
@@ -12,7 +12,8 @@ constexpr size_t HOYMILES_OUTPUT_BUFFER_SIZE = 7 * 1024;
 constexpr uint32_t SMARTHOME_POLL_INTERVAL = 6;
 constexpr uint16_t SMARTHOME_ENERGY_LOG_SIZE = 50;
 
-constexpr uint32_t P1_POLL_INTERVAL = 6;
+constexpr uint32_t P1_MIN_POLL_INTERVAL = 2;
+constexpr uint32_t P1_MAX_POLL_INTERVAL = 30;
 constexpr uint16_t P1_LOG_SIZE = 200;
 constexpr uint16_t P1_LOG_PAGE_SIZE = 25;
 
@@ -35,6 +36,8 @@ constexpr int MAX_EVENT_LOG_SIZE = 50;
 
 constexpr int FTP_RETRY_INTERVAL = 15 * SECONDS_PER_MINUTE;
 constexpr int FTP_TIMEOUT_MS = 5000;
+constexpr uint16_t FTP_IDLE_TIMEOUT = 240; // seconds; below the usual server idle timeout (300 s)
+constexpr int FTP_ROWS_PER_STEP = 20; // CSV rows written per loop() iteration
 
 constexpr uint8_t NRF_CS_PIN = 16; 
 constexpr uint8_t NRF_CE_PIN = 43;
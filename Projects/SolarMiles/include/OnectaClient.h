@@ -3,6 +3,8 @@
 
 #include <Logger.h>
 #include <SpiRamAllocator.h>
+#include <RequestBudget.h>
+#include <ResponseCache.h>
 #include <ArduinoJson.h>
 #include <NetworkClientSecure.h>
 #include <HTTPClient.h>
@@ -18,9 +20,11 @@ class OnectaClient
         OnectaClient(const char* clientId, const char* clientSecret, char* refreshToken, ILogger& logger);
 
         uint32_t responseTimeMs() { return _responseTimeMs; }
-        uint32_t rateLimitPerDay() { return _rateLimitPerDay; }
-        uint32_t rateLimitRemaining() { return _rateLimitRemaining; }
-        time_t requestAfter() { return _requestAfter; }
+        uint32_t rateLimitPerDay() { return _budget.getLimit(); }
+        uint32_t rateLimitRemaining() { return _budget.getRemaining(); }
+        time_t requestAfter() { return _budget.getNextRequestTime(); }
+        const RequestBudget& budget() { return _budget; }
+        const ResponseCache& cache() { return _cache; }
         void onTokenRefresh(std::function<void(void)> cb) { _refreshTokenCallback = cb; }
 
         bool discoverDevices();
@@ -33,10 +37,7 @@ class OnectaClient
         char* _refreshToken;
         String _accessToken;
         uint32_t _tokenExpiresMillis = 0;
-        time_t _requestAfter = 0;
         uint32_t _responseTimeMs;
-        uint32_t _rateLimitPerDay;
-        uint32_t _rateLimitRemaining;
 
         std::function<void(void)> _refreshTokenCallback;
         ILogger& _logger;
@@ -44,9 +45,11 @@ class OnectaClient
         JsonDocument _sitesFilterDoc;
         JsonDocument _deviceFilterDoc;
         SpiRamAllocator _spiRamAllocator;
+        RequestBudget _budget;
+        ResponseCache _cache;
 
         bool exchangeTokens();
-        bool request(const String& urlPath, const JsonDocument& filterDoc);
+        bool request(const String& urlPath, const JsonDocument& filterDoc, time_t time, bool isUrgent = false);
 };
 
 #endif
@@ -3,8 +3,11 @@
 #include <Log.h>
 #include <Logger.h>
 #include <TimeUtils.h>
+#include <AdaptivePoller.h>
+#include <SyncCursor.h>
 
 constexpr uint32_t P1_AGGREGATION_INTERVAL = 60; // seconds
+constexpr float P1_POLL_CHANGE_THRESHOLD = 100; // W; poll faster if total power changes more
 constexpr float GAS_CALORIFIC_VALUE = 9769; // Wh/m3
 
 struct PhaseDayStats
@@ -89,27 +92,30 @@ class P1MonitorClass
     public:
         StaticLog<P1MonitorDayStatsEntry> DayStats;
         StaticLog<P1MonitorLogEntry> Log;
-        int logEntriesToSync = 0;
+        SyncCursor logSyncCursor;
         float solarPower[3];
 
         bool isInitialized() { return _p1Client.isInitialized; }
-        bool isRequestPending() { return _p1Client.isRequestPending(); }
-        bool isResponsePending() { return _p1Client.isResponsePending(); }
+        bool isRequestPending() { return _isRequestQueued; }
+        bool isResponsePending() { return _isRequestQueued; }
+        // While active, the P1 meter is polled at the minimum interval.
+        void setActive(bool isActive) { _poller.setActive(isActive); }
 
         // Constructor
         P1MonitorClass(ILogger& logger, uint16_t logSize) 
-            : DayStats(7), Log(logSize), _logger(logger)
+            : DayStats(7), Log(logSize), logSyncCursor(logSize), _logger(logger), _poller(0, 0, P1_POLL_CHANGE_THRESHOLD)
         {
             memset(solarPower, 0, sizeof(solarPower));
         }
 
-        bool begin(const char* host, uint32_t pollInterval, float powerDelta, float voltageDelta);
+        bool begin(const char* host, uint32_t minPollInterval, uint32_t maxPollInterval, float powerDelta, float voltageDelta);
         bool run(time_t time);
         void writeStatus(HtmlWriter& html);
         void writeCurrentValues(HtmlWriter& html, int maxPhasePower);
         void writeDayStats(HtmlWriter& html);
         void writeLog(HtmlWriter& html, int page, int pageSize);
-        void writeLogCsv(Print& output, int entries);
+        // Writes at most maxRows of the last entries; returns the number of rows written.
+        int writeLogCsv(Print& output, int entries, int maxRows = INT16_MAX);
 
     private:
         P1MonitorDayStatsEntry* _currentDayStatsPtr = nullptr;
@@ -117,8 +123,9 @@ class P1MonitorClass
         P1MonitorLogEntry* _lastLogEntryPtr;
         HomeWizardP1V1Client _p1Client;
         ILogger& _logger;
-        uint32_t _pollInterval;
-        time_t _nextPollTime = 0;
+        AdaptivePoller _poller;
+        time_t _lastPollTime = 0;
+        bool _isRequestQueued = false;
         int _aggregations = 0;
         float _powerDelta;
         float _voltageDelta;
@@ -126,6 +133,8 @@ class P1MonitorClass
         float _lastGasM3 = 0;
         uint64_t _lastGasTimestamp = 0;
 
+        void requestMeasurement();
+        void onMeasurement(int httpResult);
         void updateLog(time_t time);
         void writeDayStats(HtmlWriter& html, int phase, int property);
 };
\ No newline at end of file
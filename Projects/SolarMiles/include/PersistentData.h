@@ -31,22 +31,7 @@ struct Settings : public WiFiSettingsWithFTP
     char onectaClientSecret[96];
     char onectaRefreshToken[256];
 
-    Settings() : WiFiSettingsWithFTP(
-        PSTR("SolarMiles"),
-        sizeof(registeredInvertersCount) + sizeof(registeredInverters) + sizeof(inverterPhase))
-    {
-        addStringField(dtuSerial, sizeof(dtuSerial), "DTU serial#", DEFAULT_DTU_SERIAL);
-        addIntegerField(dtuTxLevel, "DTU Tx Level", RF24_PA_MIN, RF24_PA_MAX, RF24_PA_MAX);
-        addIntegerField(ftpSyncEntries, "FTP sync entries", 0, POWER_LOG_SIZE);
-        addBooleanField(enableFritzSmartHome, "Fritz! SmartHome", false, 4);
-        addStringField(smartThingsPAT, sizeof(smartThingsPAT), "SmartThings PAT");
-        addIntegerField(powerThreshold, "Power threshold", 0, 100, 5);
-        addTimeSpanField(idleDelay, "Idle delay", 0, 3600, 5 * 60);
-        addStringField(p1MonitorHost, sizeof(p1MonitorHost), "P1 Monitor");
-        addStringField(onectaClientID, sizeof(onectaClientID), "Onecta Client ID");
-        addStringField(onectaClientSecret, sizeof(onectaClientSecret), "Onecta Secret");
-        addStringField(onectaRefreshToken, sizeof(onectaRefreshToken), "Onecta Refresh");
-    }
+    Settings();
 
     void initialize() override
     {
@@ -72,4 +57,29 @@ struct Settings : public WiFiSettingsWithFTP
     }
 };
 
+PERSISTENT_FIELD_TABLE_BEGIN
+constexpr PersistentDataField SETTINGS_FIELDS[] PROGMEM =
+{
+    PersistentDataField::stringField("DTU serial#", PERSISTENT_FIELD(Settings, dtuSerial), DEFAULT_DTU_SERIAL),
+    PersistentDataField::integerField("DTU Tx Level", PERSISTENT_FIELD(Settings, dtuTxLevel), RF24_PA_MIN, RF24_PA_MAX, RF24_PA_MAX),
+    PersistentDataField::integerField("FTP sync entries", PERSISTENT_FIELD(Settings, ftpSyncEntries), 0, POWER_LOG_SIZE),
+    PersistentDataField::booleanField("Fritz! SmartHome", PERSISTENT_FIELD(Settings, enableFritzSmartHome), false),
+    PersistentDataField::stringField("SmartThings PAT", PERSISTENT_FIELD(Settings, smartThingsPAT)),
+    PersistentDataField::integerField("Power threshold", PERSISTENT_FIELD(Settings, powerThreshold), 0, 100, 5),
+    PersistentDataField::timeSpanField("Idle delay", PERSISTENT_FIELD(Settings, idleDelay), 0, 3600, 5 * 60),
+    PersistentDataField::stringField("P1 Monitor", PERSISTENT_FIELD(Settings, p1MonitorHost)),
+    PersistentDataField::stringField("Onecta Client ID", PERSISTENT_FIELD(Settings, onectaClientID)),
+    PersistentDataField::stringField("Onecta Secret", PERSISTENT_FIELD(Settings, onectaClientSecret)),
+    PersistentDataField::stringField("Onecta Refresh", PERSISTENT_FIELD(Settings, onectaRefreshToken)),
+    PersistentDataField::binaryField("Inverter count", PERSISTENT_FIELD(Settings, registeredInvertersCount)),
+    PersistentDataField::binaryField("Inverters", PERSISTENT_FIELD(Settings, registeredInverters)),
+    PersistentDataField::binaryField("Inverter phases", PERSISTENT_FIELD(Settings, inverterPhase))
+};
+PERSISTENT_FIELD_TABLE_END
+
+Settings::Settings() : WiFiSettingsWithFTP(PSTR("SolarMiles"))
+{
+    addFields(SETTINGS_FIELDS);
+}
+
 Settings PersistentData;
@@ -3,10 +3,16 @@
 #include <Log.h>
 #include <Logger.h>
 #include <HtmlWriter.h>
+#include <AdaptivePoller.h>
+#include <CircuitBreaker.h>
+#include <SyncCursor.h>
 #include "SmartThings.h"
 #include "OnectaClient.h"
 
 constexpr uint32_t SH_RETRY_DELAY_MS = 5000;
+constexpr uint32_t SH_IDLE_DELAY_MS = 1000; // When no device is due for polling
+constexpr uint32_t SH_MAX_POLL_FACTOR = 10; // Stable devices are polled up to 10x less often
+constexpr float SH_POLL_CHANGE_THRESHOLD = 10; // W
 
 enum struct SmartDeviceState
 {
@@ -62,6 +68,7 @@ class SmartDevice
         float powerThreshold = 0;
         uint32_t powerOffDelay = 0;
         SmartDeviceEnergyLogEntry energyLogEntry; 
+        AdaptivePoller poller;
 
         const char* getStateLabel();
         const char* getSwitchStateLabel();
@@ -74,7 +81,7 @@ class SmartDevice
         ILogger& _logger;
 
         SmartDevice(const String& id, const String& name, ILogger& logger)
-            : _logger(logger)
+            : poller(0, 0, SH_POLL_CHANGE_THRESHOLD), _logger(logger)
         {
             this->id = id;
             this->name = name;
@@ -85,6 +92,8 @@ class SmartDevice
 class FritzSmartPlug : public SmartDevice
 {
     public:
+        CircuitBreaker* circuitBreakerPtr = nullptr; // Shared by all devices of the Fritzbox
+
         FritzSmartPlug(const String& id, const String& name, TR064* fritzboxPtr, ILogger& logger)
             : SmartDevice(id, name, logger)
         {
@@ -147,14 +156,15 @@ class SmartHomeClass
     public:
         std::vector<SmartDevice*> devices;
         StaticLog<SmartDeviceEnergyLogEntry> energyLog;
-        int logEntriesToSync = 0;
+        SyncCursor logSyncCursor;
 
         SmartHomeClass(ILogger& logger, uint16_t energyLogSize)
-            : energyLog(energyLogSize), _logger(logger)
+            : energyLog(energyLogSize), logSyncCursor(energyLogSize), _logger(logger)
         {}
 
         SmartHomeState getState() { return _state; }
         bool isAwaiting() { return _isAwaiting; }
+        bool isDeviceOn() { return _isDeviceOn; }
 
         const char* getStateLabel();
 
@@ -166,6 +176,7 @@ class SmartHomeClass
         bool useOnecta(const char* clientId, const char* clientSecret, char* refreshToken, std::function<void(void)> onTokenRefresh);
         bool startDiscovery();
         void writeHtml(HtmlWriter& html);
+        // Writes the entries not synced yet and advances the sync cursor, or writes all entries.
         void writeEnergyLogCsv(Print& output, bool onlyEntriesToSync = true);
 
     private:
@@ -173,9 +184,11 @@ class SmartHomeClass
         TaskHandle_t _taskHandle;
         volatile SmartHomeState _state = SmartHomeState::Uninitialized;
         TR064* _fritzboxPtr = nullptr;
+        CircuitBreaker _fritzboxBreaker;
         SmartThingsClient* _smartThingsPtr = nullptr;
         OnectaClient* _onectaPtr = nullptr;
         bool _isAwaiting = false;
+        volatile bool _isDeviceOn = false; // Set by the SmartHome task
         float _powerThreshold;
         uint32_t _powerOffDelay;
         uint32_t _pollInterval;
@@ -183,10 +196,14 @@ class SmartHomeClass
         int _currentDeviceIndex;
 
         void setState(SmartHomeState newState);
+        void addDevice(SmartDevice* smartDevicePtr);
+        int getDueDeviceIndex(uint32_t currentMillis);
         bool discoverFritzSmartPlug(int index);
         bool discoverSmartThings();
         bool discoverOnectaDevices();
         bool updateDevice();
+        void writeCircuitBreaker(HtmlWriter& html, const char* label, const CircuitBreaker& circuitBreaker);
+        void writeBudget(HtmlWriter& html, const char* label, const RequestBudget& budget, const ResponseCache& cache);
         void runStateMachine();
         static void run(void* taskParam);
 };
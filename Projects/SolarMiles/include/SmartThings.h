@@ -5,6 +5,8 @@
 #include <WiFiClientSecure.h>
 #include <Logger.h>
 #include <SpiRamAllocator.h>
+#include <RequestBudget.h>
+#include <ResponseCache.h>
 
 class SmartThingsClient
 {
@@ -14,8 +16,10 @@ class SmartThingsClient
         SmartThingsClient(const char* pat, ILogger& logger);
 
         uint32_t responseTimeMs() { return _responseTimeMs; }
+        const RequestBudget& budget() { return _budget; }
+        const ResponseCache& cache() { return _cache; }
 
-        bool request(const String& urlPath, const JsonDocument& filterDoc);
+        bool request(const String& urlPath, const JsonDocument& filterDoc, bool isUrgent = false);
         bool requestDevices();
         bool requestDeviceStatus(const String& deviceId);
         void cleanup();
@@ -28,6 +32,8 @@ class SmartThingsClient
         uint32_t _responseTimeMs = 0;
         JsonDocument _devicesFilter;
         JsonDocument _deviceStatusFilter;
+        RequestBudget _budget;
+        ResponseCache _cache;
 };
 
 #endif
\ No newline at end of file
@@ -7,11 +7,17 @@ constexpr const char* IDP_TOKEN_URL = "https://idp.onecta.daikineurope.com/v1/oi
 constexpr const char* API_BASE_URL = "https://api.onecta.daikineurope.com/v1/";
 constexpr const char* RATE_LIMIT_PER_DAY_HEADER = "X-RateLimit-Limit-day";
 constexpr const char* RATE_LIMIT_REMAINING_HEADER = "X-RateLimit-Remaining-day";
+constexpr const char* RETRY_AFTER_HEADER = "Retry-After";
+constexpr uint32_t DEFAULT_RATE_LIMIT_PER_DAY = 200;
 constexpr uint32_t MIN_REMAINING = 10;
 constexpr uint32_t SKEW_TIME_MS = 10000;
+constexpr size_t CACHE_SIZE = 4;
+constexpr uint32_t CACHE_TTL = 60; // seconds
 
 OnectaClient::OnectaClient(const char* clientId, const char* clientSecret, char* refreshToken, ILogger& logger)
-    :  jsonDoc(&_spiRamAllocator), _logger(logger)
+    :  jsonDoc(&_spiRamAllocator), _logger(logger),
+    _budget(DEFAULT_RATE_LIMIT_PER_DAY, SECONDS_PER_DAY, MIN_REMAINING),
+    _cache(CACHE_SIZE, CACHE_TTL, &_spiRamAllocator)
 {
     _clientId = clientId;
     _clientSecret = clientSecret;
@@ -116,10 +122,23 @@ bool OnectaClient::exchangeTokens()
     return true;
 }
 
-bool OnectaClient::request(const String& urlPath, const JsonDocument& filterDoc)
+bool OnectaClient::request(const String& urlPath, const JsonDocument& filterDoc, time_t time, bool isUrgent)
 {
     Tracer tracer("OnectaClient::request", urlPath.c_str());
 
+    if (_cache.get(urlPath, time, jsonDoc))
+    {
+        TRACE("Using cached response\n");
+        return true;
+    }
+
+    if (!_budget.tryAcquire(time, isUrgent))
+    {
+        TRACE("Rate limit. Request after %s\n", formatTime("%H:%M:%S", _budget.getNextRequestTime()));
+        // Better use the last known response than nothing at all
+        return _cache.get(urlPath, time, jsonDoc, UINT32_MAX);
+    }
+
     if (millis() >= _tokenExpiresMillis)
     {
         if (!exchangeTokens()) return false;
@@ -156,6 +175,9 @@ bool OnectaClient::request(const String& urlPath, const JsonDocument& filterDoc)
         _responseTimeMs,
         httpClient.getSize());
 
+    if (httpCode == HTTP_CODE_TOO_MANY_REQUESTS)
+        _budget.rateLimited(time, httpClient.header(RETRY_AFTER_HEADER).toInt());
+
     if (httpCode != HTTP_CODE_OK)
     {
         _logger.logEvent("Onecta: HTTP %d", httpCode);
@@ -177,21 +199,22 @@ bool OnectaClient::request(const String& urlPath, const JsonDocument& filterDoc)
  
     String rateLimitPerDay = httpClient.header(RATE_LIMIT_PER_DAY_HEADER);
     String rateLimitRemaining = httpClient.header(RATE_LIMIT_REMAINING_HEADER);
-    _rateLimitPerDay = rateLimitPerDay.toInt();
-    if (_rateLimitPerDay == 0) _rateLimitPerDay = 200;
-    _rateLimitRemaining = rateLimitRemaining.toInt();
+    if (rateLimitRemaining.length() > 0)
+        _budget.update(time, rateLimitPerDay.toInt(), rateLimitRemaining.toInt());
 
     TRACE("%s: '%s'\n", RATE_LIMIT_PER_DAY_HEADER, rateLimitPerDay.c_str());
     TRACE("%s: '%s'\n", RATE_LIMIT_REMAINING_HEADER, rateLimitRemaining.c_str());
 
     httpClient.end();
 
-    return (jsonError == DeserializationError::Ok);
+    if (jsonError != DeserializationError::Ok) return false;
+    _cache.put(urlPath, time, jsonDoc);
+    return true;
 }
 
 bool OnectaClient::discoverDevices()
 {
-    if (!request("sites", _sitesFilterDoc)) return false;
+    if (!request("sites", _sitesFilterDoc, time(nullptr), true)) return false;
 
     deviceIds.clear();
     for (const JsonVariant site : jsonDoc.as<JsonArray>())
@@ -208,26 +231,10 @@ bool OnectaClient::discoverDevices()
 
 bool OnectaClient::requestDeviceStatus(const String& deviceId, time_t time)
 {
-    if (time < _requestAfter)
-    {
-        TRACE("Rate limit. Request after %s\n", formatTime("%H:%M:%S", _requestAfter));
-        return true;
-    }
-
     String urlPath = "gateway-devices/";
     urlPath += deviceId;
 
-    if (!request(urlPath, _deviceFilterDoc)) return false;
-
-    if (_rateLimitRemaining > MIN_REMAINING)
-    {
-        uint32_t rateLimitDelay = SECONDS_PER_DAY / (_rateLimitPerDay - MIN_REMAINING);
-        _requestAfter = time + rateLimitDelay;
-    }
-    else
-        _requestAfter = time + SECONDS_PER_HOUR;
-
-    return true;
+    return request(urlPath, _deviceFilterDoc, time);
 }
 
 void OnectaClient::cleanup()
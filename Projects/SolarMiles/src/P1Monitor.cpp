@@ -14,14 +14,14 @@ enum DayStatsProperty
 };
 
 
-bool P1MonitorClass::begin(const char* host, uint32_t pollInterval, float powerDelta, float voltageDelta)
+bool P1MonitorClass::begin(const char* host, uint32_t minPollInterval, uint32_t maxPollInterval, float powerDelta, float voltageDelta)
 {
-    _pollInterval = pollInterval;
+    _poller.setLimits(minPollInterval * 1000, maxPollInterval * 1000);
     _powerDelta = powerDelta;
     _voltageDelta = voltageDelta;
 
     bool success = _p1Client.begin(host);
-    if (success) _p1Client.requestData();
+    if (success) requestMeasurement();
     return success;
 }
 
@@ -30,26 +30,42 @@ bool P1MonitorClass::run(time_t time)
 {
     if (!_p1Client.isInitialized) return false;
 
-    if (_p1Client.isResponsePending())
-    {
-        int httpResult = _p1Client.requestData();
-        if (httpResult == HTTP_REQUEST_PENDING) return false;
-        if (httpResult != HTTP_CODE_OK)
-        {
-            _logger.logEvent("P1Monitor: %s", _p1Client.getLastError().c_str());
-            return false;
-        }    
-    }
+    // Invokes onMeasurement if the response is available
+    _p1Client.processCallbacks();
 
-    if (time < _nextPollTime) return false;
+    if (_isRequestQueued || !_poller.isDue(millis())) return false;
 
-    _nextPollTime = time + _pollInterval;
     updateLog(time);
-    _p1Client.requestData();
+    requestMeasurement();
     return true;
 }
 
 
+void P1MonitorClass::requestMeasurement()
+{
+    int httpResult = _p1Client.queueDataRequest("", [this](int result) { onMeasurement(result); });
+    _isRequestQueued = (httpResult == HTTP_REQUEST_PENDING);
+    if (!_isRequestQueued)
+        _logger.logEvent("P1Monitor: %s", _p1Client.getLastError().c_str());
+}
+
+
+void P1MonitorClass::onMeasurement(int httpResult)
+{
+    _isRequestQueued = false;
+    if (httpResult != HTTP_CODE_OK)
+    {
+        _logger.logEvent("P1Monitor: %s", _p1Client.getLastError().c_str());
+        return;
+    }
+
+    float totalPower = 0;
+    for (PhaseData& phaseData : _p1Client.measurement)
+        totalPower += phaseData.Power;
+    _poller.update(totalPower);
+}
+
+
 void P1MonitorClass::updateLog(time_t time)
 {
     Tracer tracer("P1MonitorClass::updateLog");
@@ -64,27 +80,33 @@ void P1MonitorClass::updateLog(time_t time)
         _currentDayStatsPtr = DayStats.add(&dayStatsEntry);
     }
 
+    // The poll interval varies, so use the actual time since the previous update.
+    uint32_t interval = (_lastPollTime == 0) ? 0 : time - _lastPollTime;
+    _lastPollTime = time;
+
     int i = 0;
-    for (PhaseData& phaseData : _p1Client.electricity)
+    for (PhaseData& phaseData : _p1Client.measurement)
     {
         _newLogEntry.voltage[i] += phaseData.Voltage;
         _newLogEntry.power[i] += phaseData.Power;
-        _currentDayStatsPtr->phase[i].update(phaseData.Voltage, phaseData.Power, solarPower[i], _pollInterval);
+        _currentDayStatsPtr->phase[i].update(phaseData.Voltage, phaseData.Power, solarPower[i], interval);
         i++;
     }
     _aggregations++;
 
-    if (_p1Client.gasTimestamp != _lastGasTimestamp)
+    // Gas properties are missing if the meter has no gas meter (or it doesn't report)
+    uint64_t gasTimestamp = _p1Client.measurement.gasTimestamp;
+    if ((gasTimestamp != 0) && (gasTimestamp != _lastGasTimestamp))
     {
         if (_lastGasTimestamp != 0)
         {
-            uint32_t seconds = _p1Client.gasTimestamp - _lastGasTimestamp;
-            float gasDeltaM3 = _p1Client.gasM3 - _lastGasM3;
+            uint32_t seconds = gasTimestamp - _lastGasTimestamp;
+            float gasDeltaM3 = _p1Client.measurement.gasM3 - _lastGasM3;
             _gasPower = gasDeltaM3 * GAS_CALORIFIC_VALUE * SECONDS_PER_HOUR / seconds;
             TRACE("Gas delta: %0.3f m3 in %d s => %0.1f W\n", gasDeltaM3, seconds, _gasPower);
         }
-        _lastGasM3 = _p1Client.gasM3;
-        _lastGasTimestamp = _p1Client.gasTimestamp;
+        _lastGasM3 = _p1Client.measurement.gasM3;
+        _lastGasTimestamp = gasTimestamp;
     }
 
     if (time >= _newLogEntry.time)
@@ -94,7 +116,7 @@ void P1MonitorClass::updateLog(time_t time)
         if ((_lastLogEntryPtr == nullptr) || !_newLogEntry.equals(_lastLogEntryPtr, _powerDelta, _voltageDelta))
         {
             _lastLogEntryPtr = Log.add(&_newLogEntry);
-            logEntriesToSync = std::min(logEntriesToSync + 1, Log.size());
+            logSyncCursor.add();
         }
         _newLogEntry.reset(time + P1_AGGREGATION_INTERVAL);
         _aggregations = 0;
@@ -109,7 +131,28 @@ void P1MonitorClass::writeStatus(HtmlWriter& html)
     html.writeSectionStart("Status");
     html.writeTableStart();
     html.writeRow("P1 Meter", "%d ms", _p1Client.getResponseTimeMs());
-    html.writeRow("FTP Entries", "%d", logEntriesToSync);
+    const RESTClientStats& p1Stats = _p1Client.getStats();
+    html.writeRow(
+        "P1 connects",
+        "%u (%u reused, avg %u ms)",
+        p1Stats.connects,
+        p1Stats.reusedConnections,
+        p1Stats.getAvgConnectMs());
+    const CircuitBreaker& p1CircuitBreaker = _p1Client.getCircuitBreaker();
+    html.writeRow(
+        "P1 circuit",
+        "%s (%u failures, %u skipped)",
+        p1CircuitBreaker.getStateLabel(),
+        p1CircuitBreaker.getStats().failures,
+        p1CircuitBreaker.getStats().rejected);
+    const AdaptivePollerStats& pollStats = _poller.getStats();
+    html.writeRow(
+        "P1 Poll interval",
+        "%u ms (%u faster, %u slower)",
+        _poller.getIntervalMs(),
+        pollStats.speedUps,
+        pollStats.slowDowns);
+    html.writeRow("FTP lag", "%u entries (%u lost)", logSyncCursor.getLag(), logSyncCursor.getLost());
     html.writeTableEnd();
     html.writeSectionEnd();
 }
@@ -119,8 +162,8 @@ void P1MonitorClass::writeCurrentValues(HtmlWriter& html, int maxPhasePower)
 {
     Tracer tracer("P1MonitorClass::writeCurrentValues");
 
-    int maxTotalPower = maxPhasePower * _p1Client.electricity.size();
-    float gasKWh = _p1Client.gasM3 * GAS_CALORIFIC_VALUE / 1000;
+    int maxTotalPower = maxPhasePower * _p1Client.measurement.size();
+    float gasKWh = _p1Client.measurement.gasM3 * GAS_CALORIFIC_VALUE / 1000;
     PhaseData total
     {
         .Name = "Total",
@@ -134,7 +177,7 @@ void P1MonitorClass::writeCurrentValues(HtmlWriter& html, int maxPhasePower)
     html.writeTableStart();
 
     int i = 0;
-    for (PhaseData& phaseData : _p1Client.electricity)
+    for (PhaseData& phaseData : _p1Client.measurement)
     {
         html.writeRowStart();
         html.writeHeaderCell(phaseData.Name);
@@ -157,7 +200,7 @@ void P1MonitorClass::writeCurrentValues(HtmlWriter& html, int maxPhasePower)
         i++;
     }
 
-    total.Voltage /= _p1Client.electricity.size();
+    total.Voltage /= _p1Client.measurement.size();
 
     html.writeRowStart();
     html.writeHeaderCell(total.Name);
@@ -200,7 +243,7 @@ void P1MonitorClass::writeDayStats(HtmlWriter& html)
     html.writeRowEnd();
 
     int phase = 0;
-    for (PhaseData& phaseData : _p1Client.electricity)
+    for (PhaseData& phaseData : _p1Client.measurement)
     {
         html.writeRowStart();
         html.writeHeaderCell(phaseData.Name, 0, 8);
@@ -301,12 +344,12 @@ void P1MonitorClass::writeLog(HtmlWriter& html, int page, int pageSize)
     html.writeTableStart();
     html.writeRowStart();
     html.writeHeaderCell("Time", 0, 2);
-    for (PhaseData& phaseData : _p1Client.electricity)
+    for (PhaseData& phaseData : _p1Client.measurement)
         html.writeHeaderCell(phaseData.Name, 2);
     html.writeHeaderCell("Gas");
     html.writeRowEnd();
     html.writeRowStart();
-    for (int i = 0; i < _p1Client.electricity.size(); i++)
+    for (int i = 0; i < _p1Client.measurement.size(); i++)
     {
         html.writeHeaderCell("Voltage");
         html.writeHeaderCell("Power");
@@ -326,10 +369,12 @@ void P1MonitorClass::writeLog(HtmlWriter& html, int page, int pageSize)
 }
 
 
-void P1MonitorClass::writeLogCsv(Print& output, int entries)
+int P1MonitorClass::writeLogCsv(Print& output, int entries, int maxRows)
 {
-    for (auto i = Log.at(-entries); i != Log.end(); ++i)
+    int rows = 0;
+    for (auto i = Log.at(-entries); (i != Log.end()) && (rows < maxRows); ++i, ++rows)
         i->writeCsv(output);
+    return rows;
 }
 
 
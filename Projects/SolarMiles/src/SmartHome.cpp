@@ -1,6 +1,7 @@
 #include <Tracer.h>
 #include <TimeUtils.h>
 #include "SmartHome.h"
+#include <algorithm>
 
 constexpr size_t NUM_SMARTTHINGS_CAPABILITIES = 4;
 
@@ -149,10 +150,17 @@ void SmartHomeClass::writeHtml(HtmlWriter& html)
     html.writeTableStart();
     html.writeRow("State", "%s", getStateLabel());
     if (_fritzboxPtr != nullptr)
+    {
         html.writeRow("Fritzbox", "%d ms", _fritzboxPtr->responseTimeMs());
+        writeCircuitBreaker(html, "Fritzbox circuit", _fritzboxBreaker);
+    }
     if (_smartThingsPtr != nullptr)
+    {
         html.writeRow("SmartThings", "%d ms", _smartThingsPtr->responseTimeMs());
+        writeBudget(html, "SmartThings budget", _smartThingsPtr->budget(), _smartThingsPtr->cache());
+    }
     if (_onectaPtr != nullptr)
+    {
         html.writeRow(
             "Onecta",
             "<div>%d ms</div><div>%d / %d</div><div>%s</div>",
@@ -160,6 +168,8 @@ void SmartHomeClass::writeHtml(HtmlWriter& html)
             _onectaPtr->rateLimitRemaining(),
             _onectaPtr->rateLimitPerDay(),
             formatTime("%H:%M:%S", _onectaPtr->requestAfter()));
+        writeBudget(html, "Onecta budget", _onectaPtr->budget(), _onectaPtr->cache());
+    }
     html.writeRow("Free Heap", "%0.1f kB", float(ESP.getMaxAllocHeap()) / 1024);
 
     html.writeTableEnd();
@@ -191,8 +201,10 @@ void SmartHomeClass::writeEnergyLogCsv(Print& output, bool onlyEntriesToSync)
 {
     if (onlyEntriesToSync)
     {
-        for (auto i = energyLog.at(-logEntriesToSync); i != energyLog.end(); ++i)
+        uint16_t unsentEntries = logSyncCursor.getUnsent();
+        for (auto i = energyLog.at(-unsentEntries); i != energyLog.end(); ++i)
             i->writeCsv(output);
+        logSyncCursor.advance(unsentEntries);
     }
     else
     {
@@ -212,6 +224,33 @@ void SmartHomeClass::run(void* taskParam)
     }
 }
 
+void SmartHomeClass::writeCircuitBreaker(HtmlWriter& html, const char* label, const CircuitBreaker& circuitBreaker)
+{
+    const CircuitBreakerStats& stats = circuitBreaker.getStats();
+    html.writeRow(
+        label,
+        "<div>%s</div><div>%u failures, %u trips</div><div>%u skipped</div>",
+        circuitBreaker.getStateLabel(),
+        stats.failures,
+        stats.trips,
+        stats.rejected);
+}
+
+
+void SmartHomeClass::writeBudget(HtmlWriter& html, const char* label, const RequestBudget& budget, const ResponseCache& cache)
+{
+    const RequestBudgetStats& stats = budget.getStats();
+    html.writeRow(
+        label,
+        "<div>%u / %u used</div><div>%u deferred, %u limited</div><div>%u cached</div>",
+        budget.getUsed(),
+        budget.getLimit(),
+        stats.deferred,
+        stats.rateLimited,
+        cache.getHits());
+}
+
+
 void SmartHomeClass::runStateMachine()
 {
     uint32_t currentMillis = millis();
@@ -220,13 +259,22 @@ void SmartHomeClass::runStateMachine()
     switch (_state)
     {
         case SmartHomeState::ConnectingFritzbox:
+            if (!_fritzboxBreaker.allowRequest(currentMillis))
+            {
+                _nextActionMillis = _fritzboxBreaker.getRetryMillis();
+                break;
+            }
             _isAwaiting = true;
             _fritzboxPtr->init();
             _isAwaiting = false;
             if (_fritzboxPtr->state() == TR064_SERVICES_LOADED)
+            {
+                _fritzboxBreaker.recordSuccess();
                 setState(SmartHomeState::DiscoveringFritzDevices);
+            }
             else
             {
+                _fritzboxBreaker.recordFailure();
                 _logger.logEvent("SmartHome: TR-064 connection failed");
                 _nextActionMillis = currentMillis + SH_RETRY_DELAY_MS;
             }
@@ -264,6 +312,14 @@ void SmartHomeClass::runStateMachine()
         case SmartHomeState::Ready:
             if (devices.size() > 0)
             {
+                // Devices with a stable power reading are polled less often, but never more than one per poll interval.
+                int deviceIndex = getDueDeviceIndex(currentMillis);
+                if (deviceIndex < 0)
+                {
+                    _nextActionMillis = currentMillis + SH_IDLE_DELAY_MS;
+                    break;
+                }
+                _currentDeviceIndex = deviceIndex;
                 _nextActionMillis = currentMillis + _pollInterval * 1000;
                 updateDevice();
             }
@@ -287,7 +343,8 @@ bool SmartHomeClass::discoverFritzSmartPlug(int index)
     {
         fritzSmartPlugPtr->powerThreshold = _powerThreshold;
         fritzSmartPlugPtr->powerOffDelay = _powerOffDelay; 
-        devices.push_back(fritzSmartPlugPtr);
+        fritzSmartPlugPtr->circuitBreakerPtr = &_fritzboxBreaker;
+        addDevice(fritzSmartPlugPtr);
         return false;
     }
 
@@ -364,7 +421,7 @@ bool SmartHomeClass::discoverSmartThings()
                 else
                     smartThingsDevicePtr->powerThreshold = 0;
                 smartThingsDevicePtr->powerOffDelay = _powerOffDelay; 
-                devices.push_back(smartThingsDevicePtr);
+                addDevice(smartThingsDevicePtr);
             }
         }
     }
@@ -388,13 +445,33 @@ bool SmartHomeClass::discoverOnectaDevices()
     for (String deviceId : _onectaPtr->deviceIds)
     {
         OnectaDevice* onectaDevicePtr = new OnectaDevice(deviceId, _onectaPtr, _logger);
-        devices.push_back(onectaDevicePtr);
+        addDevice(onectaDevicePtr);
     }
 
     return true;
 }
 
 
+void SmartHomeClass::addDevice(SmartDevice* smartDevicePtr)
+{
+    smartDevicePtr->poller.setLimits(_pollInterval * 1000, _pollInterval * 1000 * SH_MAX_POLL_FACTOR);
+    devices.push_back(smartDevicePtr);
+}
+
+
+int SmartHomeClass::getDueDeviceIndex(uint32_t currentMillis)
+{
+    // Round-robin, starting at the device after the one updated last
+    for (int i = 0; i < devices.size(); i++)
+    {
+        int deviceIndex = (_currentDeviceIndex + i) % devices.size();
+        if (devices[deviceIndex]->poller.isDue(currentMillis))
+            return deviceIndex;
+    }
+    return -1;
+}
+
+
 bool SmartHomeClass::updateDevice()
 {
     time_t currentTime = time(nullptr);
@@ -413,13 +490,18 @@ bool SmartHomeClass::updateDevice()
 
     if (!success) return false;
 
+    smartDevicePtr->poller.update(smartDevicePtr->power);
+    // While a device is on, its energy is logged and it is checked for going idle; keep polling it at the minimum interval.
+    smartDevicePtr->poller.setActive(smartDevicePtr->state == SmartDeviceState::On);
+    _isDeviceOn = std::any_of(devices.begin(), devices.end(), [](SmartDevice* devicePtr) { return devicePtr->state == SmartDeviceState::On; });
+
     if (deviceStateBefore == SmartDeviceState::On && smartDevicePtr->state == SmartDeviceState::Off)
     {
         // Device switched off; update energy log
         if (smartDevicePtr->energyLogEntry.energyDelta >= 1.0F)
         {
             energyLog.add(&smartDevicePtr->energyLogEntry);
-            logEntriesToSync = std::min(logEntriesToSync + 1, energyLog.size());
+            logSyncCursor.add();
         }
     }
     return true;
@@ -535,6 +617,7 @@ void SmartDevice::writeRow(HtmlWriter& html, bool isCurrent)
     html.writeCell(formatTime("%a %H:%M", energyLogEntry.start));
     html.writeCell(formatTimeSpan(energyLogEntry.getDuration()));
     html.writeCell(energyLogEntry.energyDelta, F("%0.0f"));
+    html.writeCell(float(poller.getIntervalMs()) / 1000, F("%0.0f"));
     html.writeRowEnd();
 }
 
@@ -551,6 +634,7 @@ void SmartDevice::writeHeader(HtmlWriter& html)
     html.writeHeaderCell("Last on");
     html.writeHeaderCell("Duration");
     html.writeHeaderCell("ΔE (Wh)");
+    html.writeHeaderCell("Poll (s)");
     html.writeRowEnd();
 }
 
@@ -585,7 +669,20 @@ bool FritzSmartPlug::update(time_t currentTime)
         {"NewTemperatureCelsius", ""}
     };
 
-    if (!_fritzboxPtr->action("X_AVM-DE_Homeauto:1", "GetSpecificDeviceInfos", params, 1, fields, 7))
+    // Don't wait for connect timeouts while the Fritzbox is unreachable
+    if ((circuitBreakerPtr != nullptr) && !circuitBreakerPtr->allowRequest())
+        return false;
+
+    bool success = _fritzboxPtr->action("X_AVM-DE_Homeauto:1", "GetSpecificDeviceInfos", params, 1, fields, 7);
+    if (circuitBreakerPtr != nullptr)
+    {
+        if (success)
+            circuitBreakerPtr->recordSuccess();
+        else
+            circuitBreakerPtr->recordFailure();
+    }
+
+    if (!success)
     {
         int errorCode = _fritzboxPtr->errorCode(); 
         if (errorCode != _lastErrorCode)
@@ -1,8 +1,15 @@
 #include <Tracer.h>
 #include <HTTPClient.h>
 #include <StreamUtils.h>
+#include <TimeUtils.h>
 #include "SmartThings.h"
 
+constexpr const char* RETRY_AFTER_HEADER = "Retry-After";
+constexpr uint32_t RATE_LIMIT_PER_MINUTE = 100;
+constexpr uint32_t MIN_REMAINING = 5;
+constexpr size_t CACHE_SIZE = 8;
+constexpr uint32_t CACHE_TTL = 10; // seconds; above the SmartHome poll interval (6 s)
+
 const char* _rootCA = "-----BEGIN CERTIFICATE-----\n" \
 "MIIDQTCCAimgAwIBAgITBmyfz5m/jAo54vB4ikPmljZbyjANBgkqhkiG9w0BAQsF\n" \
 "ADA5MQswCQYDVQQGEwJVUzEPMA0GA1UEChMGQW1hem9uMRkwFwYDVQQDExBBbWF6\n" \
@@ -25,7 +32,9 @@ const char* _rootCA = "-----BEGIN CERTIFICATE-----\n" \
 "-----END CERTIFICATE-----\n";
 
 SmartThingsClient::SmartThingsClient(const char* pat, ILogger& logger)
-    : jsonDoc(&_spiRamAllocator), _logger(logger) 
+    : jsonDoc(&_spiRamAllocator), _logger(logger),
+    _budget(RATE_LIMIT_PER_MINUTE, SECONDS_PER_MINUTE, MIN_REMAINING),
+    _cache(CACHE_SIZE, CACHE_TTL, &_spiRamAllocator)
 {
     _pat = pat;
 
@@ -50,10 +59,23 @@ SmartThingsClient::SmartThingsClient(const char* pat, ILogger& logger)
 }
 
 
-bool SmartThingsClient::request(const String& urlPath, const JsonDocument& filterDoc)
+bool SmartThingsClient::request(const String& urlPath, const JsonDocument& filterDoc, bool isUrgent)
 {
     Tracer tracer("SmartThingsClient::request", urlPath.c_str());
 
+    time_t currentTime = time(nullptr);
+    if (_cache.get(urlPath, currentTime, jsonDoc))
+    {
+        TRACE("Using cached response\n");
+        return true;
+    }
+
+    if (!_budget.tryAcquire(currentTime, isUrgent))
+    {
+        TRACE("Rate limit. Request after %s\n", formatTime("%H:%M:%S", _budget.getNextRequestTime()));
+        return false;
+    }
+
     String url = "https://api.smartthings.com/v1";
     url += urlPath;
 
@@ -68,6 +90,9 @@ bool SmartThingsClient::request(const String& urlPath, const JsonDocument& filte
     httpClient.setAuthorizationType("Bearer");
     httpClient.setAuthorization(_pat.c_str());
 
+    const char* headerKeys[] = { RETRY_AFTER_HEADER };
+    httpClient.collectHeaders(headerKeys, 1);
+
     uint32_t startMillis = millis();
     int httpCode = httpClient.GET();
     _responseTimeMs = millis() - startMillis;
@@ -84,6 +109,9 @@ bool SmartThingsClient::request(const String& urlPath, const JsonDocument& filte
         _responseTimeMs,
         httpClient.getSize());
 
+    if (httpCode == HTTP_CODE_TOO_MANY_REQUESTS)
+        _budget.rateLimited(currentTime, httpClient.header(RETRY_AFTER_HEADER).toInt());
+
     if (httpCode != HTTP_CODE_OK)
     {
         _logger.logEvent("SmartThings: HTTP %d", httpCode);
@@ -102,15 +130,19 @@ bool SmartThingsClient::request(const String& urlPath, const JsonDocument& filte
     httpClient.end();
 
     if (jsonError != DeserializationError::Ok)
+    {
         _logger.logEvent("SmartThings: JSON error %s", jsonError.c_str());
+        return false;
+    }
 
-    return (jsonError == DeserializationError::Ok);
+    _cache.put(urlPath, currentTime, jsonDoc);
+    return true;
 }
 
 
 bool SmartThingsClient::requestDevices()
 {
-    return request("/devices", _devicesFilter);
+    return request("/devices", _devicesFilter, true);
 }
 
 
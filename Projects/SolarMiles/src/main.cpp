@@ -6,6 +6,7 @@
 #include <Hoymiles.h>
 #include <WiFiNTP.h>
 #include <WiFiFTP.h>
+#include <SyncCursor.h>
 #include <TimeUtils.h>
 #include <Tracer.h>
 #include <StringBuilder.h>
@@ -79,7 +80,7 @@ StaticLog<PowerLogEntry> PowerLog(POWER_LOG_SIZE);
 PowerLogEntry* lastPowerLogEntryPtr = nullptr;
 PowerLogEntry newPowerLogEntry;
 int powerLogAggregations = 0;
-int powerLogEntriesToSync = 0;
+SyncCursor powerLogSyncCursor(POWER_LOG_SIZE);
 bool ftpSyncEnergy = false;
 
 EnergyLog TotalEnergyLog;
@@ -151,8 +152,8 @@ void handleSerialRequest()
             newPowerLogEntry.dcPower[0][0] = i;
             newPowerLogEntry.dcPower[0][1] = (POWER_LOG_SIZE - i);
             lastPowerLogEntryPtr = PowerLog.add(&newPowerLogEntry);
+            powerLogSyncCursor.add();
         }
-        powerLogEntriesToSync = 10;
 
         if (InverterLogPtrs.size() > 0)
         {
@@ -183,7 +184,7 @@ void handleSerialRequest()
         testLogEntry.maxPower = 666.1;
         testLogEntry.energyDelta = 6.666;
         SmartHome.energyLog.add(&testLogEntry);
-        SmartHome.logEntriesToSync = 1;
+        SmartHome.logSyncCursor.add();
         syncFTPTime = currentTime;
     }
     else if (cmd.startsWith("wifi"))
@@ -216,8 +217,8 @@ void updatePowerLog(int numInverters)
     {
         newPowerLogEntry.time = currentTime;
         lastPowerLogEntryPtr = PowerLog.add(&newPowerLogEntry);
-        powerLogEntriesToSync = std::min(powerLogEntriesToSync + 1, POWER_LOG_SIZE);
-        if (PersistentData.isFTPEnabled() && (powerLogEntriesToSync == PersistentData.ftpSyncEntries))
+        powerLogSyncCursor.add();
+        if (PersistentData.isFTPEnabled() && (powerLogSyncCursor.getLag() == PersistentData.ftpSyncEntries))
             syncFTPTime = currentTime;
     }
     newPowerLogEntry.reset(numInverters);
@@ -364,7 +365,7 @@ bool pollInverters()
 }
 
 
-void writePowerLogEntriesCsv(Print& output)
+int writePowerLogEntriesCsv(Print& output, int entries, int maxRows)
 {
     std::vector<size_t> dcChannels;
     for (int i = 0; i < Hoymiles.getNumInverters(); i++)
@@ -375,9 +376,10 @@ void writePowerLogEntriesCsv(Print& output)
         dcChannels.push_back(dcChannelCount);
     }
 
-    if (powerLogEntriesToSync != 0)
+    int rows = 0;
+    if (entries != 0)
     {
-        for (auto i = PowerLog.at(-powerLogEntriesToSync); i != PowerLog.end(); ++i)
+        for (auto i = PowerLog.at(-entries); (i != PowerLog.end()) && (rows < maxRows); ++i, ++rows)
         {
             PowerLogEntry& powerLogEntry = *i;
             output.print(formatTime("%F %H:%M", powerLogEntry.time));
@@ -392,6 +394,16 @@ void writePowerLogEntriesCsv(Print& output)
             output.println();
         }
     }
+    return rows;
+}
+
+
+void rollbackFTPSync()
+{
+    // Entries which were sent but not acknowledged are sent again in the next sync.
+    powerLogSyncCursor.rollback();
+    P1Monitor.logSyncCursor.rollback();
+    SmartHome.logSyncCursor.rollback();
 }
 
 
@@ -406,20 +418,24 @@ bool trySyncFTP(Print* printTo)
         FTP_DEFAULT_CONTROL_PORT,
         printTo);
 
+    // The logs are written in chunks, starting at the oldest entry to sync.
+    // New entries may be added in the meantime; they are included in this sync.
+    // The sync cursors only advance when the server confirmed the transfer.
     auto powerLogWriter = [printTo](Print& output)
     {
-        if (powerLogEntriesToSync != 0)
+        uint16_t unsentEntries = powerLogSyncCursor.getUnsent();
+        if (unsentEntries == 0)
         {
-            writePowerLogEntriesCsv(output);
-            powerLogEntriesToSync = 0;
+            if (printTo != nullptr) printTo->println("Nothing to sync.");
+            return true;
         }
-        else if (printTo != nullptr)
-            printTo->println("Nothing to sync.");
+        powerLogSyncCursor.advance(writePowerLogEntriesCsv(output, unsentEntries, FTP_ROWS_PER_STEP));
+        return powerLogSyncCursor.getUnsent() == 0;
     };
 
     String filename = PersistentData.hostName;
     filename += "_Power.csv";
-    FTPClient.appendAsync(filename, powerLogWriter);
+    FTPClient.appendLogChunkedAsync(filename, powerLogSyncCursor, powerLogWriter, []() { powerLogSyncCursor.acknowledge(currentTime); });
 
     if (ftpSyncEnergy)
     {
@@ -435,50 +451,61 @@ bool trySyncFTP(Print* printTo)
                     yesterdayLogEntry.maxPower,
                     yesterdayLogEntry.energy / 1000
                     );
-                ftpSyncEnergy = false;
             };
 
             filename = PersistentData.hostName;
             filename += "_TotalEnergy.csv";
-            FTPClient.appendAsync(filename, energyLogWriter);
+            FTPClient.appendAsync(filename, energyLogWriter, []() { ftpSyncEnergy = false; });
         }
     }
 
-    if (P1Monitor.logEntriesToSync != 0)
+    if (P1Monitor.logSyncCursor.getUnsent() != 0)
     {
         auto p1MonitorLogWriter = [](Print& output)
         {
-            P1Monitor.writeLogCsv(output, P1Monitor.logEntriesToSync);
-            P1Monitor.logEntriesToSync = 0;
+            SyncCursor& syncCursor = P1Monitor.logSyncCursor;
+            syncCursor.advance(P1Monitor.writeLogCsv(output, syncCursor.getUnsent(), FTP_ROWS_PER_STEP));
+            return syncCursor.getUnsent() == 0;
         };
 
         filename = PersistentData.hostName;
         filename += "_P1.csv";
-        FTPClient.appendAsync(filename, p1MonitorLogWriter);
+        FTPClient.appendLogChunkedAsync(
+            filename,
+            P1Monitor.logSyncCursor,
+            p1MonitorLogWriter,
+            []() { P1Monitor.logSyncCursor.acknowledge(currentTime); });
     }
 
-    if (SmartHome.logEntriesToSync != 0)
+    if (SmartHome.logSyncCursor.getUnsent() != 0)
     {
         auto smartHomeEnergyLogWriter = [](Print& output)
         {
             SmartHome.writeEnergyLogCsv(output);
-            SmartHome.logEntriesToSync = 0;
         };
 
         filename = PersistentData.hostName;
         filename += "_SmartHome.csv";
-        FTPClient.appendAsync(filename, smartHomeEnergyLogWriter);
+        FTPClient.appendLogAsync(
+            filename,
+            SmartHome.logSyncCursor,
+            smartHomeEnergyLogWriter,
+            []() { SmartHome.logSyncCursor.acknowledge(currentTime); });
     }
 
    if (printTo == nullptr) return true; // Run async
 
     // Run synchronously
     bool success = FTPClient.run();
-    if (success) lastFTPSyncTime = currentTime;
+    if (success)
+        lastFTPSyncTime = currentTime;
+    else
+        rollbackFTPSync();
     return success;
 }
 
 
+
 bool canUseWiFi()
 {
     return Hoymiles.isAllRadioIdle() && WiFiSM.isConnected();
@@ -518,7 +545,7 @@ void onTimeServerSynced()
 
         if (PersistentData.p1MonitorHost[0] != 0)
         {
-            if (!P1Monitor.begin(PersistentData.p1MonitorHost, P1_POLL_INTERVAL, 10, 1))
+            if (!P1Monitor.begin(PersistentData.p1MonitorHost, P1_MIN_POLL_INTERVAL, P1_MAX_POLL_INTERVAL, 10, 1))
                 WiFiSM.logEvent("Unable to initialize P1 Monitor");
         }
     }
@@ -572,6 +599,8 @@ void onWiFiInitialized()
         pollInvertersTime = currentTime + inverterPollInterval;
     }
 
+    // While a smart device is on, follow the grid power closely
+    P1Monitor.setActive(SmartHome.isDeviceOn());
     if (canUseWiFi() && !SmartHome.isAwaiting())
         P1Monitor.run(currentTime);
 
@@ -586,12 +615,17 @@ void onWiFiInitialized()
     else
         BuiltinLED.setOff();
 
-    if (SmartHome.logEntriesToSync != 0 && syncFTPTime == 0 && PersistentData.isFTPEnabled())
+    if (SmartHome.logSyncCursor.getLag() != 0
+        && syncFTPTime == 0
+        && PersistentData.isFTPEnabled()
+        && !FTPClient.isAsyncPending())
         syncFTPTime = currentTime + FTP_RETRY_INTERVAL; // Prevent FTP sync shortly after eachother
 
-    if (P1Monitor.logEntriesToSync == PersistentData.ftpSyncEntries
+    // After a failed sync, the retry is already scheduled.
+    if (P1Monitor.logSyncCursor.getLag() == PersistentData.ftpSyncEntries
         && PersistentData.isFTPEnabled()
-        && !FTPClient.isAsyncPending())
+        && !FTPClient.isAsyncPending()
+        && (syncFTPTime == 0))
         syncFTPTime = currentTime;
 
     if (!WiFiSM.isConnected()) return;
@@ -613,6 +647,7 @@ void onWiFiInitialized()
             else
             {
                 WiFiSM.logEvent("FTP sync failed: %s", FTPClient.getLastError());
+                rollbackFTPSync();
                 syncFTPTime = currentTime + FTP_RETRY_INTERVAL;
             }
             FTPClient.endAsync();
@@ -956,6 +991,32 @@ void handleHttpSyncFTPRequest()
     else
         Html.writeParagraph("Failed: %s", FTPClient.getLastError());
 
+    Html.writeTableStart();
+    Html.writeRowStart();
+    Html.writeHeaderCell("File");
+    Html.writeHeaderCell("Size (bytes)");
+    Html.writeHeaderCell("Duration (ms)");
+    Html.writeHeaderCell("kB/s");
+    Html.writeRowEnd();
+    for (const FTPTransferStats& transfer : FTPClient.getTransfers())
+    {
+        Html.writeRowStart();
+        Html.writeCell(transfer.filename.c_str());
+        Html.writeCell(static_cast<uint32_t>(transfer.bytes));
+        Html.writeCell(transfer.durationMs);
+        Html.writeCell(transfer.getKBps(), F("%0.1f"));
+        Html.writeRowEnd();
+    }
+    Html.writeTableEnd();
+
+    const FTPClientStats& ftpStats = FTPClient.getStats();
+    Html.writeParagraph(
+        "Sessions: %u (%u reused). Transfers: %u (%u bytes)",
+        ftpStats.sessions,
+        ftpStats.reusedSessions,
+        ftpStats.transfers,
+        ftpStats.bytes);
+
     Html.writeHeading("CSV headers", 2);
     Html.writePreStart();
     HttpResponse.print("Time");
@@ -1356,6 +1417,8 @@ void handleHttpRootRequest()
     String ftpSync;
     if (!PersistentData.isFTPEnabled())
         ftpSync = "Disabled";
+    else if (FTPClient.getCircuitBreaker().isOpen())
+        ftpSync = "Server unreachable";
     else if (lastFTPSyncTime == 0)
         ftpSync = "Not yet";
     else
@@ -1372,9 +1435,9 @@ void handleHttpRootRequest()
     Html.writeRow("Next poll", "%s", formatTime("%H:%M:%S", pollInvertersTime));
     Html.writeRow("FTP Sync", ftpSync.c_str());
     Html.writeRow(
-        "Sync Entries", "%d, %d / %d",
-        powerLogEntriesToSync,
-        P1Monitor.logEntriesToSync,
+        "Sync lag", "%u, %u / %d",
+        powerLogSyncCursor.getLag(),
+        P1Monitor.logSyncCursor.getLag(),
         PersistentData.ftpSyncEntries);
     Html.writeTableEnd();
     Html.writeSectionEnd();
@@ -1413,8 +1476,15 @@ void setup()
 
     BuiltinLED.begin();
 
-    PersistentData.begin();
+    PersistentData.begin(PersistentStorage::NVS);
+
+    // Keep the log sync positions across resets (RTC memory slots)
+    powerLogSyncCursor.begin(0);
+    P1Monitor.logSyncCursor.begin(1);
+    SmartHome.logSyncCursor.begin(2);
+
     TimeServer.begin(PersistentData.ntpServer);
+    FTPClient.setIdleTimeout(FTP_IDLE_TIMEOUT);
     Html.setTitlePrefix(PersistentData.hostName);
     
     Nav.menuItems =
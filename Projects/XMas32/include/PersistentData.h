@@ -37,9 +37,7 @@ struct Settings : public BasicWiFiSettings
     uint8_t ledSchedules[RGB_LED_COUNT];
     int selectedMidiTrack;
 
-    Settings() 
-        : BasicWiFiSettings("XMas32", sizeof(scheduleEntries) + sizeof(ledSchedules) + sizeof(selectedMidiTrack))
-    {}
+    Settings();
 
     void initialize() override
     {
@@ -51,4 +49,18 @@ struct Settings : public BasicWiFiSettings
     }
 };
 
+PERSISTENT_FIELD_TABLE_BEGIN
+constexpr PersistentDataField SETTINGS_FIELDS[] PROGMEM =
+{
+    PersistentDataField::binaryField("Schedules", PERSISTENT_FIELD(Settings, scheduleEntries)),
+    PersistentDataField::binaryField("LED schedules", PERSISTENT_FIELD(Settings, ledSchedules)),
+    PersistentDataField::binaryField("MIDI track", PERSISTENT_FIELD(Settings, selectedMidiTrack))
+};
+PERSISTENT_FIELD_TABLE_END
+
+Settings::Settings() : BasicWiFiSettings("XMas32")
+{
+    addFields(SETTINGS_FIELDS);
+}
+
 Settings PersistentData;